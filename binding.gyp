@@ -13,6 +13,7 @@
                 "src/node/utils/wlog.cpp",
                 "src/node/utils/wrap.cpp",
                 "src/node/utils/wjwt.cpp",
+                "src/node/utils/wdir_hasher.cpp",
                 "src/node/pki/wcrl.cpp",
                 "src/node/pki/wcrls.cpp",
                 "src/node/pki/wrevoked.cpp",
@@ -40,7 +41,9 @@
                 "src/node/cms/wsigners.cpp",
                 "src/node/cms/wsigner_attrs.cpp",
                 "src/node/cms/wcmsRecipientInfo.cpp",
-                "src/node/cms/wcmsRecipientInfos.cpp"
+                "src/node/cms/wcmsRecipientInfos.cpp",
+                "src/node/cms/wrecipient_set.cpp",
+                "src/node/cms/wheader.cpp"
             ],
             "xcode_settings": {
                 "OTHER_CPLUSPLUSFLAGS": [
@@ -0,0 +1,73 @@
+#include <wrapper/stdafx.h>
+
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+#include <openssl/crypto.h>
+
+#include <wrapper/common/pool.h>
+
+#include "fixtures.h"
+
+/*
+ * Every heap allocation of the process (C++ operator new and OpenSSL
+ * CRYPTO_malloc) is counted here. Pool blocks are not counted, only the
+ * slabs they are carved from
+ */
+static std::atomic<uint64_t> allocations(0);
+
+void *operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+
+	void *res = malloc(size ? size : 1);
+	if (!res) {
+		throw std::bad_alloc();
+	}
+
+	return res;
+}
+
+void operator delete(void *ptr) noexcept {
+	free(ptr);
+}
+
+void *operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete[](void *ptr) noexcept {
+	free(ptr);
+}
+
+static void *benchMalloc(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+
+	return malloc(size);
+}
+
+static void *benchRealloc(void *ptr, size_t size) {
+	if (!ptr) {
+		allocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return realloc(ptr, size);
+}
+
+void benchCountAllocations() {
+	CRYPTO_set_mem_functions(benchMalloc, benchRealloc, free);
+}
+
+uint64_t benchAllocations() {
+	return allocations.load(std::memory_order_relaxed);
+}
+
+BenchAllocCounter::BenchAllocCounter(benchmark::State &state)
+	: state_(state), allocations_(benchAllocations()), slabs_(Pool::slabs())
+{
+}
+
+BenchAllocCounter::~BenchAllocCounter() {
+	state_.counters["allocs"] = benchmark::Counter((double)(benchAllocations() - allocations_), benchmark::Counter::kAvgIterations);
+	state_.counters["slabs"] = (double)(Pool::slabs() - slabs_);
+}
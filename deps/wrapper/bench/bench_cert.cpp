@@ -0,0 +1,108 @@
+#include <wrapper/stdafx.h>
+
+#include <benchmark/benchmark.h>
+
+#include "fixtures.h"
+
+static void BM_Certificate_Read(benchmark::State &state) {
+	DataFormat::DATA_FORMAT format = DataFormat::get((int)state.range(0));
+	std::string encoded = benchEncodedLeaf(format);
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		Handle<Certificate> cert = new Certificate();
+		cert->read(benchMemBio(encoded), format);
+		benchmark::DoNotOptimize(cert->internal());
+	}
+	state.SetBytesProcessed(state.iterations() * encoded.length());
+}
+BENCHMARK(BM_Certificate_Read)->Arg(DataFormat::DER)->Arg(DataFormat::BASE64);
+
+static void BM_Certificate_Thumbprint(benchmark::State &state) {
+	std::string encoded = benchEncodedLeaf(DataFormat::DER);
+
+	for (auto _ : state) {
+		Handle<Certificate> cert = new Certificate();
+		cert->read(benchMemBio(encoded), DataFormat::DER);
+		benchmark::DoNotOptimize(cert->getThumbprint());
+	}
+}
+BENCHMARK(BM_Certificate_Thumbprint);
+
+static void BM_Certificate_Hashes(benchmark::State &state) {
+	std::string encoded = benchEncodedLeaf(DataFormat::DER);
+	std::vector<Handle<std::string> > algorithms;
+	algorithms.push_back(new std::string("sha1"));
+	algorithms.push_back(new std::string("sha256"));
+
+	for (auto _ : state) {
+		Handle<Certificate> cert = new Certificate();
+		cert->read(benchMemBio(encoded), DataFormat::DER);
+		benchmark::DoNotOptimize(cert->hashes(algorithms));
+	}
+}
+BENCHMARK(BM_Certificate_Hashes);
+
+static void BM_Certificate_Properties(benchmark::State &state) {
+	Handle<Certificate> cert = BenchPki::get().leaf;
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(cert->getSubjectName());
+		benchmark::DoNotOptimize(cert->getIssuerName());
+		benchmark::DoNotOptimize(cert->getSerialNumber());
+		benchmark::DoNotOptimize(cert->getNotAfter());
+		benchmark::DoNotOptimize(cert->getOrganizationName());
+	}
+}
+BENCHMARK(BM_Certificate_Properties);
+
+/* Rejecting garbage input: 0 - read() and catch, 1 - tryRead() */
+static void BM_Certificate_ReadInvalid(benchmark::State &state) {
+	std::string encoded = benchPayload(1024);
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		Handle<Certificate> cert = new Certificate();
+		bool res = false;
+
+		if (state.range(0)) {
+			res = cert->tryRead(benchMemBio(encoded), DataFormat::DER);
+		}
+		else {
+			try {
+				cert->read(benchMemBio(encoded), DataFormat::DER);
+				res = true;
+			}
+			catch (Handle<Exception> e) {
+			}
+		}
+		benchmark::DoNotOptimize(res);
+	}
+}
+BENCHMARK(BM_Certificate_ReadInvalid)->Arg(0)->Arg(1);
+
+/* Same for CRL, whose read() wraps the error into a second exception */
+static void BM_CRL_ReadInvalid(benchmark::State &state) {
+	std::string encoded = benchPayload(1024);
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		Handle<CRL> crl = new CRL();
+		bool res = false;
+
+		if (state.range(0)) {
+			res = crl->tryRead(benchMemBio(encoded), DataFormat::DER);
+		}
+		else {
+			try {
+				crl->read(benchMemBio(encoded), DataFormat::DER);
+				res = true;
+			}
+			catch (Handle<Exception> e) {
+			}
+		}
+		benchmark::DoNotOptimize(res);
+	}
+}
+BENCHMARK(BM_CRL_ReadInvalid)->Arg(0)->Arg(1);
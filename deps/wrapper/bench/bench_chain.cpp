@@ -0,0 +1,34 @@
+#include <wrapper/stdafx.h>
+
+#include <benchmark/benchmark.h>
+
+#include <wrapper/pki/chain.h>
+
+#include "fixtures.h"
+
+static void BM_Chain_Build(benchmark::State &state) {
+	BenchPki &pki = BenchPki::get();
+	Chain chain;
+
+	for (auto _ : state) {
+		Handle<CertificateCollection> res = chain.buildChain(pki.leaf, pki.certs);
+		benchmark::DoNotOptimize(res->length());
+	}
+}
+BENCHMARK(BM_Chain_Build);
+
+static void BM_Chain_Verify(benchmark::State &state) {
+	BenchPki &pki = BenchPki::get();
+	Chain chain;
+	Handle<CertificateCollection> certs = chain.buildChain(pki.leaf, pki.certs);
+	Handle<CrlCollection> crls = new CrlCollection();
+
+	if (!chain.verifyChain(certs, crls)) {
+		state.SkipWithError("Chain::verifyChain failed");
+	}
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(chain.verifyChain(certs, crls));
+	}
+}
+BENCHMARK(BM_Chain_Verify);
@@ -0,0 +1,163 @@
+#include <wrapper/stdafx.h>
+
+#include <benchmark/benchmark.h>
+
+#include <wrapper/pki/cipher.h>
+
+#include "fixtures.h"
+
+static void BM_Cipher_Symmetric(benchmark::State &state) {
+	std::string payload = benchPayload((size_t)state.range(0));
+
+	for (auto _ : state) {
+		Cipher cipher;
+		cipher.setCryptoMethod(CryptoMethod::SYMMETRIC);
+		cipher.setPass(new std::string("benchmark"));
+
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		cipher.encrypt(benchMemBio(payload), out, DataFormat::DER);
+		benchmark::DoNotOptimize(out->internal());
+	}
+	state.SetBytesProcessed(state.iterations() * payload.length());
+}
+BENCHMARK(BM_Cipher_Symmetric)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+static void BM_Cipher_Asymmetric(benchmark::State &state) {
+	BenchPki &pki = BenchPki::get();
+	std::string payload = benchPayload((size_t)state.range(0));
+	Handle<CertificateCollection> recipients = new CertificateCollection();
+	recipients->push(pki.leaf);
+
+	for (auto _ : state) {
+		Cipher cipher;
+		cipher.addRecipientsCerts(recipients);
+
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		cipher.encrypt(benchMemBio(payload), out, DataFormat::DER);
+		benchmark::DoNotOptimize(out->internal());
+	}
+	state.SetBytesProcessed(state.iterations() * payload.length());
+}
+BENCHMARK(BM_Cipher_Asymmetric)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+/* Symmetric throughput of one cipher on 4 MB */
+static void BM_Cipher_SymmetricAlgorithm(benchmark::State &state, const char *algorithm) {
+	std::string payload = benchPayload(1 << 22);
+
+	for (auto _ : state) {
+		Cipher cipher;
+		cipher.setCryptoMethod(CryptoMethod::SYMMETRIC);
+		cipher.setPass(new std::string("benchmark"));
+		cipher.setAlgorithm(new std::string(algorithm));
+
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		cipher.encrypt(benchMemBio(payload), out, DataFormat::DER);
+		benchmark::DoNotOptimize(out->internal());
+	}
+	state.SetBytesProcessed(state.iterations() * payload.length());
+}
+BENCHMARK_CAPTURE(BM_Cipher_SymmetricAlgorithm, des_ede3_cbc, "des-ede3-cbc")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Cipher_SymmetricAlgorithm, aes_128_cbc, "aes-128-cbc")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Cipher_SymmetricAlgorithm, aes_256_cbc, "aes-256-cbc")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Cipher_SymmetricAlgorithm, aes_256_ctr, "aes-256-ctr")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Cipher_SymmetricAlgorithm, aes_128_gcm, "aes-128-gcm")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Cipher_SymmetricAlgorithm, aes_256_gcm, "aes-256-gcm")->Unit(benchmark::kMillisecond);
+
+/* CMS content encryption with AES instead of the default 3DES */
+static void BM_Cipher_AsymmetricAes(benchmark::State &state) {
+	BenchPki &pki = BenchPki::get();
+	std::string payload = benchPayload((size_t)state.range(0));
+	Handle<CertificateCollection> recipients = new CertificateCollection();
+	recipients->push(pki.leaf);
+
+	for (auto _ : state) {
+		Cipher cipher;
+		cipher.setAlgorithm(new std::string("aes-256-cbc"));
+		cipher.addRecipientsCerts(recipients);
+
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		cipher.encrypt(benchMemBio(payload), out, DataFormat::DER);
+		benchmark::DoNotOptimize(out->internal());
+	}
+	state.SetBytesProcessed(state.iterations() * payload.length());
+}
+BENCHMARK(BM_Cipher_AsymmetricAes)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+/* Chunked container, 16 MB in 1 MB chunks on range(0) threads */
+static void BM_Cipher_EncryptChunked(benchmark::State &state) {
+	std::string payload = benchPayload(16 << 20);
+
+	for (auto _ : state) {
+		Cipher cipher;
+		cipher.setCryptoMethod(CryptoMethod::SYMMETRIC);
+		cipher.setAlgorithm(new std::string("aes-256-gcm"));
+		cipher.setPass(new std::string("benchmark"));
+		cipher.setThreads((int)state.range(0));
+
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		cipher.encryptChunked(benchMemBio(payload), out);
+		benchmark::DoNotOptimize(out->internal());
+	}
+	state.SetBytesProcessed(state.iterations() * payload.length());
+}
+BENCHMARK(BM_Cipher_EncryptChunked)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/* 4 KB from the middle of a 16 MB container */
+static void BM_Cipher_DecryptChunkedRange(benchmark::State &state) {
+	std::string payload = benchPayload(16 << 20);
+
+	Cipher cipher;
+	cipher.setCryptoMethod(CryptoMethod::SYMMETRIC);
+	cipher.setAlgorithm(new std::string("aes-256-gcm"));
+	cipher.setPass(new std::string("benchmark"));
+
+	Handle<Bio> enc = new Bio(BIO_TYPE_MEM, "");
+	cipher.encryptChunked(benchMemBio(payload), enc);
+	char *data;
+	long length = BIO_get_mem_data(enc->internal(), &data);
+	std::string encrypted(data, length);
+
+	for (auto _ : state) {
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		cipher.decryptChunkedRange(benchMemBio(encrypted), out, 8 << 20, 4096);
+		benchmark::DoNotOptimize(out->internal());
+	}
+}
+BENCHMARK(BM_Cipher_DecryptChunkedRange)->Unit(benchmark::kMicrosecond);
+
+/*
+ * Decrypt of a small file encrypted with PBKDF2 (100000 iterations),
+ * range(0) = 1 - derived key comes from the cache after the first file
+ */
+static void BM_Cipher_Pbkdf2Decrypt(benchmark::State &state) {
+	std::string payload = benchPayload(4096);
+
+	Cipher cipher;
+	cipher.setCryptoMethod(CryptoMethod::SYMMETRIC);
+	cipher.setAlgorithm(new std::string("aes-256-cbc"));
+	cipher.setKdf(KdfMethod::PBKDF2, 100000);
+	cipher.setPass(new std::string("benchmark"));
+
+	Handle<Bio> enc = new Bio(BIO_TYPE_MEM, "");
+	cipher.encrypt(benchMemBio(payload), enc, DataFormat::DER);
+	char *data;
+	long length = BIO_get_mem_data(enc->internal(), &data);
+	std::string encrypted(data, length);
+
+	Cipher::setKdfCacheSize(state.range(0) ? KDF_CACHE_DEFAULT_SIZE : 0);
+
+	for (auto _ : state) {
+		Cipher file;
+		file.setCryptoMethod(CryptoMethod::SYMMETRIC);
+		file.setAlgorithm(new std::string("aes-256-cbc"));
+		file.setKdf(KdfMethod::PBKDF2, 100000);
+		file.setPass(new std::string("benchmark"));
+
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		file.decrypt(benchMemBio(encrypted), out, DataFormat::DER);
+		benchmark::DoNotOptimize(out->internal());
+	}
+
+	Cipher::setKdfCacheSize(KDF_CACHE_DEFAULT_SIZE);
+}
+BENCHMARK(BM_Cipher_Pbkdf2Decrypt)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,172 @@
+#include <wrapper/stdafx.h>
+
+#include <benchmark/benchmark.h>
+
+#include <wrapper/cms/signed_data.h>
+#include <wrapper/cms/recipient_set.h>
+#include <wrapper/cms/header.h>
+#include <wrapper/pki/cipher.h>
+
+#include "fixtures.h"
+
+static void BM_SignedData_Sign(benchmark::State &state) {
+	BenchPki &pki = BenchPki::get();
+	std::string payload = benchPayload((size_t)state.range(0));
+	Handle<CertificateCollection> certs = new CertificateCollection();
+
+	for (auto _ : state) {
+		Handle<SignedData> sd = SignedData::sign(pki.leaf, pki.leafKey, certs, benchMemBio(payload), CMS_BINARY);
+		benchmark::DoNotOptimize(sd->internal());
+	}
+	state.SetBytesProcessed(state.iterations() * payload.length());
+}
+BENCHMARK(BM_SignedData_Sign)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+static void BM_SignedData_Verify(benchmark::State &state) {
+	BenchPki &pki = BenchPki::get();
+	std::string payload = benchPayload((size_t)state.range(0));
+	Handle<CertificateCollection> certs = new CertificateCollection();
+
+	Handle<SignedData> signedData = SignedData::sign(pki.leaf, pki.leafKey, certs, benchMemBio(payload), CMS_BINARY);
+	Handle<Bio> encoded = new Bio(BIO_TYPE_MEM, "");
+	signedData->write(encoded, DataFormat::DER);
+	std::string der = *encoded->read();
+
+	Handle<SignedData> check = new SignedData();
+	check->read(benchMemBio(der), DataFormat::DER);
+	check->setFlags(CMS_BINARY | CMS_NO_SIGNER_CERT_VERIFY);
+	if (!check->verify(certs)) {
+		state.SkipWithError("SignedData::verify failed");
+	}
+
+	for (auto _ : state) {
+		Handle<SignedData> sd = new SignedData();
+		sd->read(benchMemBio(der), DataFormat::DER);
+		sd->setFlags(CMS_BINARY | CMS_NO_SIGNER_CERT_VERIFY);
+		benchmark::DoNotOptimize(sd->verify(certs));
+	}
+	state.SetBytesProcessed(state.iterations() * payload.length());
+}
+BENCHMARK(BM_SignedData_Verify)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+/* Leaf certificates of the intermediate CA sharing the leaf key, issued once */
+static Handle<CertificateCollection> benchRecipients(size_t count) {
+	static std::vector<Handle<Certificate> > issued;
+	BenchPki &pki = BenchPki::get();
+	Handle<CertificateCollection> res = new CertificateCollection();
+
+	while (issued.size() < count) {
+		std::string name = "Recipient " + std::to_string(issued.size());
+		issued.push_back(fixtureIssue(name.c_str(), pki.leafKey, pki.intermediate, pki.intermediateKey, false));
+	}
+	for (size_t i = 0; i < count; i++) {
+		res->push(issued[i]);
+	}
+
+	return res;
+}
+
+/* 1 KB message to a fixed list of recipients through Cipher: CMS_encrypt each time */
+static void BM_EnvelopedData_Cipher(benchmark::State &state) {
+	Handle<CertificateCollection> recipients = benchRecipients((size_t)state.range(0));
+	std::string payload = benchPayload(1024);
+	Cipher cipher;
+	cipher.addRecipientsCerts(recipients);
+
+	for (auto _ : state) {
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		cipher.encrypt(benchMemBio(payload), out, DataFormat::DER);
+		benchmark::DoNotOptimize(out->internal());
+	}
+}
+BENCHMARK(BM_EnvelopedData_Cipher)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+/* Same with the recipient set prepared once */
+static void BM_EnvelopedData_RecipientSet(benchmark::State &state) {
+	Handle<CertificateCollection> recipients = benchRecipients((size_t)state.range(0));
+	std::string payload = benchPayload(1024);
+	CmsRecipientSet set;
+	set.push(recipients);
+
+	for (auto _ : state) {
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		set.encrypt(benchMemBio(payload), out, DataFormat::DER);
+		benchmark::DoNotOptimize(out->internal());
+	}
+}
+BENCHMARK(BM_EnvelopedData_RecipientSet)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+/* Signed message of the given size, attached, in DER */
+static std::string benchSignedDer(size_t size) {
+	BenchPki &pki = BenchPki::get();
+	std::string payload = benchPayload(size);
+	Handle<CertificateCollection> certs = new CertificateCollection();
+
+	Handle<SignedData> signedData = SignedData::sign(pki.leaf, pki.leafKey, certs, benchMemBio(payload), CMS_BINARY);
+	Handle<Bio> encoded = new Bio(BIO_TYPE_MEM, "");
+	signedData->write(encoded, DataFormat::DER);
+
+	return *encoded->read();
+}
+
+/* Content type and signer identifier of a signed message through the full CMS parse */
+static void BM_CmsRoute_SignedData(benchmark::State &state) {
+	std::string der = benchSignedDer((size_t)state.range(0));
+
+	for (auto _ : state) {
+		Handle<SignedData> sd = new SignedData();
+		sd->read(benchMemBio(der), DataFormat::DER);
+		Handle<SignerId> id = sd->signers(0)->getSignerId();
+		benchmark::DoNotOptimize(id->getSerialNumber());
+	}
+}
+BENCHMARK(BM_CmsRoute_SignedData)->RangeMultiplier(32)->Range(1 << 10, 1 << 20)->Unit(benchmark::kMicrosecond);
+
+/* Same through CmsHeader */
+static void BM_CmsRoute_Header(benchmark::State &state) {
+	std::string der = benchSignedDer((size_t)state.range(0));
+
+	for (auto _ : state) {
+		CmsHeader header;
+		header.read((const unsigned char *)der.data(), der.length());
+		Handle<SignerId> id = header.getSigner(0);
+		benchmark::DoNotOptimize(id->getSerialNumber());
+	}
+}
+BENCHMARK(BM_CmsRoute_Header)->RangeMultiplier(32)->Range(1 << 10, 1 << 20)->Unit(benchmark::kMicrosecond);
+
+/* Recipients of a 1 MB enveloped message through Cipher::getRecipientInfos */
+static void BM_CmsRecipients_Cipher(benchmark::State &state) {
+	Handle<CertificateCollection> recipients = benchRecipients((size_t)state.range(0));
+	std::string payload = benchPayload(1 << 20);
+	CmsRecipientSet set;
+	set.push(recipients);
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+	set.encrypt(benchMemBio(payload), out, DataFormat::DER);
+	std::string der = *out->read();
+	Cipher cipher;
+
+	for (auto _ : state) {
+		Handle<CmsRecipientInfoCollection> ris = cipher.getRecipientInfos(benchMemBio(der), DataFormat::DER);
+		benchmark::DoNotOptimize(ris->items(0)->getIssuerName());
+	}
+}
+BENCHMARK(BM_CmsRecipients_Cipher)->Arg(1)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+/* Same through CmsHeader */
+static void BM_CmsRecipients_Header(benchmark::State &state) {
+	Handle<CertificateCollection> recipients = benchRecipients((size_t)state.range(0));
+	std::string payload = benchPayload(1 << 20);
+	CmsRecipientSet set;
+	set.push(recipients);
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+	set.encrypt(benchMemBio(payload), out, DataFormat::DER);
+	std::string der = *out->read();
+
+	for (auto _ : state) {
+		CmsHeader header;
+		header.read((const unsigned char *)der.data(), der.length());
+		benchmark::DoNotOptimize(header.getRecipient(0)->getIssuerName());
+	}
+}
+BENCHMARK(BM_CmsRecipients_Header)->Arg(1)->Arg(100)->Unit(benchmark::kMicrosecond);
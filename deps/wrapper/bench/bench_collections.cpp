@@ -0,0 +1,100 @@
+#include <wrapper/stdafx.h>
+
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <wrapper/pki/revokeds.h>
+
+#include "fixtures.h"
+
+/* Walk over revoked entries of a large CRL. Each item is a wrapper with its own SObject */
+static void BM_RevokedCollection_Items(benchmark::State &state) {
+	Handle<CRL> crl = benchCrl((int)state.range(0));
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		Handle<RevokedCollection> revoked = crl->getRevoked();
+		int count = revoked->length();
+
+		for (int i = 0; i < count; i++) {
+			Handle<Revoked> item = revoked->items(i);
+			benchmark::DoNotOptimize(item->internal());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RevokedCollection_Items)->Arg(1000)->Arg(10000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_CertificateCollection_Items(benchmark::State &state) {
+	Handle<CertificateCollection> certs = BenchPki::get().certs;
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		for (int i = 0; i < certs->length(); i++) {
+			Handle<Certificate> cert = certs->items(i);
+			benchmark::DoNotOptimize(cert->internal());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * certs->length());
+}
+BENCHMARK(BM_CertificateCollection_Items);
+
+/* Wrapper lifecycle only: Handle counter, wrapper and SObject */
+static void BM_Wrapper_Create(benchmark::State &state) {
+	X509 *x = BenchPki::get().leaf->internal();
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		Handle<Certificate> cert = new Certificate(x, BenchPki::get().leaf->handle());
+		benchmark::DoNotOptimize(cert->internal());
+	}
+}
+BENCHMARK(BM_Wrapper_Create);
+
+/* Checked public accessor: Handle copy plus logging */
+static void BM_SSLObject_Internal(benchmark::State &state) {
+	Handle<Certificate> cert = BenchPki::get().leaf;
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(cert->internal());
+	}
+}
+BENCHMARK(BM_SSLObject_Internal);
+
+/* Accessor used by hot paths inside the library */
+static void BM_SSLObject_Raw(benchmark::State &state) {
+	Handle<Certificate> cert = BenchPki::get().leaf;
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(cert->raw());
+	}
+}
+BENCHMARK(BM_SSLObject_Raw);
+
+/*
+ * Short-lived thread per call, as Bundle, chunked Cipher and DirectoryHasher
+ * workers do: wrappers are created and released on the thread, which is joined.
+ * Pool blocks of exited threads must be reused, so slabs stay flat
+ */
+static void BM_Pool_ThreadChurn(benchmark::State &state) {
+	X509 *x = BenchPki::get().leaf->internal();
+	Handle<SObject> parent = BenchPki::get().leaf->handle();
+	size_t count = (size_t)state.range(0);
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		std::thread worker([x, parent, count]() {
+			std::vector<Handle<Certificate> > certs;
+			certs.reserve(count);
+			for (size_t i = 0; i < count; i++) {
+				certs.push_back(new Certificate(x, parent));
+			}
+		});
+		worker.join();
+	}
+}
+BENCHMARK(BM_Pool_ThreadChurn)->Arg(100)->Arg(10000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,182 @@
+#include <wrapper/stdafx.h>
+
+#include <benchmark/benchmark.h>
+
+#include <wrapper/pki/revokeds.h>
+#include <wrapper/pki/crl_reader.h>
+#include <wrapper/pki/crl_scheduler.h>
+#include <wrapper/store/storehelper.h>
+
+#include "fixtures.h"
+
+static std::string encodeCrl(X509_CRL *crl) {
+	std::string res(i2d_X509_CRL(crl, NULL), 0);
+	unsigned char *p = (unsigned char *)&res[0];
+
+	i2d_X509_CRL(crl, &p);
+
+	return res;
+}
+
+static std::string encodedCrl(int count) {
+	return encodeCrl(benchCrl(count)->internal());
+}
+
+/* Full X509_CRL decode, signature check and walk over revoked serials */
+static void BM_CRL_ReadRevoked(benchmark::State &state) {
+	std::string encoded = encodedCrl((int)state.range(0));
+	EVP_PKEY *pkey = X509_get_pubkey(BenchPki::get().intermediate->internal());
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		Handle<CRL> crl = new CRL();
+		crl->read(benchMemBio(encoded), DataFormat::DER);
+		benchmark::DoNotOptimize(X509_CRL_verify(crl->internal(), pkey));
+
+		Handle<RevokedCollection> revoked = crl->getRevoked();
+		int count = revoked->length();
+		for (int i = 0; i < count; i++) {
+			benchmark::DoNotOptimize(revoked->items(i)->getSerialNumber());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * encoded.length());
+
+	EVP_PKEY_free(pkey);
+}
+BENCHMARK(BM_CRL_ReadRevoked)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/* Streaming parse with signature check into RevocationIndex */
+static void BM_CrlReader_Read(benchmark::State &state) {
+	std::string encoded = encodedCrl((int)state.range(0));
+	Handle<Certificate> issuer = BenchPki::get().intermediate;
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		Handle<RevocationIndex> index = CrlReader::read(benchMemBio(encoded), DataFormat::DER, issuer);
+		benchmark::DoNotOptimize(index->length());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * encoded.length());
+}
+BENCHMARK(BM_CrlReader_Read)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/* Serials 0x10000.. are revoked in benchCrl. Odd lookups miss */
+static std::vector<std::string> lookupSerials(int count) {
+	std::vector<std::string> res;
+
+	for (int i = 0; i < 1024; i++) {
+		uint32_t value = (i & 1) ? 0x80000000 + i : 0x10000 + (uint32_t)(((uint64_t)i * 7919) % count);
+		unsigned char serial[4] = { (unsigned char)(value >> 24), (unsigned char)(value >> 16), (unsigned char)(value >> 8), (unsigned char)value };
+
+		res.push_back(std::string((const char *)serial, 4));
+	}
+
+	return res;
+}
+
+/* OpenSSL lookup over the sorted X509_REVOKED stack */
+static void BM_CRL_GetBySerial(benchmark::State &state) {
+	X509_CRL *crl = benchCrl((int)state.range(0))->internal();
+	std::vector<std::string> serials = lookupSerials((int)state.range(0));
+	ASN1_INTEGER *serial = ASN1_INTEGER_new();
+	X509_REVOKED *rev;
+	size_t i = 0;
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		const std::string &s = serials[i++ & 1023];
+		ASN1_STRING_set(serial, s.data(), (int)s.length());
+		benchmark::DoNotOptimize(X509_CRL_get0_by_serial(crl, &rev, serial));
+	}
+
+	ASN1_INTEGER_free(serial);
+}
+BENCHMARK(BM_CRL_GetBySerial)->Arg(1000)->Arg(100000)->Arg(1000000);
+
+/* Arg 1 is Bloom filter bits per entry, 0 is binary search only */
+static void BM_RevocationIndex_Find(benchmark::State &state) {
+	std::string encoded = encodedCrl((int)state.range(0));
+	std::vector<std::string> serials = lookupSerials((int)state.range(0));
+	Handle<RevocationIndex> index = CrlReader::read(benchMemBio(encoded), DataFormat::DER, Handle<Certificate>());
+	size_t i = 0;
+
+	index->setBloomFilter((int)state.range(1));
+	index->sort();
+
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		const std::string &s = serials[i++ & 1023];
+		benchmark::DoNotOptimize(index->isRevoked((const unsigned char *)s.data(), s.length()));
+	}
+}
+BENCHMARK(BM_RevocationIndex_Find)->Args({ 1000, 0 })->Args({ 100000, 0 })->Args({ 100000, 10 })->Args({ 1000000, 0 })->Args({ 1000000, 10 });
+
+/* Index loaded from the file saved next to the CRL */
+static void BM_CrlReader_OpenSaved(benchmark::State &state) {
+	std::string encoded = encodedCrl((int)state.range(0));
+	const char *tmp = getenv("TMPDIR");
+	std::string filename = std::string(tmp ? tmp : "/tmp") + CROSSPLATFORM_SLASH + "wrapper_bench.crl";
+	Handle<Certificate> issuer = BenchPki::get().intermediate;
+
+	FILE *f = fopen(filename.c_str(), "wb");
+	fwrite(encoded.data(), 1, encoded.length(), f);
+	fclose(f);
+	remove((filename + REVOCATION_INDEX_FILE_SUFFIX).c_str());
+	CrlReader::open(filename, DataFormat::DER, issuer, 10);
+
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		Handle<RevocationIndex> index = CrlReader::open(filename, DataFormat::DER, issuer, 10);
+		benchmark::DoNotOptimize(index->length());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CrlReader_OpenSaved)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/* Periodic refresh with a delta CRL: parse only the changes and merge them into the index */
+static void BM_RevocationIndex_ApplyDelta(benchmark::State &state) {
+	Handle<RevocationIndex> base = CrlReader::read(benchMemBio(encodedCrl((int)state.range(0))), DataFormat::DER, Handle<Certificate>());
+	std::string encoded = encodeCrl(benchDeltaCrl((int)state.range(1))->internal());
+	Handle<Certificate> issuer = BenchPki::get().intermediate;
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		Handle<RevocationIndex> delta = CrlReader::read(benchMemBio(encoded), DataFormat::DER, issuer);
+		Handle<RevocationIndex> index = RevocationIndex::applyDelta(base, delta);
+		benchmark::DoNotOptimize(index->length());
+	}
+}
+BENCHMARK(BM_RevocationIndex_ApplyDelta)->Args({ 100000, 1000 })->Unit(benchmark::kMillisecond);
+
+/* Lookups through the scheduler. Arg 1 keeps the background thread reloading the CRL every second */
+static void BM_CrlScheduler_IsRevoked(benchmark::State &state) {
+	std::string encoded = encodedCrl((int)state.range(0));
+	const char *tmp = getenv("TMPDIR");
+	std::string filename = std::string(tmp ? tmp : "/tmp") + CROSSPLATFORM_SLASH + "wrapper_bench_scheduler.crl";
+	BenchPki &pki = BenchPki::get();
+
+	FILE *f = fopen(filename.c_str(), "wb");
+	fwrite(encoded.data(), 1, encoded.length(), f);
+	fclose(f);
+
+	CrlScheduler scheduler(new CrlFileFetcher());
+	scheduler.setRetryInterval(1);
+	scheduler.setLeadTime(INT_MAX);
+	scheduler.add(filename, "", DataFormat::DER, pki.intermediate);
+	scheduler.refresh();
+	if (state.range(1)) {
+		scheduler.start();
+	}
+
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(scheduler.isRevoked(pki.leaf));
+	}
+
+	scheduler.stop();
+}
+BENCHMARK(BM_CrlScheduler_IsRevoked)->Args({ 100000, 0 })->Args({ 100000, 1 })->MinTime(2);
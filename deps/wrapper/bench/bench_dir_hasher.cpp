@@ -0,0 +1,57 @@
+#include <wrapper/stdafx.h>
+
+#include <chrono>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include <wrapper/utils/dir_hasher.h>
+#include <wrapper/store/storehelper.h>
+
+#include "fixtures.h"
+
+/* Cerber manifest of a package tree. Second argument is the thread count, 0 - all cores */
+static void BM_DirectoryHasher_Hash(benchmark::State &state) {
+	std::string folder = benchPackageTree((int)state.range(0));
+
+	DirectoryHasher hasher;
+	hasher.setIgnore(std::vector<std::string>(1, ".complete"));
+	hasher.setThreads((int)state.range(1));
+
+	size_t files = 0;
+	for (auto _ : state) {
+		std::vector<std::string> manifest = hasher.hash(folder);
+		files = manifest.size();
+		benchmark::DoNotOptimize(manifest);
+	}
+	state.SetItemsProcessed(state.iterations() * files);
+}
+BENCHMARK(BM_DirectoryHasher_Hash)->Args({ 200, 1 })->Args({ 200, 4 })->Args({ 200, 0 })->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/* Unchanged tree with a stat cache: walk and stat only */
+static void BM_DirectoryHasher_HashCached(benchmark::State &state) {
+	std::string folder = benchPackageTree((int)state.range(0));
+	const char *tmp = getenv("TMPDIR");
+	std::string cache = std::string(tmp ? tmp : "/tmp") + CROSSPLATFORM_SLASH + "wrapper_bench_package.cache";
+
+	DirectoryHasher hasher;
+	hasher.setIgnore(std::vector<std::string>(1, ".complete"));
+	hasher.setCache(cache);
+	hasher.hash(folder);
+	if (hasher.getHashedCount()) {
+		/* Files of a just created tree are too fresh to be cached */
+		std::this_thread::sleep_for(std::chrono::seconds(DIRECTORY_HASHER_RACY_INTERVAL + 1));
+		hasher.hash(folder);
+		hasher.hash(folder);
+	}
+
+	size_t files = 0;
+	for (auto _ : state) {
+		std::vector<std::string> manifest = hasher.hash(folder);
+		files = manifest.size();
+		benchmark::DoNotOptimize(manifest);
+	}
+	state.SetItemsProcessed(state.iterations() * files);
+	state.counters["hashed"] = (double)hasher.getHashedCount();
+}
+BENCHMARK(BM_DirectoryHasher_HashCached)->Arg(200)->Unit(benchmark::kMillisecond)->UseRealTime();
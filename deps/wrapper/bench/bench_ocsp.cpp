@@ -0,0 +1,81 @@
+#include <wrapper/stdafx.h>
+
+#include <benchmark/benchmark.h>
+
+#include <wrapper/pki/crl_reader.h>
+#include <wrapper/pki/ocsp.h>
+
+#include "fixtures.h"
+
+static std::string encodeCrl(X509_CRL *crl) {
+	std::string res(i2d_X509_CRL(crl, NULL), 0);
+	unsigned char *p = (unsigned char *)&res[0];
+
+	i2d_X509_CRL(crl, &p);
+
+	return res;
+}
+
+/* Loopback responder of the intermediate CA answering from a 1000 entries CRL */
+static Handle<OcspTransport> benchResponder() {
+	BenchPki &pki = BenchPki::get();
+	std::string encoded = encodeCrl(benchCrl(1000)->internal());
+	Handle<RevocationIndex> index = CrlReader::read(benchMemBio(encoded), DataFormat::DER, pki.intermediate);
+	index->sort();
+
+	return new OcspLocalResponder(pki.intermediate, pki.intermediate, pki.intermediateKey, index);
+}
+
+/* Every check goes to the responder: request, signing, response verification */
+static void BM_Ocsp_Check(benchmark::State &state) {
+	BenchPki &pki = BenchPki::get();
+	Ocsp ocsp(benchResponder(), NULL);
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(ocsp.check(pki.leaf, pki.intermediate, NULL, "http://localhost").status);
+	}
+}
+BENCHMARK(BM_Ocsp_Check)->Unit(benchmark::kMicrosecond);
+
+/* Client side only: parse and verify a ready response */
+static void BM_Ocsp_VerifyResponse(benchmark::State &state) {
+	BenchPki &pki = BenchPki::get();
+	Handle<OcspTransport> responder = benchResponder();
+	std::string response = responder->send("", *Ocsp::createRequest(pki.leaf, pki.intermediate, false));
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(Ocsp::verifyResponse(response, pki.leaf, pki.intermediate, NULL).status);
+	}
+}
+BENCHMARK(BM_Ocsp_VerifyResponse)->Unit(benchmark::kMicrosecond);
+
+/* Answer from the memory cache */
+static void BM_Ocsp_CheckCached(benchmark::State &state) {
+	BenchPki &pki = BenchPki::get();
+	Ocsp ocsp(benchResponder(), new OcspCache(""));
+	ocsp.check(pki.leaf, pki.intermediate, NULL, "http://localhost");
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(ocsp.check(pki.leaf, pki.intermediate, NULL, "http://localhost").status);
+	}
+}
+BENCHMARK(BM_Ocsp_CheckCached)->Unit(benchmark::kMicrosecond);
+
+/* First check after restart: response is loaded from the cache folder and verified again */
+static void BM_Ocsp_CheckDiskCache(benchmark::State &state) {
+	BenchPki &pki = BenchPki::get();
+	const char *tmp = getenv("TMPDIR");
+	std::string folder = tmp ? tmp : "/tmp";
+	Handle<OcspTransport> responder = benchResponder();
+	Ocsp(responder, new OcspCache(folder)).check(pki.leaf, pki.intermediate, NULL, "http://localhost");
+	BenchAllocCounter counter(state);
+
+	for (auto _ : state) {
+		Ocsp ocsp(responder, new OcspCache(folder));
+		benchmark::DoNotOptimize(ocsp.check(pki.leaf, pki.intermediate, NULL, "http://localhost").cached);
+	}
+}
+BENCHMARK(BM_Ocsp_CheckDiskCache)->Unit(benchmark::kMicrosecond);
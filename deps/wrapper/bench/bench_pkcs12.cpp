@@ -0,0 +1,74 @@
+#include <wrapper/stdafx.h>
+
+#include <benchmark/benchmark.h>
+
+#include <wrapper/pki/pkcs12.h>
+
+#include "fixtures.h"
+
+/* PFX with the leaf, its key and the intermediate. iterations for both key derivation and MAC */
+static std::string benchPfx(int iterations) {
+	BenchPki &pki = BenchPki::get();
+
+	STACK_OF(X509) *ca = sk_X509_new_null();
+	sk_X509_push(ca, pki.intermediate->internal());
+	PKCS12 *p12 = PKCS12_create((char *)"1", (char *)"bench", pki.leafKey->internal(), pki.leaf->internal(), ca, 0, 0, iterations, iterations, 0);
+	sk_X509_free(ca);
+
+	std::string res(i2d_PKCS12(p12, NULL), 0);
+	unsigned char *p = (unsigned char *)&res[0];
+	i2d_PKCS12(p12, &p);
+	PKCS12_free(p12);
+
+	return res;
+}
+
+/* Previous getters: PKCS12_parse for each of certificate, key and CA certificates */
+static void BM_Pkcs12_ParseThrice(benchmark::State &state) {
+	std::string pfx = benchPfx((int)state.range(0));
+
+	for (auto _ : state) {
+		Handle<Pkcs12> p12 = new Pkcs12();
+		p12->read(benchMemBio(pfx));
+
+		for (int i = 0; i < 3; i++) {
+			EVP_PKEY *pkey = NULL;
+			X509 *cert = NULL;
+			STACK_OF(X509) *ca = NULL;
+
+			benchmark::DoNotOptimize(PKCS12_parse(p12->internal(), "1", &pkey, &cert, &ca));
+			EVP_PKEY_free(pkey);
+			X509_free(cert);
+			sk_X509_pop_free(ca, X509_free);
+		}
+	}
+}
+BENCHMARK(BM_Pkcs12_ParseThrice)->Arg(2048)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/* Getters after open() reuse its result */
+static void BM_Pkcs12_Getters(benchmark::State &state) {
+	std::string pfx = benchPfx((int)state.range(0));
+
+	for (auto _ : state) {
+		Handle<Pkcs12> p12 = new Pkcs12();
+		p12->read(benchMemBio(pfx));
+
+		benchmark::DoNotOptimize(p12->getCertificate("1"));
+		benchmark::DoNotOptimize(p12->getKey("1"));
+		benchmark::DoNotOptimize(p12->getCACertificates("1"));
+	}
+}
+BENCHMARK(BM_Pkcs12_Getters)->Arg(2048)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/* All three components from one parse */
+static void BM_Pkcs12_Open(benchmark::State &state) {
+	std::string pfx = benchPfx((int)state.range(0));
+
+	for (auto _ : state) {
+		Handle<Pkcs12> p12 = new Pkcs12();
+		p12->read(benchMemBio(pfx));
+
+		benchmark::DoNotOptimize(p12->open("1"));
+	}
+}
+BENCHMARK(BM_Pkcs12_Open)->Arg(2048)->Arg(100000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,125 @@
+#include <wrapper/stdafx.h>
+
+#include <benchmark/benchmark.h>
+
+#include <wrapper/pki/cipher.h>
+#include <wrapper/store/provider_system.h>
+
+#include "fixtures.h"
+
+static void BM_ProviderSystem_Init(benchmark::State &state) {
+	std::string folder = benchSystemStore((int)state.range(0));
+
+	for (auto _ : state) {
+		Handle<Provider_System> provider = new Provider_System(new std::string(folder));
+		benchmark::DoNotOptimize(provider->getProviderItemCollection()->length());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ProviderSystem_Init)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+static void BM_PkiItemCollection_Find(benchmark::State &state) {
+	std::string folder = benchSystemStore((int)state.range(0));
+	Handle<Provider_System> provider = new Provider_System(new std::string(folder));
+	Handle<PkiItemCollection> items = provider->getProviderItemCollection();
+
+	Handle<Filter> filter = new Filter();
+	filter->setType(new std::string("CERTIFICATE"));
+	filter->setSubjectFriendlyName(new std::string("Benchmark Store 1"));
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(items->find(filter)->length());
+	}
+	state.SetItemsProcessed(state.iterations() * items->length());
+}
+BENCHMARK(BM_PkiItemCollection_Find)->Arg(100)->Arg(1000);
+
+/* count certificates of the leaf key and the key in MY, messages go to the last certificate */
+static Handle<PkiStore> benchKeyStore(int count, Handle<Certificate> &last) {
+	BenchPki &pki = BenchPki::get();
+	std::string folder = benchSystemStore(count) + "_keys";
+	Handle<PkiStore> store = new PkiStore(new std::string("bench"));
+	Handle<Provider> provider = new Provider_System(new std::string(folder));
+	Handle<PkiItemCollection> items = provider->getProviderItemCollection();
+	char buf[64];
+
+	if (items->length() < count + 1) {
+		for (int i = 0; i < count; i++) {
+			sprintf(buf, "Benchmark Recipient %d", i);
+			store->addPkiObject(provider, new std::string("MY"), fixtureIssue(buf, pki.leafKey, pki.intermediate, pki.intermediateKey, false), 0);
+		}
+		store->addPkiObject(provider, pki.leafKey, new std::string(""));
+		provider = new Provider_System(new std::string(folder));
+		items = provider->getProviderItemCollection();
+	}
+	store->addProvider(provider);
+
+	sprintf(buf, "Benchmark Recipient %d", count - 1);
+	for (int i = 0; i < items->length(); i++) {
+		if (strcmp(items->items(i)->type->c_str(), "CERTIFICATE") == 0 && strcmp(items->items(i)->certSubjectFriendlyName->c_str(), buf) == 0) {
+			last = store->getItemCert(items->items(i));
+		}
+	}
+
+	return store;
+}
+
+static std::string benchEnvelope(Handle<Certificate> recipient) {
+	Handle<CertificateCollection> certs = new CertificateCollection();
+	certs->push(recipient);
+	Cipher cipher;
+	cipher.addRecipientsCerts(certs);
+
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+	cipher.encrypt(benchMemBio(benchPayload(1024)), out, DataFormat::DER);
+
+	return *out->read();
+}
+
+/* Caller side lookup: recipients from a first parse, filter search, key search, decrypt parses again */
+static void BM_Cipher_DecryptFindRecipient(benchmark::State &state) {
+	Handle<Certificate> recipient;
+	Handle<PkiStore> store = benchKeyStore((int)state.range(0), recipient);
+	std::string message = benchEnvelope(recipient);
+
+	for (auto _ : state) {
+		Cipher cipher;
+		Handle<CmsRecipientInfoCollection> ris = cipher.getRecipientInfos(benchMemBio(message), DataFormat::DER);
+		Handle<CmsRecipientInfo> ri = ris->items(0);
+
+		Handle<Filter> filter = new Filter();
+		filter->setIssuerName(ri->getIssuerName());
+		filter->setSerial(ri->getSerialNumber());
+		Handle<PkiItemCollection> found = store->find(filter);
+
+		Handle<Filter> keyFilter = new Filter();
+		keyFilter->setHash(found->items(0)->hash);
+		/*Cipher keeps raw pointers*/
+		Handle<Certificate> cert = store->getItemCert(found->items(0));
+		Handle<Key> key = store->getItemKey(store->findKey(keyFilter));
+		cipher.setRecipientCert(cert);
+		cipher.setPrivKey(key);
+
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		cipher.decrypt(benchMemBio(message), out, DataFormat::DER);
+		benchmark::DoNotOptimize(out->internal());
+	}
+}
+BENCHMARK(BM_Cipher_DecryptFindRecipient)->Arg(10)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+/* One parse, recipient from the store index */
+static void BM_Cipher_DecryptRecipientStore(benchmark::State &state) {
+	Handle<Certificate> recipient;
+	Handle<PkiStore> store = benchKeyStore((int)state.range(0), recipient);
+	std::string message = benchEnvelope(recipient);
+
+	for (auto _ : state) {
+		Cipher cipher;
+		cipher.setRecipientStore(store);
+
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		cipher.decrypt(benchMemBio(message), out, DataFormat::DER);
+		benchmark::DoNotOptimize(out->internal());
+	}
+}
+BENCHMARK(BM_Cipher_DecryptRecipientStore)->Arg(10)->Arg(1000)->Unit(benchmark::kMicrosecond);
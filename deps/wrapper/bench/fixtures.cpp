@@ -0,0 +1,178 @@
+#include <wrapper/stdafx.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#define bench_mkdir(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define bench_mkdir(path) mkdir(path, 0700)
+#endif
+
+#include <openssl/rand.h>
+
+#include <wrapper/store/storehelper.h>
+
+#include "fixtures.h"
+
+BenchPki &BenchPki::get() {
+	static BenchPki *pki = NULL;
+
+	if (!pki) {
+		pki = new BenchPki();
+
+		pki->caKey = fixtureGenerateKey(2048);
+		pki->ca = fixtureIssue("Benchmark CA", pki->caKey, NULL, NULL, true);
+
+		pki->intermediateKey = fixtureGenerateKey(2048);
+		pki->intermediate = fixtureIssue("Benchmark Intermediate CA", pki->intermediateKey, pki->ca, pki->caKey, true);
+
+		pki->leafKey = fixtureGenerateKey(2048);
+		pki->leaf = fixtureIssue("Benchmark Leaf", pki->leafKey, pki->intermediate, pki->intermediateKey, false);
+
+		pki->certs = new CertificateCollection();
+		pki->certs->push(pki->ca);
+		pki->certs->push(pki->intermediate);
+		pki->certs->push(pki->leaf);
+	}
+
+	return *pki;
+}
+
+Handle<Bio> benchMemBio(const std::string &data) {
+	return new Bio(BIO_new_mem_buf((void *)data.c_str(), (int)data.length()));
+}
+
+std::string benchPayload(size_t size) {
+	std::string res(size, '\0');
+
+	if (size) {
+		RAND_pseudo_bytes((unsigned char *)&res[0], (int)size);
+	}
+
+	return res;
+}
+
+std::string benchEncodedLeaf(DataFormat::DATA_FORMAT format) {
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+
+	BenchPki::get().leaf->write(out, format);
+
+	return *out->read();
+}
+
+Handle<CRL> benchCrl(int count) {
+	static std::map<int, Handle<CRL> > crls;
+
+	std::map<int, Handle<CRL> >::iterator it = crls.find(count);
+	if (it != crls.end()) {
+		return it->second;
+	}
+
+	BenchPki &pki = BenchPki::get();
+	Handle<CRL> res = fixtureCrl(pki.intermediate, pki.intermediateKey, count, false);
+	crls[count] = res;
+
+	return res;
+}
+
+Handle<CRL> benchDeltaCrl(int count) {
+	static std::map<int, Handle<CRL> > crls;
+
+	std::map<int, Handle<CRL> >::iterator it = crls.find(count);
+	if (it != crls.end()) {
+		return it->second;
+	}
+
+	BenchPki &pki = BenchPki::get();
+	Handle<CRL> res = fixtureDeltaCrl(pki.intermediate, pki.intermediateKey, count);
+	crls[count] = res;
+
+	return res;
+}
+
+std::string benchSystemStore(int count) {
+	char buf[64];
+	const char *tmp = getenv("TMPDIR");
+	std::string folder = std::string(tmp ? tmp : "/tmp") + CROSSPLATFORM_SLASH + "wrapper_bench_store_";
+
+	sprintf(buf, "%d", count);
+	folder += buf;
+
+	std::string my = folder + CROSSPLATFORM_SLASH + "MY";
+	std::string marker = folder + CROSSPLATFORM_SLASH + ".complete";
+
+	FILE *f = fopen(marker.c_str(), "r");
+	if (f) {
+		fclose(f);
+		return folder;
+	}
+
+	bench_mkdir(folder.c_str());
+	bench_mkdir(my.c_str());
+
+	BenchPki &pki = BenchPki::get();
+	for (int i = 0; i < count; i++) {
+		sprintf(buf, "Benchmark Store %d", i);
+		Handle<Certificate> cert = fixtureIssue(buf, pki.leafKey, pki.intermediate, pki.intermediateKey, false);
+
+		sprintf(buf, "%c%08d.crt", CROSSPLATFORM_SLASH, i);
+		cert->write(new Bio(BIO_TYPE_FILE, my + buf, "wb"), DataFormat::BASE64);
+	}
+
+	f = fopen(marker.c_str(), "w");
+	if (f) {
+		fclose(f);
+	}
+
+	return folder;
+}
+
+std::string benchPackageTree(int count) {
+	char buf[64];
+	const char *tmp = getenv("TMPDIR");
+	std::string folder = std::string(tmp ? tmp : "/tmp") + CROSSPLATFORM_SLASH + "wrapper_bench_package_";
+
+	sprintf(buf, "%d", count);
+	folder += buf;
+
+	std::string marker = folder + CROSSPLATFORM_SLASH + ".complete";
+
+	FILE *f = fopen(marker.c_str(), "r");
+	if (f) {
+		fclose(f);
+		return folder;
+	}
+
+	bench_mkdir(folder.c_str());
+
+	for (int i = 0; i < count; i++) {
+		sprintf(buf, "%cmodule%04d", CROSSPLATFORM_SLASH, i);
+		std::string module = folder + buf;
+		bench_mkdir(module.c_str());
+
+		for (int j = 0; j < 21; j++) {
+			if (j == 20 && i % 10) {
+				break;
+			}
+
+			std::string data = benchPayload(j == 20 ? 1024 * 1024 : 4096);
+			sprintf(buf, "%cfile%02d.js", CROSSPLATFORM_SLASH, j);
+
+			f = fopen((module + buf).c_str(), "wb");
+			if (f) {
+				fwrite(data.data(), 1, data.length(), f);
+				fclose(f);
+			}
+		}
+	}
+
+	f = fopen(marker.c_str(), "w");
+	if (f) {
+		fclose(f);
+	}
+
+	return folder;
+}
@@ -0,0 +1,81 @@
+#ifndef BENCH_FIXTURES_H_INCLUDED
+#define BENCH_FIXTURES_H_INCLUDED
+
+#include <map>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include <wrapper/common/common.h>
+#include <wrapper/pki/cert.h>
+#include <wrapper/pki/certs.h>
+#include <wrapper/pki/crl.h>
+#include <wrapper/pki/key.h>
+
+#include "pki_fixtures.h"
+
+/* Synthetic PKI generated once per benchmark run: CA -> intermediate -> leaf */
+class BenchPki {
+public:
+	Handle<Key> caKey;
+	Handle<Certificate> ca;
+	Handle<Key> intermediateKey;
+	Handle<Certificate> intermediate;
+	Handle<Key> leafKey;
+	Handle<Certificate> leaf;
+
+	/* ca, intermediate and leaf */
+	Handle<CertificateCollection> certs;
+
+	static BenchPki &get();
+};
+
+/* Read-only memory BIO over data. Data must outlive the BIO */
+Handle<Bio> benchMemBio(const std::string &data);
+
+/* Random payload of given size */
+std::string benchPayload(size_t size);
+
+/* DER or PEM encoding of the leaf certificate */
+std::string benchEncodedLeaf(DataFormat::DATA_FORMAT format);
+
+/*
+ * Creates store for Provider_System with count certificates in MY.
+ * Returns store folder. Folders are reused between runs
+ */
+std::string benchSystemStore(int count);
+
+/*
+ * Creates a package tree of count modules, each with 20 small files and
+ * every tenth with a 1 MB file. Returns its folder. Folders are reused between runs
+ */
+std::string benchPackageTree(int count);
+
+/* CRL issued by the intermediate CA with count revoked entries. Cached per count */
+Handle<CRL> benchCrl(int count);
+/* Delta CRL for benchCrl with count changes, half of them remove serials */
+Handle<CRL> benchDeltaCrl(int count);
+
+/*
+ * Heap allocation counter (alloc.cpp). benchCountAllocations must be called
+ * before OpenSSL allocates anything
+ */
+void benchCountAllocations();
+uint64_t benchAllocations();
+
+/*
+ * Reports heap allocations per iteration ("allocs") and pool slabs taken
+ * ("slabs") for the lifetime of the object. Create it before the loop
+ */
+class BenchAllocCounter {
+public:
+	BenchAllocCounter(benchmark::State &state);
+	~BenchAllocCounter();
+
+private:
+	benchmark::State &state_;
+	uint64_t allocations_;
+	size_t slabs_;
+};
+
+#endif //!BENCH_FIXTURES_H_INCLUDED
@@ -0,0 +1,36 @@
+#include <wrapper/stdafx.h>
+
+#include <stdio.h>
+
+#include <benchmark/benchmark.h>
+
+#include <wrapper/common/openssl.h>
+
+#include "fixtures.h"
+
+/*
+ * Usage:
+ *   wrapper_bench --benchmark_out=wrapper_bench.json --benchmark_out_format=json
+ * See --help for filters and repetitions
+ */
+int main(int argc, char **argv) {
+	benchCountAllocations();
+	OpenSSL::run();
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+		return 1;
+	}
+
+	try {
+		benchmark::RunSpecifiedBenchmarks();
+	}
+	catch (Handle<Exception> e) {
+		fprintf(stderr, "%s\n", e->what());
+		return 1;
+	}
+
+	OpenSSL::stop();
+
+	return 0;
+}
@@ -0,0 +1,144 @@
+#include <wrapper/stdafx.h>
+
+#include "pki_fixtures.h"
+
+Handle<Key> fixtureGenerateKey(int bits) {
+	Handle<Key> key = new Key();
+
+	return key->generate(DataFormat::DER, PublicExponent::peRSA_F4, bits);
+}
+
+Handle<Certificate> fixtureIssue(const char *commonName, Handle<Key> key, Handle<Certificate> issuer, Handle<Key> issuerKey,
+	bool ca, const char *extendedKeyUsage) {
+	static long serial = 1;
+
+	X509 *x = X509_new();
+
+	X509_set_version(x, 2);
+	ASN1_INTEGER_set(X509_get_serialNumber(x), serial++);
+	X509_gmtime_adj(X509_get_notBefore(x), -60 * 60);
+	X509_gmtime_adj(X509_get_notAfter(x), 60 * 60 * 24 * 365);
+	X509_set_pubkey(x, key->internal());
+
+	X509_NAME *name = X509_get_subject_name(x);
+	X509_NAME_add_entry_by_txt(name, "O", MBSTRING_ASC, (const unsigned char *)"Test", -1, -1, 0);
+	X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)commonName, -1, -1, 0);
+
+	X509 *signer = issuer.isEmpty() ? x : issuer->internal();
+	X509_set_issuer_name(x, X509_get_subject_name(signer));
+
+	X509V3_CTX ctx;
+	X509V3_set_ctx(&ctx, signer, x, NULL, NULL, 0);
+	X509_EXTENSION *ext = X509V3_EXT_conf_nid(NULL, &ctx, NID_basic_constraints, (char *)(ca ? "critical,CA:TRUE" : "CA:FALSE"));
+	X509_add_ext(x, ext, -1);
+	X509_EXTENSION_free(ext);
+
+	if (extendedKeyUsage) {
+		ext = X509V3_EXT_conf_nid(NULL, &ctx, NID_ext_key_usage, (char *)extendedKeyUsage);
+		X509_add_ext(x, ext, -1);
+		X509_EXTENSION_free(ext);
+	}
+
+	Handle<Key> signKey = issuerKey.isEmpty() ? key : issuerKey;
+	if (!X509_sign(x, signKey->internal(), EVP_sha256())) {
+		X509_free(x);
+		THROW_OPENSSL_EXCEPTION(0, Fixtures, NULL, "X509_sign");
+	}
+
+	return new Certificate(x);
+}
+
+/*
+ * Signs a CRL with numbers and sorted entries. Returns it decoded again,
+ * as OpenSSL caches the CRL number extensions only on decode
+ */
+static Handle<CRL> fixtureSignCrl(X509_CRL *crl, Handle<Key> issuerKey, long crlNumber, long baseCrlNumber) {
+	ASN1_INTEGER *number = ASN1_INTEGER_new();
+	ASN1_INTEGER_set(number, crlNumber);
+	X509_CRL_add1_ext_i2d(crl, NID_crl_number, number, 0, 0);
+	if (baseCrlNumber >= 0) {
+		ASN1_INTEGER_set(number, baseCrlNumber);
+		X509_CRL_add1_ext_i2d(crl, NID_delta_crl, number, 1, 0);
+	}
+	ASN1_INTEGER_free(number);
+
+	X509_CRL_sort(crl);
+	if (!X509_CRL_sign(crl, issuerKey->internal(), EVP_sha256())) {
+		X509_CRL_free(crl);
+		THROW_OPENSSL_EXCEPTION(0, Fixtures, NULL, "X509_CRL_sign");
+	}
+
+	unsigned char *der = NULL;
+	int length = i2d_X509_CRL(crl, &der);
+	X509_CRL_free(crl);
+
+	const unsigned char *p = der;
+	crl = length > 0 ? d2i_X509_CRL(NULL, &p, length) : NULL;
+	OPENSSL_free(der);
+	if (!crl) {
+		THROW_OPENSSL_EXCEPTION(0, Fixtures, NULL, "d2i_X509_CRL");
+	}
+
+	return new CRL(crl);
+}
+
+static X509_CRL *fixtureNewCrl(Handle<Certificate> issuer, long validity) {
+	X509_CRL *crl = X509_CRL_new();
+
+	X509_CRL_set_version(crl, 1);
+	X509_CRL_set_issuer_name(crl, X509_get_subject_name(issuer->internal()));
+
+	/* Expired CRL was issued twice its validity ago */
+	ASN1_TIME *tm = X509_gmtime_adj(NULL, validity < 0 ? 2 * validity : 0);
+	X509_CRL_set_lastUpdate(crl, tm);
+	X509_gmtime_adj(tm, validity);
+	X509_CRL_set_nextUpdate(crl, tm);
+	ASN1_TIME_free(tm);
+
+	return crl;
+}
+
+static void fixtureRevoke(X509_CRL *crl, long serialNumber, long minutesAgo, int reason) {
+	X509_REVOKED *rv = X509_REVOKED_new();
+	ASN1_INTEGER *serial = ASN1_INTEGER_new();
+	ASN1_TIME *tm = X509_gmtime_adj(NULL, -60 * minutesAgo);
+
+	ASN1_INTEGER_set(serial, serialNumber);
+	X509_REVOKED_set_serialNumber(rv, serial);
+	X509_REVOKED_set_revocationDate(rv, tm);
+	if (reason >= 0) {
+		ASN1_ENUMERATED *value = ASN1_ENUMERATED_new();
+		ASN1_ENUMERATED_set(value, reason);
+		X509_REVOKED_add1_ext_i2d(rv, NID_crl_reason, value, 0, 0);
+		ASN1_ENUMERATED_free(value);
+	}
+	X509_CRL_add0_revoked(crl, rv);
+
+	ASN1_TIME_free(tm);
+	ASN1_INTEGER_free(serial);
+}
+
+Handle<CRL> fixtureCrl(Handle<Certificate> issuer, Handle<Key> issuerKey, int count, bool reasons, long crlNumber, long validity) {
+	X509_CRL *crl = fixtureNewCrl(issuer, validity);
+
+	for (int i = 0; i < count; i++) {
+		fixtureRevoke(crl, 0x10000 + i, i, reasons && i % 11 != 7 ? i % 11 : -1);
+	}
+
+	return fixtureSignCrl(crl, issuerKey, crlNumber, -1);
+}
+
+Handle<CRL> fixtureDeltaCrl(Handle<Certificate> issuer, Handle<Key> issuerKey, int count, long baseCrlNumber, long crlNumber) {
+	X509_CRL *crl = fixtureNewCrl(issuer, 60 * 60 * 24);
+
+	for (int i = 0; i < count; i++) {
+		if (i & 1) {
+			fixtureRevoke(crl, 0x1000000 + i, 0, -1);
+		}
+		else {
+			fixtureRevoke(crl, 0x10000 + i, 0, CRL_REASON_REMOVE_FROM_CRL);
+		}
+	}
+
+	return fixtureSignCrl(crl, issuerKey, crlNumber, baseCrlNumber);
+}
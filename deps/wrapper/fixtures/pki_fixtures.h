@@ -0,0 +1,37 @@
+#ifndef WRAPPER_PKI_FIXTURES_H_INCLUDED
+#define WRAPPER_PKI_FIXTURES_H_INCLUDED
+
+#include <wrapper/common/common.h>
+#include <wrapper/pki/cert.h>
+#include <wrapper/pki/crl.h>
+#include <wrapper/pki/key.h>
+
+/*
+ * Certificate and CRL generators shared by wrapper_test and wrapper_bench.
+ * Everything is signed with SHA-256 and valid from one hour ago
+ */
+
+Handle<Key> fixtureGenerateKey(int bits);
+
+/*
+ * Self-signed when issuer is empty.
+ * extendedKeyUsage in openssl.cnf syntax, NULL - no extension
+ */
+Handle<Certificate> fixtureIssue(const char *commonName, Handle<Key> key, Handle<Certificate> issuer, Handle<Key> issuerKey,
+	bool ca, const char *extendedKeyUsage = NULL);
+
+/*
+ * CRL with count revoked serials 0x10000 + i revoked i minutes ago, valid for validity seconds
+ * (negative - expired that long ago).
+ * With reasons entry i has reasonCode i % 11 unless i % 11 is 7 (unused value), which has no reasonCode
+ */
+Handle<CRL> fixtureCrl(Handle<Certificate> issuer, Handle<Key> issuerKey, int count, bool reasons, long crlNumber = 1,
+	long validity = 60 * 60 * 24 * 7);
+
+/*
+ * Delta CRL with count changes for the base CRL number baseCrlNumber, valid for a day.
+ * Even entries remove serials 0x10000 + i of the base CRL, odd ones revoke new serials 0x1000000 + i
+ */
+Handle<CRL> fixtureDeltaCrl(Handle<Certificate> issuer, Handle<Key> issuerKey, int count, long baseCrlNumber = 1, long crlNumber = 2);
+
+#endif //!WRAPPER_PKI_FIXTURES_H_INCLUDED
@@ -0,0 +1,64 @@
+#ifndef CMS_HEADER_H_INCLUDED
+#define CMS_HEADER_H_INCLUDED
+
+#include <openssl/cms.h>
+
+#include <vector>
+
+#include "../common/common.h"
+#include "../pki/oid.h"
+#include "signer_id.h"
+
+/*
+ * Routing fields of CMS ContentInfo taken by walking its tags and lengths.
+ * Only content types and signer and recipient identifiers are decoded:
+ * content, certificates, CRLs, attributes, signatures and encrypted keys are skipped
+ * by their lengths. DER and BER with indefinite lengths (streamed CMS) are accepted.
+ *
+ * Signers are sid of SignedData SignerInfos. Recipients are rid of KeyTransRecipientInfo
+ * and KeyAgreeRecipientInfo (one for each encrypted key) and kekid of KEKRecipientInfo,
+ * password and other recipients have no identifier and are not listed
+ */
+class CmsStream;
+
+class CTWRAPPER_API CmsHeader {
+public:
+	CmsHeader();
+	~CmsHeader(){};
+
+	/*
+	 * BASE64 is PEM with CMS or PKCS7 label and is read whole. DER is read in small
+	 * blocks up to the signer or recipient identifiers, skipped values are dropped
+	 * and the rest of the BIO is not read
+	 */
+	void read(Handle<Bio> in, DataFormat::DATA_FORMAT format);
+	void read(const unsigned char *data, size_t len);
+
+	/* ContentInfo contentType: signedData, envelopedData... */
+	Handle<OID> getContentType();
+	/* eContentType of SignedData, contentType of EnvelopedData EncryptedContentInfo. Empty for others */
+	Handle<OID> getEncapsulatedType();
+	/* No eContent in SignedData or encryptedContent in EnvelopedData */
+	bool isDetached();
+
+	int getSignersLength();
+	Handle<SignerId> getSigner(int index);
+	int getRecipientsLength();
+	Handle<SignerId> getRecipient(int index);
+
+protected:
+	/* end is the offset where the input ends, streams of unknown length pass the largest */
+	void readContentInfo(CmsStream &in, uint64_t end);
+	/* Stream is at the content of [0] of ContentInfo, end is its limit */
+	void readSignedData(CmsStream &in, uint64_t end);
+	void readEnvelopedData(CmsStream &in, uint64_t end);
+
+protected:
+	Handle<OID> contentType;
+	Handle<OID> encapsulatedType;
+	bool detached;
+	std::vector<Handle<SignerId> > signers;
+	std::vector<Handle<SignerId> > recipients;
+};
+
+#endif //!CMS_HEADER_H_INCLUDED
@@ -0,0 +1,60 @@
+#ifndef CMS_RECIPIENT_SET_H_INCLUDED
+#define CMS_RECIPIENT_SET_H_INCLUDED
+
+#include <openssl/evp.h>
+#include <openssl/cms.h>
+
+#include <vector>
+
+#include "../common/common.h"
+#include "../pki/cert.h"
+#include "../pki/certs.h"
+
+/* Plain text read at once, each part becomes one OCTET STRING of the encrypted content */
+#define CMS_RECIPIENT_SET_BUFFER_SIZE (16 * 1024)
+
+/*
+ * Fixed list of recipients for many EnvelopedData messages.
+ * Public keys, issuer names and serial numbers are taken from the certificates once.
+ *
+ * While all recipients have RSA keys CMS_encrypt is not used: every
+ * KeyTransRecipientInfo is a prepared prefix (version, issuer and serial,
+ * rsaEncryption) and the content key encrypted with the kept key context.
+ * Content is written in BER with indefinite lengths, as i2d_CMS_bio_stream does.
+ * Other keys (GOST, EC) go through CMS_encrypt with the kept certificate stack.
+ *
+ * Key contexts are reused, so one set must not be used by several threads at once
+ */
+class CTWRAPPER_API CmsRecipientSet {
+public:
+	CmsRecipientSet();
+	~CmsRecipientSet();
+
+	void push(Handle<Certificate> cert);
+	void push(Handle<CertificateCollection> certs);
+	int length();
+
+	/* Content cipher, des-ede3-cbc by default as in Cipher. AEAD modes are not supported */
+	void setAlgorithm(Handle<std::string> name);
+
+	/* Same output as Cipher::encrypt in ASSYMETRIC mode. DER or BASE64 (PEM) */
+	void encrypt(Handle<Bio> in, Handle<Bio> out, DataFormat::DATA_FORMAT format);
+
+protected:
+	void encryptPrepared(BIO *in, BIO *out);
+	void encryptCms(BIO *in, BIO *out, DataFormat::DATA_FORMAT format);
+
+protected:
+	const EVP_CIPHER *cipher;
+
+	STACK_OF(X509) *certs;
+	/* For each certificate while all keys are RSA, encrypt initialized */
+	std::vector<EVP_PKEY_CTX *> contexts;
+	/* version | IssuerAndSerialNumber | keyEncryptionAlgorithm of each KeyTransRecipientInfo */
+	std::vector<std::string> prefixes;
+	bool prepared;
+	/* First recipient has a GOST key, CMS_encrypt takes GOST 28147-89 then */
+	bool gost;
+};
+
+#endif //!CMS_RECIPIENT_SET_H_INCLUDED
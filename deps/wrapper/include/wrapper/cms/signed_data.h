@@ -42,6 +42,8 @@ public:
 	void write(Handle<Bio> out, DataFormat::DATA_FORMAT format);
 	void addCertificate(Handle<Certificate> cert);
 	bool verify(Handle<CertificateCollection> certs);
+	/* Doesn't throw, reports rejected signature and failed signer index */
+	VerifyResult verifyResult(Handle<CertificateCollection> certs);
 
 	int cms_copy_content(BIO *out, BIO *in, unsigned int flags);
 
@@ -51,6 +53,9 @@ public:
 	Handle<Signer> createSigner(Handle<Certificate> cert, Handle<Key> pkey);
 
 protected:
+	void checkSignature(Handle<CertificateCollection> certs, VerifyResult &result);
+	int findInvalidSigner(unsigned long err);
+
 	Handle<Bio> content = NULL;
 	unsigned int flags;
 };
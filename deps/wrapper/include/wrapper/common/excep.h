@@ -4,6 +4,7 @@
 #define  CMS_COMMON_EXCEP_H_INCLUDED
 
 #include <stdio.h>
+#include <vector>
 #include "refcount.h"
 
 #define ERROR_PARAMETER_NULL "Parameter %d can not be NULL"
@@ -19,7 +20,9 @@
 #define THROW_OPENSSL_EXCEPTION(code, className, stack, msg, ...) \
 	{ \
 		Handle<Exception> __e = new Exception(true, __FILE__, __LINE__, code, #className, __FUNCTION__, stack, msg, ## __VA_ARGS__); \
-		LOGGER_WARN("%s", __e->what()); \
+		if (logger->levels & LoggerLevel::Warning) { \
+			LOGGER_WARN("%s", __e->what()); \
+		} \
 		throw __e; \
 	}
 
@@ -43,8 +46,22 @@
 		actions \
 	}
 
+/* OpenSSL error queue entry taken by Exception */
+struct ExceptionError {
+	unsigned long code;
+	const char *file;
+	int line;
+	std::string data;
+};
+
+/*
+ * The OpenSSL error queue is drained when the exception is created, but the
+ * description (file, line, error strings and the nested exceptions) is only
+ * formatted on the first call to what() or description(). Rejected input
+ * that is caught and never printed costs no string formatting
+ */
 //class CTWRAPPER_API Exception: public std::runtime_error {
-class CTWRAPPER_API Exception{
+class CTWRAPPER_API Exception : public PoolObject {
 public:
 	// � ������ ���� ��� char* �������� �� const char*
 	Exception(
@@ -63,23 +80,25 @@ public:
 	};
 
 	const std::string description();
-	void fillDescription(
-			const std::string& message,
-			bool fromOpenSSL);
 	const char *what() const throw ();
 	int code(){
 		return this->code_;
 	}
 
 protected:
+	void fillDescription() const;
 
-	std::string description_;
-	std::string class_;
-	std::string method_;
+	mutable std::string description_;
+	mutable bool described_;
+	std::string message_;
+	const char *class_;
+	const char *method_;
 	int line_;
-	std::string file_;
-	va_list arguments_;
+	const char *file_;
 	int code_;
+	bool fromOpenSSL_;
+	unsigned long thread_;
+	std::vector<ExceptionError> errors_;
 	Handle<Exception> except_; //Handle ||| sd::list
 };
 
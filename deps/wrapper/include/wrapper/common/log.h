@@ -87,7 +87,7 @@ public:
 	LoggerFunction(Logger *logger, const char *fn);
 	~LoggerFunction();
 protected:
-	Handle<std::string> _fn = NULL;
+	const char *_fn = NULL;
 	Logger *_logger = NULL;
 };
 #endif //!COMMON_LOG_H_INCLUDE
@@ -0,0 +1,30 @@
+#include "common.h"
+
+#ifndef COMMON_MAPPED_FILE_H_INCLUDED
+#define  COMMON_MAPPED_FILE_H_INCLUDED
+
+/* Read-only view of a whole file. Uses mmap (MapViewOfFile on Windows) */
+class CTWRAPPER_API MappedFile
+{
+public:
+	MappedFile(const std::string &filename);
+	~MappedFile();
+
+	const unsigned char *data();
+	size_t size();
+
+protected:
+	void close();
+
+protected:
+	unsigned char *data_;
+	size_t size_;
+#ifdef _WIN32
+	HANDLE file_;
+	HANDLE mapping_;
+#else
+	int fd_;
+#endif
+};
+
+#endif  //!COMMON_MAPPED_FILE_H_INCLUDED
@@ -2,7 +2,6 @@
 #define  CMS_COMMON_OBJECT_H_INCLUDED
 
 #include <typeinfo>
-#include <set>
 #include "common.h"
 
 class Object{
@@ -19,47 +18,39 @@ class SObject;
 
 typedef SObject * SObjectPtr;
 
-class SObject{
+class SObject : public PoolObject {
 public:
 	SObject(void *obj, Handle<SObject>parent, const char* tname)
-		: free_(NULL), obj_(obj), type_name_(tname)
+		: free_(NULL), owner_(NULL), firstChild_(NULL), prevSibling_(NULL), nextSibling_(NULL),
+		obj_(obj), type_name_(tname)
 	{
 		LOGGER_FN();
 
 		this->parent = parent;
 		if (!this->parent.isEmpty()){
-			/*std::set < int > it;
-			it.insert("");*/
-
-			this->parent->children.insert(this);
+			this->parent->addChild(this);
 		}
 	}
 
 	~SObject(){
 		LOGGER_FN();
 
+		if (this->owner_){
+			LOGGER_TRACE("Remove item from parent's children");
+			this->owner_->removeChild(this);
+		}
+
 		if (this->isRemovable()){
 			LOGGER_TRACE("OpenSSL free");
 			this->free();
 		}
-		else
-		{
-			LOGGER_TRACE("Remove item from parent's children");
-			this->parent->children.erase(this);
-			LOGGER_TRACE("Remove children: SUCCESS");
-		}
 	}
 
 	void destroy(void){
 		LOGGER_FN();
 
-		std::set<SObject*> *children = &(this->children);
-		int children_size = this->children.size();
-		if (children_size > 0){
-			for (std::set<SObject*>::iterator i = children->begin(); i != children->end(); ++i) {
-				SObject *child = *i;
-				child->destroy();
-			}
+		for (SObject *child = this->firstChild_; child; child = child->nextSibling_) {
+			child->destroy();
 		}
 		if (this->isRemovable()){
 			this->free();
@@ -87,6 +78,11 @@ public:
 		return this->obj_ == NULL;
 	}
 
+	/* Unlogged access to the OpenSSL object, see SSLObject::raw */
+	void *data(){
+		return this->obj_;
+	}
+
 	bool isRemovable(){
 		LOGGER_FN();
 
@@ -105,11 +101,44 @@ protected:
 		this->obj_ = NULL;
 	}
 
+	/*
+	 * Children are kept in an intrusive doubly linked list, so wrappers
+	 * handed out by large collections are linked and unlinked in O(1)
+	 */
+	void addChild(SObject *child){
+		child->owner_ = this;
+		child->prevSibling_ = NULL;
+		child->nextSibling_ = this->firstChild_;
+		if (this->firstChild_){
+			this->firstChild_->prevSibling_ = child;
+		}
+		this->firstChild_ = child;
+	}
+
+	void removeChild(SObject *child){
+		if (child->prevSibling_){
+			child->prevSibling_->nextSibling_ = child->nextSibling_;
+		}
+		else{
+			this->firstChild_ = child->nextSibling_;
+		}
+		if (child->nextSibling_){
+			child->nextSibling_->prevSibling_ = child->prevSibling_;
+		}
+		child->owner_ = NULL;
+		child->prevSibling_ = NULL;
+		child->nextSibling_ = NULL;
+	}
+
 public:
 	Handle<SObject> parent;
 	void(*free_)(void *);
-	std::set<SObjectPtr> children;
 protected:
+	SObject *owner_;
+	SObject *firstChild_;
+	SObject *prevSibling_;
+	SObject *nextSibling_;
+
 	void *obj_;
 	const char *type_name_;
 
@@ -121,7 +150,7 @@ protected:
 };
 
 template<typename T>
-class SSLObject{
+class SSLObject : public PoolObject {
 public:
 	SSLObject(T* data, void(*fn)(void *), Handle<SObject> parent = NULL) :fnFree_(fn){
 		LOGGER_TRACE("Create OpenSSL object");
@@ -157,6 +186,18 @@ public:
 		return tmp->internal<T>();
 	}
 
+	/*
+	 * Accessor for hot paths inside the library. Same check as internal(),
+	 * but without the Handle copy and logging
+	 */
+	T *raw()
+	{
+		void *res = this->data_->data();
+		if (!res)
+			THROW_EXCEPTION(2, SSLObject, NULL, "Internal object was deleted");
+		return (T *)res;
+	}
+
 	Handle<SObject> handle(){
 		LOGGER_FN();
 
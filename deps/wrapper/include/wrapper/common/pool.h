@@ -0,0 +1,49 @@
+#ifndef CMS_COMMON_POOL_H_INCLUDED
+#define  CMS_COMMON_POOL_H_INCLUDED
+
+#include <stddef.h>
+#include <new>
+
+/*
+ * Small block allocator for wrapper objects (SObject, Handle counters,
+ * SSLObject wrappers). Blocks are rounded up to POOL_GRANULARITY bytes and
+ * carved from POOL_SLAB_SIZE slabs into per-thread free lists, so allocation
+ * and release are a pointer pop/push without locking.
+ *
+ * Slabs are never returned to the system. A block released on another thread
+ * joins that thread's free list. When a thread exits its free lists go to a
+ * shared locked list, which a thread takes whole when its own list is empty,
+ * so short-lived worker threads do not grow the pool. Requests larger than
+ * POOL_MAX_BLOCK go to the global operator new.
+ *
+ * Define WRAPPER_NO_POOL to use the global operator new for everything
+ * (e.g. for valgrind or address sanitizer runs).
+ */
+#define POOL_GRANULARITY 16
+#define POOL_MAX_BLOCK 256
+#define POOL_SLAB_SIZE (64 * 1024)
+
+class Pool {
+public:
+	static void *allocate(size_t size);
+	static void deallocate(void *ptr, size_t size);
+
+	/* Number of slabs taken from the system by all threads */
+	static size_t slabs();
+};
+
+/* Base class routing operator new/delete of derived classes to Pool */
+class PoolObject {
+public:
+#ifndef WRAPPER_NO_POOL
+	static void *operator new(size_t size){
+		return Pool::allocate(size);
+	}
+
+	static void operator delete(void *ptr, size_t size){
+		Pool::deallocate(ptr, size);
+	}
+#endif
+};
+
+#endif //!CMS_COMMON_POOL_H_INCLUDED
@@ -36,6 +36,7 @@
 
 
 #include <stdexcept>
+#include "pool.h"
 //#include <iostream>      // The iostream facilities are not used in the classes
 // in this file, but they are used in the code that
 // tests the classes.
@@ -219,7 +220,7 @@ public:
 
 private:
 
-	struct CountHolder : public RCObject {
+	struct CountHolder : public RCObject, public PoolObject {
 
 		~CountHolder() {
 			if (pointee) delete pointee;
@@ -0,0 +1,40 @@
+#ifndef PKI_BUNDLE_H_INCLUDED
+#define PKI_BUNDLE_H_INCLUDED
+
+#include <vector>
+
+#include "../common/common.h"
+#include "../common/mapped_file.h"
+
+#include "certs.h"
+#include "crls.h"
+
+/* Minimal number of objects decoded by one thread */
+#define BUNDLE_ITEMS_PER_THREAD 64
+
+/* One object of a bundle. Points into the mapped file */
+class BundleItem {
+public:
+	const unsigned char *data;
+	size_t length;
+	bool pem;
+};
+
+/*
+ * Loads files with many concatenated PEM (or DER) certificates or CRLs.
+ * The file is mapped, object boundaries are found in place and objects
+ * are decoded in parallel
+ */
+class CTWRAPPER_API Bundle {
+public:
+	static Handle<CertificateCollection> loadCertificates(Handle<std::string> filename);
+	static Handle<CrlCollection> loadCrls(Handle<std::string> filename);
+
+	static std::vector<BundleItem> split(const unsigned char *data, size_t length, const char * const *labels);
+
+protected:
+	static std::vector<BundleItem> splitPem(const unsigned char *data, size_t length, const char * const *labels);
+	static std::vector<BundleItem> splitDer(const unsigned char *data, size_t length);
+};
+
+#endif //!PKI_BUNDLE_H_INCLUDED
@@ -4,6 +4,8 @@
 #include <openssl/x509v3.h>
 #include <openssl/pem.h>
 
+#include <vector>
+
 #include "../common/common.h"
 
 class CTWRAPPER_API Certificate;
@@ -14,6 +16,23 @@ class CTWRAPPER_API Certificate;
 
 SSLOBJECT_free(X509, X509_free);
 
+/* Decoded certificate fields. Each value is filled on first access */
+class CertificateCache {
+public:
+	Handle<std::string> serialNumber;
+	Handle<std::string> notBefore;
+	Handle<std::string> notAfter;
+	Handle<std::string> issuerFriendlyName;
+	Handle<std::string> issuerName;
+	Handle<std::string> subjectFriendlyName;
+	Handle<std::string> subjectName;
+	Handle<std::string> thumbprint;
+	Handle<std::string> signatureAlgorithm;
+	Handle<std::string> signatureDigest;
+	Handle<std::string> organizationName;
+	Handle<std::string> encoded;
+};
+
 class Certificate : public SSLObject < X509 > {
 public:
 	//constructor
@@ -33,6 +52,7 @@ public:
 	Handle<std::string> getSignatureAlgorithm();
 	Handle<std::string> getSignatureDigest();
 	Handle<std::string> getOrganizationName();
+	Handle<std::string> getEncoded();
 	Handle<Key> getPublicKey();
 	int getType();
 	int getKeyUsage();
@@ -40,15 +60,24 @@ public:
 
 	//Methods
 	void read(Handle<Bio> in, DataFormat::DATA_FORMAT format);
+	/* Returns false instead of throwing if data is not a certificate */
+	bool tryRead(Handle<Bio> in, DataFormat::DATA_FORMAT format);
 	void write(Handle<Bio> out, DataFormat::DATA_FORMAT format);
 	Handle<Certificate> duplicate();
 	int compare(Handle<Certificate> cert);
 	bool equals(Handle<Certificate> cert);
 	Handle<std::string> hash(Handle<std::string> algorithm);
 	Handle<std::string> hash(const EVP_MD *md);
+	std::vector<Handle<std::string> > hashes(std::vector<Handle<std::string> > algorithms);
+	std::vector<Handle<std::string> > hashes(std::vector<const EVP_MD *> mds);
 
 protected:
 	static Handle<std::string> GetCommonName(X509_NAME *a);
+
+	//Replaces X509 and drops decoded fields of the previous one
+	void setData(X509 *v);
+
+	CertificateCache cache;
 };
 
 char *i2t_X509_NAME_CN(X509_NAME *a, char* buf, int len);
@@ -10,7 +10,12 @@ class CTWRAPPER_API CertificateCollection;
 #include "pki.h"
 #include "cert.h"
 
-SSLOBJECT_free(stack_st_X509, sk_X509_free)
+/* Collection owns one reference of every certificate in the stack */
+static void sk_X509_free_all(stack_st_X509 *sk){
+	sk_X509_pop_free(sk, X509_free);
+}
+
+SSLOBJECT_free(stack_st_X509, sk_X509_free_all)
 
 class CertificateCollection : public SSLObject < stack_st_X509 > {
 public:
@@ -18,7 +23,14 @@ public:
 	SSLOBJECT_new_null(CertificateCollection, stack_st_X509, sk_X509_new_null){}
 
 	//methods
+	//Stack passed to the constructor must own its certificates (get1 functions)
 	void push(Handle<Certificate> cert);
+	//Share X509 with the source by reference counter instead of X509_dup.
+	//Use push when the pushed certificate can be modified later
+	void pushRef(Handle<Certificate> cert);
+	void pushRef(stack_st_X509 *certs);
+	void pushRef(Handle<CertificateCollection> certs);
+	//Certificates returned by items() stay valid after pop and removeAt
 	void pop();
 	void removeAt(int index);
 	int length();
@@ -32,7 +32,11 @@ public:
 	/* Check cerificates in chain */
 	bool verifyChain(Handle<CertificateCollection> chain, Handle<CrlCollection> crls);
 
+	/* Same check, reports error and depth of the failed certificate. Doesn't throw */
+	VerifyResult verifyChainResult(Handle<CertificateCollection> chain, Handle<CrlCollection> crls);
+
 private:
+	void checkChain(Handle<CertificateCollection> chain, Handle<CrlCollection> crls, VerifyResult &result);
 	Handle<Certificate> getIssued(Handle<CertificateCollection> certs, Handle<Certificate> cert);
 	bool checkIssued(Handle<Certificate> issuer, Handle<Certificate> cert);
 };
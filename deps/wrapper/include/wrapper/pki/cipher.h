@@ -15,6 +15,8 @@
 #include "cert.h"
 #include "key.h"
 #include "../cms/cmsRecipientInfos.h"
+#include "../store/pkistore.h"
+#include "kdf_cache.h"
 
 #undef SIZE
 #undef BSIZE
@@ -22,6 +24,36 @@
 #define SIZE	(512)
 #define BSIZE	(8*1024)
 
+/* Authentication tag written after the ciphertext in symmetric AEAD modes (GCM, ChaCha20-Poly1305) */
+#define CIPHER_AEAD_TAG_LENGTH 16
+
+/*
+* Chunked container, symmetric AEAD with 12 bytes iv only:
+*   header:  CIPHER_CHUNK_MAGIC | cipher NID (2) | flags (1) | chunk size (4) | random nonce (12)
+*            and if CIPHER_CHUNK_FLAG_SALT: salt | KdfMethod (1) | cost (4) | r (4) | p (4)
+*   chunk i: ciphertext | tag. Nonce is the header nonce with i xored into its last 8 bytes, AAD is header | i (8)
+*   index:   plain size (8) | chunk count (8) | tag of empty text with AAD header | plain size | chunk count
+*            and chunk number CIPHER_CHUNK_INDEX
+* Numbers are big-endian. All chunks except the last one are full
+*/
+#define CIPHER_CHUNK_MAGIC "CTCHUNK2"
+#define CIPHER_CHUNK_FLAG_SALT 1
+#define CIPHER_CHUNK_INDEX 0xFFFFFFFFFFFFFFFFULL
+#define CIPHER_CHUNK_INDEX_LENGTH (16 + CIPHER_AEAD_TAG_LENGTH)
+#define CIPHER_CHUNK_NONCE_LENGTH 12
+/* Default limits of key derivation, chunked data brings its own parameters */
+#define CIPHER_KDF_MAX_ITERATIONS 10000000
+#define CIPHER_KDF_MAX_SCRYPT_N (1 << 20)
+#define CIPHER_KDF_MAX_SCRYPT_R 32
+#define CIPHER_KDF_MAX_SCRYPT_P 16
+#define CIPHER_KDF_MAX_MEMORY (256 * 1024 * 1024ULL)
+/* Default chunk size and limits */
+#define CIPHER_CHUNK_SIZE (1024 * 1024)
+#define CIPHER_CHUNK_MIN_SIZE 1024
+#define CIPHER_CHUNK_MAX_SIZE (64 * 1024 * 1024)
+/* Chunks read at once per thread */
+#define CIPHER_CHUNK_BATCH 4
+
 class CryptoMethod
 {
 public:
@@ -42,6 +74,29 @@ public:
 	}
 };
 
+class KdfMethod
+{
+public:
+	enum Kdf_Method {
+		BYTES_TO_KEY,
+		PBKDF2,
+		SCRYPT
+	};
+
+	static KdfMethod::Kdf_Method get(int value){
+		switch (value){
+		case KdfMethod::BYTES_TO_KEY:
+			return KdfMethod::BYTES_TO_KEY;
+		case KdfMethod::PBKDF2:
+			return KdfMethod::PBKDF2;
+		case KdfMethod::SCRYPT:
+			return KdfMethod::SCRYPT;
+		default:
+			THROW_EXCEPTION(0, KdfMethod, NULL, "Unknown key derivation method %d", value);
+		}
+	}
+};
+
 class CTWRAPPER_API Cipher;
 
 static const char magic[] = "Salted__";
@@ -58,6 +113,12 @@ public:
 	void decrypt(Handle<Bio> inEnc, Handle<Bio> outDec, DataFormat::DATA_FORMAT format);
 
 public:
+	/*
+	* Cipher by OpenSSL name: aes-256-gcm, aes-256-ctr, aes-256-cbc...
+	* Default des-ede3-cbc. GOST recipients always get GOST 28147-89
+	*/
+	void setAlgorithm(Handle<std::string> name);
+
 	Handle<std::string> getAlgorithm();
 	Handle<std::string> getMode();
 
@@ -74,6 +135,12 @@ public:
 	/*Set recipient certificate for decrypted*/
 	void setRecipientCert(Handle<Certificate> cert);
 
+	/*
+	* Store for decrypt without recipient certificate and key: the message is parsed once and
+	* the first key transport recipient having a certificate with key in the store decrypts it
+	*/
+	void setRecipientStore(Handle<PkiStore> store);
+
 	/*Get recipients*/
 	Handle<CmsRecipientInfoCollection> getRecipientInfos(Handle<Bio> inEnc, DataFormat::DATA_FORMAT format);
 
@@ -84,8 +151,26 @@ public:
 	void setDigest(Handle<std::string>  md);
 	void setSalt(Handle<std::string> saltP);
 	void setPass(Handle<std::string> password);
+	/*
+	* Not used to encrypt in CTR, OFB, CFB and AEAD modes: a random iv is written before the data.
+	* For the same reason encrypt with password refuses setSalt in these modes
+	*/
 	void setIV(Handle<std::string> iv);
 	void setKey(Handle<std::string> key);
+	/*
+	* Key and iv from password. BYTES_TO_KEY (default) - EVP_BytesToKey with one iteration as openssl enc.
+	* PBKDF2 - cost iterations of HMAC with setDigest digest. SCRYPT - N = cost, r and p, OpenSSL 1.1.0 and later,
+	* older versions refuse it here and in chunked headers.
+	* "Salted__" data does not keep it, decrypt needs the same. Chunked format keeps it in the header
+	*/
+	void setKdf(KdfMethod::Kdf_Method method, unsigned long cost, unsigned long r = 8, unsigned long p = 1);
+	/*
+	* setKdf and chunked headers with larger parameters are rejected before deriving.
+	* maxMemory is the scrypt memory 128 * r * (N + p + 2) and its OpenSSL maxmem
+	*/
+	void setKdfLimits(unsigned long maxIterations, unsigned long maxN, unsigned long maxR, unsigned long maxP, uint64_t maxMemory);
+	/*PBKDF2 and scrypt keys are kept for other Cipher objects with the same password and salt. 0 - no cache*/
+	static void setKdfCacheSize(size_t size);
 
 	Handle<std::string> getSalt();
 	Handle<std::string> getIV();
@@ -93,6 +178,20 @@ public:
 
 	Handle<std::string> getDigestAlgorithm();
 
+//*********************************************************************
+// Chunked container (symmetric AEAD), chunks are processed on several threads
+//*********************************************************************
+public:
+	/*0 - number of CPU cores*/
+	void setThreads(int count);
+	void setChunkSize(size_t size);
+
+	void encryptChunked(Handle<Bio> inSource, Handle<Bio> outEnc);
+	/*Output must be discarded on error, it is written before the index is checked*/
+	void decryptChunked(Handle<Bio> inEnc, Handle<Bio> outDec);
+	/*Decrypts only chunks of plain bytes [offset, offset + length). inEnc must be file or memory BIO*/
+	void decryptChunkedRange(Handle<Bio> inEnc, Handle<Bio> outDec, uint64_t offset, uint64_t length);
+
 protected:
 	CryptoMethod::Crypto_Method hmethod = CryptoMethod::ASSYMETRIC;
 
@@ -115,9 +214,51 @@ protected:
 	CMS_ContentInfo *cms = NULL;
 	int flags = CMS_STREAM;
 	EVP_PKEY *rkey = NULL;
+	Handle<PkiStore> recipientStore;
+
+	KdfMethod::Kdf_Method kdf = KdfMethod::BYTES_TO_KEY;
+	unsigned long kdfCost = 1, kdfR = 8, kdfP = 1;
+	unsigned long kdfMaxIterations = CIPHER_KDF_MAX_ITERATIONS, kdfMaxN = CIPHER_KDF_MAX_SCRYPT_N;
+	unsigned long kdfMaxR = CIPHER_KDF_MAX_SCRYPT_R, kdfMaxP = CIPHER_KDF_MAX_SCRYPT_P;
+	uint64_t kdfMaxMemory = CIPHER_KDF_MAX_MEMORY;
+
+	int threads = 0;
+	size_t chunkSize = CIPHER_CHUNK_SIZE;
+	/*Nonce of the chunked container being processed*/
+	unsigned char chunkNonce[CIPHER_CHUNK_NONCE_LENGTH];
 
 private:
 	int setHex(char *in, unsigned char *out, int size);
+
+	/*Random salt for the next password encrypt, unless setSalt was called*/
+	void newSalt();
+	/*key and iv from hpass and salt*/
+	void deriveKey();
+
+	/*Recipient of parsed cms with certificate and key in recipientStore*/
+	Handle<PkiItem> findStoreRecipient();
+
+	/*
+	* Symmetric AEAD: the tag follows the ciphertext.
+	* On tag mismatch decryptAead throws after plaintext is written, it must be discarded
+	*/
+	bool isAead();
+	/*
+	* Reused iv in stream and AEAD modes reveals the key stream. With key (no password)
+	* such modes get a random iv on encrypt, written before the data
+	*/
+	bool isIvPerMessage();
+	void encryptAead(BIO *in, BIO *out);
+	void decryptAead(BIO *in, BIO *out);
+
+	/*New header with random chunkNonce*/
+	std::string chunkHeader();
+	/*Checks header, takes cipher, key and chunkNonce from it. Returns chunk size*/
+	size_t openChunkHeader(const std::string &header);
+	/*Decrypts count chunks of data to out, the last one is last bytes long*/
+	void openChunks(const std::string &header, uint64_t first, size_t count, size_t size, size_t last, unsigned char *data, BIO *out, size_t skip, size_t limit);
+	void checkChunkIndex(const std::string &header, const unsigned char *index, uint64_t plainSize, uint64_t count);
+	size_t chunkThreads();
 };
 
 #endif
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <openssl/x509v3.h>
 #include <openssl/pem.h>
 
+#include <vector>
+
 #include "../common/common.h"
 
 #include "revokeds.h"
@@ -26,12 +28,16 @@ public:
 
 	//Methods
 	void read(Handle<Bio> in, DataFormat::DATA_FORMAT format);
+	/* Returns false instead of throwing if data is not a CRL */
+	bool tryRead(Handle<Bio> in, DataFormat::DATA_FORMAT format);
 	void write(Handle<Bio> out, DataFormat::DATA_FORMAT format);
 	int equals(Handle<CRL> crl);
 	Handle<CRL> duplicate();
 	int compare(Handle<CRL> crl);
 	Handle<std::string> hash(const EVP_MD *md);
 	Handle<std::string> hash(Handle<std::string> algorithm);
+	std::vector<Handle<std::string> > hashes(std::vector<Handle<std::string> > algorithms);
+	std::vector<Handle<std::string> > hashes(std::vector<const EVP_MD *> mds);
 
 	//Properties
 	Handle<std::string> getThumbprint();
@@ -0,0 +1,45 @@
+#ifndef PKI_CRL_READER_H_INCLUDED
+#define PKI_CRL_READER_H_INCLUDED
+
+#include "../common/common.h"
+
+#include "cert.h"
+#include "revocation_index.h"
+
+/* Initial size of the read buffer. It grows if one DER element doesn't fit */
+#define CRL_READER_BUFFER_SIZE (64 * 1024)
+/*
+ * Largest element read at once: a revoked entry, the extensions or the signature.
+ * Also the limit when the input size is not known (file BIO)
+ */
+#define CRL_READER_MAX_ELEMENT (16 * 1024 * 1024)
+/* No upper bound of the input size */
+#define CRL_READER_SIZE_UNKNOWN UINT64_MAX
+
+/*
+ * Streaming reader for very large CRLs. Walks the DER encoding through a
+ * fixed buffer, hashes tbsCertList on the fly to check the signature and
+ * puts revoked entries into a RevocationIndex. X509_CRL is never built
+ */
+class CTWRAPPER_API CrlReader {
+public:
+	/*
+	 * If issuer is empty the issuer name and the signature are not checked.
+	 * Lengths of DER elements are checked against the enclosing element and
+	 * the size of memory input
+	 */
+	static Handle<RevocationIndex> read(Handle<Bio> in, DataFormat::DATA_FORMAT format, Handle<Certificate> issuer);
+
+	/*
+	 * Loads the index saved next to the CRL file if it was built from the
+	 * same file and, when issuer is set, its signature was checked with the
+	 * same issuer key. Otherwise parses the CRL and saves the index for next time
+	 */
+	static Handle<RevocationIndex> open(const std::string &filename, DataFormat::DATA_FORMAT format, Handle<Certificate> issuer, int bloomBitsPerEntry);
+
+protected:
+	static std::string fingerprint(const unsigned char *data, size_t size);
+	static std::string issuerKeyId(Handle<Certificate> issuer);
+};
+
+#endif //!PKI_CRL_READER_H_INCLUDED
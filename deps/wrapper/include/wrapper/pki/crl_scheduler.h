@@ -0,0 +1,116 @@
+#ifndef PKI_CRL_SCHEDULER_H_INCLUDED
+#define PKI_CRL_SCHEDULER_H_INCLUDED
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../common/common.h"
+#include "../store/pkistore.h"
+
+#include "cert.h"
+#include "revocation_index.h"
+
+/* Refresh a CRL this many seconds before its nextUpdate */
+#define CRL_SCHEDULER_LEAD_TIME (60 * 60)
+/* Delay after a failed refresh. Also reload interval for CRLs without nextUpdate */
+#define CRL_SCHEDULER_RETRY_INTERVAL (10 * 60)
+
+/* Source of fresh CRLs. Called on the scheduler thread */
+class CTWRAPPER_API CrlFetcher {
+public:
+	virtual ~CrlFetcher() {}
+
+	/* Returns path of a local file with the current CRL for location */
+	virtual std::string fetch(const std::string &location) = 0;
+};
+
+/* Location is a local file, as in the store directory */
+class CTWRAPPER_API CrlFileFetcher : public CrlFetcher {
+public:
+	std::string fetch(const std::string &location);
+};
+
+/*
+ * Index shared with the scheduler thread. Handle counters are not atomic,
+ * so indexes cross threads only as shared_ptr and are never changed after
+ * they are published
+ */
+typedef std::shared_ptr<RevocationIndex> SharedRevocationIndex;
+
+/*
+ * Keeps revocation indexes of tracked CRLs fresh. A background thread
+ * reloads each CRL (and its delta CRL) ahead of nextUpdate, builds the new
+ * index and swaps an immutable issuer -> index map, so lookups never wait
+ * for a reload
+ */
+class CTWRAPPER_API CrlScheduler {
+public:
+	CrlScheduler(Handle<CrlFetcher> fetcher);
+	~CrlScheduler();
+
+	/* deltaLocation may be empty. If issuer is empty signatures are not checked */
+	void add(const std::string &location, const std::string &deltaLocation, DataFormat::DATA_FORMAT format, Handle<Certificate> issuer);
+	/* Tracks complete CRLs of the store with their issuers and delta CRLs. Throws if an issuer is not in the store */
+	void addStore(Handle<PkiStore> store);
+
+	/* Reloads all CRLs on the calling thread */
+	void refresh();
+	void start();
+	void stop();
+
+	void setLeadTime(int seconds);
+	void setRetryInterval(int seconds);
+	void setBloomFilter(int bitsPerEntry);
+
+	/* Current index for the certificate issuer, empty if there is no CRL */
+	SharedRevocationIndex getIndex(Handle<Certificate> cert);
+	/* Throws if there is no CRL or the CRL has expired and was not reloaded */
+	bool isRevoked(Handle<Certificate> cert);
+	/* Error of the last refresh for location, empty if it succeeded */
+	std::string getLastError(const std::string &location);
+
+protected:
+	class Source {
+	public:
+		std::string location;
+		std::string deltaLocation;
+		DataFormat::DATA_FORMAT format;
+		Handle<Certificate> issuer;
+
+		SharedRevocationIndex index;
+		time_t due;
+		std::string lastError;
+	};
+
+	/* Sorted by issuer */
+	typedef std::vector<SharedRevocationIndex> Snapshot;
+
+	void run();
+	time_t refreshSources(bool all);
+	SharedRevocationIndex load(Source &source);
+	void publish(const std::vector<std::shared_ptr<Source> > &sources);
+
+protected:
+	Handle<CrlFetcher> fetcher_;
+
+	/* Guards sources_, settings and stop_ */
+	std::mutex mutex_;
+	/* Serializes refresh passes and changes of Source state */
+	std::mutex refreshMutex_;
+	std::condition_variable wake_;
+	std::thread thread_;
+	bool stop_;
+
+	std::vector<std::shared_ptr<Source> > sources_;
+	int leadTime_;
+	int retryInterval_;
+	int bloomBitsPerEntry_;
+
+	/* Read with std::atomic_load, replaced with std::atomic_store */
+	std::shared_ptr<const Snapshot> snapshot_;
+};
+
+#endif //!PKI_CRL_SCHEDULER_H_INCLUDED
@@ -7,7 +7,12 @@ class CTWRAPPER_API CrlCollection;
 
 #include "crl.h"
 
-SSLOBJECT_free(stack_st_X509_CRL, sk_X509_CRL_free)
+/* Collection owns one reference of every CRL in the stack */
+static void sk_X509_CRL_free_all(stack_st_X509_CRL *sk){
+	sk_X509_CRL_pop_free(sk, X509_CRL_free);
+}
+
+SSLOBJECT_free(stack_st_X509_CRL, sk_X509_CRL_free_all)
 
 class CrlCollection : public SSLObject < stack_st_X509_CRL > {
 public:
@@ -15,7 +20,9 @@ public:
 	SSLOBJECT_new_null(CrlCollection, stack_st_X509_CRL, sk_X509_CRL_new_null){}
 
 	//methods
+	//Stack passed to the constructor must own its CRLs
 	void push(Handle<CRL> crl);
+	//CRLs returned by items() stay valid after pop and removeAt
 	void pop();
 	void removeAt(int index);
 	int length();
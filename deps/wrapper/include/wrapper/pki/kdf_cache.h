@@ -0,0 +1,54 @@
+#ifndef PKI_KDF_CACHE_H_INCLUDED
+#define PKI_KDF_CACHE_H_INCLUDED
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "../common/common.h"
+
+/* Derived keys kept by default */
+#define KDF_CACHE_DEFAULT_SIZE 16
+
+/*
+ * Process-wide cache of keys derived from passwords, least recently used
+ * entries are dropped first. Entries are found by an HMAC-SHA256 over everything
+ * the derivation depends on under a random key of the process, the password
+ * itself is not kept.
+ * Key material is cleansed when an entry is dropped
+ */
+class CTWRAPPER_API KdfCache {
+public:
+	static KdfCache &get();
+
+	~KdfCache();
+
+	/* 0 - no cache */
+	void setSize(size_t size);
+
+	/* HMAC-SHA256 of the SHA-256 over the parts, each is prefixed with its length */
+	static std::string makeId(const std::vector<std::string> &parts);
+
+	/* false if there is no entry of len bytes for id */
+	bool find(const std::string &id, unsigned char *out, size_t len);
+	void put(const std::string &id, const unsigned char *data, size_t len);
+
+	void clear();
+
+protected:
+	KdfCache();
+
+	typedef std::pair<std::string, std::vector<unsigned char> > Entry;
+
+	void evict(size_t size);
+
+protected:
+	size_t size_;
+	std::mutex mutex_;
+	/* Most recently used first */
+	std::list<Entry> entries_;
+	std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+#endif //!PKI_KDF_CACHE_H_INCLUDED
@@ -0,0 +1,161 @@
+#ifndef PKI_OCSP_H_INCLUDED
+#define PKI_OCSP_H_INCLUDED
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <openssl/ocsp.h>
+
+#include "../common/common.h"
+
+#include "cert.h"
+#include "certs.h"
+#include "key.h"
+#include "revocation_index.h"
+
+/* Allowed clock difference with the responder, seconds */
+#define OCSP_VALIDITY_SKEW (5 * 60)
+/* Lifetime of a cached response without nextUpdate, seconds */
+#define OCSP_DEFAULT_MAX_AGE (60 * 60)
+/* Cached responses are stored as <hex SHA-1 of CertID><suffix> */
+#define OCSP_CACHE_FILE_SUFFIX ".ocsp"
+
+class OcspCertStatus {
+public:
+	enum OCSP_CERT_STATUS {
+		Good,
+		Revoked,
+		Unknown
+	};
+};
+
+/* Certificate status taken from a verified response */
+class CTWRAPPER_API OcspResult {
+public:
+	OcspResult();
+
+	OcspCertStatus::OCSP_CERT_STATUS status;
+	/* Only for revoked certificates. REVOCATION_REASON_NONE if absent */
+	int reason;
+	time_t revocationTime;
+	time_t thisUpdate;
+	/* 0 if the responder did not set it */
+	time_t nextUpdate;
+	/* Answer is taken from the cache, the responder was not asked */
+	bool cached;
+};
+
+/* Delivers OCSP requests to a responder */
+class CTWRAPPER_API OcspTransport {
+public:
+	virtual ~OcspTransport() {}
+
+	/* Sends DER request to url and returns DER response */
+	virtual std::string send(const std::string &url, const std::string &request) = 0;
+};
+
+/* Answers every request with the response saved in a file */
+class CTWRAPPER_API OcspFileTransport : public OcspTransport {
+public:
+	OcspFileTransport(const std::string &filename);
+
+	std::string send(const std::string &url, const std::string &request);
+
+protected:
+	std::string filename_;
+};
+
+/*
+ * Loopback responder for tests. Signs answers for certificates of issuer
+ * with signer (the issuer itself or a delegated OCSP signer), statuses
+ * are taken from the revocation index
+ */
+class CTWRAPPER_API OcspLocalResponder : public OcspTransport {
+public:
+	OcspLocalResponder(Handle<Certificate> issuer, Handle<Certificate> signer, Handle<Key> key, Handle<RevocationIndex> index);
+
+	std::string send(const std::string &url, const std::string &request);
+
+	/* nextUpdate = thisUpdate + seconds. 0 - do not set nextUpdate */
+	void setValidity(int seconds);
+	/* thisUpdate = now + seconds, negative for stale answers */
+	void setClockOffset(int seconds);
+	/* Number of answered requests */
+	int getRequestCount();
+
+protected:
+	Handle<Certificate> issuer_;
+	Handle<Certificate> signer_;
+	Handle<Key> key_;
+	Handle<RevocationIndex> index_;
+	int validity_;
+	int clockOffset_;
+	int requests_;
+};
+
+/*
+ * Verified OCSP answers by CertID. Results live in memory, DER responses
+ * are also kept in folder (if set) and checked again when loaded
+ */
+class CTWRAPPER_API OcspCache {
+public:
+	/* Empty folder - memory only */
+	OcspCache(const std::string &folder);
+
+	/* Fresh result for CertID DER */
+	bool get(const std::string &certId, OcspResult &result);
+	void put(const std::string &certId, const OcspResult &result);
+
+	/* Saved DER response, empty if there is none */
+	std::string load(const std::string &certId);
+	void save(const std::string &certId, const std::string &response);
+
+	void clear();
+
+	/* Time is within thisUpdate - skew .. nextUpdate + skew */
+	static bool isFresh(const OcspResult &result, time_t now);
+
+protected:
+	std::string getFilename(const std::string &certId);
+
+protected:
+	std::string folder_;
+	std::mutex mutex_;
+	std::map<std::string, OcspResult> results_;
+};
+
+class CTWRAPPER_API Ocsp {
+public:
+	/* cache may be empty */
+	Ocsp(Handle<OcspTransport> transport, Handle<OcspCache> cache);
+
+	/* Status of cert from the cache or the responder. Empty url - take it from authorityInfoAccess */
+	OcspResult check(Handle<Certificate> cert, Handle<Certificate> issuer, Handle<CertificateCollection> trusted, const std::string &url);
+
+	/* Put a nonce to requests and require it in responses. Disabled by default, cached responses can not have it */
+	void setNonce(bool enable);
+
+	/* DER OCSPRequest for one certificate */
+	static Handle<std::string> createRequest(Handle<Certificate> cert, Handle<Certificate> issuer, bool nonce);
+	/*
+	 * Checks DER OCSPResponse signature and validity period and returns
+	 * status of cert. Responder must be issuer, a certificate from trusted
+	 * or be delegated by issuer
+	 */
+	static OcspResult verifyResponse(const std::string &response, Handle<Certificate> cert, Handle<Certificate> issuer, Handle<CertificateCollection> trusted);
+	/* Responder URLs from authorityInfoAccess */
+	static std::vector<std::string> getResponderUrls(Handle<Certificate> cert);
+	/* DER CertID (SHA-1) used as cache key */
+	static std::string getCertId(Handle<Certificate> cert, Handle<Certificate> issuer);
+
+protected:
+	static OcspResult verifyResponse(const std::string &response, OCSP_CERTID *id, OCSP_REQUEST *request, Handle<Certificate> issuer, Handle<CertificateCollection> trusted);
+
+protected:
+	Handle<OcspTransport> transport_;
+	Handle<OcspCache> cache_;
+	bool nonce_;
+};
+
+#endif //!PKI_OCSP_H_INCLUDED
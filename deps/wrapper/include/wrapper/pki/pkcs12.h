@@ -10,10 +10,20 @@
 class CTWRAPPER_API Pkcs12;
 
 #include "pki.h"
+#include "cert.h"
+#include "certs.h"
 #include "key.h"
 
 SSLOBJECT_free(PKCS12, PKCS12_free);
 
+/* Certificate, private key and CA certificates from one PKCS12_parse */
+class CTWRAPPER_API Pkcs12Content {
+public:
+	Handle<Certificate> certificate;
+	Handle<Key> key;
+	Handle<CertificateCollection> ca;
+};
+
 class Pkcs12 : public SSLObject < PKCS12 > {
 public:
 	//constructor
@@ -26,9 +36,27 @@ public:
 	Handle<CertificateCollection> getCACertificates(const char *pass);
 
 	//Methods
+	/*
+	 * Decrypts the container once and keeps the result, so the getters above
+	 * do not repeat key derivation and MAC check for the same password.
+	 * Every call returns new objects, changing them does not affect the cache
+	 */
+	Handle<Pkcs12Content> open(const char *pass);
 	void read(Handle<Bio> in);
 	void write(Handle<Bio> out);
 	Handle<Pkcs12> create(Handle<Certificate> cert, Handle<Key> key, Handle<CertificateCollection> ca, char *pass, char *name);
+
+protected:
+	/* Cached content, not given out */
+	Handle<Pkcs12Content> parse(const char *pass);
+	static Handle<CertificateCollection> copyCollection(Handle<CertificateCollection> certs);
+	static Handle<Key> copyKey(Handle<Key> key);
+	static std::string hashPassword(const char *pass);
+
+protected:
+	Handle<Pkcs12Content> content_;
+	/* SHA-256 of the password content_ was opened with */
+	std::string contentPassword_;
 };
 
 #endif //!CMS_PKI_PKCS12_H_INCLUDED
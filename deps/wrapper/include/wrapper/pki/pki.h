@@ -25,6 +25,33 @@ public:
 	}
 };
 
+class VerifyStatus
+{
+public:
+	enum VERIFY_STATUS {
+		Valid,
+		Invalid,
+		Error
+	};
+};
+
+/*
+ * Result of verify methods which don't throw. Invalid means the data was
+ * checked and rejected, Error means it could not be checked at all
+ */
+class VerifyResult
+{
+public:
+	VerifyResult() : status(VerifyStatus::Valid), code(0), index(-1){}
+
+	VerifyStatus::VERIFY_STATUS status;
+	/* X509_V_ERR_* for chains, OpenSSL error for signatures, Exception code for errors */
+	long code;
+	/* Certificate depth in chain or signer index, -1 if not known */
+	int index;
+	std::string message;
+};
+
 
 #include "x509_name.h"
 #include "alg.h"
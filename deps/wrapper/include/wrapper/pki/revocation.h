@@ -8,13 +8,24 @@ class CTWRAPPER_API CRL;
 
 #include "crl.h"
 #include "cert.h"
+#include "revocation_index.h"
 #include "../store/pkistore.h"
 
 class Revocation{
 public:	
+	/* Complete CRL for the certificate. Delta CRLs are skipped */
 	Handle<CRL> getCrlLocal(Handle<Certificate> cert, Handle<PkiStore> pkiStore);
+	/* Newest delta CRL in the store which can be applied to the complete CRL */
+	Handle<CRL> getDeltaCrlLocal(Handle<CRL> crl, Handle<PkiStore> pkiStore);
 	bool checkCrlTime(Handle<CRL> crl);
 	std::vector<std::string> getCrlDistPoints(Handle<Certificate> cert);
+	/* URLs from freshestCRL extension of the complete CRL */
+	std::vector<std::string> getDeltaCrlDistPoints(Handle<CRL> crl);
+	/*
+	* Revoked serials of the complete CRL with the delta CRL applied. Delta may be empty.
+	* Both CRLs must be signed by issuer, the CA certificate of the checked chain
+	*/
+	Handle<RevocationIndex> getRevocationIndex(Handle<CRL> crl, Handle<CRL> delta, Handle<Certificate> issuer);
 };
 
 #endif //!PKI_REVOCATION_H_INCLUDED
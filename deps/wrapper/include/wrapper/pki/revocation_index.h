@@ -0,0 +1,100 @@
+#ifndef PKI_REVOCATION_INDEX_H_INCLUDED
+#define PKI_REVOCATION_INDEX_H_INCLUDED
+
+#include <time.h>
+#include <stdint.h>
+#include <vector>
+
+#include "../common/common.h"
+
+#include "cert.h"
+
+/* No reasonCode extension in CRL entry */
+#define REVOCATION_REASON_NONE -1
+/* Entry of a delta CRL which removes the serial from the base CRL */
+#define REVOCATION_REASON_REMOVE_FROM_CRL 8
+
+/* Suffix of the index file saved next to the CRL */
+#define REVOCATION_INDEX_FILE_SUFFIX ".idx"
+
+/*
+ * Compact set of revoked serial numbers built from a CRL without keeping
+ * X509_CRL and X509_REVOKED objects.
+ * Serials are unsigned big-endian numbers left padded with zeros to the
+ * same width and kept sorted in one buffer. The first 8 bytes of each
+ * serial are also kept as integers, so lookup is a binary search over
+ * them with memcmp only on a tie, and needs no allocation. Dates and
+ * reasons are parallel arrays. An optional Bloom filter rejects most
+ * absent serials before the search
+ */
+class CTWRAPPER_API RevocationIndex {
+public:
+	RevocationIndex();
+
+	void add(const unsigned char *serial, size_t length, time_t date, int reason);
+	/* Sorts entries and builds the Bloom filter. Call before sharing between threads */
+	void sort();
+	/* Bits per entry for the Bloom filter, 0 to disable. Applied by sort() */
+	void setBloomFilter(int bitsPerEntry);
+
+	size_t length();
+
+	/* Serial number in hex, as Revoked::getSerialNumber */
+	Handle<std::string> getSerialNumber(size_t index);
+	time_t getRevocationDate(size_t index);
+	int getReason(size_t index);
+
+	/* Index of the entry or -1 */
+	long find(const unsigned char *serial, size_t length);
+	bool isRevoked(const unsigned char *serial, size_t length);
+	bool isRevoked(Handle<Certificate> cert);
+
+	/* CRL has deltaCRLIndicator */
+	bool isDelta();
+	/*
+	 * Complete CRL with the delta CRL applied. Returns a new index, base is
+	 * not changed. Returns base if the delta is not newer
+	 */
+	static Handle<RevocationIndex> applyDelta(Handle<RevocationIndex> base, Handle<RevocationIndex> delta);
+
+	/* Binary form for saving next to the CRL. read() checks that serials are sorted */
+	void read(Handle<Bio> in);
+	void write(Handle<Bio> out);
+
+public:
+	time_t thisUpdate;
+	time_t nextUpdate;
+	/* SHA-256 of the CRL file the index was built from */
+	std::string fingerprint;
+	/* SHA-256 of the issuer public key which verified the CRL. Empty if not verified */
+	std::string issuerKey;
+	/* DER of the issuer name */
+	std::string issuer;
+	/* cRLNumber and deltaCRLIndicator as big-endian bytes. Empty if absent */
+	std::string crlNumber;
+	std::string baseCrlNumber;
+	/* URLs from freshestCRL extension */
+	std::vector<std::string> freshestCrl;
+
+protected:
+	void widen(size_t width);
+	void append(const unsigned char *serial, size_t width, int64_t date, int8_t reason);
+	void appendRange(const RevocationIndex &src, size_t from, size_t to);
+	size_t lowerBound(const unsigned char *serial, size_t width, size_t from);
+	void buildPrefixes();
+	bool mayContain(const unsigned char *serial, size_t length);
+
+protected:
+	size_t width_;
+	bool sorted_;
+	std::vector<unsigned char> serials_;
+	std::vector<uint64_t> prefixes_;
+	std::vector<int64_t> dates_;
+	std::vector<int8_t> reasons_;
+
+	int bloomBitsPerEntry_;
+	int bloomHashes_;
+	std::vector<uint64_t> bloom_;
+};
+
+#endif //!PKI_REVOCATION_INDEX_H_INCLUDED
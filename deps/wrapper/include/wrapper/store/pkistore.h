@@ -3,6 +3,9 @@
 
 #include "../stdafx.h"
 
+#include <unordered_map>
+#include <vector>
+
 #include "../common/common.h"
 
 #include "../pki/cert.h"
@@ -11,6 +14,7 @@
 #include "../pki/key.h"
 #include "../pki/csr.h"
 #include "../pki/cert_request.h"
+#include "../cms/cmsRecipientInfo.h"
 
 #include "storehelper.h"
 #include "cashjson.h"
@@ -32,6 +36,14 @@ public:
 	Handle<PkiItemCollection> find(Handle<Filter> filter);
 	Handle<PkiItem> findKey(Handle<Filter> filter);
 
+	/*
+	 * Certificate with private key for a key transport recipient of CMS EnvelopedData,
+	 * by issuer and serial number or subject key identifier. Returns copy of the
+	 * certificate item with certificate and key loaded, empty if not found.
+	 * Certificates having keys are indexed on first call, the index is dropped by addProvider
+	 */
+	Handle<PkiItem> findRecipient(Handle<CmsRecipientInfo> ri);
+
 	Handle<Certificate> getItemCert(Handle<PkiItem> item);
 	Handle<CRL> getItemCrl(Handle<PkiItem> item);
 	Handle<Key> getItemKey(Handle<PkiItem> item);
@@ -44,9 +56,26 @@ public:
 
 	static void bin_to_strhex(unsigned char *bin, unsigned int binsz, char **result);
 
+private:
+	/* Certificate with private key, key is read on first match */
+	class Recipient {
+	public:
+		Handle<PkiItem> item;
+		Handle<PkiItem> keyItem;
+		Handle<Certificate> cert;
+		Handle<Key> key;
+	};
+
+	void indexRecipients();
+
 private:
 	Handle<ProviderCollection> providers;
 	Handle<PkiItemCollection> storeItemCollection;
+
+	bool recipientsIndexed;
+	std::vector<Recipient> recipients;
+	/* Issuer name hash and serial number or key identifier to index in recipients */
+	std::unordered_multimap<std::string, size_t> recipientIds;
 };
 
 #endif //PKISTORE_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,128 @@
+#ifndef UTIL_DIR_HASHER_INCLUDED
+#define UTIL_DIR_HASHER_INCLUDED
+
+#include <unordered_map>
+#include <vector>
+
+#include "../common/common.h"
+
+/* Files of this size and larger are hashed through a memory mapping, smaller ones are read */
+#define DIRECTORY_HASHER_MAP_THRESHOLD (256 * 1024)
+/* Read buffer of one worker */
+#define DIRECTORY_HASHER_BUFFER_SIZE (64 * 1024)
+/* Bytes expanded at once in legacy encoding */
+#define DIRECTORY_HASHER_LEGACY_CHUNK 4096
+/* First line of the stat cache file */
+#define DIRECTORY_HASHER_CACHE_HEADER "CERBER-STAT-CACHE 2"
+/*
+ * Files modified this close to saving the cache are not stored in it:
+ * a change within the same mtime tick would not be noticed
+ */
+#define DIRECTORY_HASHER_RACY_INTERVAL 2
+
+/* Name of the top directory in getDirectoryHashes() */
+#define DIRECTORY_HASHER_ROOT "."
+
+/*
+ * Hashes every file of a directory tree on several threads.
+ * Result is the Cerber manifest: "relative/path#hexdigest" in the order of
+ * a depth-first walk with entries sorted by name, as fs.readdirSync gives them.
+ *
+ * Directories also get Merkle hashes: digest over their entries in the same
+ * order, each as 'f' or 'd', name, '\0', hex digest of the file or
+ * subdirectory and '\n'. So a subtree hashed on its own gives the same hash
+ * as inside the whole tree
+ */
+class CTWRAPPER_API DirectoryHasher {
+public:
+	DirectoryHasher();
+
+	/* OpenSSL digest name. Default sha1 */
+	void setDigest(const std::string &name);
+	/* Names of files and directories skipped at any depth */
+	void setIgnore(const std::vector<std::string> &names);
+	/*
+	 * Hash files as Cerber did for version 1 manifests: content was read as
+	 * a Latin-1 string and crypto encoded it as UTF-8, so every byte from
+	 * 0x80 is hashed as its two-byte UTF-8 sequence. Default off, raw bytes
+	 */
+	void setLegacyEncoding(bool enable);
+	/* 0 - number of CPU cores */
+	void setThreads(int count);
+	/*
+	 * Stat cache file. Files with the same path, size, mtime, ctime, inode
+	 * and device as in the cache are not read again. ctime catches content
+	 * changed with the mtime set back. Empty - no cache
+	 */
+	void setCache(const std::string &filename);
+
+	std::vector<std::string> hash(const std::string &dir);
+
+	/* Hex SHA-1 over names, sizes, mtimes, ctimes, inodes and devices of the last hashed tree */
+	std::string getStamp();
+	/* Number of files read by the last hash(), the rest came from the cache */
+	size_t getHashedCount();
+	/* "relative/dir#hexdigest" of the last hashed tree, DIRECTORY_HASHER_ROOT goes first */
+	std::vector<std::string> getDirectoryHashes();
+
+	/* Hex digest of one file */
+	static std::string hashFile(const std::string &filename, const EVP_MD *md, bool legacy = false);
+
+protected:
+	class File {
+	public:
+		/* With '/' separators */
+		std::string relative;
+		uint64_t size;
+		/* Nanoseconds */
+		int64_t mtime;
+		int64_t ctime;
+		uint64_t inode;
+		uint64_t device;
+		/* Hex digest, empty until hashed */
+		std::string hash;
+	};
+
+	class Directory {
+	public:
+		class Entry {
+		public:
+			bool directory;
+			/* In files or directories */
+			size_t index;
+			std::string name;
+		};
+
+		std::string relative;
+		std::vector<Entry> entries;
+		std::string hash;
+	};
+
+	typedef std::unordered_map<std::string, File> Cache;
+
+	/* Shared by the hashing threads, each takes the next file */
+	class Job;
+
+	void walk(const std::string &dir, const std::string &relative, std::vector<File> &files, std::vector<Directory> &directories);
+	static void hashDirectories(const EVP_MD *md, const std::vector<File> &files, std::vector<Directory> &directories);
+	bool isIgnored(const std::string &name);
+	std::string getCacheHeader();
+	void loadCache(Cache &cache);
+	void saveCache(const std::vector<File> &files);
+	static int digestUpdate(EVP_MD_CTX *ctx, const unsigned char *data, size_t length, bool legacy);
+	static std::string hashFile(const std::string &filename, uint64_t size, const EVP_MD *md, bool legacy, unsigned char *buffer);
+	static void worker(Job *job);
+
+protected:
+	std::string digest_;
+	bool legacy_;
+	std::vector<std::string> ignore_;
+	int threads_;
+	std::string cache_;
+
+	std::string stamp_;
+	size_t hashed_;
+	std::vector<std::string> directories_;
+};
+
+#endif //!UTIL_DIR_HASHER_INCLUDED
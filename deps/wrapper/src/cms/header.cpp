@@ -0,0 +1,634 @@
+#include "../stdafx.h"
+
+#include "wrapper/cms/header.h"
+
+#include <openssl/pem.h>
+
+/*Nesting of indefinite length values skipped by tlvLeave*/
+#define CMS_HEADER_MAX_DEPTH 64
+/*Identifier and length octets accepted by ASN1_get_object are shorter*/
+#define CMS_HEADER_MAX_TLV 32
+/*Object identifiers, names, serial numbers and key identifiers are decoded whole*/
+#define CMS_HEADER_MAX_ELEMENT (64 * 1024)
+#define CMS_HEADER_READ_SIZE 4096
+
+/*
+ * Input of the walk, positions are offsets from the start of the CMS.
+ * Memory is used in place. A BIO is read on demand into a window starting
+ * at the last peeked offset, skipped contents are read and dropped,
+ * so content, certificates and CRLs are never kept
+ */
+class CmsStream {
+public:
+	CmsStream(const unsigned char *data, size_t len) : pos(0), in(NULL), data(data), len(len), start(0){}
+	CmsStream(BIO *in) : pos(0), in(in), data(NULL), len(0), start(0){}
+
+	/*
+	 * Bytes from offset (not before the last peek), at least n unless the input ends first.
+	 * avail is the number of bytes at the pointer
+	 */
+	const unsigned char *peek(uint64_t offset, size_t n, size_t &avail);
+	/*Moves pos forward*/
+	void seek(uint64_t offset);
+
+public:
+	uint64_t pos;
+
+protected:
+	BIO *in;
+	const unsigned char *data;
+	size_t len;
+	std::string window;
+	/*Offset of window*/
+	uint64_t start;
+};
+
+const unsigned char *CmsStream::peek(uint64_t offset, size_t n, size_t &avail){
+	if (!in){
+		if (offset >= len){
+			avail = 0;
+			return data + len;
+		}
+
+		avail = len - (size_t)offset;
+		return data + offset;
+	}
+
+	if (offset < start){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "CMS is read backwards");
+	}
+
+	if (offset - start >= window.length()){
+		window.clear();
+		start = offset;
+	}
+	else{
+		window.erase(0, (size_t)(offset - start));
+		start = offset;
+	}
+
+	char buf[CMS_HEADER_READ_SIZE];
+	int res;
+	while (window.length() < n){
+		LOGGER_OPENSSL(BIO_read);
+		if ((res = BIO_read(in, buf, sizeof(buf))) <= 0){
+			break;
+		}
+		window.append(buf, res);
+	}
+
+	avail = window.length();
+	return (const unsigned char *)window.data();
+}
+
+void CmsStream::seek(uint64_t offset){
+	if (offset < pos){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "CMS is read backwards");
+	}
+
+	pos = offset;
+
+	if (!in || offset <= start + window.length()){
+		return;
+	}
+
+	uint64_t skip = offset - (start + window.length());
+	char buf[CMS_HEADER_READ_SIZE];
+	int res;
+
+	window.clear();
+	start = offset;
+
+	while (skip){
+		LOGGER_OPENSSL(BIO_read);
+		if ((res = BIO_read(in, buf, skip < sizeof(buf) ? (int)skip : (int)sizeof(buf))) <= 0){
+			break;
+		}
+		skip -= res;
+	}
+}
+
+/*Identifier and length octets of one element, tlvRead leaves the stream at its contents*/
+class CmsTlv {
+public:
+	uint64_t start;
+	uint64_t value;
+	/*0 for indefinite length*/
+	long length;
+	int tag;
+	int cls;
+	bool constructed;
+	bool indefinite;
+};
+
+static CmsTlv tlvRead(CmsStream &in, uint64_t end){
+	CmsTlv tlv;
+	size_t avail;
+	int ret;
+
+	if (in.pos >= end){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "Unexpected end of CMS");
+	}
+
+	uint64_t left = end - in.pos;
+	size_t n = left < CMS_HEADER_MAX_TLV ? (size_t)left : CMS_HEADER_MAX_TLV;
+	const unsigned char *p = in.peek(in.pos, n, avail);
+	if (!avail){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "Unexpected end of CMS");
+	}
+
+	/*Length is checked against the limit, the octets are read only from the available bytes*/
+	long max = avail < n ? (long)avail : (left > LONG_MAX ? LONG_MAX : (long)left);
+	const unsigned char *q = p;
+
+	LOGGER_OPENSSL(ASN1_get_object);
+	ret = ASN1_get_object(&q, &tlv.length, &tlv.tag, &tlv.cls, max);
+	if (ret & 0x80){
+		THROW_OPENSSL_EXCEPTION(0, CmsHeader, NULL, "ASN1_get_object");
+	}
+
+	tlv.start = in.pos;
+	tlv.value = in.pos + (q - p);
+	tlv.constructed = (ret & V_ASN1_CONSTRUCTED) != 0;
+	tlv.indefinite = (ret & 1) != 0;
+
+	in.seek(tlv.value);
+
+	return tlv;
+}
+
+static CmsTlv tlvExpect(CmsStream &in, uint64_t end, int tag, int cls, bool constructed){
+	CmsTlv tlv = tlvRead(in, end);
+
+	if (tlv.tag != tag || tlv.cls != cls || tlv.constructed != constructed){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "Unexpected ASN.1 tag %d (class %d)", tlv.tag, tlv.cls);
+	}
+
+	return tlv;
+}
+
+/*Bound of the contents. Indefinite length contents are bounded by the outer element*/
+static uint64_t tlvLimit(const CmsTlv &tlv, uint64_t end){
+	return tlv.indefinite ? end : tlv.value + tlv.length;
+}
+
+/*No more elements in the contents: limit reached or end-of-contents octets*/
+static bool tlvEnd(CmsStream &in, uint64_t end, bool indefinite){
+	if (!indefinite){
+		return in.pos >= end;
+	}
+
+	size_t avail;
+	const unsigned char *p = in.peek(in.pos, 2, avail);
+	if (avail < 2 || in.pos + 2 > end){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "Unexpected end of CMS");
+	}
+
+	return !p[0] && !p[1];
+}
+
+/*
+ * Moves the stream from the contents of tlv (at an element boundary) past the element.
+ * Definite lengths are jumped over, indefinite ones are walked to their end-of-contents
+ */
+static void tlvLeave(CmsStream &in, uint64_t end, const CmsTlv &tlv, int depth = 0){
+	if (!tlv.indefinite){
+		in.seek(tlv.value + tlv.length);
+		return;
+	}
+
+	if (depth > CMS_HEADER_MAX_DEPTH){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "Too deep nesting of indefinite lengths");
+	}
+
+	while (!tlvEnd(in, end, true)){
+		CmsTlv child = tlvRead(in, end);
+		tlvLeave(in, end, child, depth + 1);
+	}
+
+	in.seek(in.pos + 2);
+}
+
+/*Whole primitive element, from its identifier octets*/
+static const unsigned char *tlvBytes(CmsStream &in, const CmsTlv &tlv){
+	size_t avail;
+
+	if (tlv.length > CMS_HEADER_MAX_ELEMENT){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "Too long ASN.1 element %d (class %d)", tlv.tag, tlv.cls);
+	}
+
+	size_t n = (size_t)(tlv.value - tlv.start) + tlv.length;
+	const unsigned char *p = in.peek(tlv.start, n, avail);
+	if (avail < n){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "Unexpected end of CMS");
+	}
+
+	return p;
+}
+
+static Handle<OID> readObject(CmsStream &in, uint64_t end){
+	CmsTlv tlv = tlvExpect(in, end, V_ASN1_OBJECT, V_ASN1_UNIVERSAL, false);
+	const unsigned char *q = tlvBytes(in, tlv);
+	ASN1_OBJECT *obj;
+
+	LOGGER_OPENSSL(d2i_ASN1_OBJECT);
+	if (!(obj = d2i_ASN1_OBJECT(NULL, &q, (long)(tlv.value - tlv.start) + tlv.length))){
+		THROW_OPENSSL_EXCEPTION(0, CmsHeader, NULL, "d2i_ASN1_OBJECT");
+	}
+
+	in.seek(tlv.value + tlv.length);
+
+	return new OID(obj);
+}
+
+/*IssuerAndSerialNumber, the stream is at its contents*/
+static Handle<SignerId> readIssuerAndSerial(CmsStream &in, const CmsTlv &tlv, uint64_t end){
+	X509_NAME *name = NULL;
+	ASN1_INTEGER *sn = NULL;
+	BIO *bioSerial = NULL;
+
+	try{
+		Handle<SignerId> id = new SignerId();
+
+		uint64_t left = tlvLimit(tlv, end) - tlv.value;
+		if (!tlv.indefinite && left > CMS_HEADER_MAX_ELEMENT){
+			THROW_EXCEPTION(0, CmsHeader, NULL, "Too long IssuerAndSerialNumber");
+		}
+
+		size_t avail;
+		size_t n = left < CMS_HEADER_MAX_ELEMENT ? (size_t)left : CMS_HEADER_MAX_ELEMENT;
+		const unsigned char *q = in.peek(tlv.value, n, avail);
+		const unsigned char *limit = q + (avail < n ? avail : n);
+
+		LOGGER_OPENSSL(d2i_X509_NAME);
+		if (!(name = d2i_X509_NAME(NULL, &q, limit - q))){
+			THROW_OPENSSL_EXCEPTION(0, CmsHeader, NULL, "d2i_X509_NAME");
+		}
+
+		LOGGER_OPENSSL(d2i_ASN1_INTEGER);
+		if (!(sn = d2i_ASN1_INTEGER(NULL, &q, limit - q))){
+			THROW_OPENSSL_EXCEPTION(0, CmsHeader, NULL, "d2i_ASN1_INTEGER");
+		}
+
+		LOGGER_OPENSSL(BIO_new);
+		if (!(bioSerial = BIO_new(BIO_s_mem()))){
+			THROW_OPENSSL_EXCEPTION(0, CmsHeader, NULL, "BIO_new");
+		}
+
+		LOGGER_OPENSSL(i2a_ASN1_INTEGER);
+		if (i2a_ASN1_INTEGER(bioSerial, sn) < 0){
+			THROW_OPENSSL_EXCEPTION(0, CmsHeader, NULL, "i2a_ASN1_INTEGER");
+		}
+
+		char *cont;
+		LOGGER_OPENSSL(BIO_get_mem_data);
+		long contlen = BIO_get_mem_data(bioSerial, &cont);
+		id->setSerialNumber(new std::string(cont, contlen));
+
+		LOGGER_OPENSSL(X509_NAME_oneline_ex);
+		id->setIssuerName(new std::string(X509_NAME_oneline_ex(name)));
+
+		BIO_free(bioSerial);
+		ASN1_INTEGER_free(sn);
+		X509_NAME_free(name);
+
+		return id;
+	}
+	catch (Handle<Exception> e){
+		if (bioSerial){
+			BIO_free(bioSerial);
+		}
+		if (sn){
+			ASN1_INTEGER_free(sn);
+		}
+		if (name){
+			X509_NAME_free(name);
+		}
+
+		THROW_EXCEPTION(0, CmsHeader, e, "Error read IssuerAndSerialNumber");
+	}
+}
+
+/*SubjectKeyIdentifier as raw bytes, as Signer::getSignerId gives it*/
+static Handle<SignerId> readKeyId(CmsStream &in, const CmsTlv &tlv){
+	if (tlv.constructed){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "Constructed key identifier is not supported");
+	}
+
+	const unsigned char *p = tlvBytes(in, tlv) + (tlv.value - tlv.start);
+
+	Handle<SignerId> id = new SignerId();
+	id->setKeyId(new std::string((const char *)p, tlv.length));
+
+	return id;
+}
+
+/*SignerIdentifier and RecipientIdentifier: IssuerAndSerialNumber or [0] SubjectKeyIdentifier*/
+static Handle<SignerId> readIdentifier(CmsStream &in, const CmsTlv &tlv, uint64_t end){
+	if (tlv.cls == V_ASN1_UNIVERSAL && tlv.tag == V_ASN1_SEQUENCE){
+		return readIssuerAndSerial(in, tlv, end);
+	}
+
+	if (tlv.cls == V_ASN1_CONTEXT_SPECIFIC && tlv.tag == 0){
+		return readKeyId(in, tlv);
+	}
+
+	THROW_EXCEPTION(0, CmsHeader, NULL, "Unknown identifier tag %d (class %d)", tlv.tag, tlv.cls);
+}
+
+static void skipElement(CmsStream &in, uint64_t end){
+	CmsTlv tlv = tlvRead(in, end);
+	tlvLeave(in, end, tlv);
+}
+
+CmsHeader::CmsHeader() : detached(false){
+	LOGGER_FN();
+}
+
+void CmsHeader::read(Handle<Bio> in, DataFormat::DATA_FORMAT format){
+	LOGGER_FN();
+
+	try{
+		if (in.isEmpty()){
+			THROW_EXCEPTION(0, CmsHeader, NULL, "Parameter %d is NULL", 1);
+		}
+
+		switch (format){
+		case DataFormat::DER:{
+			/*Stops after the identifiers, the rest of the BIO is not read*/
+			CmsStream stream(in->internal());
+			readContentInfo(stream, (uint64_t)-1);
+			break;
+		}
+		case DataFormat::BASE64:{
+			unsigned char *data = NULL;
+			long len;
+
+			LOGGER_OPENSSL(PEM_bytes_read_bio);
+			if (!PEM_bytes_read_bio(&data, &len, NULL, PEM_STRING_CMS, in->internal(), NULL, NULL)){
+				THROW_OPENSSL_EXCEPTION(0, CmsHeader, NULL, "PEM_bytes_read_bio");
+			}
+
+			try{
+				read(data, len);
+			}
+			catch (Handle<Exception> e){
+				OPENSSL_free(data);
+				throw;
+			}
+
+			OPENSSL_free(data);
+			break;
+		}
+		default:
+			THROW_EXCEPTION(0, CmsHeader, NULL, ERROR_DATA_FORMAT_UNKNOWN_FORMAT, format);
+		}
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, CmsHeader, e, "Error read CMS header");
+	}
+}
+
+void CmsHeader::read(const unsigned char *data, size_t len){
+	LOGGER_FN();
+
+	try{
+		CmsStream stream(data, len);
+		readContentInfo(stream, len);
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, CmsHeader, e, "Error read CMS header");
+	}
+}
+
+void CmsHeader::readContentInfo(CmsStream &in, uint64_t end){
+	LOGGER_FN();
+
+	contentType = NULL;
+	encapsulatedType = NULL;
+	detached = false;
+	signers.clear();
+	recipients.clear();
+
+	CmsTlv ci = tlvExpect(in, end, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL, true);
+	uint64_t ciEnd = tlvLimit(ci, end);
+
+	contentType = readObject(in, ciEnd);
+
+	if (tlvEnd(in, ciEnd, ci.indefinite)){
+		return;
+	}
+
+	CmsTlv content = tlvExpect(in, ciEnd, 0, V_ASN1_CONTEXT_SPECIFIC, true);
+	uint64_t contentEnd = tlvLimit(content, ciEnd);
+
+	switch (contentType->toNid()){
+	case NID_pkcs7_signed:
+		readSignedData(in, contentEnd);
+		break;
+	case NID_pkcs7_enveloped:
+		readEnvelopedData(in, contentEnd);
+		break;
+	default:
+		break;
+	}
+}
+
+void CmsHeader::readSignedData(CmsStream &in, uint64_t end){
+	LOGGER_FN();
+
+	CmsTlv sd = tlvExpect(in, end, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL, true);
+	uint64_t sdEnd = tlvLimit(sd, end);
+
+	/*version, digestAlgorithms*/
+	skipElement(in, sdEnd);
+	skipElement(in, sdEnd);
+
+	CmsTlv encap = tlvExpect(in, sdEnd, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL, true);
+	uint64_t encapEnd = tlvLimit(encap, sdEnd);
+	encapsulatedType = readObject(in, encapEnd);
+	detached = tlvEnd(in, encapEnd, encap.indefinite);
+	tlvLeave(in, encapEnd, encap);
+
+	while (!tlvEnd(in, sdEnd, sd.indefinite)){
+		CmsTlv tlv = tlvRead(in, sdEnd);
+
+		/*[0] certificates, [1] crls*/
+		if (tlv.cls == V_ASN1_CONTEXT_SPECIFIC){
+			tlvLeave(in, sdEnd, tlv);
+			continue;
+		}
+
+		if (tlv.tag != V_ASN1_SET){
+			THROW_EXCEPTION(0, CmsHeader, NULL, "SignerInfos expected");
+		}
+
+		uint64_t setEnd = tlvLimit(tlv, sdEnd);
+		while (!tlvEnd(in, setEnd, tlv.indefinite)){
+			CmsTlv si = tlvExpect(in, setEnd, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL, true);
+			uint64_t siEnd = tlvLimit(si, setEnd);
+
+			/*version*/
+			skipElement(in, siEnd);
+
+			CmsTlv sid = tlvRead(in, siEnd);
+			signers.push_back(readIdentifier(in, sid, siEnd));
+			tlvLeave(in, siEnd, sid);
+
+			tlvLeave(in, siEnd, si);
+		}
+
+		/*signerInfos is the last field, nothing else is needed*/
+		return;
+	}
+
+	THROW_EXCEPTION(0, CmsHeader, NULL, "SignedData has no SignerInfos");
+}
+
+void CmsHeader::readEnvelopedData(CmsStream &in, uint64_t end){
+	LOGGER_FN();
+
+	CmsTlv ed = tlvExpect(in, end, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL, true);
+	uint64_t edEnd = tlvLimit(ed, end);
+
+	/*version*/
+	skipElement(in, edEnd);
+
+	CmsTlv set = tlvRead(in, edEnd);
+	/*[0] originatorInfo*/
+	if (set.cls == V_ASN1_CONTEXT_SPECIFIC && set.tag == 0){
+		tlvLeave(in, edEnd, set);
+		set = tlvRead(in, edEnd);
+	}
+
+	if (set.cls != V_ASN1_UNIVERSAL || set.tag != V_ASN1_SET){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "RecipientInfos expected");
+	}
+
+	uint64_t setEnd = tlvLimit(set, edEnd);
+	while (!tlvEnd(in, setEnd, set.indefinite)){
+		CmsTlv ri = tlvRead(in, setEnd);
+		uint64_t riEnd = tlvLimit(ri, setEnd);
+
+		if (ri.cls == V_ASN1_UNIVERSAL && ri.tag == V_ASN1_SEQUENCE){
+			/*KeyTransRecipientInfo: version, rid*/
+			skipElement(in, riEnd);
+
+			CmsTlv rid = tlvRead(in, riEnd);
+			recipients.push_back(readIdentifier(in, rid, riEnd));
+			tlvLeave(in, riEnd, rid);
+		}
+		else if (ri.cls == V_ASN1_CONTEXT_SPECIFIC && ri.tag == 1 && ri.constructed){
+			/*KeyAgreeRecipientInfo: version, [0] originator, [1] ukm OPTIONAL, keyEncryptionAlgorithm*/
+			skipElement(in, riEnd);
+			skipElement(in, riEnd);
+
+			CmsTlv tlv = tlvRead(in, riEnd);
+			if (tlv.cls == V_ASN1_CONTEXT_SPECIFIC && tlv.tag == 1){
+				tlvLeave(in, riEnd, tlv);
+				tlv = tlvRead(in, riEnd);
+			}
+			tlvLeave(in, riEnd, tlv);
+
+			CmsTlv keys = tlvExpect(in, riEnd, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL, true);
+			uint64_t keysEnd = tlvLimit(keys, riEnd);
+			while (!tlvEnd(in, keysEnd, keys.indefinite)){
+				CmsTlv rek = tlvExpect(in, keysEnd, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL, true);
+				uint64_t rekEnd = tlvLimit(rek, keysEnd);
+
+				CmsTlv rid = tlvRead(in, rekEnd);
+				if (rid.cls == V_ASN1_CONTEXT_SPECIFIC && rid.tag == 0){
+					/*RecipientKeyIdentifier: subjectKeyIdentifier, date, other*/
+					CmsTlv skid = tlvExpect(in, tlvLimit(rid, rekEnd), V_ASN1_OCTET_STRING, V_ASN1_UNIVERSAL, false);
+					recipients.push_back(readKeyId(in, skid));
+					in.seek(skid.value + skid.length);
+				}
+				else{
+					recipients.push_back(readIdentifier(in, rid, rekEnd));
+				}
+				tlvLeave(in, rekEnd, rid);
+
+				tlvLeave(in, rekEnd, rek);
+			}
+			tlvLeave(in, keysEnd, keys);
+		}
+		else if (ri.cls == V_ASN1_CONTEXT_SPECIFIC && ri.tag == 2 && ri.constructed){
+			/*KEKRecipientInfo: version, kekid (keyIdentifier, date, other)*/
+			skipElement(in, riEnd);
+
+			CmsTlv kekid = tlvExpect(in, riEnd, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL, true);
+			CmsTlv keyId = tlvExpect(in, tlvLimit(kekid, riEnd), V_ASN1_OCTET_STRING, V_ASN1_UNIVERSAL, false);
+			recipients.push_back(readKeyId(in, keyId));
+			in.seek(keyId.value + keyId.length);
+			tlvLeave(in, riEnd, kekid);
+		}
+
+		tlvLeave(in, riEnd, ri);
+	}
+	tlvLeave(in, setEnd, set);
+
+	/*EncryptedContentInfo: contentType, contentEncryptionAlgorithm, [0] encryptedContent OPTIONAL*/
+	CmsTlv eci = tlvExpect(in, edEnd, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL, true);
+	uint64_t eciEnd = tlvLimit(eci, edEnd);
+	encapsulatedType = readObject(in, eciEnd);
+	skipElement(in, eciEnd);
+	detached = tlvEnd(in, eciEnd, eci.indefinite);
+}
+
+Handle<OID> CmsHeader::getContentType(){
+	LOGGER_FN();
+
+	if (contentType.isEmpty()){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "CMS header is not read");
+	}
+
+	return contentType;
+}
+
+Handle<OID> CmsHeader::getEncapsulatedType(){
+	LOGGER_FN();
+
+	if (encapsulatedType.isEmpty()){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "CMS has no encapsulated content type");
+	}
+
+	return encapsulatedType;
+}
+
+bool CmsHeader::isDetached(){
+	LOGGER_FN();
+
+	return detached;
+}
+
+int CmsHeader::getSignersLength(){
+	LOGGER_FN();
+
+	return (int)signers.size();
+}
+
+Handle<SignerId> CmsHeader::getSigner(int index){
+	LOGGER_FN();
+
+	if (index < 0 || index >= (int)signers.size()){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "Signer index out of range");
+	}
+
+	return signers[index];
+}
+
+int CmsHeader::getRecipientsLength(){
+	LOGGER_FN();
+
+	return (int)recipients.size();
+}
+
+Handle<SignerId> CmsHeader::getRecipient(int index){
+	LOGGER_FN();
+
+	if (index < 0 || index >= (int)recipients.size()){
+		THROW_EXCEPTION(0, CmsHeader, NULL, "Recipient index out of range");
+	}
+
+	return recipients[index];
+}
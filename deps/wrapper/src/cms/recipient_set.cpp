@@ -0,0 +1,514 @@
+#include "../stdafx.h"
+
+#include "wrapper/cms/recipient_set.h"
+
+#include <openssl/pkcs7.h>
+#include <openssl/rand.h>
+
+/*End of contents of an indefinite length*/
+static const char berEoc[2] = { 0, 0 };
+
+static std::string berLength(size_t len){
+	std::string res;
+
+	if (len < 0x80){
+		res.push_back((char)len);
+		return res;
+	}
+
+	while (len){
+		res.insert(res.begin(), (char)(len & 0xFF));
+		len >>= 8;
+	}
+	res.insert(res.begin(), (char)(0x80 | res.length()));
+
+	return res;
+}
+
+static std::string berTlv(unsigned char tag, const std::string &value){
+	return std::string(1, (char)tag) + berLength(value.length()) + value;
+}
+
+/*Header of a constructed value of indefinite length*/
+static std::string berIndefinite(unsigned char tag){
+	std::string res(1, (char)tag);
+	res.push_back((char)0x80);
+	return res;
+}
+
+static std::string encodeObject(int nid){
+	LOGGER_OPENSSL(OBJ_nid2obj);
+	ASN1_OBJECT *obj = OBJ_nid2obj(nid);
+	int len;
+
+	LOGGER_OPENSSL(i2d_ASN1_OBJECT);
+	if (!obj || (len = i2d_ASN1_OBJECT(obj, NULL)) <= 0){
+		THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "Error encode object %d", nid);
+	}
+
+	std::string res(len, 0);
+	unsigned char *p = (unsigned char *)&res[0];
+	i2d_ASN1_OBJECT(obj, &p);
+
+	return res;
+}
+
+static std::string encodeAlgor(X509_ALGOR *alg){
+	int len;
+
+	LOGGER_OPENSSL(i2d_X509_ALGOR);
+	if ((len = i2d_X509_ALGOR(alg, NULL)) <= 0){
+		THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "Error encode algorithm identifier");
+	}
+
+	std::string res(len, 0);
+	unsigned char *p = (unsigned char *)&res[0];
+	i2d_X509_ALGOR(alg, &p);
+
+	return res;
+}
+
+static void setWrite(BIO *out, const char *data, size_t len){
+	if (len && BIO_write(out, data, (int)len) != (int)len){
+		THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "Error writing output bio");
+	}
+}
+
+static void setWrite(BIO *out, const std::string &data){
+	setWrite(out, data.data(), data.length());
+}
+
+static bool isGostKey(EVP_PKEY *pkey){
+	switch (EVP_PKEY_id(pkey)){
+	case NID_id_GostR3410_94:
+	case NID_id_GostR3410_2001:
+#ifndef OPENSSL_NO_CTGOSTCP
+	case NID_id_tc26_gost3410_12_256:
+	case NID_id_tc26_gost3410_12_512:
+#endif
+		return true;
+	}
+
+	return false;
+}
+
+CmsRecipientSet::CmsRecipientSet() : cipher(NULL), certs(NULL), prepared(true), gost(false){
+	LOGGER_FN();
+
+	LOGGER_OPENSSL(EVP_get_cipherbyname);
+	if ((cipher = EVP_get_cipherbyname(SN_des_ede3_cbc)) == NULL) {
+		THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "Error get cipher by name");
+	}
+
+	LOGGER_OPENSSL(sk_X509_new_null);
+	if ((certs = sk_X509_new_null()) == NULL){
+		THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "sk_X509_new_null");
+	}
+}
+
+CmsRecipientSet::~CmsRecipientSet(){
+	LOGGER_FN();
+
+	for (size_t i = 0; i < contexts.size(); i++){
+		LOGGER_OPENSSL(EVP_PKEY_CTX_free);
+		EVP_PKEY_CTX_free(contexts[i]);
+	}
+
+	LOGGER_OPENSSL(sk_X509_pop_free);
+	sk_X509_pop_free(certs, X509_free);
+}
+
+void CmsRecipientSet::push(Handle<Certificate> cert){
+	LOGGER_FN();
+
+	EVP_PKEY *pkey = NULL;
+	EVP_PKEY_CTX *ctx = NULL;
+	PKCS7_ISSUER_AND_SERIAL *ias = NULL;
+	X509_ALGOR *alg = NULL;
+
+	try{
+		if (cert.isEmpty()){
+			THROW_PARAMETER_NULL(CmsRecipientSet, NULL, 1);
+		}
+
+		X509 *x = cert->internal();
+
+		LOGGER_OPENSSL(X509_get_pubkey);
+		if ((pkey = X509_get_pubkey(x)) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "Error get pubkey");
+		}
+
+		if (!sk_X509_num(certs)){
+			gost = isGostKey(pkey);
+		}
+
+		if (prepared && EVP_PKEY_id(pkey) != EVP_PKEY_RSA){
+			/*Key agreement and GOST key transport are left to CMS_encrypt*/
+			for (size_t i = 0; i < contexts.size(); i++){
+				EVP_PKEY_CTX_free(contexts[i]);
+			}
+			contexts.clear();
+			prefixes.clear();
+			prepared = false;
+		}
+
+		if (prepared){
+			LOGGER_OPENSSL(EVP_PKEY_CTX_new);
+			if ((ctx = EVP_PKEY_CTX_new(pkey, NULL)) == NULL){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "EVP_PKEY_CTX_new");
+			}
+
+			LOGGER_OPENSSL(EVP_PKEY_encrypt_init);
+			if (EVP_PKEY_encrypt_init(ctx) <= 0){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "EVP_PKEY_encrypt_init");
+			}
+
+			/*rid: issuerAndSerialNumber, as CMS_add1_recipient_cert by default*/
+			LOGGER_OPENSSL(PKCS7_ISSUER_AND_SERIAL_new);
+			if ((ias = PKCS7_ISSUER_AND_SERIAL_new()) == NULL){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "PKCS7_ISSUER_AND_SERIAL_new");
+			}
+
+			LOGGER_OPENSSL(X509_NAME_set);
+			if (!X509_NAME_set(&ias->issuer, X509_get_issuer_name(x))){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "X509_NAME_set");
+			}
+
+			ASN1_INTEGER_free(ias->serial);
+			LOGGER_OPENSSL(ASN1_INTEGER_dup);
+			if ((ias->serial = ASN1_INTEGER_dup(X509_get_serialNumber(x))) == NULL){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "ASN1_INTEGER_dup");
+			}
+
+			int len;
+			LOGGER_OPENSSL(i2d_PKCS7_ISSUER_AND_SERIAL);
+			if ((len = i2d_PKCS7_ISSUER_AND_SERIAL(ias, NULL)) <= 0){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "i2d_PKCS7_ISSUER_AND_SERIAL");
+			}
+
+			std::string rid(len, 0);
+			unsigned char *p = (unsigned char *)&rid[0];
+			i2d_PKCS7_ISSUER_AND_SERIAL(ias, &p);
+
+			/*PKCS #1 v1.5 padding, parameters NULL*/
+			LOGGER_OPENSSL(X509_ALGOR_new);
+			if ((alg = X509_ALGOR_new()) == NULL
+				|| !X509_ALGOR_set0(alg, OBJ_nid2obj(NID_rsaEncryption), V_ASN1_NULL, NULL)){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "X509_ALGOR_set0");
+			}
+
+			/*version 0*/
+			prefixes.push_back(std::string("\x02\x01\x00", 3) + rid + encodeAlgor(alg));
+			contexts.push_back(ctx);
+			ctx = NULL;
+		}
+
+		LOGGER_OPENSSL(CRYPTO_add);
+		CRYPTO_add(&x->references, 1, CRYPTO_LOCK_X509);
+		LOGGER_OPENSSL(sk_X509_push);
+		sk_X509_push(certs, x);
+	}
+	catch (Handle<Exception> e){
+		EVP_PKEY_free(pkey);
+		EVP_PKEY_CTX_free(ctx);
+		PKCS7_ISSUER_AND_SERIAL_free(ias);
+		X509_ALGOR_free(alg);
+
+		THROW_EXCEPTION(0, CmsRecipientSet, e, "Error add recipient");
+	}
+
+	EVP_PKEY_free(pkey);
+	PKCS7_ISSUER_AND_SERIAL_free(ias);
+	X509_ALGOR_free(alg);
+}
+
+void CmsRecipientSet::push(Handle<CertificateCollection> certs){
+	LOGGER_FN();
+
+	try{
+		if (certs.isEmpty()){
+			THROW_PARAMETER_NULL(CmsRecipientSet, NULL, 1);
+		}
+
+		for (int i = 0, c = certs->length(); i < c; i++){
+			push(certs->items(i));
+		}
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, CmsRecipientSet, e, "Error add recipients");
+	}
+}
+
+int CmsRecipientSet::length(){
+	LOGGER_FN();
+
+	return sk_X509_num(certs);
+}
+
+void CmsRecipientSet::setAlgorithm(Handle<std::string> name){
+	LOGGER_FN();
+
+	try{
+		const EVP_CIPHER *value;
+
+		LOGGER_OPENSSL(EVP_get_cipherbyname);
+		if ((value = EVP_get_cipherbyname(name->c_str())) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "Unknown cipher '%s'", name->c_str());
+		}
+
+		if (EVP_CIPHER_flags(value) & EVP_CIPH_FLAG_AEAD_CIPHER){
+			THROW_EXCEPTION(0, CmsRecipientSet, NULL, "AEAD cipher is not supported for CMS, use CBC mode");
+		}
+
+		switch (EVP_CIPHER_mode(value)){
+		case EVP_CIPH_CCM_MODE:
+		case EVP_CIPH_XTS_MODE:
+		case EVP_CIPH_WRAP_MODE:
+			THROW_EXCEPTION(0, CmsRecipientSet, NULL, "Cipher mode is not supported '%s'", name->c_str());
+		}
+
+		cipher = value;
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, CmsRecipientSet, e, "Error set algorithm");
+	}
+}
+
+void CmsRecipientSet::encrypt(Handle<Bio> in, Handle<Bio> out, DataFormat::DATA_FORMAT format){
+	LOGGER_FN();
+
+	try{
+		if (!sk_X509_num(certs)){
+			THROW_EXCEPTION(0, CmsRecipientSet, NULL, "Recipients certs undefined");
+		}
+
+		if (!prepared){
+			encryptCms(in->internal(), out->internal(), format);
+			return;
+		}
+
+		switch (format){
+		case DataFormat::DER:
+			encryptPrepared(in->internal(), out->internal());
+			break;
+		case DataFormat::BASE64: {
+			setWrite(out->internal(), std::string("-----BEGIN CMS-----\n"));
+
+			LOGGER_OPENSSL(BIO_new);
+			BIO *b64 = BIO_new(BIO_f_base64());
+			if (!b64){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "BIO_new");
+			}
+			LOGGER_OPENSSL(BIO_push);
+			BIO_push(b64, out->internal());
+
+			try{
+				encryptPrepared(in->internal(), b64);
+
+				LOGGER_OPENSSL(BIO_flush);
+				if (BIO_flush(b64) != 1){
+					THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "BIO_flush");
+				}
+			}
+			catch (Handle<Exception> e){
+				BIO_pop(b64);
+				BIO_free(b64);
+				throw;
+			}
+
+			BIO_pop(b64);
+			BIO_free(b64);
+
+			setWrite(out->internal(), std::string("-----END CMS-----\n"));
+			break;
+		}
+		default:
+			THROW_EXCEPTION(0, CmsRecipientSet, NULL, ERROR_DATA_FORMAT_UNKNOWN_FORMAT, format);
+		}
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, CmsRecipientSet, e, "Error encrypt");
+	}
+}
+
+/*
+ * ContentInfo { envelopedData, [0] EnvelopedData {
+ *   version 0, RecipientInfos, EncryptedContentInfo { data, algorithm, [0] OCTET STRING parts } } }
+ */
+void CmsRecipientSet::encryptPrepared(BIO *in, BIO *out){
+	LOGGER_FN();
+
+	EVP_CIPHER_CTX *ctx = NULL;
+	X509_ALGOR *alg = NULL;
+	unsigned char key[EVP_MAX_KEY_LENGTH];
+	unsigned char iv[EVP_MAX_IV_LENGTH];
+	std::vector<unsigned char> ek;
+	std::vector<unsigned char> buff(CMS_RECIPIENT_SET_BUFFER_SIZE);
+	std::vector<unsigned char> enc(CMS_RECIPIENT_SET_BUFFER_SIZE + EVP_MAX_BLOCK_LENGTH);
+
+	try{
+		int keylen = EVP_CIPHER_key_length(cipher);
+		int ivlen = EVP_CIPHER_iv_length(cipher);
+
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_new);
+		if ((ctx = EVP_CIPHER_CTX_new()) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "EVP_CIPHER_CTX_new");
+		}
+
+		LOGGER_OPENSSL(EVP_EncryptInit_ex);
+		if (!EVP_EncryptInit_ex(ctx, cipher, NULL, NULL, NULL)){
+			THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "EVP_EncryptInit_ex");
+		}
+
+		/*Content key with DES parity where needed, as CMS does*/
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_rand_key);
+		if (EVP_CIPHER_CTX_rand_key(ctx, key) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "EVP_CIPHER_CTX_rand_key");
+		}
+
+		LOGGER_OPENSSL(RAND_bytes);
+		if (ivlen > 0 && RAND_bytes(iv, ivlen) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "RAND_bytes");
+		}
+
+		LOGGER_OPENSSL(EVP_EncryptInit_ex);
+		if (!EVP_EncryptInit_ex(ctx, NULL, NULL, key, ivlen > 0 ? iv : NULL)){
+			THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "EVP_EncryptInit_ex");
+		}
+
+		/*contentEncryptionAlgorithm*/
+		LOGGER_OPENSSL(X509_ALGOR_new);
+		if ((alg = X509_ALGOR_new()) == NULL || (alg->parameter = ASN1_TYPE_new()) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "X509_ALGOR_new");
+		}
+		ASN1_OBJECT_free(alg->algorithm);
+		alg->algorithm = OBJ_nid2obj(EVP_CIPHER_type(cipher));
+
+		LOGGER_OPENSSL(EVP_CIPHER_param_to_asn1);
+		if (EVP_CIPHER_param_to_asn1(ctx, alg->parameter) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "EVP_CIPHER_param_to_asn1");
+		}
+
+		/*Only the content key wrap per recipient*/
+		std::string ris;
+		for (size_t i = 0; i < contexts.size(); i++){
+			size_t eklen = 0;
+
+			LOGGER_OPENSSL(EVP_PKEY_encrypt);
+			if (EVP_PKEY_encrypt(contexts[i], NULL, &eklen, key, keylen) <= 0){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "EVP_PKEY_encrypt");
+			}
+			ek.resize(eklen);
+
+			LOGGER_OPENSSL(EVP_PKEY_encrypt);
+			if (EVP_PKEY_encrypt(contexts[i], &ek[0], &eklen, key, keylen) <= 0){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "EVP_PKEY_encrypt");
+			}
+
+			ris += berTlv(V_ASN1_SEQUENCE | V_ASN1_CONSTRUCTED,
+				prefixes[i] + berTlv(V_ASN1_OCTET_STRING, std::string((char *)&ek[0], eklen)));
+		}
+
+		OPENSSL_cleanse(key, sizeof key);
+
+		setWrite(out, berIndefinite(V_ASN1_SEQUENCE | V_ASN1_CONSTRUCTED)
+			+ encodeObject(NID_pkcs7_enveloped)
+			+ berIndefinite(V_ASN1_CONTEXT_SPECIFIC | V_ASN1_CONSTRUCTED)
+			+ berIndefinite(V_ASN1_SEQUENCE | V_ASN1_CONSTRUCTED)
+			+ std::string("\x02\x01\x00", 3)
+			+ berTlv(V_ASN1_SET | V_ASN1_CONSTRUCTED, ris)
+			+ berIndefinite(V_ASN1_SEQUENCE | V_ASN1_CONSTRUCTED)
+			+ encodeObject(NID_pkcs7_data)
+			+ encodeAlgor(alg)
+			+ berIndefinite(V_ASN1_CONTEXT_SPECIFIC | V_ASN1_CONSTRUCTED));
+
+		for (;;){
+			int inl, outl;
+
+			LOGGER_OPENSSL(BIO_read);
+			if ((inl = BIO_read(in, (char *)&buff[0], (int)buff.size())) <= 0){
+				break;
+			}
+
+			LOGGER_OPENSSL(EVP_EncryptUpdate);
+			if (!EVP_EncryptUpdate(ctx, &enc[0], &outl, &buff[0], inl)){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "EVP_EncryptUpdate");
+			}
+
+			if (outl > 0){
+				setWrite(out, berTlv(V_ASN1_OCTET_STRING, std::string((char *)&enc[0], outl)));
+			}
+		}
+
+		int outl;
+		LOGGER_OPENSSL(EVP_EncryptFinal_ex);
+		if (!EVP_EncryptFinal_ex(ctx, &enc[0], &outl)){
+			THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "EVP_EncryptFinal_ex");
+		}
+		if (outl > 0){
+			setWrite(out, berTlv(V_ASN1_OCTET_STRING, std::string((char *)&enc[0], outl)));
+		}
+
+		/*encryptedContent, EncryptedContentInfo, EnvelopedData, [0], ContentInfo*/
+		for (int i = 0; i < 5; i++){
+			setWrite(out, berEoc, sizeof berEoc);
+		}
+	}
+	catch (Handle<Exception> e){
+		OPENSSL_cleanse(key, sizeof key);
+		EVP_CIPHER_CTX_free(ctx);
+		X509_ALGOR_free(alg);
+
+		THROW_EXCEPTION(0, CmsRecipientSet, e, "Error encrypt with prepared recipients");
+	}
+
+	EVP_CIPHER_CTX_free(ctx);
+	X509_ALGOR_free(alg);
+}
+
+void CmsRecipientSet::encryptCms(BIO *in, BIO *out, DataFormat::DATA_FORMAT format){
+	LOGGER_FN();
+
+	CMS_ContentInfo *cms = NULL;
+
+	try{
+		const EVP_CIPHER *value = cipher;
+		unsigned int flags = CMS_STREAM | CMS_BINARY;
+
+		if (gost){
+			LOGGER_OPENSSL(EVP_get_cipherbyname);
+			if ((value = EVP_get_cipherbyname(SN_id_Gost28147_89)) == NULL){
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "Error get cipher by name");
+			}
+		}
+
+		LOGGER_OPENSSL(CMS_encrypt);
+		if ((cms = CMS_encrypt(certs, in, value, flags)) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "Error create encrypted CMS_ContentInfo");
+		}
+
+		switch (format){
+		case DataFormat::DER:
+			LOGGER_OPENSSL(i2d_CMS_bio_stream);
+			if (!i2d_CMS_bio_stream(out, cms, in, flags)) {
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "i2d_CMS_bio_stream");
+			}
+			break;
+		case DataFormat::BASE64:
+			LOGGER_OPENSSL(PEM_write_bio_CMS_stream);
+			if (!PEM_write_bio_CMS_stream(out, cms, in, flags)) {
+				THROW_OPENSSL_EXCEPTION(0, CmsRecipientSet, NULL, "PEM_write_bio_CMS_stream");
+			}
+			break;
+		default:
+			THROW_EXCEPTION(0, CmsRecipientSet, NULL, ERROR_DATA_FORMAT_UNKNOWN_FORMAT, format);
+		}
+	}
+	catch (Handle<Exception> e){
+		CMS_ContentInfo_free(cms);
+
+		THROW_EXCEPTION(0, CmsRecipientSet, e, "Error encrypt with CMS_encrypt");
+	}
+
+	CMS_ContentInfo_free(cms);
+}
@@ -214,31 +214,106 @@ Handle<Bio> SignedData::getContent(){
 
 bool SignedData::verify(Handle<CertificateCollection> certs){
 	LOGGER_FN();
-	int res;
 
 	try {
-		stack_st_X509 *pCerts = NULL;
-		if (!certs.isEmpty()){
-			pCerts = certs->internal();
-		}
-
-		//    
-		content->reset();
+		VerifyResult res;
 
-		X509_STORE *store = X509_STORE_new();
+		this->checkSignature(certs, res);
 
-		LOGGER_OPENSSL("CMS_verify");
-		res = CMS_verify(this->internal(), pCerts, store, content->internal(), NULL, flags);
-		LOGGER_OPENSSL("X509_STORE_free");
-		X509_STORE_free(store);
-		
-		return res == 1;
+		return res.status == VerifyStatus::Valid;
 	}
 	catch (Handle<Exception> e){
 		THROW_EXCEPTION(0, SignedData, e, "Error CMS verify");
 	}
 }
 
+VerifyResult SignedData::verifyResult(Handle<CertificateCollection> certs){
+	LOGGER_FN();
+
+	VerifyResult res;
+
+	try {
+		this->checkSignature(certs, res);
+	}
+	catch (Handle<Exception> e){
+		res.status = VerifyStatus::Error;
+		res.code = e->code();
+		res.message = e->what();
+	}
+	catch (std::exception &e){
+		res.status = VerifyStatus::Error;
+		res.message = e.what();
+	}
+
+	return res;
+}
+
+void SignedData::checkSignature(Handle<CertificateCollection> certs, VerifyResult &result){
+	LOGGER_FN();
+
+	stack_st_X509 *pCerts = NULL;
+	if (!certs.isEmpty()){
+		pCerts = certs->internal();
+	}
+
+	//    
+	content->reset();
+
+	X509_STORE *store = X509_STORE_new();
+
+	LOGGER_OPENSSL("CMS_verify");
+	int res = CMS_verify(this->internal(), pCerts, store, content->internal(), NULL, flags);
+	LOGGER_OPENSSL("X509_STORE_free");
+	X509_STORE_free(store);
+
+	if (res != 1){
+		/* Rejected signature is a result, not an error */
+		result.status = VerifyStatus::Invalid;
+		result.code = ERR_peek_error();
+		result.index = this->findInvalidSigner(result.code);
+
+		if (result.code){
+			char buf[256];
+
+			ERR_error_string_n(result.code, buf, sizeof(buf));
+			result.message = buf;
+		}
+
+		LOGGER_OPENSSL("ERR_clear_error");
+		ERR_clear_error();
+	}
+}
+
+int SignedData::findInvalidSigner(unsigned long err){
+	LOGGER_FN();
+
+	LOGGER_OPENSSL("CMS_get0_SignerInfos");
+	STACK_OF(CMS_SignerInfo) *sinfos = CMS_get0_SignerInfos(this->raw());
+	int count = sk_CMS_SignerInfo_num(sinfos);
+
+	/* Signature over signed attributes can be checked per signer */
+	for (int i = 0; i < count; i++){
+		CMS_SignerInfo *si = sk_CMS_SignerInfo_value(sinfos, i);
+
+		if (CMS_signed_get_attr_count(si) >= 0 && CMS_SignerInfo_verify(si) == 0){
+			return i;
+		}
+	}
+
+	/* Other per signer failures can only be attributed with one signer */
+	if (count == 1 && ERR_GET_LIB(err) == ERR_LIB_CMS){
+		switch (ERR_GET_REASON(err)){
+		case CMS_R_CERTIFICATE_VERIFY_ERROR:
+		case CMS_R_SIGNER_CERTIFICATE_NOT_FOUND:
+		case CMS_R_VERIFICATION_FAILURE:
+		case CMS_R_CONTENT_VERIFY_ERROR:
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
 Handle<SignedData> SignedData::sign(Handle<Certificate> cert, Handle<Key> pkey, Handle<CertificateCollection> certs, Handle<Bio> content, unsigned int flags){
 	LOGGER_FN();
 
@@ -130,6 +130,10 @@ bool Signer::verify(){
 		if (res == -1){
 			THROW_OPENSSL_EXCEPTION(0, Signer, NULL, "CMS_SignerInfo_verify");
 		}
+		if (res != 1){
+			LOGGER_OPENSSL("ERR_clear_error");
+			ERR_clear_error();
+		}
 
 		return res == 1;
 	}
@@ -225,9 +229,13 @@ bool Signer::verify(Handle<Bio> content){
 			}	
 		}
 
-		if (pctx) {
-			LOGGER_OPENSSL("EVP_PKEY_CTX_free");
-			EVP_PKEY_CTX_free(pctx);
+		/* pctx is owned by mctx */
+		LOGGER_OPENSSL("EVP_MD_CTX_destroy");
+		EVP_MD_CTX_destroy(mctx);
+
+		if (res != 1){
+			LOGGER_OPENSSL("ERR_clear_error");
+			ERR_clear_error();
 		}
 
 		return res == 1;
@@ -2,6 +2,8 @@
 
 #include <stdarg.h>
 
+#include <openssl/err.h>
+
 #include "wrapper/common/excep.h"
 
 //Exception::Exception(int code, std::string msg, std::string className, std::string methodName, Exception* exception, ...) {
@@ -21,53 +23,99 @@ Exception::Exception(
 		...)
 //: std::runtime_error("") {
 {
-	this->except_ = NULL;
+	this->described_ = false;
 	this->file_ = file;
 	this->line_ = line;
 	this->code_ = errorNum;
 	this->class_ = className;
 	this->method_ = methodName;
+	this->thread_ = 0;
+	this->fromOpenSSL_ = fromOpenSSL;
 	this->except_ = stack;
 
-	va_list args;
-	char msg[256] = {0};
+	/*Arguments may be paths or names from JS of any length: measure, then format*/
+	va_list args, copy;
+	char msg[256];
 
 	va_start(args, message);
-#ifdef _WIN32
-	vsprintf_s(msg, message, args);
-#else
-	vsprintf(msg, message, args);
-#endif
+	va_copy(copy, args);
+	int length = vsnprintf(msg, sizeof(msg), message, args);
+	if (length >= (int)sizeof(msg)) {
+		this->message_.resize(length + 1);
+		vsnprintf(&this->message_[0], length + 1, message, copy);
+		this->message_.resize(length);
+	}
+	else if (length > 0) {
+		this->message_ = msg;
+	}
+	va_end(copy);
 	va_end(args);
 
-	this->fillDescription(msg, fromOpenSSL);
+	if (fromOpenSSL) {
+		unsigned long err;
+		const char *errFile;
+		const char *data;
+		int errLine;
+		int flags;
+
+		this->thread_ = CRYPTO_thread_id();
+		while ((err = ERR_get_error_line_data(&errFile, &errLine, &data, &flags)) != 0) {
+			ExceptionError item;
+			item.code = err;
+			item.file = errFile;
+			item.line = errLine;
+			if (data && (flags & ERR_TXT_STRING)) {
+				item.data = data;
+			}
+			this->errors_.push_back(item);
+		}
+	}
 }
 
 const std::string Exception::description() {
+	this->fillDescription();
+
 	return this->description_;
 }
 
 const char *Exception::what() const throw () {
+	this->fillDescription();
+
 	return this->description_.c_str();
 }
 
-void Exception::fillDescription(
-		const std::string& message,
-		bool fromOpenSSL)
+void Exception::fillDescription() const
 {
+	if (this->described_) {
+		return;
+	}
+	this->described_ = true;
+
 	char desc[512] = {0};
 #ifdef _WIN32
-	sprintf_s(desc, "\n%s:%d\n", this->file_.c_str(), this->line_);
+	sprintf_s(desc, "\n%s:%d\n", this->file_, this->line_);
 #else
-	sprintf(desc, "\n%s:%d\n", this->file_.c_str(), this->line_);
+	sprintf(desc, "\n%s:%d\n", this->file_, this->line_);
 #endif
-	this->description_ = this->method_ + " " + message + desc;
+	this->description_ = std::string(this->method_) + " " + this->message_ + desc;
 
-	if (fromOpenSSL) {
-		this->description_ += "\n" + *OpenSSL::printErrors();
+	if (this->fromOpenSSL_) {
+		/* Same format as ERR_print_errors */
+		char buf[256];
+		char line[512];
+
+		this->description_ += "\n";
+		for (size_t i = 0; i < this->errors_.size(); i++) {
+			const ExceptionError &item = this->errors_[i];
+
+			ERR_error_string_n(item.code, buf, sizeof(buf));
+			BIO_snprintf(line, sizeof(line), "%lu:%s:%s:%d:%s\n", this->thread_, buf, item.file, item.line, item.data.c_str());
+			this->description_ += line;
+		}
 	}
 
 	if (!this->except_.isEmpty()) {
+		this->except_->fillDescription();
 		this->description_ += this->except_->description_;
 	}
 }
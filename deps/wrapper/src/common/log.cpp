@@ -149,11 +149,11 @@ void Logger::info(const char* fn, const char *msg, ...){
 }
 
 LoggerFunction::LoggerFunction(Logger *logger, const char*fn){
-	this->_fn = new std::string(fn);
+	this->_fn = fn;
 	this->_logger = logger;
-	this->_logger->write(LoggerLevel::Trace, this->_fn->c_str(), "Begin");
+	this->_logger->write(LoggerLevel::Trace, this->_fn, "Begin");
 }
 
 LoggerFunction::~LoggerFunction(){
-	this->_logger->write(LoggerLevel::Trace, this->_fn->c_str(), "End");
+	this->_logger->write(LoggerLevel::Trace, this->_fn, "End");
 }
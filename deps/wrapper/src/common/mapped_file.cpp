@@ -0,0 +1,115 @@
+#include "../stdafx.h"
+
+#include "wrapper/common/mapped_file.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::MappedFile(const std::string &filename)
+	: data_(NULL), size_(0)
+{
+	LOGGER_FN();
+
+#ifdef _WIN32
+	this->mapping_ = NULL;
+	this->file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (this->file_ == INVALID_HANDLE_VALUE) {
+		THROW_EXCEPTION(0, MappedFile, NULL, "Can not open file '%s'", filename.c_str());
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(this->file_, &fileSize)) {
+		this->close();
+		THROW_EXCEPTION(0, MappedFile, NULL, "Can not get size of file '%s'", filename.c_str());
+	}
+	this->size_ = (size_t)fileSize.QuadPart;
+
+	if (this->size_ == 0) {
+		return;
+	}
+
+	this->mapping_ = CreateFileMapping(this->file_, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!this->mapping_) {
+		this->close();
+		THROW_EXCEPTION(0, MappedFile, NULL, "CreateFileMapping");
+	}
+
+	this->data_ = (unsigned char *)MapViewOfFile(this->mapping_, FILE_MAP_READ, 0, 0, 0);
+	if (!this->data_) {
+		this->close();
+		THROW_EXCEPTION(0, MappedFile, NULL, "MapViewOfFile");
+	}
+#else
+	this->fd_ = open(filename.c_str(), O_RDONLY);
+	if (this->fd_ < 0) {
+		THROW_EXCEPTION(0, MappedFile, NULL, "Can not open file '%s'", filename.c_str());
+	}
+
+	struct stat st;
+	if (fstat(this->fd_, &st) != 0) {
+		this->close();
+		THROW_EXCEPTION(0, MappedFile, NULL, "Can not get size of file '%s'", filename.c_str());
+	}
+	this->size_ = (size_t)st.st_size;
+
+	if (this->size_ == 0) {
+		return;
+	}
+
+	void *addr = mmap(NULL, this->size_, PROT_READ, MAP_PRIVATE, this->fd_, 0);
+	if (addr == MAP_FAILED) {
+		this->close();
+		THROW_EXCEPTION(0, MappedFile, NULL, "mmap");
+	}
+	this->data_ = (unsigned char *)addr;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	LOGGER_FN();
+
+	this->close();
+}
+
+void MappedFile::close()
+{
+	LOGGER_FN();
+
+#ifdef _WIN32
+	if (this->data_) {
+		UnmapViewOfFile(this->data_);
+	}
+	if (this->mapping_) {
+		CloseHandle(this->mapping_);
+		this->mapping_ = NULL;
+	}
+	if (this->file_ != INVALID_HANDLE_VALUE) {
+		CloseHandle(this->file_);
+		this->file_ = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (this->data_) {
+		munmap(this->data_, this->size_);
+	}
+	if (this->fd_ >= 0) {
+		::close(this->fd_);
+		this->fd_ = -1;
+	}
+#endif
+	this->data_ = NULL;
+}
+
+const unsigned char *MappedFile::data()
+{
+	return this->data_;
+}
+
+size_t MappedFile::size()
+{
+	return this->size_;
+}
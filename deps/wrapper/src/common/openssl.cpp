@@ -3,9 +3,29 @@
 #include "wrapper/common/openssl.h"
 #include "wrapper/common/common.h"
 
+#include <mutex>
+
+static std::mutex *openssl_locks = NULL;
+
+static void openssl_locking(int mode, int n, const char *file, int line) {
+	if (mode & CRYPTO_LOCK) {
+		openssl_locks[n].lock();
+	}
+	else {
+		openssl_locks[n].unlock();
+	}
+}
+
 void OpenSSL::run() {
 	LOGGER_FN();
 
+	//Objects can be decoded on several threads (see Bundle).
+	//Keep callbacks of the host application (e.g. Node) if it has set them
+	if (!CRYPTO_get_locking_callback()) {
+		openssl_locks = new std::mutex[CRYPTO_num_locks()];
+		CRYPTO_set_locking_callback(openssl_locking);
+	}
+
 	CRYPTO_malloc_debug_init();
 	CRYPTO_set_mem_debug_options(V_CRYPTO_MDEBUG_ALL);
 	
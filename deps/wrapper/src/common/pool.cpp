@@ -0,0 +1,133 @@
+#include "../stdafx.h"
+
+#include <stdlib.h>
+#include <atomic>
+#include <mutex>
+
+#include "wrapper/common/pool.h"
+
+#define POOL_CLASSES (POOL_MAX_BLOCK / POOL_GRANULARITY)
+
+struct PoolBlock {
+	PoolBlock *next;
+};
+
+static thread_local PoolBlock *poolFree[POOL_CLASSES];
+/* Last block of each non-empty poolFree list, set when the list is refilled from empty */
+static thread_local PoolBlock *poolTail[POOL_CLASSES];
+static std::atomic<size_t> poolSlabs(0);
+
+/* Blocks of exited threads, taken whole by a thread whose own list is empty */
+static std::mutex poolSharedMutex;
+static PoolBlock *poolShared[POOL_CLASSES];
+static PoolBlock *poolSharedTail[POOL_CLASSES];
+
+/*
+ * Hands the free lists of an exiting thread to poolShared.
+ * Touched only on the slow paths, so the fast paths keep plain TLS access
+ */
+class PoolThreadExit {
+public:
+	void touch() {
+	}
+
+	~PoolThreadExit() {
+		std::lock_guard<std::mutex> lock(poolSharedMutex);
+
+		for (size_t i = 0; i < POOL_CLASSES; i++) {
+			if (!poolFree[i]) {
+				continue;
+			}
+
+			if (!poolShared[i]) {
+				poolSharedTail[i] = poolTail[i];
+			}
+			poolTail[i]->next = poolShared[i];
+			poolShared[i] = poolFree[i];
+
+			poolFree[i] = NULL;
+		}
+	}
+};
+
+static thread_local PoolThreadExit poolThreadExit;
+
+static PoolBlock *poolTakeShared(size_t index, PoolBlock **tail) {
+	std::lock_guard<std::mutex> lock(poolSharedMutex);
+
+	PoolBlock *res = poolShared[index];
+	*tail = poolSharedTail[index];
+	poolShared[index] = NULL;
+
+	return res;
+}
+
+static PoolBlock *poolGrow(size_t index, PoolBlock **tail) {
+	size_t blockSize = (index + 1) * POOL_GRANULARITY;
+	size_t count = POOL_SLAB_SIZE / blockSize;
+
+	char *slab = (char *)malloc(POOL_SLAB_SIZE);
+	if (!slab) {
+		throw std::bad_alloc();
+	}
+	poolSlabs++;
+
+	PoolBlock *head = NULL;
+	for (size_t i = count; i > 0; i--) {
+		PoolBlock *block = (PoolBlock *)(slab + (i - 1) * blockSize);
+		block->next = head;
+		head = block;
+	}
+	*tail = (PoolBlock *)(slab + (count - 1) * blockSize);
+
+	return head;
+}
+
+void *Pool::allocate(size_t size) {
+	if (size == 0) {
+		size = 1;
+	}
+	if (size > POOL_MAX_BLOCK) {
+		return ::operator new(size);
+	}
+
+	size_t index = (size - 1) / POOL_GRANULARITY;
+	PoolBlock *block = poolFree[index];
+	if (!block) {
+		poolThreadExit.touch();
+		block = poolTakeShared(index, &poolTail[index]);
+		if (!block) {
+			block = poolGrow(index, &poolTail[index]);
+		}
+	}
+	poolFree[index] = block->next;
+
+	return block;
+}
+
+void Pool::deallocate(void *ptr, size_t size) {
+	if (!ptr) {
+		return;
+	}
+	if (size == 0) {
+		size = 1;
+	}
+	if (size > POOL_MAX_BLOCK) {
+		::operator delete(ptr);
+		return;
+	}
+
+	size_t index = (size - 1) / POOL_GRANULARITY;
+	PoolBlock *block = (PoolBlock *)ptr;
+	block->next = poolFree[index];
+	if (!block->next) {
+		/* A thread may only release blocks allocated elsewhere */
+		poolThreadExit.touch();
+		poolTail[index] = block;
+	}
+	poolFree[index] = block;
+}
+
+size_t Pool::slabs() {
+	return poolSlabs;
+}
@@ -0,0 +1,304 @@
+#include "../stdafx.h"
+
+#include <thread>
+#include <algorithm>
+
+#include "wrapper/pki/bundle.h"
+
+#define PEM_BEGIN "-----BEGIN "
+#define PEM_END "-----END "
+#define PEM_DASHES "-----"
+
+static const char * const certLabels[] = { "CERTIFICATE", "X509 CERTIFICATE", "TRUSTED CERTIFICATE", NULL };
+static const char * const crlLabels[] = { "X509 CRL", NULL };
+
+static const unsigned char *findText(const unsigned char *from, const unsigned char *to, const char *text) {
+	size_t len = strlen(text);
+	const unsigned char *res = std::search(from, to, (const unsigned char *)text, (const unsigned char *)text + len);
+
+	return res == to ? NULL : res;
+}
+
+/* Throws with the OpenSSL error queue of the calling thread */
+static X509 *decodeCertificate(const BundleItem &item) {
+	X509 *res = NULL;
+
+	if (item.pem) {
+		BIO *in = BIO_new_mem_buf((void *)item.data, (int)item.length);
+		if (in) {
+			res = PEM_read_bio_X509_AUX(in, NULL, NULL, NULL);
+			BIO_free(in);
+		}
+	}
+	else {
+		const unsigned char *p = item.data;
+		res = d2i_X509(NULL, &p, (long)item.length);
+	}
+
+	if (!res) {
+		THROW_OPENSSL_EXCEPTION(0, Bundle, NULL, "Can not decode certificate");
+	}
+
+	return res;
+}
+
+static X509_CRL *decodeCrl(const BundleItem &item) {
+	X509_CRL *res = NULL;
+
+	if (item.pem) {
+		BIO *in = BIO_new_mem_buf((void *)item.data, (int)item.length);
+		if (in) {
+			res = PEM_read_bio_X509_CRL(in, NULL, NULL, NULL);
+			BIO_free(in);
+		}
+	}
+	else {
+		const unsigned char *p = item.data;
+		res = d2i_X509_CRL(NULL, &p, (long)item.length);
+	}
+
+	if (!res) {
+		THROW_OPENSSL_EXCEPTION(0, Bundle, NULL, "Can not decode CRL");
+	}
+
+	return res;
+}
+
+/*
+ * Decodes items from first with step on the calling thread.
+ * Each error slot is written by one thread and read after join
+ */
+template <typename T>
+static void decodeRange(const std::vector<BundleItem> &items, std::vector<T *> &res, std::vector<Handle<Exception> > &errors,
+	T *(*decode)(const BundleItem &), size_t first, size_t step) {
+	for (size_t i = first; i < items.size(); i += step) {
+		try {
+			res[i] = decode(items[i]);
+		}
+		catch (Handle<Exception> e) {
+			errors[i] = e;
+		}
+		catch (std::exception &e) {
+			errors[i] = new Exception(false, __FILE__, __LINE__, 0, "Bundle", __FUNCTION__, NULL, "%s", e.what());
+		}
+	}
+}
+
+/*
+ * Decodes items on several threads. Returns index of the first item
+ * which can not be decoded or -1, error is its exception
+ */
+template <typename T>
+static int decodeItems(const std::vector<BundleItem> &items, std::vector<T *> &res, T *(*decode)(const BundleItem &), Handle<Exception> &error) {
+	std::vector<Handle<Exception> > errors(items.size());
+	res.assign(items.size(), NULL);
+
+	size_t threads = std::thread::hardware_concurrency();
+	threads = std::min(threads, items.size() / BUNDLE_ITEMS_PER_THREAD);
+
+	if (threads < 2) {
+		decodeRange(items, res, errors, decode, 0, 1);
+	}
+	else {
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < threads; t++) {
+			workers.push_back(std::thread([&items, &res, &errors, decode, threads, t]() {
+				decodeRange(items, res, errors, decode, t, threads);
+				ERR_remove_thread_state(NULL);
+			}));
+		}
+		for (size_t t = 0; t < threads; t++) {
+			workers[t].join();
+		}
+	}
+
+	for (size_t i = 0; i < res.size(); i++) {
+		if (!res[i]) {
+			error = errors[i];
+			return (int)i;
+		}
+	}
+
+	return -1;
+}
+
+std::vector<BundleItem> Bundle::split(const unsigned char *data, size_t length, const char * const *labels) {
+	LOGGER_FN();
+
+	if (length && findText(data, data + length, PEM_BEGIN)) {
+		return splitPem(data, length, labels);
+	}
+
+	return splitDer(data, length);
+}
+
+std::vector<BundleItem> Bundle::splitPem(const unsigned char *data, size_t length, const char * const *labels) {
+	LOGGER_FN();
+
+	std::vector<BundleItem> res;
+	const unsigned char *end = data + length;
+	const unsigned char *p = data;
+
+	while ((p = findText(p, end, PEM_BEGIN)) != NULL) {
+		const unsigned char *label = p + strlen(PEM_BEGIN);
+		const unsigned char *labelEnd = findText(label, end, PEM_DASHES);
+		if (!labelEnd) {
+			break;
+		}
+
+		std::string name((const char *)label, labelEnd - label);
+
+		bool accepted = false;
+		for (int i = 0; labels[i]; i++) {
+			if (name == labels[i]) {
+				accepted = true;
+				break;
+			}
+		}
+
+		std::string footer = PEM_END + name + PEM_DASHES;
+		const unsigned char *stop = findText(labelEnd, end, footer.c_str());
+		if (!stop) {
+			THROW_EXCEPTION(0, Bundle, NULL, "PEM block '%s' has no footer", name.c_str());
+		}
+		stop += footer.length();
+
+		if (accepted) {
+			BundleItem item;
+			item.data = p;
+			item.length = stop - p;
+			item.pem = true;
+			res.push_back(item);
+		}
+
+		p = stop;
+	}
+
+	return res;
+}
+
+std::vector<BundleItem> Bundle::splitDer(const unsigned char *data, size_t length) {
+	LOGGER_FN();
+
+	std::vector<BundleItem> res;
+	const unsigned char *end = data + length;
+	const unsigned char *p = data;
+
+	while (p < end) {
+		const unsigned char *q = p;
+		long len = 0;
+		int tag = 0, xclass = 0;
+
+		LOGGER_OPENSSL(ASN1_get_object);
+		int ret = ASN1_get_object(&q, &len, &tag, &xclass, end - p);
+		if ((ret & 0x80) || tag != V_ASN1_SEQUENCE || (ret & 0x01)) {
+			THROW_OPENSSL_EXCEPTION(0, Bundle, NULL, "Wrong DER object at offset %d", (int)(p - data));
+		}
+
+		BundleItem item;
+		item.data = p;
+		item.length = (q - p) + len;
+		item.pem = false;
+		res.push_back(item);
+
+		p = q + len;
+	}
+
+	return res;
+}
+
+Handle<CertificateCollection> Bundle::loadCertificates(Handle<std::string> filename) {
+	LOGGER_FN();
+
+	if (filename.isEmpty()) {
+		THROW_EXCEPTION(0, Bundle, NULL, ERROR_PARAMETER_NULL, 1);
+	}
+
+	try{
+		MappedFile file(*filename);
+		std::vector<BundleItem> items = split(file.data(), file.size(), certLabels);
+
+		std::vector<X509 *> certs;
+		Handle<Exception> error;
+		int bad = decodeItems(items, certs, decodeCertificate, error);
+		if (bad >= 0) {
+			for (size_t i = 0; i < certs.size(); i++) {
+				X509_free(certs[i]);
+			}
+			THROW_EXCEPTION(0, Bundle, error, "Can not decode certificate %d", bad);
+		}
+
+		/* Stack owns the decoded objects from here */
+		LOGGER_OPENSSL(sk_X509_new_null);
+		stack_st_X509 *sk = sk_X509_new_null();
+		if (!sk) {
+			for (size_t i = 0; i < certs.size(); i++) {
+				X509_free(certs[i]);
+			}
+			THROW_OPENSSL_EXCEPTION(0, Bundle, NULL, "sk_X509_new_null");
+		}
+		for (size_t i = 0; i < certs.size(); i++) {
+			LOGGER_OPENSSL(sk_X509_push);
+			if (!sk_X509_push(sk, certs[i])) {
+				for (size_t j = i; j < certs.size(); j++) {
+					X509_free(certs[j]);
+				}
+				sk_X509_pop_free(sk, X509_free);
+				THROW_OPENSSL_EXCEPTION(0, Bundle, NULL, "sk_X509_push");
+			}
+		}
+
+		return new CertificateCollection(sk);
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Bundle, e, "Error load certificates");
+	}
+}
+
+Handle<CrlCollection> Bundle::loadCrls(Handle<std::string> filename) {
+	LOGGER_FN();
+
+	if (filename.isEmpty()) {
+		THROW_EXCEPTION(0, Bundle, NULL, ERROR_PARAMETER_NULL, 1);
+	}
+
+	try{
+		MappedFile file(*filename);
+		std::vector<BundleItem> items = split(file.data(), file.size(), crlLabels);
+
+		std::vector<X509_CRL *> crls;
+		Handle<Exception> error;
+		int bad = decodeItems(items, crls, decodeCrl, error);
+		if (bad >= 0) {
+			for (size_t i = 0; i < crls.size(); i++) {
+				X509_CRL_free(crls[i]);
+			}
+			THROW_EXCEPTION(0, Bundle, error, "Can not decode CRL %d", bad);
+		}
+
+		/* Stack owns the decoded objects from here */
+		LOGGER_OPENSSL(sk_X509_CRL_new_null);
+		stack_st_X509_CRL *sk = sk_X509_CRL_new_null();
+		if (!sk) {
+			for (size_t i = 0; i < crls.size(); i++) {
+				X509_CRL_free(crls[i]);
+			}
+			THROW_OPENSSL_EXCEPTION(0, Bundle, NULL, "sk_X509_CRL_new_null");
+		}
+		for (size_t i = 0; i < crls.size(); i++) {
+			LOGGER_OPENSSL(sk_X509_CRL_push);
+			if (!sk_X509_CRL_push(sk, crls[i])) {
+				for (size_t j = i; j < crls.size(); j++) {
+					X509_CRL_free(crls[j]);
+				}
+				sk_X509_CRL_pop_free(sk, X509_CRL_free);
+				THROW_OPENSSL_EXCEPTION(0, Bundle, NULL, "sk_X509_CRL_push");
+			}
+		}
+
+		return new CrlCollection(sk);
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Bundle, e, "Error load CRLs");
+	}
+}
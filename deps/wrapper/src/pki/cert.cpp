@@ -7,7 +7,7 @@ Handle<Key> Certificate::getPublicKey() {
 
 	if (!this->isEmpty()) {
 		LOGGER_OPENSSL(X509_get_pubkey);
-		EVP_PKEY *key = X509_get_pubkey(this->internal());
+		EVP_PKEY *key = X509_get_pubkey(this->raw());
 		if (!key) {
 			THROW_EXCEPTION(0, Certificate, NULL, "X509_get_pubkey");
 		}
@@ -22,7 +22,7 @@ Handle<Certificate> Certificate::duplicate(){
 
 	X509 *cert = NULL;
 	LOGGER_OPENSSL(X509_dup);
-	cert = X509_dup(this->internal());
+	cert = X509_dup(this->raw());
 	if (!cert)
 		THROW_EXCEPTION(1, Certificate, NULL, "X509_dup");
 	return new Certificate(cert);
@@ -31,6 +31,14 @@ Handle<Certificate> Certificate::duplicate(){
 void Certificate::read(Handle<Bio> in, DataFormat::DATA_FORMAT format){
 	LOGGER_FN();
 
+	if (!this->tryRead(in, format)) {
+		THROW_EXCEPTION(0, Certificate, NULL, "Can not read X509 data from BIO");
+	}
+}
+
+bool Certificate::tryRead(Handle<Bio> in, DataFormat::DATA_FORMAT format){
+	LOGGER_FN();
+
 	if (in.isEmpty())
 		THROW_EXCEPTION(0, Certificate, NULL, "Parameter %d cann't be NULL", 1);
 
@@ -52,10 +60,20 @@ void Certificate::read(Handle<Bio> in, DataFormat::DATA_FORMAT format){
 	}
 
 	if (!cert) {
-		THROW_EXCEPTION(0, Certificate, NULL, "Can not read X509 data from BIO");
+		LOGGER_OPENSSL(ERR_clear_error);
+		ERR_clear_error();
+		return false;
 	}
 
 	this->setData(cert);
+	return true;
+}
+
+void Certificate::setData(X509 *v){
+	LOGGER_FN();
+
+	SSLObject<X509>::setData(v);
+	this->cache = CertificateCache();
 }
 
 void Certificate::write(Handle<Bio> out, DataFormat::DATA_FORMAT format){
@@ -67,12 +85,12 @@ void Certificate::write(Handle<Bio> out, DataFormat::DATA_FORMAT format){
 	switch (format){
 	case DataFormat::DER:
 		LOGGER_OPENSSL(i2d_X509_bio);
-		if (i2d_X509_bio(out->internal(), this->internal()) < 1)
+		if (i2d_X509_bio(out->internal(), this->raw()) < 1)
 			THROW_OPENSSL_EXCEPTION(0, Certificate, NULL, "i2d_X509_bio", NULL);
 		break;
 	case DataFormat::BASE64:
 		LOGGER_OPENSSL(PEM_write_bio_X509);
-		if (PEM_write_bio_X509(out->internal(), this->internal()) < 1)
+		if (PEM_write_bio_X509(out->internal(), this->raw()) < 1)
 			THROW_OPENSSL_EXCEPTION(0, Certificate, NULL, "PEM_write_bio_X509", NULL);
 		break;
 	default:
@@ -86,16 +104,28 @@ Handle<std::string> Certificate::getSubjectFriendlyName()
 {
 	LOGGER_FN();
 
+	if (!this->cache.subjectFriendlyName.isEmpty()) {
+		return this->cache.subjectFriendlyName;
+	}
+
 	LOGGER_OPENSSL(X509_get_subject_name);
-	return GetCommonName(X509_get_subject_name(this->internal()));
+	this->cache.subjectFriendlyName = GetCommonName(X509_get_subject_name(this->raw()));
+
+	return this->cache.subjectFriendlyName;
 }
 
 Handle<std::string> Certificate::getIssuerFriendlyName()
 {
 	LOGGER_FN();
 
+	if (!this->cache.issuerFriendlyName.isEmpty()) {
+		return this->cache.issuerFriendlyName;
+	}
+
 	LOGGER_OPENSSL(X509_get_issuer_name);
-	return GetCommonName(X509_get_issuer_name(this->internal()));
+	this->cache.issuerFriendlyName = GetCommonName(X509_get_issuer_name(this->raw()));
+
+	return this->cache.issuerFriendlyName;
 }
 
 Handle<std::string> Certificate::GetCommonName(X509_NAME *a){
@@ -137,8 +167,12 @@ Handle<std::string> Certificate::getSubjectName()
 {
 	LOGGER_FN();
 
+	if (!this->cache.subjectName.isEmpty()) {
+		return this->cache.subjectName;
+	}
+
 	LOGGER_OPENSSL(X509_get_subject_name);
-	X509_NAME *name = X509_get_subject_name(this->internal());
+	X509_NAME *name = X509_get_subject_name(this->raw());
 	if (!name)
 		THROW_EXCEPTION(0, Certificate, NULL, "X509_NAME is NULL");
 
@@ -147,6 +181,8 @@ Handle<std::string> Certificate::getSubjectName()
 
 	Handle<std::string> res = new std::string(str_name.c_str(), str_name.length());
 
+	this->cache.subjectName = res;
+
 	return res;
 }
 
@@ -154,8 +190,12 @@ Handle<std::string> Certificate::getIssuerName()
 {
 	LOGGER_FN();
 
+	if (!this->cache.issuerName.isEmpty()) {
+		return this->cache.issuerName;
+	}
+
 	LOGGER_OPENSSL(X509_get_issuer_name);
-	X509_NAME *name = X509_get_issuer_name(this->internal());
+	X509_NAME *name = X509_get_issuer_name(this->raw());
 	if (!name)
 		THROW_EXCEPTION(0, Certificate, NULL, "X509_NAME is NULL");
 
@@ -164,6 +204,8 @@ Handle<std::string> Certificate::getIssuerName()
 
 	Handle<std::string> res = new std::string(str_name.c_str(), str_name.length());
 
+	this->cache.issuerName = res;
+
 	return res;
 }
 
@@ -171,8 +213,12 @@ Handle<std::string> Certificate::getNotAfter()
 {
 	LOGGER_FN();
 
+	if (!this->cache.notAfter.isEmpty()) {
+		return this->cache.notAfter;
+	}
+
 	LOGGER_OPENSSL(X509_get_notAfter);
-	ASN1_TIME *time = X509_get_notAfter(this->internal());
+	ASN1_TIME *time = X509_get_notAfter(this->raw());
 	LOGGER_OPENSSL(ASN1_TIME_to_generalizedtime);
 	ASN1_GENERALIZEDTIME *gtime = ASN1_TIME_to_generalizedtime(time, NULL);
 	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
@@ -180,15 +226,21 @@ Handle<std::string> Certificate::getNotAfter()
 	ASN1_GENERALIZEDTIME_print(out->internal(), gtime);
 	LOGGER_OPENSSL(ASN1_GENERALIZEDTIME_free);
 	ASN1_GENERALIZEDTIME_free(gtime);
-	return out->read();
+	this->cache.notAfter = out->read();
+
+	return this->cache.notAfter;
 }
 
 Handle<std::string> Certificate::getNotBefore()
 {
 	LOGGER_FN();
 
+	if (!this->cache.notBefore.isEmpty()) {
+		return this->cache.notBefore;
+	}
+
 	LOGGER_OPENSSL(X509_get_notBefore);
-	ASN1_TIME *time = X509_get_notBefore(this->internal());
+	ASN1_TIME *time = X509_get_notBefore(this->raw());
 	LOGGER_OPENSSL(ASN1_TIME_to_generalizedtime);
 	ASN1_GENERALIZEDTIME *gtime = ASN1_TIME_to_generalizedtime(time, NULL);
 	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
@@ -196,17 +248,23 @@ Handle<std::string> Certificate::getNotBefore()
 	ASN1_GENERALIZEDTIME_print(out->internal(), gtime);
 	LOGGER_OPENSSL(ASN1_GENERALIZEDTIME_free);
 	ASN1_GENERALIZEDTIME_free(gtime);
-	return out->read();
+	this->cache.notBefore = out->read();
+
+	return this->cache.notBefore;
 }
 
 Handle<std::string> Certificate::getSerialNumber()
 {
 	LOGGER_FN();
 
+	if (!this->cache.serialNumber.isEmpty()) {
+		return this->cache.serialNumber;
+	}
+
 	LOGGER_OPENSSL(BIO_new);
 	BIO * bioSerial = BIO_new(BIO_s_mem());
 	LOGGER_OPENSSL(i2a_ASN1_INTEGER);
-	if (i2a_ASN1_INTEGER(bioSerial, X509_get_serialNumber(this->internal())) < 0){
+	if (i2a_ASN1_INTEGER(bioSerial, X509_get_serialNumber(this->raw())) < 0){
 		THROW_OPENSSL_EXCEPTION(0, Certificate, NULL, "i2a_ASN1_INTEGER", NULL);
 	}
 
@@ -219,32 +277,45 @@ Handle<std::string> Certificate::getSerialNumber()
 
 	BIO_free(bioSerial);
 
+	this->cache.serialNumber = res;
+
 	return res;
 }
 
 Handle<std::string> Certificate::getSignatureAlgorithm() {
 	LOGGER_FN();
 
-	X509_ALGOR *sigalg = this->internal()->sig_alg;
+	if (!this->cache.signatureAlgorithm.isEmpty()) {
+		return this->cache.signatureAlgorithm;
+	}
+
+	X509_ALGOR *sigalg = this->raw()->sig_alg;
 
 	LOGGER_OPENSSL(X509_get_signature_nid);
-	int sig_nid = X509_get_signature_nid(this->internal());
+	int sig_nid = X509_get_signature_nid(this->raw());
 	if (sig_nid != NID_undef) {
 		LOGGER_OPENSSL(OBJ_nid2ln);
-		return new std::string(OBJ_nid2ln(sig_nid));
+		this->cache.signatureAlgorithm = new std::string(OBJ_nid2ln(sig_nid));
+	}
+	else {
+		this->cache.signatureAlgorithm = (new Algorithm(sigalg))->getName();
 	}
 
-	return (new Algorithm(sigalg))->getName();
+	return this->cache.signatureAlgorithm;
 }
 
 Handle<std::string> Certificate::getSignatureDigest() {
 	LOGGER_FN();
 
+	if (!this->cache.signatureDigest.isEmpty()) {
+		return this->cache.signatureDigest;
+	}
+
 	int signature_nid = 0, md_nid = 0;
 	const EVP_MD *type;
 
 	LOGGER_OPENSSL("X509_get_signature_nid");
-	signature_nid = X509_get_signature_nid(this->internal());
+	signature_nid = X509_get_signature_nid(this->raw());
 	if (!signature_nid){
 		THROW_OPENSSL_EXCEPTION(0, SignedData, NULL, "Unknown signature nid");
 	}
@@ -258,15 +329,21 @@ Handle<std::string> Certificate::getSignatureDigest() {
 		THROW_OPENSSL_EXCEPTION(0, SignedData, NULL, "Unknown digest name");
 	}
 
-	return new std::string(OBJ_nid2sn(md_nid));
+	this->cache.signatureDigest = new std::string(OBJ_nid2sn(md_nid));
+
+	return this->cache.signatureDigest;
 }
 
 Handle<std::string> Certificate::getOrganizationName(){
 	LOGGER_FN();
 
+	if (!this->cache.organizationName.isEmpty()) {
+		return this->cache.organizationName;
+	}
+
 	X509_NAME * a = NULL;
 	Handle<std::string> organizationName = new std::string("");
-	if ((a = X509_get_subject_name(this->internal())) == NULL) {
+	if ((a = X509_get_subject_name(this->raw())) == NULL) {
 		THROW_OPENSSL_EXCEPTION(0, Certificate, NULL, "Cannot get subject name");
 	}		
 
@@ -290,9 +367,8 @@ Handle<std::string> Certificate::getOrganizationName(){
 			}
 		}
 	}
-	else {
-		return new std::string("");
-	}
+
+	this->cache.organizationName = organizationName;
 
 	return organizationName;
 }
@@ -301,7 +377,7 @@ int Certificate::compare(Handle<Certificate> cert){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_cmp);
-	int res = X509_cmp(this->internal(), cert->internal());
+	int res = X509_cmp(this->raw(), cert->raw());
 
 	return res;
 }
@@ -310,14 +386,20 @@ Handle<std::string> Certificate::getThumbprint()
 {
 	LOGGER_FN();
 
-	return this->hash(EVP_sha1());
+	if (!this->cache.thumbprint.isEmpty()) {
+		return this->cache.thumbprint;
+	}
+
+	this->cache.thumbprint = this->hash(EVP_sha1());
+
+	return this->cache.thumbprint;
 }
 
 long Certificate::getVersion(){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_get_version);
-	long res = X509_get_version(this->internal());
+	long res = X509_get_version(this->raw());
 
 	return res;
 }
@@ -326,7 +408,7 @@ int Certificate::getType(){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_get_pubkey);
-	EVP_PKEY *pk = X509_get_pubkey(this->internal());
+	EVP_PKEY *pk = X509_get_pubkey(this->raw());
 	if (!pk)
 		THROW_OPENSSL_EXCEPTION(0, Certificate, NULL, "X509_get_pubkey", NULL);
 
@@ -337,9 +419,9 @@ int Certificate::getKeyUsage(){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_check_purpose);
-	X509_check_purpose(this->internal(), -1, -1);
-	if (this->internal()->ex_flags & EXFLAG_KUSAGE)
-		return this->internal()->ex_kusage;
+	X509_check_purpose(this->raw(), -1, -1);
+	if (this->raw()->ex_flags & EXFLAG_KUSAGE)
+		return this->raw()->ex_kusage;
 
 	return UINT32_MAX;
 }
@@ -360,8 +442,8 @@ bool Certificate::isSelfSigned() {
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_check_purpose);
-	X509_check_purpose(this->internal(), -1, 0);
-	if (this->internal()->ex_flags & EXFLAG_SS) {
+	X509_check_purpose(this->raw(), -1, 0);
+	if (this->raw()->ex_flags & EXFLAG_SS) {
 		return true;
 	}		
 	else {
@@ -384,15 +466,68 @@ Handle<std::string> Certificate::hash(Handle<std::string> algorithm){
 Handle<std::string> Certificate::hash(const EVP_MD *md) {
 	LOGGER_FN();
 
+	std::vector<const EVP_MD *> mds;
+	mds.push_back(md);
+
+	return this->hashes(mds)[0];
+}
+
+std::vector<Handle<std::string> > Certificate::hashes(std::vector<Handle<std::string> > algorithms){
+	LOGGER_FN();
+
+	std::vector<const EVP_MD *> mds;
+	for (size_t i = 0; i < algorithms.size(); i++) {
+		LOGGER_OPENSSL(EVP_get_digestbyname);
+		const EVP_MD *md = EVP_get_digestbyname(algorithms[i]->c_str());
+		if (!md) {
+			THROW_OPENSSL_EXCEPTION(0, Certificate, NULL, "EVP_get_digestbyname '%s'", algorithms[i]->c_str());
+		}
+		mds.push_back(md);
+	}
+
+	return this->hashes(mds);
+}
+
+std::vector<Handle<std::string> > Certificate::hashes(std::vector<const EVP_MD *> mds) {
+	LOGGER_FN();
+
+	std::vector<Handle<std::string> > res;
+
+	//DER is encoded once and shared by all digests
+	Handle<std::string> der = this->getEncoded();
+
 	unsigned char hash[EVP_MAX_MD_SIZE] = { 0 };
 	unsigned int hashlen = 0;
 
-	LOGGER_OPENSSL(X509_digest);
-	if (!X509_digest(this->internal(), md, hash, &hashlen)) {
-		THROW_OPENSSL_EXCEPTION(0, Certificate, NULL, "X509_digest");
-	}
+	for (size_t i = 0; i < mds.size(); i++) {
+		LOGGER_OPENSSL(EVP_Digest);
+		if (!EVP_Digest(der->c_str(), der->length(), hash, &hashlen, mds[i], NULL)) {
+			THROW_OPENSSL_EXCEPTION(0, Certificate, NULL, "EVP_Digest");
+		}
 
-	Handle<std::string> res = new std::string((char *)hash, hashlen);
+		res.push_back(new std::string((char *)hash, hashlen));
+	}
 
 	return res;
-}
\ No newline at end of file
+}
+
+Handle<std::string> Certificate::getEncoded(){
+	LOGGER_FN();
+
+	if (!this->cache.encoded.isEmpty()) {
+		return this->cache.encoded;
+	}
+
+	unsigned char *der = NULL;
+
+	LOGGER_OPENSSL(i2d_X509);
+	int derlen = i2d_X509(this->raw(), &der);
+	if (derlen <= 0) {
+		THROW_OPENSSL_EXCEPTION(0, Certificate, NULL, "i2d_X509");
+	}
+
+	this->cache.encoded = new std::string((char *)der, derlen);
+	OPENSSL_free(der);
+
+	return this->cache.encoded;
+}
@@ -9,12 +9,74 @@ void CertificateCollection::push(Handle<Certificate> cert) {
 		LOGGER_OPENSSL("sk_X509_new_null");
 		this->setData(sk_X509_new_null());
 	}
-	Handle<Certificate> certcpy = cert->duplicate();
+
+	LOGGER_OPENSSL("X509_dup");
+	X509 *x = X509_dup(cert->raw());
+	if (!x){
+		THROW_OPENSSL_EXCEPTION(0, CertificateCollection, NULL, "X509_dup");
+	}
 
 	LOGGER_OPENSSL("sk_X509_push");
-	sk_X509_push(this->internal(), certcpy->internal());
+	if (!sk_X509_push(this->raw(), x)) {
+		X509_free(x);
+		THROW_OPENSSL_EXCEPTION(0, CertificateCollection, NULL, "sk_X509_push");
+	}
+}
+
+void CertificateCollection::pushRef(Handle<Certificate> cert) {
+	LOGGER_FN();
+
+	if (this->isEmpty()){
+		LOGGER_OPENSSL("sk_X509_new_null");
+		this->setData(sk_X509_new_null());
+	}
 
-	certcpy->setParent(this->handle());
+	X509 *x = cert->raw();
+
+	LOGGER_OPENSSL("CRYPTO_add");
+	CRYPTO_add(&x->references, 1, CRYPTO_LOCK_X509);
+
+	LOGGER_OPENSSL("sk_X509_push");
+	if (!sk_X509_push(this->raw(), x)) {
+		X509_free(x);
+		THROW_OPENSSL_EXCEPTION(0, CertificateCollection, NULL, "sk_X509_push");
+	}
+}
+
+void CertificateCollection::pushRef(stack_st_X509 *certs) {
+	LOGGER_FN();
+
+	if (!certs){
+		THROW_EXCEPTION(0, CertificateCollection, NULL, ERROR_PARAMETER_NULL, 1);
+	}
+
+	if (this->isEmpty()){
+		LOGGER_OPENSSL("sk_X509_new_null");
+		this->setData(sk_X509_new_null());
+	}
+
+	for (int i = 0, c = sk_X509_num(certs); i < c; i++){
+		X509 *x = sk_X509_value(certs, i);
+
+		LOGGER_OPENSSL("CRYPTO_add");
+		CRYPTO_add(&x->references, 1, CRYPTO_LOCK_X509);
+
+		LOGGER_OPENSSL("sk_X509_push");
+		if (!sk_X509_push(this->raw(), x)) {
+			X509_free(x);
+			THROW_OPENSSL_EXCEPTION(0, CertificateCollection, NULL, "sk_X509_push");
+		}
+	}
+}
+
+void CertificateCollection::pushRef(Handle<CertificateCollection> certs) {
+	LOGGER_FN();
+
+	if (certs->isEmpty()){
+		return;
+	}
+
+	this->pushRef(certs->raw());
 }
 
 int CertificateCollection::length() {
@@ -24,32 +86,44 @@ int CertificateCollection::length() {
 		return 0;
 
 	LOGGER_OPENSSL("sk_X509_num");
-	return sk_X509_num(this->internal());
+	return sk_X509_num(this->raw());
 }
 
 Handle<Certificate> CertificateCollection::items(int index) {
 	LOGGER_FN();
 
 	LOGGER_OPENSSL("sk_X509_value");
-	X509 *cert = sk_X509_value(this->internal(), index);
+	X509 *cert = sk_X509_value(this->raw(), index);
 
 	if (!cert){
 		THROW_OPENSSL_EXCEPTION(0, CertificateCollection, NULL, "Has no item by index %d", index);
 	}
 
-	return new Certificate(cert, this->handle());
+	/*Own reference: the item outlives its removal from the collection*/
+	LOGGER_OPENSSL("CRYPTO_add");
+	CRYPTO_add(&cert->references, 1, CRYPTO_LOCK_X509);
+
+	return new Certificate(cert);
 }
 
 void CertificateCollection::pop(){
 	LOGGER_FN();
 
-	LOGGER_OPENSSL("sk_X509_value");
-	sk_X509_pop(this->internal());	
+	LOGGER_OPENSSL("sk_X509_pop");
+	X509 *cert = sk_X509_pop(this->raw());
+
+	if (cert){
+		X509_free(cert);
+	}
 }
 
 void CertificateCollection::removeAt(int index){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL("sk_X509_delete");
-	sk_X509_delete(this->internal(), index);
+	X509 *cert = sk_X509_delete(this->raw(), index);
+
+	if (cert){
+		X509_free(cert);
+	}
 }
\ No newline at end of file
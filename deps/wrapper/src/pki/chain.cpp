@@ -9,7 +9,7 @@ Handle<CertificateCollection> Chain::buildChain(Handle<Certificate> cert, Handle
 		Handle<Certificate> issuer = new Certificate();
 
 		Handle<CertificateCollection> chain = new CertificateCollection();
-		chain->push(cert);
+		chain->pushRef(cert);
 
 		if (cert->isSelfSigned()) {
 			return chain;
@@ -26,7 +26,7 @@ Handle<CertificateCollection> Chain::buildChain(Handle<Certificate> cert, Handle
 				issuer.empty();
 			}
 			else{
-				chain->push(issuer);
+				chain->pushRef(issuer);
 				xtemp = issuer;
 			}
 
@@ -44,16 +44,57 @@ bool Chain::verifyChain(Handle<CertificateCollection> chain, Handle<CrlCollectio
 	LOGGER_FN();
 
 	try{
-		bool res = true;
+		VerifyResult res;
+
+		this->checkChain(chain, crls, res);
+
+		return res.status == VerifyStatus::Valid;
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Chain, e, "Error verify chain (provider store)");
+	}	
+}
+
+VerifyResult Chain::verifyChainResult(Handle<CertificateCollection> chain, Handle<CrlCollection> crls){
+	LOGGER_FN();
+
+	VerifyResult res;
+
+	try{
+		this->checkChain(chain, crls, res);
+	}
+	catch (Handle<Exception> e){
+		res.status = VerifyStatus::Error;
+		res.code = e->code();
+		res.message = e->what();
+	}
+	catch (std::exception &e){
+		res.status = VerifyStatus::Error;
+		res.message = e.what();
+	}
+
+	return res;
+}
+
+void Chain::checkChain(Handle<CertificateCollection> chain, Handle<CrlCollection> crls, VerifyResult &result){
+	LOGGER_FN();
+
+	X509_STORE_CTX *ctx = NULL;
+	X509_STORE *st = NULL;
+
+	try{
+		if (chain.isEmpty() || !chain->length()){
+			THROW_EXCEPTION(0, Chain, NULL, "Chain is empty");
+		}
 
 		LOGGER_OPENSSL(X509_STORE_CTX_new);
-		X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+		ctx = X509_STORE_CTX_new();
 		if (!ctx) {
 			THROW_OPENSSL_EXCEPTION(0, Revocation, NULL, "Error create new store ctx");
 		}
 
 		LOGGER_OPENSSL(X509_STORE_new);
-		X509_STORE *st = X509_STORE_new();
+		st = X509_STORE_new();
 		if (!st) {
 			THROW_OPENSSL_EXCEPTION(0, Revocation, NULL, "Error create new store");
 		}
@@ -64,11 +105,13 @@ bool Chain::verifyChain(Handle<CertificateCollection> chain, Handle<CrlCollectio
 		}
 
 		LOGGER_OPENSSL(X509_STORE_CTX_init);
-		X509_STORE_CTX_init(ctx, st, chain->items(0)->internal(), chain->internal());
+		if (!X509_STORE_CTX_init(ctx, st, chain->items(0)->internal(), chain->raw())) {
+			THROW_OPENSSL_EXCEPTION(0, Chain, NULL, "X509_STORE_CTX_init");
+		}
 
-		if (crls->length()) {
+		if (!crls.isEmpty() && crls->length()) {
 			LOGGER_OPENSSL(X509_STORE_CTX_set0_crls);
-			X509_STORE_CTX_set0_crls(ctx, crls->internal());
+			X509_STORE_CTX_set0_crls(ctx, crls->raw());
 
 			LOGGER_OPENSSL(X509_STORE_CTX_set_flags);
 			X509_STORE_CTX_set_flags(ctx, X509_V_FLAG_CRL_CHECK);
@@ -81,22 +124,34 @@ bool Chain::verifyChain(Handle<CertificateCollection> chain, Handle<CrlCollectio
 
 		LOGGER_OPENSSL(X509_verify_cert);
 		if (X509_verify_cert(ctx) <= 0){
-			res = false;
+			result.status = VerifyStatus::Invalid;
+			result.code = X509_STORE_CTX_get_error(ctx);
+			result.index = X509_STORE_CTX_get_error_depth(ctx);
+			result.message = X509_verify_cert_error_string(result.code);
+
+			LOGGER_OPENSSL(ERR_clear_error);
+			ERR_clear_error();
+		}
+	}
+	catch (...){
+		/*Handle<Exception> and std::bad_alloc alike*/
+		if (ctx){
+			X509_STORE_CTX_free(ctx);
+		}
+		if (st){
+			X509_STORE_free(st);
 		}
 
-		LOGGER_OPENSSL(X509_STORE_CTX_free);
-		X509_STORE_CTX_free(ctx);
-		ctx = NULL;
+		throw;
+	}
 
-		LOGGER_OPENSSL(X509_STORE_free);
-		X509_STORE_free(st);
-		st = NULL;
+	LOGGER_OPENSSL(X509_STORE_CTX_free);
+	X509_STORE_CTX_free(ctx);
+	ctx = NULL;
 
-		return res;
-	}
-	catch (Handle<Exception> e){
-		THROW_EXCEPTION(0, Chain, e, "Error verify chain (provider store)");
-	}	
+	LOGGER_OPENSSL(X509_STORE_free);
+	X509_STORE_free(st);
+	st = NULL;
 }
 
 Handle<Certificate> Chain::getIssued(Handle<CertificateCollection> certs, Handle<Certificate> cert){
@@ -131,7 +186,7 @@ bool Chain::checkIssued(Handle<Certificate> issuer, Handle<Certificate> cert){
 		}
 
 		LOGGER_OPENSSL(X509_check_issued);
-		ret = X509_check_issued(issuer->internal(), cert->internal());
+		ret = X509_check_issued(issuer->raw(), cert->raw());
 		if (ret == X509_V_OK){
 			return 1;
 		}
@@ -2,6 +2,169 @@
 
 #include "wrapper/pki/cipher.h"
 
+#include <atomic>
+#include <climits>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/*OpenSSL 1.0.2 has only GCM names of AEAD controls*/
+#ifdef EVP_CTRL_AEAD_SET_TAG
+#define CIPHER_CTRL_AEAD_GET_TAG EVP_CTRL_AEAD_GET_TAG
+#define CIPHER_CTRL_AEAD_SET_TAG EVP_CTRL_AEAD_SET_TAG
+#else
+#define CIPHER_CTRL_AEAD_GET_TAG EVP_CTRL_GCM_GET_TAG
+#define CIPHER_CTRL_AEAD_SET_TAG EVP_CTRL_GCM_SET_TAG
+#endif
+
+/*Magic, NID, flags, chunk size, nonce*/
+#define CIPHER_CHUNK_HEADER_LENGTH (sizeof CIPHER_CHUNK_MAGIC - 1 + 2 + 1 + 4 + CIPHER_CHUNK_NONCE_LENGTH)
+/*Salt, KdfMethod, cost, r, p*/
+#define CIPHER_CHUNK_SALT_LENGTH (PKCS5_SALT_LEN + 1 + 4 + 4 + 4)
+
+static void chunkPutUint(unsigned char *out, uint64_t value, int size){
+	for (int i = size - 1; i >= 0; i--){
+		out[i] = (unsigned char)value;
+		value >>= 8;
+	}
+}
+
+static uint64_t chunkGetUint(const unsigned char *in, int size){
+	uint64_t res = 0;
+
+	for (int i = 0; i < size; i++){
+		res = (res << 8) | in[i];
+	}
+
+	return res;
+}
+
+/*Reads until len bytes or end of data*/
+static size_t chunkRead(BIO *in, unsigned char *out, size_t len){
+	size_t res = 0;
+
+	while (res < len){
+		int n = BIO_read(in, (char *)out + res, (int)(len - res));
+		if (n <= 0){
+			break;
+		}
+		res += n;
+	}
+
+	return res;
+}
+
+static void chunkWrite(BIO *out, const unsigned char *data, size_t len){
+	if (len && BIO_write(out, (const char *)data, (int)len) != (int)len){
+		THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error writing output bio");
+	}
+}
+
+/*Random access to file and memory BIOs*/
+static uint64_t chunkBioSize(BIO *bio){
+	FILE *fp = NULL;
+	char *data;
+
+	switch (BIO_method_type(bio)){
+	case BIO_TYPE_MEM:
+		return BIO_get_mem_data(bio, &data);
+	case BIO_TYPE_FILE:
+		BIO_get_fp(bio, &fp);
+#ifdef _WIN32
+		if (!fp || _fseeki64(fp, 0, SEEK_END)){
+			THROW_EXCEPTION(0, Cipher, NULL, "Error seek file");
+		}
+		return _ftelli64(fp);
+#else
+		if (!fp || fseeko(fp, 0, SEEK_END)){
+			THROW_EXCEPTION(0, Cipher, NULL, "Error seek file");
+		}
+		return ftello(fp);
+#endif
+	default:
+		THROW_EXCEPTION(0, Cipher, NULL, "Random access needs file or memory BIO");
+	}
+}
+
+static void chunkReadAt(BIO *bio, uint64_t offset, unsigned char *out, size_t len){
+	FILE *fp = NULL;
+	char *data;
+
+	if (BIO_method_type(bio) == BIO_TYPE_MEM){
+		if (offset + len > (uint64_t)BIO_get_mem_data(bio, &data)){
+			THROW_EXCEPTION(0, Cipher, NULL, "Unexpected end of data");
+		}
+		memcpy(out, data + offset, len);
+		return;
+	}
+
+	BIO_get_fp(bio, &fp);
+#ifdef _WIN32
+	if (!fp || _fseeki64(fp, offset, SEEK_SET) || fread(out, 1, len, fp) != len){
+#else
+	if (!fp || fseeko(fp, offset, SEEK_SET) || fread(out, 1, len, fp) != len){
+#endif
+		THROW_EXCEPTION(0, Cipher, NULL, "Unexpected end of data");
+	}
+}
+
+/*
+* Seals or opens one chunk. Ciphertext is written over the text, tag is
+* taken from or stored to tag. Returns false on error or wrong tag
+*/
+static bool chunkCrypt(const EVP_CIPHER *cipher, const unsigned char *key, const unsigned char *base, uint64_t index,
+	const std::string &aad, unsigned char *data, size_t len, unsigned char *tag, int enc){
+	unsigned char nonce[CIPHER_CHUNK_NONCE_LENGTH];
+	unsigned char number[8];
+	unsigned char final[EVP_MAX_BLOCK_LENGTH];
+	EVP_CIPHER_CTX *actx;
+	int outl;
+	bool res;
+
+	memcpy(nonce, base, sizeof nonce);
+	for (int i = 0; i < 8; i++){
+		nonce[sizeof nonce - 1 - i] ^= (unsigned char)(index >> (8 * i));
+	}
+	chunkPutUint(number, index, sizeof number);
+
+	if ((actx = EVP_CIPHER_CTX_new()) == NULL){
+		return false;
+	}
+
+	res = EVP_CipherInit_ex(actx, cipher, NULL, key, nonce, enc)
+		&& EVP_CipherUpdate(actx, NULL, &outl, (const unsigned char *)aad.data(), (int)aad.length())
+		&& EVP_CipherUpdate(actx, NULL, &outl, number, sizeof number)
+		&& (!len || EVP_CipherUpdate(actx, data, &outl, data, (int)len))
+		&& (enc || EVP_CIPHER_CTX_ctrl(actx, CIPHER_CTRL_AEAD_SET_TAG, CIPHER_AEAD_TAG_LENGTH, tag))
+		&& EVP_CipherFinal_ex(actx, final, &outl) > 0
+		&& (!enc || EVP_CIPHER_CTX_ctrl(actx, CIPHER_CTRL_AEAD_GET_TAG, CIPHER_AEAD_TAG_LENGTH, tag));
+
+	EVP_CIPHER_CTX_free(actx);
+
+	return res;
+}
+
+/*Calls job(i) for i < count on up to threads threads, the calling thread is one of them*/
+static void chunkParallel(size_t threads, size_t count, const std::function<void(size_t)> &job){
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> pool;
+
+	auto worker = [&next, count, &job]() {
+		for (size_t i; (i = next++) < count;){
+			job(i);
+		}
+	};
+
+	for (size_t i = 1; i < threads && i < count; i++){
+		pool.push_back(std::thread(worker));
+	}
+	worker();
+
+	for (size_t i = 0; i < pool.size(); i++){
+		pool[i].join();
+	}
+}
+
 Cipher::Cipher(){
 	LOGGER_FN();
 
@@ -20,9 +183,9 @@ Cipher::Cipher(){
 		} 
 
 		/*Rand salt*/
-		LOGGER_OPENSSL(RAND_pseudo_bytes);
-		if (RAND_pseudo_bytes(salt, sizeof salt) < 0){
-			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Invalid generate pseudo rand");
+		LOGGER_OPENSSL(RAND_bytes);
+		if (RAND_bytes(salt, sizeof salt) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error generate rand");
 		}
 	}
 	catch (Handle<Exception> e){
@@ -108,10 +271,48 @@ void Cipher::encrypt(Handle<Bio> inSource, Handle<Bio> outEnc, DataFormat::DATA_
 				}
 
 				/*Check IV*/
-				if (hiv == NULL){
+				if (hiv == NULL && !isIvPerMessage()){
 					THROW_EXCEPTION(0, Cipher, NULL, "iv undefined");
 				}
 			}
+			else{
+				/*Same salt gives the same key and iv, the iv of these modes must not repeat*/
+				if (hsalt && isIvPerMessage()){
+					THROW_EXCEPTION(0, Cipher, NULL, "Salt can not be set for %s with password, the iv would repeat", EVP_CIPHER_name(cipher));
+				}
+				newSalt();
+				deriveKey();
+			}
+
+			wbio = outEnc->internal();
+
+			/*
+			* Write 'Salted__' and salt to bio.
+			* Without salt possible to perform  dictionary attacks on the password
+			*/
+			if (hpass){
+				LOGGER_OPENSSL(BIO_write);
+				if ((BIO_write(wbio, magic, sizeof magic - 1) != sizeof magic - 1
+					|| BIO_write(wbio, (char *)salt, sizeof salt) != sizeof salt)){
+					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error write bio");
+				}
+			}
+			else if (isIvPerMessage()){
+				LOGGER_OPENSSL(RAND_bytes);
+				if (RAND_bytes(iv, EVP_CIPHER_iv_length(cipher)) <= 0){
+					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error generate iv");
+				}
+
+				LOGGER_OPENSSL(BIO_write);
+				if (BIO_write(wbio, (char *)iv, EVP_CIPHER_iv_length(cipher)) != EVP_CIPHER_iv_length(cipher)){
+					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error write bio");
+				}
+			}
+
+			if (isAead()){
+				encryptAead(inSource->internal(), wbio);
+				break;
+			}
 
 			if ((buff = (unsigned char *)OPENSSL_malloc(EVP_ENCODE_LENGTH(bsize))) == NULL){
 				THROW_EXCEPTION(0, Cipher, NULL, "OPENSSL_malloc failure");
@@ -136,20 +337,6 @@ void Cipher::encrypt(Handle<Bio> inSource, Handle<Bio> outEnc, DataFormat::DATA_
 				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error setting cipher");
 			}
 
-			wbio = outEnc->internal();
-
-			/*
-			* Write 'Salted__' and salt to bio.
-			* Without salt possible to perform  dictionary attacks on the password
-			*/
-			if (hpass){
-				LOGGER_OPENSSL(BIO_write);
-				if ((BIO_write(wbio, magic, sizeof magic - 1) != sizeof magic - 1
-					|| BIO_write(wbio, (char *)salt, sizeof salt) != sizeof salt)){
-					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error write bio");
-				}
-			}
-
 			if (benc != NULL){
 				LOGGER_OPENSSL(BIO_push);
 				wbio = BIO_push(benc, wbio);
@@ -212,6 +399,13 @@ void Cipher::encrypt(Handle<Bio> inSource, Handle<Bio> outEnc, DataFormat::DATA_
 				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error get cipher by name");
 			}
 
+#if OPENSSL_VERSION_NUMBER < 0x30000000L
+			/*AuthEnvelopedData appeared in OpenSSL 3.0*/
+			if (isAead()){
+				THROW_EXCEPTION(0, Cipher, NULL, "AEAD cipher is not supported for CMS, use CBC mode");
+			}
+#endif
+
 			flags |= CMS_BINARY; /*Don't translate message to text*/
 
 			LOGGER_OPENSSL(CMS_encrypt);
@@ -267,7 +461,7 @@ void Cipher::decrypt(Handle<Bio> inEnc, Handle<Bio> outDec, DataFormat::DATA_FOR
 				}
 
 				/*Check IV*/
-				if (hiv == NULL){
+				if (hiv == NULL && !isIvPerMessage()){
 					THROW_EXCEPTION(0, Cipher, NULL, "iv undefined");
 				}
 			}
@@ -289,12 +483,20 @@ void Cipher::decrypt(Handle<Bio> inEnc, Handle<Bio> outDec, DataFormat::DATA_FOR
 					THROW_EXCEPTION(0, Cipher, NULL, "bad magic number");
 				}
 
-				LOGGER_OPENSSL(EVP_BytesToKey);
-				if (EVP_BytesToKey(cipher, dgst, salt, (unsigned char *)hpass, strlen(hpass), 1, key, iv) == 0){
-					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "EVP_BytesToKey");
+				deriveKey();
+			}
+			else if (isIvPerMessage()){
+				LOGGER_OPENSSL(BIO_read);
+				if (BIO_read(rbio, (char *)iv, EVP_CIPHER_iv_length(cipher)) != EVP_CIPHER_iv_length(cipher)){
+					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "error reading input file");
 				}
 			}
 
+			if (isAead()){
+				decryptAead(rbio, wbio);
+				break;
+			}
+
 			LOGGER_OPENSSL(BIO_new);
 			if ((benc = BIO_new(BIO_f_cipher())) == NULL){
 				THROW_EXCEPTION(0, Cipher, NULL, "BIO_new(BIO_f_cipher())");
@@ -338,7 +540,7 @@ void Cipher::decrypt(Handle<Bio> inEnc, Handle<Bio> outDec, DataFormat::DATA_FOR
 		// Assymmetric decrypt
 		//***************************************************************************************
 		case CryptoMethod::ASSYMETRIC:
-			if (!rcert || !rkey){
+			if ((!rcert || !rkey) && recipientStore.isEmpty()){
 				THROW_EXCEPTION(0, Cipher, NULL, "Recipient cert or key undefined");
 			}
 
@@ -362,9 +564,19 @@ void Cipher::decrypt(Handle<Bio> inEnc, Handle<Bio> outDec, DataFormat::DATA_FOR
 				THROW_EXCEPTION(0, Cipher, NULL, ERROR_DATA_FORMAT_UNKNOWN_FORMAT, format);
 			}
 
-			LOGGER_OPENSSL(CMS_decrypt_set1_pkey);
-			if (!CMS_decrypt_set1_pkey(cms, rkey, rcert)) {
-				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "CMS_decrypt_set1_pkey 'Error set private key'");
+			if (rcert && rkey){
+				LOGGER_OPENSSL(CMS_decrypt_set1_pkey);
+				if (!CMS_decrypt_set1_pkey(cms, rkey, rcert)) {
+					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "CMS_decrypt_set1_pkey 'Error set private key'");
+				}
+			}
+			else{
+				Handle<PkiItem> recipient = findStoreRecipient();
+
+				LOGGER_OPENSSL(CMS_decrypt_set1_pkey);
+				if (!CMS_decrypt_set1_pkey(cms, recipient->key->internal(), recipient->certificate->internal())) {
+					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "CMS_decrypt_set1_pkey 'Error set private key'");
+				}
 			}
 
 			LOGGER_OPENSSL(CMS_decrypt);
@@ -389,6 +601,36 @@ void Cipher::decrypt(Handle<Bio> inEnc, Handle<Bio> outDec, DataFormat::DATA_FOR
 	}
 }
 
+void Cipher::setRecipientStore(Handle<PkiStore> store){
+	LOGGER_FN();
+
+	recipientStore = store;
+}
+
+Handle<PkiItem> Cipher::findStoreRecipient(){
+	LOGGER_FN();
+
+	try{
+		LOGGER_OPENSSL(CMS_get0_RecipientInfos);
+		STACK_OF(CMS_RecipientInfo) *ris = CMS_get0_RecipientInfos(cms);
+
+		for (int i = 0, c = ris ? sk_CMS_RecipientInfo_num(ris) : 0; i < c; i++){
+			Handle<CmsRecipientInfo> ri = new CmsRecipientInfo();
+			ri->setValue(sk_CMS_RecipientInfo_value(ris, i));
+
+			Handle<PkiItem> recipient = recipientStore->findRecipient(ri);
+			if (!recipient.isEmpty()){
+				return recipient;
+			}
+		}
+
+		THROW_EXCEPTION(0, Cipher, NULL, "No recipient certificate with key in store");
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Cipher, e, "Error find recipient in store");
+	}
+}
+
 Handle<CmsRecipientInfoCollection> Cipher::getRecipientInfos(Handle<Bio> inEnc, DataFormat::DATA_FORMAT format) {
 	LOGGER_FN();
 
@@ -430,6 +672,37 @@ Handle<CmsRecipientInfoCollection> Cipher::getRecipientInfos(Handle<Bio> inEnc,
 	}
 }
 
+void Cipher::setAlgorithm(Handle<std::string> name){
+	LOGGER_FN();
+
+	try{
+		const EVP_CIPHER *value;
+
+		LOGGER_OPENSSL(EVP_get_cipherbyname);
+		if ((value = EVP_get_cipherbyname(name->c_str())) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Unknown cipher '%s'", name->c_str());
+		}
+
+		/*Need message length in advance or special key format*/
+		switch (EVP_CIPHER_mode(value)){
+		case EVP_CIPH_CCM_MODE:
+		case EVP_CIPH_XTS_MODE:
+		case EVP_CIPH_WRAP_MODE:
+			THROW_EXCEPTION(0, Cipher, NULL, "Cipher mode is not supported '%s'", name->c_str());
+		}
+
+		cipher = value;
+
+		/*Key and iv from password depend on cipher*/
+		if (hpass && kdf == KdfMethod::BYTES_TO_KEY){
+			deriveKey();
+		}
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Cipher, e, "Error set algorithm");
+	}
+}
+
 void Cipher::setDigest(Handle<std::string> md){
 	LOGGER_FN();
 
@@ -455,12 +728,149 @@ void Cipher::setPass(Handle<std::string> password){
 		hpass = strdup(password->c_str());
 	}
 
-	LOGGER_OPENSSL(EVP_BytesToKey);
-	if (EVP_BytesToKey(cipher, dgst, salt, (unsigned char *)hpass, strlen(hpass), 1, key, iv) == 0){
-		THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "EVP_BytesToKey");
+	/*PBKDF2 and scrypt are slow, they are done with the final salt in encrypt and decrypt*/
+	if (kdf == KdfMethod::BYTES_TO_KEY){
+		deriveKey();
+	}
+}
+
+void Cipher::setKdf(KdfMethod::Kdf_Method method, unsigned long cost, unsigned long r, unsigned long p){
+	LOGGER_FN();
+
+	try{
+		switch (method){
+		case KdfMethod::BYTES_TO_KEY:
+			break;
+		case KdfMethod::PBKDF2:
+			if (cost < 1 || cost > INT_MAX){
+				THROW_EXCEPTION(0, Cipher, NULL, "Invalid PBKDF2 iterations %lu", cost);
+			}
+			if (cost > kdfMaxIterations){
+				THROW_EXCEPTION(0, Cipher, NULL, "PBKDF2 iterations %lu exceed limit %lu", cost, kdfMaxIterations);
+			}
+			break;
+		case KdfMethod::SCRYPT:
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+			/*No EVP_PBE_scrypt, refuse it here and not on every encrypt*/
+			THROW_EXCEPTION(0, Cipher, NULL, "scrypt needs OpenSSL 1.1.0 or later");
+#endif
+			if (cost < 2 || (cost & (cost - 1)) || r < 1 || p < 1){
+				THROW_EXCEPTION(0, Cipher, NULL, "Invalid scrypt parameters N=%lu r=%lu p=%lu", cost, r, p);
+			}
+			/*Memory check divides, so big limits do not overflow*/
+			if (cost > kdfMaxN || r > kdfMaxR || p > kdfMaxP
+				|| (uint64_t)r > kdfMaxMemory / 128 / ((uint64_t)cost + p + 2)){
+				THROW_EXCEPTION(0, Cipher, NULL, "scrypt parameters N=%lu r=%lu p=%lu exceed limits", cost, r, p);
+			}
+			break;
+		default:
+			THROW_EXCEPTION(0, Cipher, NULL, "Unknown key derivation method");
+		}
+
+		kdf = method;
+		kdfCost = cost;
+		kdfR = r;
+		kdfP = p;
+
+		if (hpass && kdf == KdfMethod::BYTES_TO_KEY){
+			deriveKey();
+		}
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Cipher, e, "Error set key derivation");
+	}
+}
+
+void Cipher::setKdfLimits(unsigned long maxIterations, unsigned long maxN, unsigned long maxR, unsigned long maxP, uint64_t maxMemory){
+	LOGGER_FN();
+
+	kdfMaxIterations = maxIterations;
+	kdfMaxN = maxN;
+	kdfMaxR = maxR;
+	kdfMaxP = maxP;
+	kdfMaxMemory = maxMemory;
+}
+
+void Cipher::setKdfCacheSize(size_t size){
+	LOGGER_FN();
+
+	KdfCache::get().setSize(size);
+}
+
+void Cipher::newSalt(){
+	LOGGER_FN();
+
+	/*Salt set by setSalt is kept as openssl enc -S does, encrypt allows it only for CBC*/
+	if (hsalt){
+		return;
+	}
+
+	LOGGER_OPENSSL(RAND_bytes);
+	if (RAND_bytes(salt, sizeof salt) <= 0){
+		THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error generate salt");
 	}
 }
 
+void Cipher::deriveKey(){
+	LOGGER_FN();
+
+	int keyLength = EVP_CIPHER_key_length(cipher);
+	int ivLength = EVP_CIPHER_iv_length(cipher);
+	int length = keyLength + ivLength;
+	unsigned char derived[EVP_MAX_KEY_LENGTH + EVP_MAX_IV_LENGTH];
+
+	if (kdf == KdfMethod::BYTES_TO_KEY){
+		LOGGER_OPENSSL(EVP_BytesToKey);
+		if (EVP_BytesToKey(cipher, dgst, salt, (unsigned char *)hpass, strlen(hpass), 1, key, iv) == 0){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "EVP_BytesToKey");
+		}
+		return;
+	}
+
+	/*Everything the result depends on*/
+	char params[128];
+	snprintf(params, sizeof params, "%d %lu %lu %lu %d %d", (int)kdf, kdfCost, kdfR, kdfP,
+		kdf == KdfMethod::PBKDF2 ? EVP_MD_type(dgst) : 0, length);
+
+	std::vector<std::string> parts;
+	parts.push_back(params);
+	parts.push_back(std::string((char *)salt, sizeof salt));
+	parts.push_back(hpass);
+	std::string id = KdfCache::makeId(parts);
+	OPENSSL_cleanse(&parts[2][0], parts[2].length());
+
+	if (!KdfCache::get().find(id, derived, length)){
+		switch (kdf){
+		case KdfMethod::PBKDF2:
+			LOGGER_OPENSSL(PKCS5_PBKDF2_HMAC);
+			if (!PKCS5_PBKDF2_HMAC(hpass, strlen(hpass), salt, sizeof salt, (int)kdfCost, dgst, length, derived)){
+				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "PKCS5_PBKDF2_HMAC");
+			}
+			break;
+		case KdfMethod::SCRYPT:
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+			LOGGER_OPENSSL(EVP_PBE_scrypt);
+			/*Parameters are checked against the limits in setKdf*/
+			if (!EVP_PBE_scrypt(hpass, strlen(hpass), salt, sizeof salt, kdfCost, kdfR, kdfP,
+				kdfMaxMemory, derived, length)){
+				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "EVP_PBE_scrypt");
+			}
+			break;
+#else
+			THROW_EXCEPTION(0, Cipher, NULL, "scrypt needs OpenSSL 1.1.0 or later");
+#endif
+		default:
+			THROW_EXCEPTION(0, Cipher, NULL, "Unknown key derivation method");
+		}
+
+		KdfCache::get().put(id, derived, length);
+	}
+
+	memcpy(key, derived, keyLength);
+	memcpy(iv, derived + keyLength, ivLength);
+	OPENSSL_cleanse(derived, sizeof derived);
+}
+
 void Cipher::setSalt(Handle<std::string> saltP){
 	LOGGER_FN();
 
@@ -625,7 +1035,16 @@ Handle<std::string> Cipher::getMode(){
 			temp = "cfb";
 		}
 		else if (EVP_CIPH_OFB_MODE == EVP_CIPHER_mode(cipher)){
-			temp == "ofb";
+			temp = "ofb";
+		}
+		else if (EVP_CIPH_CTR_MODE == EVP_CIPHER_mode(cipher)){
+			temp = "ctr";
+		}
+		else if (EVP_CIPH_GCM_MODE == EVP_CIPHER_mode(cipher)){
+			temp = "gcm";
+		}
+		else if (EVP_CIPH_STREAM_CIPHER == EVP_CIPHER_mode(cipher)){
+			temp = "stream";
 		}
 
 		Handle<std::string> res = new std::string(temp);
@@ -647,4 +1066,531 @@ Handle<std::string> Cipher::getDigestAlgorithm(){
 	else{
 		return NULL;
 	}
-}
\ No newline at end of file
+}
+
+bool Cipher::isAead(){
+	LOGGER_FN();
+
+	return (EVP_CIPHER_flags(cipher) & EVP_CIPH_FLAG_AEAD_CIPHER) != 0;
+}
+
+bool Cipher::isIvPerMessage(){
+	LOGGER_FN();
+
+	switch (EVP_CIPHER_mode(cipher)){
+	case EVP_CIPH_ECB_MODE:
+	case EVP_CIPH_CBC_MODE:
+		return false;
+	default:
+		return EVP_CIPHER_iv_length(cipher) > 0;
+	}
+}
+
+void Cipher::encryptAead(BIO *in, BIO *out){
+	LOGGER_FN();
+
+	EVP_CIPHER_CTX *actx = NULL;
+
+	try{
+		std::vector<unsigned char> inbuf(bsize), outbuf(bsize + EVP_MAX_BLOCK_LENGTH);
+		unsigned char tag[CIPHER_AEAD_TAG_LENGTH];
+		int outl;
+
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_new);
+		if ((actx = EVP_CIPHER_CTX_new()) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "EVP_CIPHER_CTX_new");
+		}
+
+		LOGGER_OPENSSL(EVP_EncryptInit_ex);
+		if (!EVP_EncryptInit_ex(actx, cipher, NULL, key, iv)){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error setting cipher");
+		}
+
+		for (;;) {
+			LOGGER_OPENSSL(BIO_read);
+			inl = BIO_read(in, (char *)&inbuf[0], bsize);
+			if (inl <= 0){
+				break;
+			}
+
+			LOGGER_OPENSSL(EVP_EncryptUpdate);
+			if (!EVP_EncryptUpdate(actx, &outbuf[0], &outl, &inbuf[0], inl)){
+				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "EVP_EncryptUpdate");
+			}
+
+			LOGGER_OPENSSL(BIO_write);
+			if (outl && BIO_write(out, (char *)&outbuf[0], outl) != outl){
+				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error writing output bio");
+			}
+		}
+
+		LOGGER_OPENSSL(EVP_EncryptFinal_ex);
+		if (!EVP_EncryptFinal_ex(actx, &outbuf[0], &outl)){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "EVP_EncryptFinal_ex");
+		}
+
+		LOGGER_OPENSSL(BIO_write);
+		if (outl && BIO_write(out, (char *)&outbuf[0], outl) != outl){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error writing output bio");
+		}
+
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_ctrl);
+		if (!EVP_CIPHER_CTX_ctrl(actx, CIPHER_CTRL_AEAD_GET_TAG, sizeof tag, tag)){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error get tag");
+		}
+
+		LOGGER_OPENSSL(BIO_write);
+		if (BIO_write(out, (char *)tag, sizeof tag) != sizeof tag){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error writing output bio");
+		}
+
+		LOGGER_OPENSSL(BIO_flush);
+		if (BIO_flush(out) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "BIO_flush");
+		}
+
+		EVP_CIPHER_CTX_free(actx);
+	}
+	catch (Handle<Exception> e){
+		EVP_CIPHER_CTX_free(actx);
+
+		THROW_EXCEPTION(0, Cipher, e, "Error encrypt AEAD");
+	}
+}
+
+void Cipher::decryptAead(BIO *in, BIO *out){
+	LOGGER_FN();
+
+	EVP_CIPHER_CTX *actx = NULL;
+
+	try{
+		/*Last CIPHER_AEAD_TAG_LENGTH bytes read so far may be the tag, they are kept at the beginning*/
+		std::vector<unsigned char> inbuf(CIPHER_AEAD_TAG_LENGTH + bsize), outbuf(bsize + EVP_MAX_BLOCK_LENGTH);
+		int held = 0;
+		int outl;
+
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_new);
+		if ((actx = EVP_CIPHER_CTX_new()) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "EVP_CIPHER_CTX_new");
+		}
+
+		LOGGER_OPENSSL(EVP_DecryptInit_ex);
+		if (!EVP_DecryptInit_ex(actx, cipher, NULL, key, iv)){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error setting cipher");
+		}
+
+		for (;;) {
+			LOGGER_OPENSSL(BIO_read);
+			inl = BIO_read(in, (char *)&inbuf[held], bsize);
+			if (inl <= 0){
+				break;
+			}
+
+			int avail = held + inl - CIPHER_AEAD_TAG_LENGTH;
+			if (avail <= 0){
+				held += inl;
+				continue;
+			}
+
+			LOGGER_OPENSSL(EVP_DecryptUpdate);
+			if (!EVP_DecryptUpdate(actx, &outbuf[0], &outl, &inbuf[0], avail)){
+				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "EVP_DecryptUpdate");
+			}
+
+			LOGGER_OPENSSL(BIO_write);
+			if (outl && BIO_write(out, (char *)&outbuf[0], outl) != outl){
+				THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error writing output bio");
+			}
+
+			memmove(&inbuf[0], &inbuf[avail], CIPHER_AEAD_TAG_LENGTH);
+			held = CIPHER_AEAD_TAG_LENGTH;
+		}
+
+		if (held != CIPHER_AEAD_TAG_LENGTH){
+			THROW_EXCEPTION(0, Cipher, NULL, "Authentication tag is missing");
+		}
+
+		LOGGER_OPENSSL(EVP_CIPHER_CTX_ctrl);
+		if (!EVP_CIPHER_CTX_ctrl(actx, CIPHER_CTRL_AEAD_SET_TAG, CIPHER_AEAD_TAG_LENGTH, &inbuf[0])){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error set tag");
+		}
+
+		LOGGER_OPENSSL(EVP_DecryptFinal_ex);
+		if (EVP_DecryptFinal_ex(actx, &outbuf[0], &outl) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "bad decrypt");
+		}
+
+		LOGGER_OPENSSL(BIO_write);
+		if (outl && BIO_write(out, (char *)&outbuf[0], outl) != outl){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error writing output bio");
+		}
+
+		LOGGER_OPENSSL(BIO_flush);
+		if (BIO_flush(out) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "BIO_flush");
+		}
+
+		EVP_CIPHER_CTX_free(actx);
+	}
+	catch (Handle<Exception> e){
+		EVP_CIPHER_CTX_free(actx);
+
+		THROW_EXCEPTION(0, Cipher, e, "Error decrypt AEAD");
+	}
+}
+
+void Cipher::setThreads(int count){
+	LOGGER_FN();
+
+	threads = count;
+}
+
+void Cipher::setChunkSize(size_t size){
+	LOGGER_FN();
+
+	if (size < CIPHER_CHUNK_MIN_SIZE || size > CIPHER_CHUNK_MAX_SIZE){
+		THROW_EXCEPTION(0, Cipher, NULL, "Chunk size must be from %d to %d", CIPHER_CHUNK_MIN_SIZE, CIPHER_CHUNK_MAX_SIZE);
+	}
+
+	chunkSize = size;
+}
+
+size_t Cipher::chunkThreads(){
+	LOGGER_FN();
+
+	size_t res = threads > 0 ? (size_t)threads : (size_t)std::thread::hardware_concurrency();
+
+	return res ? res : 1;
+}
+
+std::string Cipher::chunkHeader(){
+	LOGGER_FN();
+
+	if (!isAead() || EVP_CIPHER_iv_length(cipher) != CIPHER_CHUNK_NONCE_LENGTH){
+		THROW_EXCEPTION(0, Cipher, NULL, "Chunked format needs AEAD cipher with 12 bytes iv (aes-256-gcm)");
+	}
+
+	if (hpass == NULL && hkey == NULL){
+		THROW_EXCEPTION(0, Cipher, NULL, "Password or key undefined");
+	}
+
+	if (hpass){
+		newSalt();
+		deriveKey();
+	}
+
+	unsigned char fields[CIPHER_CHUNK_HEADER_LENGTH];
+	memcpy(fields, CIPHER_CHUNK_MAGIC, sizeof CIPHER_CHUNK_MAGIC - 1);
+	chunkPutUint(fields + sizeof CIPHER_CHUNK_MAGIC - 1, EVP_CIPHER_nid(cipher), 2);
+	fields[sizeof CIPHER_CHUNK_MAGIC + 1] = hpass ? CIPHER_CHUNK_FLAG_SALT : 0;
+	chunkPutUint(fields + sizeof CIPHER_CHUNK_MAGIC + 2, chunkSize, 4);
+
+	/*Chunk nonces of every container are new even with the same key*/
+	LOGGER_OPENSSL(RAND_bytes);
+	if (RAND_bytes(chunkNonce, sizeof chunkNonce) <= 0){
+		THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error generate nonce");
+	}
+	memcpy(fields + sizeof CIPHER_CHUNK_MAGIC + 6, chunkNonce, sizeof chunkNonce);
+
+	std::string res((char *)fields, sizeof fields);
+	if (hpass){
+		unsigned char params[CIPHER_CHUNK_SALT_LENGTH];
+		memcpy(params, salt, sizeof salt);
+		params[sizeof salt] = (unsigned char)kdf;
+		chunkPutUint(params + sizeof salt + 1, kdfCost, 4);
+		chunkPutUint(params + sizeof salt + 5, kdfR, 4);
+		chunkPutUint(params + sizeof salt + 9, kdfP, 4);
+		res.append((char *)params, sizeof params);
+	}
+
+	return res;
+}
+
+size_t Cipher::openChunkHeader(const std::string &header){
+	LOGGER_FN();
+
+	const unsigned char *fields = (const unsigned char *)header.data();
+
+	if (header.length() < CIPHER_CHUNK_HEADER_LENGTH || memcmp(fields, CIPHER_CHUNK_MAGIC, sizeof CIPHER_CHUNK_MAGIC - 1)){
+		THROW_EXCEPTION(0, Cipher, NULL, "bad magic number");
+	}
+
+	int nid = (int)chunkGetUint(fields + sizeof CIPHER_CHUNK_MAGIC - 1, 2);
+	int flags = fields[sizeof CIPHER_CHUNK_MAGIC + 1];
+	size_t size = (size_t)chunkGetUint(fields + sizeof CIPHER_CHUNK_MAGIC + 2, 4);
+	memcpy(chunkNonce, fields + sizeof CIPHER_CHUNK_MAGIC + 6, sizeof chunkNonce);
+
+	if (size < CIPHER_CHUNK_MIN_SIZE || size > CIPHER_CHUNK_MAX_SIZE){
+		THROW_EXCEPTION(0, Cipher, NULL, "Invalid chunk size");
+	}
+
+	if (flags & CIPHER_CHUNK_FLAG_SALT){
+		if (hpass == NULL){
+			THROW_EXCEPTION(0, Cipher, NULL, "Password undefined");
+		}
+
+		/*Cipher of password-encrypted data is known only from the header*/
+		LOGGER_OPENSSL(EVP_get_cipherbynid);
+		if ((cipher = EVP_get_cipherbynid(nid)) == NULL){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Unknown cipher %d", nid);
+		}
+
+		if (header.length() < CIPHER_CHUNK_HEADER_LENGTH + CIPHER_CHUNK_SALT_LENGTH){
+			THROW_EXCEPTION(0, Cipher, NULL, "Salt is missing");
+		}
+
+		const unsigned char *params = fields + CIPHER_CHUNK_HEADER_LENGTH;
+		memcpy(salt, params, sizeof salt);
+		setKdf(KdfMethod::get(params[sizeof salt]), (unsigned long)chunkGetUint(params + sizeof salt + 1, 4),
+			(unsigned long)chunkGetUint(params + sizeof salt + 5, 4), (unsigned long)chunkGetUint(params + sizeof salt + 9, 4));
+		deriveKey();
+	}
+	else if (hkey == NULL){
+		THROW_EXCEPTION(0, Cipher, NULL, "key undefined");
+	}
+	else if (nid != EVP_CIPHER_nid(cipher)){
+		THROW_EXCEPTION(0, Cipher, NULL, "Data is encrypted with %s", OBJ_nid2sn(nid));
+	}
+
+	if (!isAead() || EVP_CIPHER_iv_length(cipher) != CIPHER_CHUNK_NONCE_LENGTH){
+		THROW_EXCEPTION(0, Cipher, NULL, "Chunked format needs AEAD cipher with 12 bytes iv");
+	}
+
+	return size;
+}
+
+void Cipher::openChunks(const std::string &header, uint64_t first, size_t count, size_t size, size_t last,
+	unsigned char *data, BIO *out, size_t skip, size_t limit){
+	LOGGER_FN();
+
+	size_t record = size + CIPHER_AEAD_TAG_LENGTH;
+	std::vector<char> ok(count);
+
+	chunkParallel(chunkThreads(), count, [&](size_t i) {
+		size_t len = i + 1 == count ? last : size;
+		ok[i] = chunkCrypt(cipher, key, chunkNonce, first + i, header, data + i * record, len, data + i * record + len, 0);
+	});
+
+	for (size_t i = 0; i < count; i++){
+		if (!ok[i]){
+			THROW_EXCEPTION(0, Cipher, NULL, "bad decrypt, chunk %llu", (unsigned long long)(first + i));
+		}
+
+		size_t len = i + 1 == count ? last : size;
+		if (skip >= len){
+			skip -= len;
+			continue;
+		}
+
+		size_t n = len - skip < limit ? len - skip : limit;
+		chunkWrite(out, data + i * record + skip, n);
+		limit -= n;
+		skip = 0;
+	}
+}
+
+void Cipher::checkChunkIndex(const std::string &header, const unsigned char *index, uint64_t plainSize, uint64_t count){
+	LOGGER_FN();
+
+	unsigned char tag[CIPHER_AEAD_TAG_LENGTH];
+	memcpy(tag, index + 16, sizeof tag);
+
+	if (!chunkCrypt(cipher, key, chunkNonce, CIPHER_CHUNK_INDEX, header + std::string((const char *)index, 16), NULL, 0, tag, 0)){
+		THROW_EXCEPTION(0, Cipher, NULL, "bad decrypt, index");
+	}
+
+	if (chunkGetUint(index, 8) != plainSize || chunkGetUint(index + 8, 8) != count){
+		THROW_EXCEPTION(0, Cipher, NULL, "Data is truncated or reordered");
+	}
+}
+
+void Cipher::encryptChunked(Handle<Bio> inSource, Handle<Bio> outEnc){
+	LOGGER_FN();
+
+	try{
+		BIO *in = inSource->internal();
+		BIO *out = outEnc->internal();
+		std::string header = chunkHeader();
+		size_t threadCount = chunkThreads();
+		size_t batch = threadCount * CIPHER_CHUNK_BATCH;
+		size_t record = chunkSize + CIPHER_AEAD_TAG_LENGTH;
+		std::vector<unsigned char> data(batch * record);
+		std::vector<size_t> lengths(batch);
+		std::vector<char> ok(batch);
+		uint64_t count = 0, plainSize = 0;
+		bool eof = false;
+
+		chunkWrite(out, (const unsigned char *)header.data(), header.length());
+
+		while (!eof){
+			size_t n = 0;
+			while (n < batch && !eof){
+				lengths[n] = chunkRead(in, &data[n * record], chunkSize);
+				eof = lengths[n] < chunkSize;
+				if (lengths[n]){
+					n++;
+				}
+			}
+
+			chunkParallel(threadCount, n, [&](size_t i) {
+				ok[i] = chunkCrypt(cipher, key, chunkNonce, count + i, header, &data[i * record], lengths[i], &data[i * record + lengths[i]], 1);
+			});
+
+			for (size_t i = 0; i < n; i++){
+				if (!ok[i]){
+					THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error encrypt chunk");
+				}
+				chunkWrite(out, &data[i * record], lengths[i] + CIPHER_AEAD_TAG_LENGTH);
+				plainSize += lengths[i];
+			}
+			count += n;
+		}
+
+		unsigned char index[CIPHER_CHUNK_INDEX_LENGTH];
+		chunkPutUint(index, plainSize, 8);
+		chunkPutUint(index + 8, count, 8);
+		if (!chunkCrypt(cipher, key, chunkNonce, CIPHER_CHUNK_INDEX, header + std::string((char *)index, 16), NULL, 0, index + 16, 1)){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "Error encrypt index");
+		}
+		chunkWrite(out, index, sizeof index);
+
+		LOGGER_OPENSSL(BIO_flush);
+		if (BIO_flush(out) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "BIO_flush");
+		}
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Cipher, e, "Error encrypt chunked");
+	}
+}
+
+void Cipher::decryptChunked(Handle<Bio> inEnc, Handle<Bio> outDec){
+	LOGGER_FN();
+
+	try{
+		BIO *in = inEnc->internal();
+		BIO *out = outDec->internal();
+
+		std::string header(CIPHER_CHUNK_HEADER_LENGTH, 0);
+		if (chunkRead(in, (unsigned char *)&header[0], header.length()) != header.length()){
+			THROW_EXCEPTION(0, Cipher, NULL, "error reading input file");
+		}
+		if (header[sizeof CIPHER_CHUNK_MAGIC + 1] & CIPHER_CHUNK_FLAG_SALT){
+			header.resize(CIPHER_CHUNK_HEADER_LENGTH + CIPHER_CHUNK_SALT_LENGTH);
+			if (chunkRead(in, (unsigned char *)&header[CIPHER_CHUNK_HEADER_LENGTH], CIPHER_CHUNK_SALT_LENGTH) != CIPHER_CHUNK_SALT_LENGTH){
+				THROW_EXCEPTION(0, Cipher, NULL, "error reading input file");
+			}
+		}
+
+		size_t size = openChunkHeader(header);
+		size_t record = size + CIPHER_AEAD_TAG_LENGTH;
+		size_t batch = chunkThreads() * CIPHER_CHUNK_BATCH;
+
+		/*The index is always kept back until the end of data*/
+		std::vector<unsigned char> data(batch * record + CIPHER_CHUNK_INDEX_LENGTH);
+		size_t have = 0;
+		uint64_t count = 0, plainSize = 0;
+
+		for (bool eof = false; !eof;){
+			have += chunkRead(in, &data[have], data.size() - have);
+			eof = have < data.size();
+
+			if (have < CIPHER_CHUNK_INDEX_LENGTH){
+				THROW_EXCEPTION(0, Cipher, NULL, "Data is truncated");
+			}
+
+			size_t avail = have - CIPHER_CHUNK_INDEX_LENGTH;
+			size_t n = eof ? (avail + record - 1) / record : avail / record;
+			size_t last = n ? avail - (n - 1) * record : 0;
+			if (n && last <= CIPHER_AEAD_TAG_LENGTH){
+				THROW_EXCEPTION(0, Cipher, NULL, "Data is truncated");
+			}
+			last -= n ? CIPHER_AEAD_TAG_LENGTH : 0;
+
+			openChunks(header, count, n, size, last, &data[0], out, 0, (size_t)-1);
+			count += n;
+			plainSize += n ? (n - 1) * size + last : 0;
+
+			if (eof){
+				checkChunkIndex(header, &data[avail], plainSize, count);
+			}
+			else{
+				memmove(&data[0], &data[n * record], have - n * record);
+				have -= n * record;
+			}
+		}
+
+		LOGGER_OPENSSL(BIO_flush);
+		if (BIO_flush(out) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "BIO_flush");
+		}
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Cipher, e, "Error decrypt chunked");
+	}
+}
+
+void Cipher::decryptChunkedRange(Handle<Bio> inEnc, Handle<Bio> outDec, uint64_t offset, uint64_t length){
+	LOGGER_FN();
+
+	try{
+		BIO *in = inEnc->internal();
+		BIO *out = outDec->internal();
+		uint64_t total = chunkBioSize(in);
+
+		std::string header(CIPHER_CHUNK_HEADER_LENGTH, 0);
+		if (total < header.length() + CIPHER_CHUNK_INDEX_LENGTH){
+			THROW_EXCEPTION(0, Cipher, NULL, "Data is truncated");
+		}
+		chunkReadAt(in, 0, (unsigned char *)&header[0], header.length());
+		if (header[sizeof CIPHER_CHUNK_MAGIC + 1] & CIPHER_CHUNK_FLAG_SALT){
+			header.resize(CIPHER_CHUNK_HEADER_LENGTH + CIPHER_CHUNK_SALT_LENGTH);
+			chunkReadAt(in, CIPHER_CHUNK_HEADER_LENGTH, (unsigned char *)&header[CIPHER_CHUNK_HEADER_LENGTH], CIPHER_CHUNK_SALT_LENGTH);
+		}
+
+		size_t size = openChunkHeader(header);
+		size_t record = size + CIPHER_AEAD_TAG_LENGTH;
+
+		/*Sizes come from the authenticated index*/
+		unsigned char index[CIPHER_CHUNK_INDEX_LENGTH];
+		chunkReadAt(in, total - sizeof index, index, sizeof index);
+		uint64_t plainSize = chunkGetUint(index, 8);
+		uint64_t count = chunkGetUint(index + 8, 8);
+		checkChunkIndex(header, index, plainSize, count);
+
+		if (count != (plainSize + size - 1) / size || total != header.length() + plainSize + count * CIPHER_AEAD_TAG_LENGTH + sizeof index){
+			THROW_EXCEPTION(0, Cipher, NULL, "Data is truncated");
+		}
+
+		if (offset < plainSize && length){
+			uint64_t end = length < plainSize - offset ? offset + length : plainSize;
+			uint64_t first = offset / size;
+			uint64_t stop = (end - 1) / size + 1;
+			size_t batch = chunkThreads() * CIPHER_CHUNK_BATCH;
+			std::vector<unsigned char> data((size_t)(batch < stop - first ? batch : stop - first) * record);
+			size_t skip = (size_t)(offset - first * size);
+
+			for (uint64_t i = first; i < stop;){
+				size_t n = (size_t)(stop - i < batch ? stop - i : batch);
+				size_t last = i + n == count ? (size_t)(plainSize - (count - 1) * size) : size;
+				uint64_t pos = header.length() + i * record;
+				size_t len = (n - 1) * record + last + CIPHER_AEAD_TAG_LENGTH;
+				size_t limit = (size_t)(end - i * size) - skip;
+
+				chunkReadAt(in, pos, &data[0], len);
+				openChunks(header, i, n, size, last, &data[0], out, skip, limit);
+
+				i += n;
+				skip = 0;
+			}
+		}
+
+		LOGGER_OPENSSL(BIO_flush);
+		if (BIO_flush(out) <= 0){
+			THROW_OPENSSL_EXCEPTION(0, Cipher, NULL, "BIO_flush");
+		}
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Cipher, e, "Error decrypt chunked range");
+	}
+}
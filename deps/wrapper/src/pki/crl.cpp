@@ -6,37 +6,50 @@ void CRL::read(Handle<Bio> in, DataFormat::DATA_FORMAT format) {
 	LOGGER_FN();
 
 	try{
-		if (in.isEmpty()){
-			THROW_EXCEPTION(0, CRL, NULL, ERROR_PARAMETER_NULL, 1);
-		}
-			
-		X509_CRL *crl = NULL;
-
-		switch (format){
-		case DataFormat::BASE64:
-			LOGGER_OPENSSL("PEM_read_bio_X509_CRL");
-			crl = PEM_read_bio_X509_CRL(in->internal(), NULL, NULL, NULL);
-			if (!crl){
+		if (!this->tryRead(in, format)){
+			if (format == DataFormat::BASE64){
 				THROW_EXCEPTION(0, CRL, NULL, ERROR_CRL_BAD_PEM_INPUT_DATA);
-			}				
-			break;
-		case DataFormat::DER:
-			LOGGER_OPENSSL("d2i_X509_CRL_bio");
-			crl = d2i_X509_CRL_bio(in->internal(), NULL);
-			if (!crl){
-				THROW_EXCEPTION(0, CRL, NULL, ERROR_CRL_BAD_DIR_INPUT_DATA);
-			}				
-			break;
-		default:
-			THROW_EXCEPTION(0, CRL, NULL, ERROR_DATA_FORMAT_UNKNOWN_FORMAT, format);
+			}
+			THROW_EXCEPTION(0, CRL, NULL, ERROR_CRL_BAD_DIR_INPUT_DATA);
 		}
-		this->setData(crl);
 	}
 	catch (Handle<Exception> e){
 		THROW_EXCEPTION(0, CRL, e, "Error read CRL");
 	}	
 }
 
+bool CRL::tryRead(Handle<Bio> in, DataFormat::DATA_FORMAT format) {
+	LOGGER_FN();
+
+	if (in.isEmpty()){
+		THROW_EXCEPTION(0, CRL, NULL, ERROR_PARAMETER_NULL, 1);
+	}
+
+	X509_CRL *crl = NULL;
+
+	switch (format){
+	case DataFormat::BASE64:
+		LOGGER_OPENSSL("PEM_read_bio_X509_CRL");
+		crl = PEM_read_bio_X509_CRL(in->internal(), NULL, NULL, NULL);
+		break;
+	case DataFormat::DER:
+		LOGGER_OPENSSL("d2i_X509_CRL_bio");
+		crl = d2i_X509_CRL_bio(in->internal(), NULL);
+		break;
+	default:
+		THROW_EXCEPTION(0, CRL, NULL, ERROR_DATA_FORMAT_UNKNOWN_FORMAT, format);
+	}
+
+	if (!crl){
+		LOGGER_OPENSSL("ERR_clear_error");
+		ERR_clear_error();
+		return false;
+	}
+
+	this->setData(crl);
+	return true;
+}
+
 void CRL::write(Handle<Bio> out, DataFormat::DATA_FORMAT format) {
 	LOGGER_FN();
 
@@ -48,13 +61,13 @@ void CRL::write(Handle<Bio> out, DataFormat::DATA_FORMAT format) {
 		switch (format){
 		case DataFormat::DER:
 			LOGGER_OPENSSL(i2d_X509_CRL_bio);
-			if (!i2d_X509_CRL_bio(out->internal(), this->internal())){
+			if (!i2d_X509_CRL_bio(out->internal(), this->raw())){
 				THROW_OPENSSL_EXCEPTION(0, CRL, NULL, "i2d_X509_CRL_bio");
 			}				
 			break;
 		case DataFormat::BASE64:
 			LOGGER_OPENSSL(PEM_write_bio_X509_CRL);
-			if (!PEM_write_bio_X509_CRL(out->internal(), this->internal())){
+			if (!PEM_write_bio_X509_CRL(out->internal(), this->raw())){
 				THROW_OPENSSL_EXCEPTION(0, CRL, NULL, "PEM_write_bio_X509_CRL");
 			}				
 			break;
@@ -72,7 +85,7 @@ Handle<CRL> CRL::duplicate(){
 	try{
 		X509_CRL *crl = NULL;
 		LOGGER_OPENSSL(X509_CRL_dup);
-		crl = X509_CRL_dup(this->internal());
+		crl = X509_CRL_dup(this->raw());
 		if (!crl){
 			THROW_OPENSSL_EXCEPTION(0, CRL, NULL, "X509_CRL_dup");
 		}
@@ -87,7 +100,7 @@ int CRL::equals(Handle<CRL> crl){
 	LOGGER_FN();
 	try{
 		LOGGER_OPENSSL(X509_CRL_cmp);
-		if (X509_CRL_cmp(this->internal(), crl->internal()) == 0){
+		if (X509_CRL_cmp(this->raw(), crl->raw()) == 0){
 			return 0;
 		}
 		else{
@@ -103,7 +116,7 @@ int CRL::compare(Handle<CRL> crl){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_CRL_cmp);
-	int res = X509_CRL_cmp(this->internal(), crl->internal());
+	int res = X509_CRL_cmp(this->raw(), crl->raw());
 
 	return res;
 }
@@ -130,15 +143,47 @@ Handle<std::string> CRL::hash(Handle<std::string> algorithm){
 Handle<std::string> CRL::hash(const EVP_MD *md) {
 	LOGGER_FN();
 
+	std::vector<const EVP_MD *> mds;
+	mds.push_back(md);
+
+	return this->hashes(mds)[0];
+}
+
+std::vector<Handle<std::string> > CRL::hashes(std::vector<Handle<std::string> > algorithms){
+	LOGGER_FN();
+
+	std::vector<const EVP_MD *> mds;
+	for (size_t i = 0; i < algorithms.size(); i++) {
+		LOGGER_OPENSSL(EVP_get_digestbyname);
+		const EVP_MD *md = EVP_get_digestbyname(algorithms[i]->c_str());
+		if (!md) {
+			THROW_OPENSSL_EXCEPTION(0, CRL, NULL, "EVP_get_digestbyname '%s'", algorithms[i]->c_str());
+		}
+		mds.push_back(md);
+	}
+
+	return this->hashes(mds);
+}
+
+std::vector<Handle<std::string> > CRL::hashes(std::vector<const EVP_MD *> mds) {
+	LOGGER_FN();
+
+	std::vector<Handle<std::string> > res;
+
+	//DER is encoded once and shared by all digests
+	Handle<std::string> der = this->getEncoded();
+
 	unsigned char hash[EVP_MAX_MD_SIZE] = { 0 };
 	unsigned int hashlen = 0;
 
-	LOGGER_OPENSSL(X509_CRL_digest);
-	if (!X509_CRL_digest(this->internal(), md, hash, &hashlen)) {
-		THROW_OPENSSL_EXCEPTION(0, CRL, NULL, "X509_CRL_digest");
-	}
+	for (size_t i = 0; i < mds.size(); i++) {
+		LOGGER_OPENSSL(EVP_Digest);
+		if (!EVP_Digest(der->c_str(), der->length(), hash, &hashlen, mds[i], NULL)) {
+			THROW_OPENSSL_EXCEPTION(0, CRL, NULL, "EVP_Digest");
+		}
 
-	Handle<std::string> res = new std::string((char *)hash, hashlen);
+		res.push_back(new std::string((char *)hash, hashlen));
+	}
 
 	return res;
 }
@@ -148,7 +193,7 @@ long CRL::getVersion()
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_CRL_get_version);
-	long ver = X509_CRL_get_version(this->internal());
+	long ver = X509_CRL_get_version(this->raw());
 
 	return ver;
 }
@@ -158,7 +203,7 @@ Handle<std::string> CRL::getSigAlgName(){
 
 	try{
 		LOGGER_OPENSSL(OBJ_obj2nid);
-		int pkey_nid = OBJ_obj2nid(this->internal()->sig_alg->algorithm);
+		int pkey_nid = OBJ_obj2nid(this->raw()->sig_alg->algorithm);
 
 		if (pkey_nid == NID_undef) {
 			THROW_EXCEPTION(0, CRL, NULL, "Can not get key nid");
@@ -181,7 +226,7 @@ Handle<std::string> CRL::getSigAlgShortName(){
 
 	try{
 		LOGGER_OPENSSL(OBJ_obj2nid);
-		int pkey_nid = OBJ_obj2nid(this->internal()->sig_alg->algorithm);
+		int pkey_nid = OBJ_obj2nid(this->raw()->sig_alg->algorithm);
 		if (pkey_nid == NID_undef) {
 			THROW_EXCEPTION(0, CRL, NULL, "Can not get key nid");
 		}
@@ -205,7 +250,7 @@ Handle<std::string> CRL::getSigAlgOID(){
 		char buf[100];
 		LOGGER_OPENSSL(OBJ_obj2txt);
 		int bufLen = 0;
-		if ((bufLen = OBJ_obj2txt(buf, 100, this->internal()->sig_alg->algorithm, 1)) <= 0){
+		if ((bufLen = OBJ_obj2txt(buf, 100, this->raw()->sig_alg->algorithm, 1)) <= 0){
 			THROW_OPENSSL_EXCEPTION(0, Algorithm, NULL, "OBJ_obj2txt");
 		}
 			
@@ -223,7 +268,7 @@ Handle<std::string> CRL::issuerName()
 	
 
 	LOGGER_OPENSSL(X509_CRL_get_issuer);
-	X509_NAME *name = X509_CRL_get_issuer(this->internal());
+	X509_NAME *name = X509_CRL_get_issuer(this->raw());
 	if (!name)
 		THROW_EXCEPTION(1, CRL, NULL, "X509_NAME is NULL");
 
@@ -243,7 +288,7 @@ Handle<std::string> CRL::issuerFriendlyName()
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_get_issuer_name);
-	return GetCommonName(X509_CRL_get_issuer(this->internal()));
+	return GetCommonName(X509_CRL_get_issuer(this->raw()));
 }
 
 Handle<std::string> CRL::GetCommonName(X509_NAME *a){
@@ -286,7 +331,7 @@ Handle<std::string> CRL::getEncoded(){
 		LOGGER_OPENSSL(BIO_new);
 		BIO * bio_out = BIO_new(BIO_s_mem());
 		LOGGER_OPENSSL(i2d_X509_CRL_bio);
-		if (!i2d_X509_CRL_bio(bio_out, this->internal())){
+		if (!i2d_X509_CRL_bio(bio_out, this->raw())){
 			THROW_OPENSSL_EXCEPTION(0, CRL, NULL, "i2d_X509_CRL_bio");
 		}
 		BUF_MEM *bio_buf;
@@ -307,7 +352,7 @@ Handle<std::string> CRL::getSignature(){
 	LOGGER_FN();
 
 	try{
-		std::string sslbuf = std::string((char *)(this->internal()->signature)->data, (this->internal()->signature)->length);
+		std::string sslbuf = std::string((char *)(this->raw()->signature)->data, (this->raw()->signature)->length);
 		Handle<std::string> res = new std::string(sslbuf.c_str(), sslbuf.length());
 
 		return res;
@@ -321,7 +366,7 @@ Handle<std::string> CRL::getNextUpdate(){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_CRL_get_nextUpdate);
-	ASN1_TIME *time = X509_CRL_get_nextUpdate(this->internal());
+	ASN1_TIME *time = X509_CRL_get_nextUpdate(this->raw());
 	return ASN1_TIME_toString(time);
 }
 
@@ -329,7 +374,7 @@ Handle<std::string> CRL::getThisUpdate(){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_CRL_get_lastUpdate);
-	ASN1_TIME *time = X509_CRL_get_lastUpdate(this->internal());
+	ASN1_TIME *time = X509_CRL_get_lastUpdate(this->raw());
 	return ASN1_TIME_toString(time);
 }
 
@@ -337,5 +382,5 @@ Handle<RevokedCollection> CRL::getRevoked(){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL(X509_CRL_get_REVOKED);
-	return new RevokedCollection(X509_CRL_get_REVOKED(this->internal()), this->handle());
+	return new RevokedCollection(X509_CRL_get_REVOKED(this->raw()), this->handle());
 }
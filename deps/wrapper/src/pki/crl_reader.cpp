@@ -0,0 +1,779 @@
+#include "../stdafx.h"
+
+#include "wrapper/pki/crl_reader.h"
+#include "wrapper/common/mapped_file.h"
+
+#define CRL_READER_PEM_BEGIN "-----BEGIN X509 CRL-----"
+
+#define TAG_SEQUENCE (V_ASN1_SEQUENCE | V_ASN1_CONSTRUCTED)
+#define TAG_EXTENSIONS (V_ASN1_CONTEXT_SPECIFIC | V_ASN1_CONSTRUCTED | 0)
+
+/* id-ce-reasonCode 2.5.29.21 */
+static const unsigned char oidReasonCode[] = { 0x55, 0x1D, 0x15 };
+/* id-ce-cRLNumber 2.5.29.20 */
+static const unsigned char oidCrlNumber[] = { 0x55, 0x1D, 0x14 };
+/* id-ce-deltaCRLIndicator 2.5.29.27 */
+static const unsigned char oidDeltaCrlIndicator[] = { 0x55, 0x1D, 0x1B };
+/* id-ce-freshestCRL 2.5.29.46 */
+static const unsigned char oidFreshestCrl[] = { 0x55, 0x1D, 0x2E };
+
+/* Days since 1970-01-01 for a proleptic Gregorian date */
+static int64_t daysFromCivil(int y, int m, int d) {
+	y -= m <= 2;
+	const int64_t era = (y >= 0 ? y : y - 399) / 400;
+	const int yoe = (int)(y - era * 400);
+	const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+	return era * 146097 + doe - 719468;
+}
+
+static int digits(const unsigned char *p, int count) {
+	int res = 0;
+
+	for (int i = 0; i < count; i++) {
+		if (p[i] < '0' || p[i] > '9') {
+			return -1;
+		}
+		res = res * 10 + (p[i] - '0');
+	}
+
+	return res;
+}
+
+/* UTCTime YYMMDDHHMMSSZ or GeneralizedTime YYYYMMDDHHMMSS[.f]Z */
+static time_t asn1TimeToUnix(int tag, const unsigned char *p, size_t length) {
+	int year;
+
+	if (tag == V_ASN1_UTCTIME && length >= 13) {
+		year = digits(p, 2);
+		year += year < 50 ? 2000 : 1900;
+		p += 2;
+	}
+	else if (tag == V_ASN1_GENERALIZEDTIME && length >= 15) {
+		year = digits(p, 4);
+		p += 4;
+	}
+	else {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Unsupported time format");
+	}
+
+	int month = digits(p, 2);
+	int day = digits(p + 2, 2);
+	int hour = digits(p + 4, 2);
+	int minute = digits(p + 6, 2);
+	int second = digits(p + 8, 2);
+
+	if (year < 0 || month < 1 || month > 12 || day < 1 || day > 31 || hour < 0 || minute < 0 || second < 0) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Wrong time value");
+	}
+
+	return (time_t)(daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second);
+}
+
+/* Reads one TLV from memory. p is moved past the element */
+static bool readTlv(const unsigned char *&p, const unsigned char *end, int &tag, const unsigned char *&content, size_t &length) {
+	if (end - p < 2) {
+		return false;
+	}
+
+	tag = p[0];
+	size_t len = p[1];
+	p += 2;
+
+	if (len & 0x80) {
+		int count = len & 0x7F;
+		if (count == 0 || count > 4 || end - p < count) {
+			return false;
+		}
+		len = 0;
+		for (int i = 0; i < count; i++) {
+			len = (len << 8) | *p++;
+		}
+	}
+
+	if ((size_t)(end - p) < len) {
+		return false;
+	}
+
+	content = p;
+	length = len;
+	p += len;
+
+	return true;
+}
+
+/* Reads next Extension of a list. value is the content of extnValue */
+static bool readExtension(const unsigned char *&p, const unsigned char *end, const unsigned char *&oid, size_t &oidLength, const unsigned char *&value, size_t &valueLength) {
+	const unsigned char *content;
+	size_t length;
+	int tag;
+
+	if (!readTlv(p, end, tag, content, length) || tag != TAG_SEQUENCE) {
+		return false;
+	}
+
+	const unsigned char *q = content;
+	const unsigned char *qEnd = content + length;
+
+	if (!readTlv(q, qEnd, tag, oid, oidLength) || tag != V_ASN1_OBJECT) {
+		return false;
+	}
+
+	/* critical BOOLEAN DEFAULT FALSE */
+	if (!readTlv(q, qEnd, tag, value, valueLength)) {
+		return false;
+	}
+	if (tag == V_ASN1_BOOLEAN && !readTlv(q, qEnd, tag, value, valueLength)) {
+		return false;
+	}
+
+	return tag == V_ASN1_OCTET_STRING;
+}
+
+static bool isOid(const unsigned char *oid, size_t length, const unsigned char *expected, size_t expectedLength) {
+	return length == expectedLength && !memcmp(oid, expected, length);
+}
+
+/* INTEGER inside extnValue as big-endian bytes without leading zeros */
+static std::string readNumber(const unsigned char *value, size_t length) {
+	const unsigned char *content;
+	size_t contentLength;
+	int tag;
+
+	if (!readTlv(value, value + length, tag, content, contentLength) || tag != V_ASN1_INTEGER) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Wrong CRL number");
+	}
+
+	while (contentLength > 0 && content[0] == 0) {
+		content++;
+		contentLength--;
+	}
+
+	return std::string((const char *)content, contentLength);
+}
+
+/* URIs of full names from CRLDistributionPoints */
+static void readDistPoints(const unsigned char *value, size_t length, std::vector<std::string> &urls) {
+	LOGGER_OPENSSL(d2i_CRL_DIST_POINTS);
+	STACK_OF(DIST_POINT) *points = d2i_CRL_DIST_POINTS(NULL, &value, (long)length);
+	if (!points) {
+		THROW_OPENSSL_EXCEPTION(0, CrlReader, NULL, "d2i_CRL_DIST_POINTS");
+	}
+
+	for (int i = 0; i < sk_DIST_POINT_num(points); i++) {
+		DIST_POINT *point = sk_DIST_POINT_value(points, i);
+		if (!point->distpoint || point->distpoint->type != 0) {
+			continue;
+		}
+
+		STACK_OF(GENERAL_NAME) *names = point->distpoint->name.fullname;
+		for (int j = 0; j < sk_GENERAL_NAME_num(names); j++) {
+			GENERAL_NAME *name = sk_GENERAL_NAME_value(names, j);
+			if (name->type == GEN_URI) {
+				ASN1_IA5STRING *uri = name->d.uniformResourceIdentifier;
+				urls.push_back(std::string((const char *)uri->data, uri->length));
+			}
+		}
+	}
+
+	sk_DIST_POINT_pop_free(points, DIST_POINT_free);
+}
+
+/*
+ * Buffered DER walker over a BIO. Consumed bytes of tbsCertList are
+ * passed to the verify context in blocks, not per element
+ */
+class CrlReaderStream {
+public:
+	/* inputSize is an upper bound of the DER size, CRL_READER_SIZE_UNKNOWN if not known */
+	CrlReaderStream(BIO *in, Handle<Certificate> issuer, uint64_t inputSize)
+		: in_(in), issuer_(issuer), inputSize_(inputSize), buffer_(CRL_READER_BUFFER_SIZE), pos_(0), end_(0), offset_(0),
+		hashing_(false), hashMark_(0), mctx_(NULL), pkey_(NULL)
+	{
+	}
+
+	~CrlReaderStream() {
+		if (this->mctx_) {
+			EVP_MD_CTX_destroy(this->mctx_);
+		}
+		if (this->pkey_) {
+			EVP_PKEY_free(this->pkey_);
+		}
+	}
+
+	Handle<RevocationIndex> parse();
+
+protected:
+	/* Makes at least count bytes available at data() */
+	void fill(size_t count) {
+		if (this->end_ - this->pos_ >= count) {
+			return;
+		}
+
+		this->flushHash();
+		if (this->pos_) {
+			memmove(&this->buffer_[0], &this->buffer_[this->pos_], this->end_ - this->pos_);
+			this->end_ -= this->pos_;
+			this->pos_ = 0;
+			this->hashMark_ = 0;
+		}
+		if (this->buffer_.size() < count) {
+			this->buffer_.resize(count);
+		}
+
+		while (this->end_ < count) {
+			int n = BIO_read(this->in_, &this->buffer_[this->end_], (int)(this->buffer_.size() - this->end_));
+			if (n <= 0) {
+				THROW_EXCEPTION(0, CrlReader, NULL, "Unexpected end of CRL data");
+			}
+			this->end_ += n;
+		}
+	}
+
+	const unsigned char *data() {
+		return &this->buffer_[this->pos_];
+	}
+
+	void skip(size_t count) {
+		this->pos_ += count;
+		this->offset_ += count;
+	}
+
+	/*
+	 * Reads tag and length of the next element without consuming it.
+	 * The element must end within limit (end offset of the enclosing element)
+	 * and within the input, so a crafted length can not make fill() allocate it
+	 */
+	void peek(int &tag, size_t &length, size_t &headerLength, uint64_t limit) {
+		this->fill(2);
+
+		const unsigned char *p = this->data();
+		tag = p[0];
+		length = p[1];
+		headerLength = 2;
+
+		if (length & 0x80) {
+			int count = length & 0x7F;
+			if (count == 0 || count > 4) {
+				THROW_EXCEPTION(0, CrlReader, NULL, "Unsupported DER length");
+			}
+
+			this->fill(2 + count);
+			p = this->data();
+			length = 0;
+			for (int i = 0; i < count; i++) {
+				length = (length << 8) | p[2 + i];
+			}
+			headerLength += count;
+		}
+
+		uint64_t end = this->offset_ + headerLength + length;
+		if (end > limit || end > this->inputSize_) {
+			THROW_EXCEPTION(0, CrlReader, NULL, "DER length %lu at offset %lu exceeds the enclosing element",
+				(unsigned long)length, (unsigned long)this->offset_);
+		}
+	}
+
+	/* Consumes header of a constructed element, returns offset of its end */
+	uint64_t enter(int expected, uint64_t limit) {
+		int tag;
+		size_t length, headerLength;
+
+		this->peek(tag, length, headerLength, limit);
+		if (tag != expected) {
+			THROW_EXCEPTION(0, CrlReader, NULL, "Unexpected tag 0x%02X, expected 0x%02X", tag, expected);
+		}
+		this->skip(headerLength);
+
+		return this->offset_ + length;
+	}
+
+	/* Makes the whole next element available and consumes it */
+	const unsigned char *element(int &tag, size_t &total, uint64_t limit) {
+		size_t length, headerLength;
+
+		this->peek(tag, length, headerLength, limit);
+		total = headerLength + length;
+		if (total > CRL_READER_MAX_ELEMENT) {
+			THROW_EXCEPTION(0, CrlReader, NULL, "DER element of %lu bytes at offset %lu is too large",
+				(unsigned long)total, (unsigned long)this->offset_);
+		}
+		this->fill(total);
+
+		const unsigned char *res = this->data();
+		this->skip(total);
+
+		return res;
+	}
+
+	void startHash() {
+		this->hashing_ = true;
+		this->hashMark_ = this->pos_;
+	}
+
+	void stopHash() {
+		this->flushHash();
+		this->hashing_ = false;
+	}
+
+	void flushHash() {
+		if (!this->hashing_ || this->pos_ == this->hashMark_) {
+			return;
+		}
+
+		const unsigned char *p = &this->buffer_[this->hashMark_];
+		size_t count = this->pos_ - this->hashMark_;
+
+		if (this->mctx_) {
+			if (EVP_DigestVerifyUpdate(this->mctx_, p, count) != 1) {
+				THROW_OPENSSL_EXCEPTION(0, CrlReader, NULL, "EVP_DigestVerifyUpdate");
+			}
+		}
+		else {
+			this->pending_.append((const char *)p, count);
+		}
+		this->hashMark_ = this->pos_;
+	}
+
+	void initVerify(const unsigned char *alg, size_t length);
+	void checkIssuer(const unsigned char *name, size_t length);
+	void parseEntry(RevocationIndex *index, const unsigned char *p, size_t length);
+	void parseExtensions(RevocationIndex *index, const unsigned char *p, size_t length);
+
+protected:
+	BIO *in_;
+	Handle<Certificate> issuer_;
+	uint64_t inputSize_;
+	std::vector<unsigned char> buffer_;
+	size_t pos_;
+	size_t end_;
+	uint64_t offset_;
+
+	bool hashing_;
+	size_t hashMark_;
+	std::string pending_;
+	EVP_MD_CTX *mctx_;
+	EVP_PKEY *pkey_;
+};
+
+/* Sets up signature check for AlgorithmIdentifier of tbsCertList */
+void CrlReaderStream::initVerify(const unsigned char *alg, size_t length) {
+	LOGGER_FN();
+
+	if (this->issuer_.isEmpty()) {
+		return;
+	}
+
+	LOGGER_OPENSSL(d2i_X509_ALGOR);
+	X509_ALGOR *algor = d2i_X509_ALGOR(NULL, &alg, (long)length);
+	if (!algor) {
+		THROW_OPENSSL_EXCEPTION(0, CrlReader, NULL, "d2i_X509_ALGOR");
+	}
+
+	int mdNid, pkeyNid;
+	int nid = OBJ_obj2nid(algor->algorithm);
+	X509_ALGOR_free(algor);
+
+	LOGGER_OPENSSL(OBJ_find_sigid_algs);
+	if (!OBJ_find_sigid_algs(nid, &mdNid, &pkeyNid)) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Unknown signature algorithm %d", nid);
+	}
+
+	LOGGER_OPENSSL(EVP_get_digestbynid);
+	const EVP_MD *md = EVP_get_digestbynid(mdNid);
+	if (!md) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Unsupported digest algorithm %d", mdNid);
+	}
+
+	LOGGER_OPENSSL(X509_get_pubkey);
+	if (!(this->pkey_ = X509_get_pubkey(this->issuer_->raw()))) {
+		THROW_OPENSSL_EXCEPTION(0, CrlReader, NULL, "X509_get_pubkey");
+	}
+
+	LOGGER_OPENSSL(EVP_MD_CTX_create);
+	this->mctx_ = EVP_MD_CTX_create();
+
+	LOGGER_OPENSSL(EVP_DigestVerifyInit);
+	if (!this->mctx_ || EVP_DigestVerifyInit(this->mctx_, NULL, md, NULL, this->pkey_) != 1) {
+		THROW_OPENSSL_EXCEPTION(0, CrlReader, NULL, "EVP_DigestVerifyInit");
+	}
+
+	/* tbsCertList header and version were read before the algorithm was known */
+	if (!this->pending_.empty()) {
+		LOGGER_OPENSSL(EVP_DigestVerifyUpdate);
+		if (EVP_DigestVerifyUpdate(this->mctx_, this->pending_.data(), this->pending_.length()) != 1) {
+			THROW_OPENSSL_EXCEPTION(0, CrlReader, NULL, "EVP_DigestVerifyUpdate");
+		}
+		this->pending_.clear();
+	}
+}
+
+void CrlReaderStream::checkIssuer(const unsigned char *name, size_t length) {
+	LOGGER_FN();
+
+	if (this->issuer_.isEmpty()) {
+		return;
+	}
+
+	LOGGER_OPENSSL(d2i_X509_NAME);
+	X509_NAME *issuerName = d2i_X509_NAME(NULL, &name, (long)length);
+	if (!issuerName) {
+		THROW_OPENSSL_EXCEPTION(0, CrlReader, NULL, "d2i_X509_NAME");
+	}
+
+	LOGGER_OPENSSL(X509_NAME_cmp);
+	int cmp = X509_NAME_cmp(issuerName, X509_get_subject_name(this->issuer_->raw()));
+	X509_NAME_free(issuerName);
+
+	if (cmp) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "CRL issuer does not match the certificate subject");
+	}
+}
+
+/* revokedCertificates entry: userCertificate, revocationDate, crlEntryExtensions */
+void CrlReaderStream::parseEntry(RevocationIndex *index, const unsigned char *p, size_t length) {
+	const unsigned char *end = p + length;
+	const unsigned char *serial, *date, *content;
+	size_t serialLength, dateLength, contentLength;
+	int tag, dateTag;
+	int reason = REVOCATION_REASON_NONE;
+
+	if (!readTlv(p, end, tag, serial, serialLength) || tag != V_ASN1_INTEGER ||
+		!readTlv(p, end, dateTag, date, dateLength)) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Wrong revoked certificate entry");
+	}
+
+	if (p < end && readTlv(p, end, tag, content, contentLength) && tag == TAG_SEQUENCE) {
+		const unsigned char *ext = content;
+		const unsigned char *extEnd = content + contentLength;
+		const unsigned char *oid, *value;
+		size_t oidLength, valueLength;
+
+		while (ext < extEnd && readExtension(ext, extEnd, oid, oidLength, value, valueLength)) {
+			/* CRLReason ENUMERATED */
+			const unsigned char *r = value;
+			if (isOid(oid, oidLength, oidReasonCode, sizeof(oidReasonCode)) &&
+				readTlv(r, value + valueLength, tag, content, contentLength) &&
+				tag == V_ASN1_ENUMERATED && contentLength == 1) {
+				reason = content[0];
+			}
+		}
+	}
+
+	index->add(serial, serialLength, asn1TimeToUnix(dateTag, date, dateLength), reason);
+}
+
+/* crlExtensions [0] EXPLICIT Extensions */
+void CrlReaderStream::parseExtensions(RevocationIndex *index, const unsigned char *p, size_t length) {
+	LOGGER_FN();
+
+	const unsigned char *end = p + length;
+	const unsigned char *content, *oid, *value;
+	size_t contentLength, oidLength, valueLength;
+	int tag;
+
+	if (!readTlv(p, end, tag, content, contentLength) || tag != TAG_EXTENSIONS ||
+		!readTlv(content, content + contentLength, tag, p, length) || tag != TAG_SEQUENCE) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Wrong CRL extensions");
+	}
+
+	end = p + length;
+	while (p < end) {
+		if (!readExtension(p, end, oid, oidLength, value, valueLength)) {
+			THROW_EXCEPTION(0, CrlReader, NULL, "Wrong CRL extension");
+		}
+
+		if (isOid(oid, oidLength, oidCrlNumber, sizeof(oidCrlNumber))) {
+			index->crlNumber = readNumber(value, valueLength);
+		}
+		else if (isOid(oid, oidLength, oidDeltaCrlIndicator, sizeof(oidDeltaCrlIndicator))) {
+			index->baseCrlNumber = readNumber(value, valueLength);
+		}
+		else if (isOid(oid, oidLength, oidFreshestCrl, sizeof(oidFreshestCrl))) {
+			readDistPoints(value, valueLength, index->freshestCrl);
+		}
+	}
+}
+
+Handle<RevocationIndex> CrlReaderStream::parse() {
+	LOGGER_FN();
+
+	Handle<RevocationIndex> res = new RevocationIndex();
+	RevocationIndex *index = &*res;
+	const unsigned char *p;
+	int tag;
+	size_t length, headerLength, total;
+
+	/* CertificateList */
+	uint64_t crlEnd = this->enter(TAG_SEQUENCE, this->inputSize_);
+
+	/* tbsCertList */
+	this->startHash();
+	uint64_t tbsEnd = this->enter(TAG_SEQUENCE, crlEnd);
+
+	this->peek(tag, length, headerLength, tbsEnd);
+	if (tag == V_ASN1_INTEGER) {
+		this->element(tag, total, tbsEnd);
+	}
+
+	p = this->element(tag, total, tbsEnd);
+	if (tag != TAG_SEQUENCE) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Wrong signature algorithm");
+	}
+	this->initVerify(p, total);
+
+	p = this->element(tag, total, tbsEnd);
+	if (tag != TAG_SEQUENCE) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Wrong issuer name");
+	}
+	this->checkIssuer(p, total);
+	index->issuer.assign((const char *)p, total);
+
+	this->peek(tag, length, headerLength, tbsEnd);
+	p = this->element(tag, total, tbsEnd);
+	index->thisUpdate = asn1TimeToUnix(tag, p + headerLength, length);
+
+	if (this->offset_ < tbsEnd) {
+		this->peek(tag, length, headerLength, tbsEnd);
+		if (tag == V_ASN1_UTCTIME || tag == V_ASN1_GENERALIZEDTIME) {
+			p = this->element(tag, total, tbsEnd);
+			index->nextUpdate = asn1TimeToUnix(tag, p + headerLength, length);
+		}
+	}
+
+	if (this->offset_ < tbsEnd) {
+		this->peek(tag, length, headerLength, tbsEnd);
+		if (tag == TAG_SEQUENCE) {
+			uint64_t listEnd = this->enter(TAG_SEQUENCE, tbsEnd);
+
+			while (this->offset_ < listEnd) {
+				p = this->element(tag, total, listEnd);
+				if (tag != TAG_SEQUENCE) {
+					THROW_EXCEPTION(0, CrlReader, NULL, "Wrong revoked certificate entry");
+				}
+
+				const unsigned char *entry = p;
+				const unsigned char *content;
+				if (!readTlv(entry, p + total, tag, content, length)) {
+					THROW_EXCEPTION(0, CrlReader, NULL, "Wrong revoked certificate entry");
+				}
+				this->parseEntry(index, content, length);
+			}
+		}
+	}
+
+	/* crlExtensions [0] */
+	if (this->offset_ < tbsEnd) {
+		this->peek(tag, length, headerLength, tbsEnd);
+		if (tag == TAG_EXTENSIONS) {
+			p = this->element(tag, total, tbsEnd);
+			this->parseExtensions(index, p, total);
+		}
+	}
+
+	if (this->offset_ != tbsEnd) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Wrong tbsCertList length");
+	}
+	this->stopHash();
+
+	/* signatureAlgorithm */
+	this->element(tag, total, crlEnd);
+
+	/* signatureValue BIT STRING, the first byte is the number of unused bits */
+	this->peek(tag, length, headerLength, crlEnd);
+	if (tag != V_ASN1_BIT_STRING || length < 1) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Wrong signature value");
+	}
+	p = this->element(tag, total, crlEnd);
+
+	if (this->mctx_) {
+		LOGGER_OPENSSL(EVP_DigestVerifyFinal);
+		if (EVP_DigestVerifyFinal(this->mctx_, (unsigned char *)p + headerLength + 1, length - 1) != 1) {
+			THROW_OPENSSL_EXCEPTION(0, CrlReader, NULL, "CRL signature is invalid");
+		}
+	}
+
+	if (this->offset_ != crlEnd) {
+		THROW_EXCEPTION(0, CrlReader, NULL, "Wrong CertificateList length");
+	}
+
+	index->sort();
+
+	return res;
+}
+
+static void skipPemHeader(BIO *in) {
+	char line[256];
+
+	for (;;) {
+		LOGGER_OPENSSL(BIO_gets);
+		int n = BIO_gets(in, line, sizeof(line));
+		if (n <= 0) {
+			THROW_EXCEPTION(0, CrlReader, NULL, "PEM header '%s' not found", CRL_READER_PEM_BEGIN);
+		}
+		if (!strncmp(line, CRL_READER_PEM_BEGIN, strlen(CRL_READER_PEM_BEGIN))) {
+			return;
+		}
+	}
+}
+
+Handle<RevocationIndex> CrlReader::read(Handle<Bio> in, DataFormat::DATA_FORMAT format, Handle<Certificate> issuer) {
+	LOGGER_FN();
+
+	BIO *b64 = NULL;
+
+	try {
+		if (in.isEmpty()) {
+			THROW_EXCEPTION(0, CrlReader, NULL, ERROR_PARAMETER_NULL, 1);
+		}
+
+		BIO *source = in->internal();
+		uint64_t inputSize = CRL_READER_SIZE_UNKNOWN;
+
+		switch (format) {
+		case DataFormat::DER:
+			if (BIO_method_type(source) == BIO_TYPE_MEM) {
+				inputSize = BIO_ctrl_pending(source);
+			}
+			break;
+		case DataFormat::BASE64:
+			skipPemHeader(source);
+			if (BIO_method_type(source) == BIO_TYPE_MEM) {
+				/* Decoded size is at most 3/4 of the text */
+				inputSize = BIO_ctrl_pending(source) / 4 * 3 + 3;
+			}
+
+			LOGGER_OPENSSL(BIO_new);
+			b64 = BIO_new(BIO_f_base64());
+			LOGGER_OPENSSL(BIO_push);
+			source = BIO_push(b64, source);
+			break;
+		default:
+			THROW_EXCEPTION(0, CrlReader, NULL, ERROR_DATA_FORMAT_UNKNOWN_FORMAT, format);
+		}
+
+		Handle<RevocationIndex> res;
+		{
+			CrlReaderStream stream(source, issuer, inputSize);
+			res = stream.parse();
+		}
+
+		if (!issuer.isEmpty()) {
+			res->issuerKey = CrlReader::issuerKeyId(issuer);
+		}
+
+		if (b64) {
+			BIO_pop(b64);
+			BIO_free(b64);
+		}
+
+		return res;
+	}
+	catch (Handle<Exception> e) {
+		if (b64) {
+			BIO_pop(b64);
+			BIO_free(b64);
+		}
+
+		THROW_EXCEPTION(0, CrlReader, e, "Error read CRL");
+	}
+	catch (std::bad_alloc &) {
+		if (b64) {
+			BIO_pop(b64);
+			BIO_free(b64);
+		}
+
+		THROW_EXCEPTION(0, CrlReader, NULL, "Error read CRL: out of memory");
+	}
+}
+
+/* SHA-256 of the whole file. Any change of the CRL gives another index */
+std::string CrlReader::fingerprint(const unsigned char *data, size_t size) {
+	LOGGER_FN();
+
+	unsigned char md[SHA256_DIGEST_LENGTH];
+
+	SHA256_CTX ctx;
+	SHA256_Init(&ctx);
+	SHA256_Update(&ctx, data, size);
+	SHA256_Final(md, &ctx);
+
+	return std::string((const char *)md, sizeof(md));
+}
+
+/* SHA-256 of the issuer SubjectPublicKeyInfo */
+std::string CrlReader::issuerKeyId(Handle<Certificate> issuer) {
+	LOGGER_FN();
+
+	unsigned char *der = NULL;
+	unsigned char md[SHA256_DIGEST_LENGTH];
+
+	LOGGER_OPENSSL(i2d_X509_PUBKEY);
+	int length = i2d_X509_PUBKEY(X509_get_X509_PUBKEY(issuer->raw()), &der);
+	if (length <= 0) {
+		THROW_OPENSSL_EXCEPTION(0, CrlReader, NULL, "i2d_X509_PUBKEY");
+	}
+
+	SHA256(der, length, md);
+	OPENSSL_free(der);
+
+	return std::string((const char *)md, sizeof(md));
+}
+
+Handle<RevocationIndex> CrlReader::open(const std::string &filename, DataFormat::DATA_FORMAT format, Handle<Certificate> issuer, int bloomBitsPerEntry) {
+	LOGGER_FN();
+
+	try {
+		MappedFile file(filename);
+		std::string indexFile = filename + REVOCATION_INDEX_FILE_SUFFIX;
+		std::string fingerprint = CrlReader::fingerprint(file.data(), file.size());
+		std::string issuerKey = issuer.isEmpty() ? std::string() : CrlReader::issuerKeyId(issuer);
+
+		LOGGER_OPENSSL(BIO_new_file);
+		BIO *bin = BIO_new_file(indexFile.c_str(), "rb");
+		if (bin) {
+			Handle<RevocationIndex> index = new RevocationIndex();
+
+			try {
+				index->read(new Bio(bin));
+				/* Index built without a signature check is not trusted when an issuer is given */
+				if (index->fingerprint == fingerprint && (issuerKey.empty() || index->issuerKey == issuerKey)) {
+					return index;
+				}
+			}
+			catch (Handle<Exception> e) {
+				/* Broken index file is rebuilt below */
+			}
+		}
+		ERR_clear_error();
+
+		if (!file.size()) {
+			THROW_EXCEPTION(0, CrlReader, NULL, "CRL file '%s' is empty", filename.c_str());
+		}
+
+		LOGGER_OPENSSL(BIO_new_mem_buf);
+		Handle<RevocationIndex> index = CrlReader::read(new Bio(BIO_new_mem_buf((void *)file.data(), (int)file.size())), format, issuer);
+		index->fingerprint = fingerprint;
+		index->setBloomFilter(bloomBitsPerEntry);
+		index->sort();
+
+		/* Index file is a cache only, so a read-only folder is not an error */
+		LOGGER_OPENSSL(BIO_new_file);
+		BIO *bout = BIO_new_file(indexFile.c_str(), "wb");
+		if (bout) {
+			try {
+				index->write(new Bio(bout));
+			}
+			catch (Handle<Exception> e) {
+				remove(indexFile.c_str());
+			}
+		}
+		ERR_clear_error();
+
+		return index;
+	}
+	catch (Handle<Exception> e) {
+		THROW_EXCEPTION(0, CrlReader, e, "Error open CRL '%s'", filename.c_str());
+	}
+}
@@ -0,0 +1,376 @@
+#include "../stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "wrapper/pki/crl_scheduler.h"
+#include "wrapper/pki/crl_reader.h"
+
+/* DER of the issuer name, compared without copying */
+class IssuerKey {
+public:
+	const char *data;
+	size_t length;
+};
+
+static int compareIssuer(const std::string &issuer, const IssuerKey &key) {
+	int res = memcmp(issuer.data(), key.data, issuer.length() < key.length ? issuer.length() : key.length);
+
+	if (res == 0 && issuer.length() != key.length) {
+		res = issuer.length() < key.length ? -1 : 1;
+	}
+
+	return res;
+}
+
+static bool indexIssuerLess(const SharedRevocationIndex &index, const IssuerKey &key) {
+	return compareIssuer(index->issuer, key) < 0;
+}
+
+static bool indexLess(const SharedRevocationIndex &a, const SharedRevocationIndex &b) {
+	if (a->issuer != b->issuer) {
+		return a->issuer < b->issuer;
+	}
+
+	/* Newest CRL of the issuer goes first */
+	return a->thisUpdate > b->thisUpdate;
+}
+
+std::string CrlFileFetcher::fetch(const std::string &location) {
+	return location;
+}
+
+CrlScheduler::CrlScheduler(Handle<CrlFetcher> fetcher)
+	: fetcher_(fetcher), stop_(false), leadTime_(CRL_SCHEDULER_LEAD_TIME),
+	retryInterval_(CRL_SCHEDULER_RETRY_INTERVAL), bloomBitsPerEntry_(0),
+	snapshot_(std::make_shared<const Snapshot>())
+{
+	LOGGER_FN();
+
+	if (fetcher.isEmpty()) {
+		THROW_EXCEPTION(0, CrlScheduler, NULL, ERROR_PARAMETER_NULL, 1);
+	}
+}
+
+CrlScheduler::~CrlScheduler() {
+	LOGGER_FN();
+
+	this->stop();
+}
+
+void CrlScheduler::add(const std::string &location, const std::string &deltaLocation, DataFormat::DATA_FORMAT format, Handle<Certificate> issuer) {
+	LOGGER_FN();
+
+	std::shared_ptr<Source> source = std::make_shared<Source>();
+	source->location = location;
+	source->deltaLocation = deltaLocation;
+	source->format = format;
+	/* Own copy, the scheduler thread must not touch Handles of the caller */
+	if (!issuer.isEmpty()) {
+		source->issuer = issuer->duplicate();
+	}
+	source->due = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->sources_.push_back(source);
+	}
+	this->wake_.notify_all();
+}
+
+void CrlScheduler::addStore(Handle<PkiStore> store) {
+	LOGGER_FN();
+
+	try {
+		if (store.isEmpty()) {
+			THROW_EXCEPTION(0, CrlScheduler, NULL, ERROR_PARAMETER_NULL, 1);
+		}
+
+		Handle<Filter> filter = new Filter();
+		filter->types.push_back(new std::string("CRL"));
+
+		Handle<PkiItemCollection> items = store->find(filter);
+		Handle<CertificateCollection> certs = store->getCerts();
+		std::vector<Handle<CRL> > crls;
+
+		for (int i = 0; i < items->length(); i++) {
+			crls.push_back(store->getItemCrl(items->items(i)));
+		}
+
+		for (size_t i = 0; i < crls.size(); i++) {
+			X509_CRL *crl = crls[i]->raw();
+			if (crl->base_crl_number) {
+				continue;
+			}
+
+			Handle<PkiItem> item = items->items((int)i);
+
+			Handle<Certificate> issuer;
+			for (int j = 0; j < certs->length(); j++) {
+				Handle<Certificate> cert = certs->items(j);
+
+				LOGGER_OPENSSL(X509_NAME_cmp);
+				if (!X509_NAME_cmp(X509_get_subject_name(cert->raw()), X509_CRL_get_issuer(crl))) {
+					issuer = cert;
+					break;
+				}
+			}
+
+			/* Without the issuer signatures of reloaded CRLs could not be checked */
+			if (issuer.isEmpty()) {
+				THROW_EXCEPTION(0, CrlScheduler, NULL, "Issuer of CRL '%s' not found in store", item->uri->c_str());
+			}
+
+			/* Newest delta for this CRL */
+			std::string deltaLocation;
+			X509_CRL *best = NULL;
+			for (size_t j = 0; crl->crl_number && j < crls.size(); j++) {
+				X509_CRL *delta = crls[j]->raw();
+
+				if (!delta->base_crl_number || !delta->crl_number ||
+					X509_NAME_cmp(X509_CRL_get_issuer(delta), X509_CRL_get_issuer(crl)) ||
+					ASN1_INTEGER_cmp(delta->base_crl_number, crl->crl_number) > 0 ||
+					ASN1_INTEGER_cmp(delta->crl_number, crl->crl_number) <= 0) {
+					continue;
+				}
+
+				if (!best || ASN1_INTEGER_cmp(delta->crl_number, best->crl_number) > 0) {
+					best = delta;
+					deltaLocation = *items->items((int)j)->uri;
+				}
+			}
+
+			DataFormat::DATA_FORMAT format = (item->format.isEmpty() || strcmp(item->format->c_str(), "PEM")) ? DataFormat::DER : DataFormat::BASE64;
+
+			this->add(*item->uri, deltaLocation, format, issuer);
+		}
+	}
+	catch (Handle<Exception> e) {
+		THROW_EXCEPTION(0, CrlScheduler, e, "Error add CRLs of store");
+	}
+}
+
+void CrlScheduler::setLeadTime(int seconds) {
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	this->leadTime_ = seconds;
+}
+
+void CrlScheduler::setRetryInterval(int seconds) {
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	this->retryInterval_ = seconds > 0 ? seconds : 1;
+}
+
+void CrlScheduler::setBloomFilter(int bitsPerEntry) {
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	this->bloomBitsPerEntry_ = bitsPerEntry;
+}
+
+void CrlScheduler::start() {
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	if (this->thread_.joinable()) {
+		return;
+	}
+
+	this->stop_ = false;
+	this->thread_ = std::thread(&CrlScheduler::run, this);
+}
+
+void CrlScheduler::stop() {
+	LOGGER_FN();
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->stop_ = true;
+	}
+	this->wake_.notify_all();
+
+	if (this->thread_.joinable()) {
+		this->thread_.join();
+	}
+}
+
+void CrlScheduler::refresh() {
+	LOGGER_FN();
+
+	this->refreshSources(true);
+}
+
+void CrlScheduler::run() {
+	std::unique_lock<std::mutex> lock(this->mutex_);
+
+	while (!this->stop_) {
+		lock.unlock();
+		time_t next = this->refreshSources(false);
+		lock.lock();
+
+		/* add() and stop() wake the thread before the due time */
+		if (!this->stop_) {
+			this->wake_.wait_until(lock, std::chrono::system_clock::from_time_t(next));
+		}
+	}
+
+	ERR_remove_thread_state(NULL);
+}
+
+/* Refreshes due sources (or all). Returns time of the next due source */
+time_t CrlScheduler::refreshSources(bool all) {
+	std::lock_guard<std::mutex> refreshLock(this->refreshMutex_);
+	std::vector<std::shared_ptr<Source> > sources;
+	int leadTime, retryInterval;
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		sources = this->sources_;
+		leadTime = this->leadTime_;
+		retryInterval = this->retryInterval_;
+	}
+
+	time_t now = time(NULL);
+	time_t next = now + retryInterval;
+	bool changed = false;
+
+	for (size_t i = 0; i < sources.size(); i++) {
+		Source &source = *sources[i];
+
+		if (all || source.due <= now) {
+			try {
+				source.index = this->load(source);
+				source.lastError.clear();
+				changed = true;
+
+				/* Stale CRL that was not updated yet is retried, not reloaded in a loop */
+				source.due = now + retryInterval;
+				if (source.index->nextUpdate && source.index->nextUpdate - leadTime > source.due) {
+					source.due = source.index->nextUpdate - leadTime;
+				}
+			}
+			catch (Handle<Exception> e) {
+				source.lastError = e->what();
+				source.due = now + retryInterval;
+			}
+		}
+
+		if (source.due < next) {
+			next = source.due;
+		}
+	}
+
+	if (changed) {
+		this->publish(sources);
+	}
+
+	return next;
+}
+
+/* Builds the index off the hot path. Old index stays published until swap */
+SharedRevocationIndex CrlScheduler::load(Source &source) {
+	LOGGER_FN();
+
+	int bloomBitsPerEntry;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		bloomBitsPerEntry = this->bloomBitsPerEntry_;
+	}
+
+	std::string path = this->fetcher_->fetch(source.location);
+	Handle<RevocationIndex> index = CrlReader::open(path, source.format, source.issuer, bloomBitsPerEntry);
+
+	if (!source.deltaLocation.empty()) {
+		std::string deltaPath = this->fetcher_->fetch(source.deltaLocation);
+		Handle<RevocationIndex> delta = CrlReader::open(deltaPath, source.format, source.issuer, 0);
+
+		index = RevocationIndex::applyDelta(index, delta);
+	}
+
+	/* Readers only call const lookups, so the index must be sorted before it is shared */
+	index->sort();
+
+	return std::make_shared<RevocationIndex>(*index);
+}
+
+void CrlScheduler::publish(const std::vector<std::shared_ptr<Source> > &sources) {
+	LOGGER_FN();
+
+	std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (sources[i]->index) {
+			snapshot->push_back(sources[i]->index);
+		}
+	}
+
+	/* Several CRLs of one issuer: the newest wins */
+	std::sort(snapshot->begin(), snapshot->end(), indexLess);
+	Snapshot::iterator last = snapshot->begin();
+	for (Snapshot::iterator it = snapshot->begin(); it != snapshot->end(); ++it) {
+		if (it == snapshot->begin() || (*it)->issuer != (*(last - 1))->issuer) {
+			*last++ = *it;
+		}
+	}
+	snapshot->erase(last, snapshot->end());
+
+	std::atomic_store(&this->snapshot_, std::shared_ptr<const Snapshot>(snapshot));
+}
+
+SharedRevocationIndex CrlScheduler::getIndex(Handle<Certificate> cert) {
+	LOGGER_FN();
+
+	try {
+		if (cert.isEmpty()) {
+			THROW_EXCEPTION(0, CrlScheduler, NULL, ERROR_PARAMETER_NULL, 1);
+		}
+
+		/* i2d fills the cached encoding, decoded names already have it */
+		X509_NAME *name = X509_get_issuer_name(cert->raw());
+		LOGGER_OPENSSL(i2d_X509_NAME);
+		if (i2d_X509_NAME(name, NULL) <= 0) {
+			THROW_OPENSSL_EXCEPTION(0, CrlScheduler, NULL, "i2d_X509_NAME");
+		}
+
+		IssuerKey key;
+		key.data = name->bytes->data;
+		key.length = name->bytes->length;
+
+		std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&this->snapshot_);
+		Snapshot::const_iterator it = std::lower_bound(snapshot->begin(), snapshot->end(), key, indexIssuerLess);
+		if (it == snapshot->end() || compareIssuer((*it)->issuer, key)) {
+			return SharedRevocationIndex();
+		}
+
+		return *it;
+	}
+	catch (Handle<Exception> e) {
+		THROW_EXCEPTION(0, CrlScheduler, e, "Error get revocation index");
+	}
+}
+
+bool CrlScheduler::isRevoked(Handle<Certificate> cert) {
+	LOGGER_FN();
+
+	SharedRevocationIndex index = this->getIndex(cert);
+	if (!index) {
+		THROW_EXCEPTION(0, CrlScheduler, NULL, "No CRL for the certificate issuer");
+	}
+
+	/* Reloads keep failing after nextUpdate: the index can not tell that the certificate is valid */
+	if (index->nextUpdate && index->nextUpdate < time(NULL)) {
+		THROW_EXCEPTION(0, CrlScheduler, NULL, "CRL has expired");
+	}
+
+	return index->isRevoked(cert);
+}
+
+std::string CrlScheduler::getLastError(const std::string &location) {
+	std::lock_guard<std::mutex> refreshLock(this->refreshMutex_);
+	std::lock_guard<std::mutex> lock(this->mutex_);
+
+	for (size_t i = 0; i < this->sources_.size(); i++) {
+		if (this->sources_[i]->location == location) {
+			return this->sources_[i]->lastError;
+		}
+	}
+
+	return std::string();
+}
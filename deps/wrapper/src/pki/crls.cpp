@@ -10,12 +10,17 @@ void CrlCollection::push(Handle<CRL> crl) {
 		this->setData(sk_X509_CRL_new_null());
 	}
 
-	Handle<CRL> crlcpy = crl->duplicate();
+	LOGGER_OPENSSL("X509_CRL_dup");
+	X509_CRL *x = X509_CRL_dup(crl->raw());
+	if (!x){
+		THROW_OPENSSL_EXCEPTION(0, CrlCollection, NULL, "X509_CRL_dup");
+	}
 
 	LOGGER_OPENSSL("sk_X509_CRL_push");
-	sk_X509_CRL_push(this->internal(), crlcpy->internal());
-
-	crlcpy->setParent(this->handle());
+	if (!sk_X509_CRL_push(this->raw(), x)) {
+		X509_CRL_free(x);
+		THROW_OPENSSL_EXCEPTION(0, CrlCollection, NULL, "sk_X509_CRL_push");
+	}
 }
 
 int CrlCollection::length() {
@@ -26,32 +31,44 @@ int CrlCollection::length() {
 	}		
 
 	LOGGER_OPENSSL("sk_X509_CRL_num");
-	return sk_X509_CRL_num(this->internal());
+	return sk_X509_CRL_num(this->raw());
 }
 
 Handle<CRL> CrlCollection::items(int index) {
 	LOGGER_FN();
 
 	LOGGER_OPENSSL("sk_X509_CRL_value");
-	X509_CRL *crl = sk_X509_CRL_value(this->internal(), index);
+	X509_CRL *crl = sk_X509_CRL_value(this->raw(), index);
 
 	if (!crl){
 		THROW_OPENSSL_EXCEPTION(0, CrlCollection, NULL, "Has no item by index %d", index);
 	}
 
-	return new CRL(crl, this->handle());
+	/*Own reference: the item outlives its removal from the collection*/
+	LOGGER_OPENSSL("CRYPTO_add");
+	CRYPTO_add(&crl->references, 1, CRYPTO_LOCK_X509_CRL);
+
+	return new CRL(crl);
 }
 
 void CrlCollection::pop(){
 	LOGGER_FN();
 
-	LOGGER_OPENSSL("sk_X509_CRL_value");
-	sk_X509_CRL_pop(this->internal());	
+	LOGGER_OPENSSL("sk_X509_CRL_pop");
+	X509_CRL *crl = sk_X509_CRL_pop(this->raw());
+
+	if (crl){
+		X509_CRL_free(crl);
+	}
 }
 
 void CrlCollection::removeAt(int index){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL("sk_X509_CRL_delete");
-	sk_X509_CRL_delete(this->internal(), index);
+	X509_CRL *crl = sk_X509_CRL_delete(this->raw(), index);
+
+	if (crl){
+		X509_CRL_free(crl);
+	}
 }
@@ -0,0 +1,129 @@
+#include "../stdafx.h"
+
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+
+#include "wrapper/pki/kdf_cache.h"
+
+/* Key of the ids, generated once per process */
+static unsigned char idKey[SHA256_DIGEST_LENGTH];
+static std::once_flag idKeyOnce;
+
+static void generateIdKey() {
+	LOGGER_OPENSSL(RAND_bytes);
+	if (RAND_bytes(idKey, sizeof idKey) != 1) {
+		THROW_OPENSSL_EXCEPTION(0, KdfCache, NULL, "RAND_bytes");
+	}
+}
+
+KdfCache &KdfCache::get() {
+	static KdfCache cache;
+
+	return cache;
+}
+
+KdfCache::KdfCache()
+	: size_(KDF_CACHE_DEFAULT_SIZE)
+{
+}
+
+KdfCache::~KdfCache() {
+	/* Logger may be gone at exit */
+	evict(0);
+}
+
+void KdfCache::setSize(size_t size) {
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+
+	this->size_ = size;
+	evict(size);
+}
+
+std::string KdfCache::makeId(const std::vector<std::string> &parts) {
+	LOGGER_FN();
+
+	unsigned char md[SHA256_DIGEST_LENGTH];
+	unsigned char id[SHA256_DIGEST_LENGTH];
+	unsigned int idLength = sizeof id;
+	unsigned char length[4];
+	SHA256_CTX ctx;
+
+	/* Not marked as done if it throws, the next call tries again */
+	std::call_once(idKeyOnce, generateIdKey);
+
+	SHA256_Init(&ctx);
+	for (size_t i = 0; i < parts.size(); i++) {
+		size_t n = parts[i].length();
+		length[0] = (unsigned char)(n >> 24);
+		length[1] = (unsigned char)(n >> 16);
+		length[2] = (unsigned char)(n >> 8);
+		length[3] = (unsigned char)n;
+
+		SHA256_Update(&ctx, length, sizeof length);
+		SHA256_Update(&ctx, parts[i].data(), n);
+	}
+	SHA256_Final(md, &ctx);
+	OPENSSL_cleanse(&ctx, sizeof ctx);
+
+	/* Without the key ids can not be checked against password guesses */
+	LOGGER_OPENSSL(HMAC);
+	if (!HMAC(EVP_sha256(), idKey, sizeof idKey, md, sizeof md, id, &idLength)) {
+		OPENSSL_cleanse(md, sizeof md);
+		THROW_OPENSSL_EXCEPTION(0, KdfCache, NULL, "HMAC");
+	}
+	OPENSSL_cleanse(md, sizeof md);
+
+	return std::string((char *)id, idLength);
+}
+
+bool KdfCache::find(const std::string &id, unsigned char *out, size_t len) {
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+
+	std::unordered_map<std::string, std::list<Entry>::iterator>::iterator it = this->index_.find(id);
+	if (it == this->index_.end() || it->second->second.size() != len) {
+		return false;
+	}
+
+	this->entries_.splice(this->entries_.begin(), this->entries_, it->second);
+	memcpy(out, &it->second->second[0], len);
+
+	return true;
+}
+
+void KdfCache::put(const std::string &id, const unsigned char *data, size_t len) {
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+
+	if (!this->size_ || !len || this->index_.count(id)) {
+		return;
+	}
+
+	this->entries_.push_front(Entry(id, std::vector<unsigned char>(data, data + len)));
+	this->index_[id] = this->entries_.begin();
+
+	evict(this->size_);
+}
+
+void KdfCache::clear() {
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+
+	evict(0);
+}
+
+void KdfCache::evict(size_t size) {
+	while (this->entries_.size() > size) {
+		Entry &entry = this->entries_.back();
+
+		OPENSSL_cleanse(&entry.second[0], entry.second.size());
+		this->index_.erase(entry.first);
+		this->entries_.pop_back();
+	}
+}
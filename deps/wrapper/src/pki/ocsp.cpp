@@ -0,0 +1,679 @@
+#include "../stdafx.h"
+
+#include <openssl/sha.h>
+
+#include "wrapper/pki/ocsp.h"
+#include "wrapper/common/mapped_file.h"
+#include "wrapper/store/storehelper.h"
+
+static time_t asn1TimeToTime(ASN1_GENERALIZEDTIME *time) {
+	if (!time) {
+		return 0;
+	}
+
+	LOGGER_OPENSSL(ASN1_TIME_set);
+	ASN1_TIME *epoch = ASN1_TIME_set(NULL, 0);
+	if (!epoch) {
+		THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Error create ASN1_TIME");
+	}
+
+	int days = 0, seconds = 0;
+	LOGGER_OPENSSL(ASN1_TIME_diff);
+	int res = ASN1_TIME_diff(&days, &seconds, epoch, time);
+	ASN1_TIME_free(epoch);
+
+	if (!res) {
+		THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Wrong time in OCSP response");
+	}
+
+	return (time_t)days * 86400 + seconds;
+}
+
+static std::string readFile(const std::string &filename) {
+	MappedFile file(filename);
+
+	return std::string((const char *)file.data(), file.size());
+}
+
+static OCSP_CERTID *createCertId(Handle<Certificate> cert, Handle<Certificate> issuer) {
+	if (cert.isEmpty()) {
+		THROW_EXCEPTION(0, Ocsp, NULL, ERROR_PARAMETER_NULL, 1);
+	}
+	if (issuer.isEmpty()) {
+		THROW_EXCEPTION(0, Ocsp, NULL, ERROR_PARAMETER_NULL, 2);
+	}
+
+	LOGGER_OPENSSL(OCSP_cert_to_id);
+	OCSP_CERTID *id = OCSP_cert_to_id(EVP_sha1(), cert->internal(), issuer->internal());
+	if (!id) {
+		THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Error create OCSP CertID");
+	}
+
+	return id;
+}
+
+static std::string encodeCertId(OCSP_CERTID *id) {
+	LOGGER_OPENSSL(i2d_OCSP_CERTID);
+	int length = i2d_OCSP_CERTID(id, NULL);
+	if (length <= 0) {
+		THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Error encode OCSP CertID");
+	}
+
+	std::string res(length, 0);
+	unsigned char *p = (unsigned char *)&res[0];
+	i2d_OCSP_CERTID(id, &p);
+
+	return res;
+}
+
+/* Request for the id. Takes ownership of id */
+static OCSP_REQUEST *createOcspRequest(OCSP_CERTID *id, bool nonce) {
+	LOGGER_OPENSSL(OCSP_REQUEST_new);
+	OCSP_REQUEST *req = OCSP_REQUEST_new();
+	if (!req) {
+		OCSP_CERTID_free(id);
+		THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Error create OCSP request");
+	}
+
+	LOGGER_OPENSSL(OCSP_request_add0_id);
+	if (!OCSP_request_add0_id(req, id)) {
+		OCSP_CERTID_free(id);
+		OCSP_REQUEST_free(req);
+		THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Error add CertID to OCSP request");
+	}
+
+	LOGGER_OPENSSL(OCSP_request_add1_nonce);
+	if (nonce && !OCSP_request_add1_nonce(req, NULL, -1)) {
+		OCSP_REQUEST_free(req);
+		THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Error add nonce to OCSP request");
+	}
+
+	return req;
+}
+
+static std::string encodeOcspRequest(OCSP_REQUEST *req) {
+	LOGGER_OPENSSL(i2d_OCSP_REQUEST);
+	int length = i2d_OCSP_REQUEST(req, NULL);
+	if (length <= 0) {
+		THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Error encode OCSP request");
+	}
+
+	std::string res(length, 0);
+	unsigned char *p = (unsigned char *)&res[0];
+	i2d_OCSP_REQUEST(req, &p);
+
+	return res;
+}
+
+OcspResult::OcspResult()
+	: status(OcspCertStatus::Unknown), reason(REVOCATION_REASON_NONE), revocationTime(0),
+	thisUpdate(0), nextUpdate(0), cached(false)
+{
+}
+
+OcspFileTransport::OcspFileTransport(const std::string &filename)
+	: filename_(filename)
+{
+}
+
+std::string OcspFileTransport::send(const std::string & /* url */, const std::string & /* request */) {
+	LOGGER_FN();
+
+	try {
+		return readFile(this->filename_);
+	}
+	catch (Handle<Exception> e) {
+		THROW_EXCEPTION(0, OcspFileTransport, e, "Error read OCSP response '%s'", this->filename_.c_str());
+	}
+}
+
+OcspLocalResponder::OcspLocalResponder(Handle<Certificate> issuer, Handle<Certificate> signer, Handle<Key> key, Handle<RevocationIndex> index)
+	: issuer_(issuer), signer_(signer), key_(key), index_(index), validity_(OCSP_DEFAULT_MAX_AGE), clockOffset_(0), requests_(0)
+{
+	LOGGER_FN();
+
+	if (issuer.isEmpty()) {
+		THROW_EXCEPTION(0, OcspLocalResponder, NULL, ERROR_PARAMETER_NULL, 1);
+	}
+	if (signer.isEmpty()) {
+		THROW_EXCEPTION(0, OcspLocalResponder, NULL, ERROR_PARAMETER_NULL, 2);
+	}
+	if (key.isEmpty()) {
+		THROW_EXCEPTION(0, OcspLocalResponder, NULL, ERROR_PARAMETER_NULL, 3);
+	}
+	if (index.isEmpty()) {
+		THROW_EXCEPTION(0, OcspLocalResponder, NULL, ERROR_PARAMETER_NULL, 4);
+	}
+}
+
+void OcspLocalResponder::setValidity(int seconds) {
+	this->validity_ = seconds;
+}
+
+void OcspLocalResponder::setClockOffset(int seconds) {
+	this->clockOffset_ = seconds;
+}
+
+int OcspLocalResponder::getRequestCount() {
+	return this->requests_;
+}
+
+std::string OcspLocalResponder::send(const std::string & /* url */, const std::string &request) {
+	LOGGER_FN();
+
+	OCSP_REQUEST *req = NULL;
+	OCSP_BASICRESP *bs = NULL;
+	OCSP_RESPONSE *resp = NULL;
+	OCSP_CERTID *issuerId = NULL;
+	ASN1_TIME *thisUpdate = NULL;
+	ASN1_TIME *nextUpdate = NULL;
+	ASN1_TIME *revocationTime = NULL;
+
+	try {
+		const unsigned char *p = (const unsigned char *)request.data();
+		LOGGER_OPENSSL(d2i_OCSP_REQUEST);
+		req = d2i_OCSP_REQUEST(NULL, &p, (long)request.length());
+		if (!req) {
+			THROW_OPENSSL_EXCEPTION(0, OcspLocalResponder, NULL, "Error decode OCSP request");
+		}
+
+		LOGGER_OPENSSL(OCSP_BASICRESP_new);
+		bs = OCSP_BASICRESP_new();
+		if (!bs) {
+			THROW_OPENSSL_EXCEPTION(0, OcspLocalResponder, NULL, "Error create OCSP basic response");
+		}
+
+		/* Serial is ignored, only issuer name and key hashes are compared */
+		LOGGER_OPENSSL(OCSP_cert_id_new);
+		issuerId = OCSP_cert_id_new(EVP_sha1(), X509_get_subject_name(this->issuer_->internal()), X509_get0_pubkey_bitstr(this->issuer_->internal()), NULL);
+		if (!issuerId) {
+			THROW_OPENSSL_EXCEPTION(0, OcspLocalResponder, NULL, "Error create issuer CertID");
+		}
+
+		LOGGER_OPENSSL(X509_gmtime_adj);
+		thisUpdate = X509_gmtime_adj(NULL, this->clockOffset_);
+		if (this->validity_ > 0) {
+			nextUpdate = X509_gmtime_adj(NULL, (long)this->clockOffset_ + this->validity_);
+		}
+		if (!thisUpdate || (this->validity_ > 0 && !nextUpdate)) {
+			THROW_OPENSSL_EXCEPTION(0, OcspLocalResponder, NULL, "Error create update time");
+		}
+
+		for (int i = 0, c = OCSP_request_onereq_count(req); i < c; i++) {
+			OCSP_CERTID *id = OCSP_onereq_get0_id(OCSP_request_onereq_get0(req, i));
+			ASN1_INTEGER *serial = NULL;
+			OCSP_id_get0_info(NULL, NULL, NULL, &serial, id);
+
+			int status = V_OCSP_CERTSTATUS_UNKNOWN;
+			int reason = OCSP_REVOKED_STATUS_NOSTATUS;
+			ASN1_TIME_free(revocationTime);
+			revocationTime = NULL;
+
+			if (!OCSP_id_issuer_cmp(issuerId, id)) {
+				long entry = this->index_->find(serial->data, serial->length);
+
+				if (entry < 0) {
+					status = V_OCSP_CERTSTATUS_GOOD;
+				}
+				else {
+					status = V_OCSP_CERTSTATUS_REVOKED;
+					reason = this->index_->getReason(entry);
+					if (reason == REVOCATION_REASON_NONE) {
+						reason = OCSP_REVOKED_STATUS_NOSTATUS;
+					}
+
+					LOGGER_OPENSSL(ASN1_TIME_set);
+					revocationTime = ASN1_TIME_set(NULL, this->index_->getRevocationDate(entry));
+					if (!revocationTime) {
+						THROW_OPENSSL_EXCEPTION(0, OcspLocalResponder, NULL, "Error create revocation time");
+					}
+				}
+			}
+
+			LOGGER_OPENSSL(OCSP_basic_add1_status);
+			if (!OCSP_basic_add1_status(bs, id, status, reason, revocationTime, thisUpdate, nextUpdate)) {
+				THROW_OPENSSL_EXCEPTION(0, OcspLocalResponder, NULL, "Error add status to OCSP response");
+			}
+		}
+
+		LOGGER_OPENSSL(OCSP_copy_nonce);
+		if (OCSP_copy_nonce(bs, req) <= 0) {
+			THROW_OPENSSL_EXCEPTION(0, OcspLocalResponder, NULL, "Error copy nonce to OCSP response");
+		}
+
+		LOGGER_OPENSSL(OCSP_basic_sign);
+		if (!OCSP_basic_sign(bs, this->signer_->internal(), this->key_->internal(), EVP_sha256(), NULL, 0)) {
+			THROW_OPENSSL_EXCEPTION(0, OcspLocalResponder, NULL, "Error sign OCSP response");
+		}
+
+		LOGGER_OPENSSL(OCSP_response_create);
+		resp = OCSP_response_create(OCSP_RESPONSE_STATUS_SUCCESSFUL, bs);
+		if (!resp) {
+			THROW_OPENSSL_EXCEPTION(0, OcspLocalResponder, NULL, "Error create OCSP response");
+		}
+
+		LOGGER_OPENSSL(i2d_OCSP_RESPONSE);
+		int length = i2d_OCSP_RESPONSE(resp, NULL);
+		if (length <= 0) {
+			THROW_OPENSSL_EXCEPTION(0, OcspLocalResponder, NULL, "Error encode OCSP response");
+		}
+
+		std::string res(length, 0);
+		unsigned char *out = (unsigned char *)&res[0];
+		i2d_OCSP_RESPONSE(resp, &out);
+
+		OCSP_RESPONSE_free(resp);
+		OCSP_BASICRESP_free(bs);
+		OCSP_REQUEST_free(req);
+		OCSP_CERTID_free(issuerId);
+		ASN1_TIME_free(thisUpdate);
+		ASN1_TIME_free(nextUpdate);
+		ASN1_TIME_free(revocationTime);
+
+		this->requests_++;
+
+		return res;
+	}
+	catch (Handle<Exception> e) {
+		OCSP_RESPONSE_free(resp);
+		OCSP_BASICRESP_free(bs);
+		OCSP_REQUEST_free(req);
+		OCSP_CERTID_free(issuerId);
+		ASN1_TIME_free(thisUpdate);
+		ASN1_TIME_free(nextUpdate);
+		ASN1_TIME_free(revocationTime);
+
+		THROW_EXCEPTION(0, OcspLocalResponder, e, "Error answer OCSP request");
+	}
+}
+
+OcspCache::OcspCache(const std::string &folder)
+	: folder_(folder)
+{
+}
+
+bool OcspCache::isFresh(const OcspResult &result, time_t now) {
+	if (now + OCSP_VALIDITY_SKEW < result.thisUpdate) {
+		return false;
+	}
+
+	if (result.nextUpdate) {
+		return now <= result.nextUpdate + OCSP_VALIDITY_SKEW;
+	}
+
+	return now <= result.thisUpdate + OCSP_DEFAULT_MAX_AGE;
+}
+
+bool OcspCache::get(const std::string &certId, OcspResult &result) {
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+
+	std::map<std::string, OcspResult>::iterator it = this->results_.find(certId);
+	if (it == this->results_.end()) {
+		return false;
+	}
+
+	if (!OcspCache::isFresh(it->second, time(NULL))) {
+		this->results_.erase(it);
+		return false;
+	}
+
+	result = it->second;
+	result.cached = true;
+
+	return true;
+}
+
+void OcspCache::put(const std::string &certId, const OcspResult &result) {
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+
+	this->results_[certId] = result;
+}
+
+std::string OcspCache::getFilename(const std::string &certId) {
+	static const char hex[] = "0123456789abcdef";
+
+	unsigned char md[SHA_DIGEST_LENGTH];
+	SHA1((const unsigned char *)certId.data(), certId.length(), md);
+
+	std::string name;
+	for (int i = 0; i < SHA_DIGEST_LENGTH; i++) {
+		name += hex[md[i] >> 4];
+		name += hex[md[i] & 0x0F];
+	}
+
+	return this->folder_ + CROSSPLATFORM_SLASH + name + OCSP_CACHE_FILE_SUFFIX;
+}
+
+std::string OcspCache::load(const std::string &certId) {
+	LOGGER_FN();
+
+	if (this->folder_.empty()) {
+		return "";
+	}
+
+	try {
+		return readFile(this->getFilename(certId));
+	}
+	catch (Handle<Exception> e) {
+		/* No saved response */
+		return "";
+	}
+}
+
+void OcspCache::save(const std::string &certId, const std::string &response) {
+	LOGGER_FN();
+
+	if (this->folder_.empty()) {
+		return;
+	}
+
+	std::string filename = this->getFilename(certId);
+
+	/* Disk copy is a cache only, so a read-only folder is not an error */
+	LOGGER_OPENSSL(BIO_new_file);
+	BIO *out = BIO_new_file(filename.c_str(), "wb");
+	if (out) {
+		LOGGER_OPENSSL(BIO_write);
+		if (BIO_write(out, response.data(), (int)response.length()) != (int)response.length()) {
+			BIO_free(out);
+			remove(filename.c_str());
+		}
+		else {
+			BIO_free(out);
+		}
+	}
+	ERR_clear_error();
+}
+
+void OcspCache::clear() {
+	LOGGER_FN();
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+
+	this->results_.clear();
+}
+
+Ocsp::Ocsp(Handle<OcspTransport> transport, Handle<OcspCache> cache)
+	: transport_(transport), cache_(cache), nonce_(false)
+{
+	LOGGER_FN();
+
+	if (transport.isEmpty()) {
+		THROW_EXCEPTION(0, Ocsp, NULL, ERROR_PARAMETER_NULL, 1);
+	}
+}
+
+void Ocsp::setNonce(bool enable) {
+	this->nonce_ = enable;
+}
+
+std::string Ocsp::getCertId(Handle<Certificate> cert, Handle<Certificate> issuer) {
+	LOGGER_FN();
+
+	OCSP_CERTID *id = createCertId(cert, issuer);
+
+	try {
+		std::string res = encodeCertId(id);
+		OCSP_CERTID_free(id);
+
+		return res;
+	}
+	catch (Handle<Exception> e) {
+		OCSP_CERTID_free(id);
+		THROW_EXCEPTION(0, Ocsp, e, "Error get CertID");
+	}
+}
+
+Handle<std::string> Ocsp::createRequest(Handle<Certificate> cert, Handle<Certificate> issuer, bool nonce) {
+	LOGGER_FN();
+
+	try {
+		OCSP_REQUEST *req = createOcspRequest(createCertId(cert, issuer), nonce);
+
+		try {
+			Handle<std::string> res = new std::string(encodeOcspRequest(req));
+			OCSP_REQUEST_free(req);
+
+			return res;
+		}
+		catch (Handle<Exception> e) {
+			OCSP_REQUEST_free(req);
+			throw;
+		}
+	}
+	catch (Handle<Exception> e) {
+		THROW_EXCEPTION(0, Ocsp, e, "Error create OCSP request");
+	}
+}
+
+std::vector<std::string> Ocsp::getResponderUrls(Handle<Certificate> cert) {
+	LOGGER_FN();
+
+	if (cert.isEmpty()) {
+		THROW_EXCEPTION(0, Ocsp, NULL, ERROR_PARAMETER_NULL, 1);
+	}
+
+	std::vector<std::string> res;
+
+	LOGGER_OPENSSL(X509_get1_ocsp);
+	STACK_OF(OPENSSL_STRING) *urls = X509_get1_ocsp(cert->internal());
+	if (urls) {
+		for (int i = 0, c = sk_OPENSSL_STRING_num(urls); i < c; i++) {
+			res.push_back(sk_OPENSSL_STRING_value(urls, i));
+		}
+
+		X509_email_free(urls);
+	}
+
+	return res;
+}
+
+OcspResult Ocsp::verifyResponse(const std::string &response, Handle<Certificate> cert, Handle<Certificate> issuer, Handle<CertificateCollection> trusted) {
+	LOGGER_FN();
+
+	OCSP_CERTID *id = NULL;
+
+	try {
+		id = createCertId(cert, issuer);
+		OcspResult res = Ocsp::verifyResponse(response, id, NULL, issuer, trusted);
+		OCSP_CERTID_free(id);
+
+		return res;
+	}
+	catch (Handle<Exception> e) {
+		OCSP_CERTID_free(id);
+		THROW_EXCEPTION(0, Ocsp, e, "Error verify OCSP response");
+	}
+}
+
+OcspResult Ocsp::verifyResponse(const std::string &response, OCSP_CERTID *id, OCSP_REQUEST *request, Handle<Certificate> issuer, Handle<CertificateCollection> trusted) {
+	LOGGER_FN();
+
+	OCSP_RESPONSE *resp = NULL;
+	OCSP_BASICRESP *bs = NULL;
+	X509_STORE *st = NULL;
+	STACK_OF(X509) *certs = NULL;
+
+	try {
+		const unsigned char *p = (const unsigned char *)response.data();
+		LOGGER_OPENSSL(d2i_OCSP_RESPONSE);
+		resp = d2i_OCSP_RESPONSE(NULL, &p, (long)response.length());
+		if (!resp) {
+			THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Error decode OCSP response");
+		}
+
+		LOGGER_OPENSSL(OCSP_response_status);
+		int responseStatus = OCSP_response_status(resp);
+		if (responseStatus != OCSP_RESPONSE_STATUS_SUCCESSFUL) {
+			THROW_EXCEPTION(0, Ocsp, NULL, "OCSP responder error: %s", OCSP_response_status_str(responseStatus));
+		}
+
+		LOGGER_OPENSSL(OCSP_response_get1_basic);
+		bs = OCSP_response_get1_basic(resp);
+		if (!bs) {
+			THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Error get OCSP basic response");
+		}
+
+		LOGGER_OPENSSL(OCSP_check_nonce);
+		if (request && OCSP_check_nonce(request, bs) <= 0) {
+			THROW_EXCEPTION(0, Ocsp, NULL, "OCSP response nonce does not match");
+		}
+
+		/*
+		 * Issuer is the trust anchor. It may sign responses itself or delegate
+		 * it to a certificate with id-kp-OCSPSigning, trusted adds other allowed responders
+		 */
+		LOGGER_OPENSSL(X509_STORE_new);
+		st = X509_STORE_new();
+		LOGGER_OPENSSL(sk_X509_new_null);
+		certs = sk_X509_new_null();
+		if (!st || !certs) {
+			THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Error create store");
+		}
+
+		LOGGER_OPENSSL(X509_STORE_add_cert);
+		X509_STORE_add_cert(st, issuer->internal());
+		sk_X509_push(certs, issuer->internal());
+
+		if (!trusted.isEmpty()) {
+			for (int i = 0, c = trusted->length(); i < c; i++) {
+				Handle<Certificate> item = trusted->items(i);
+
+				LOGGER_OPENSSL(X509_STORE_add_cert);
+				X509_STORE_add_cert(st, item->internal());
+				sk_X509_push(certs, item->internal());
+			}
+		}
+		ERR_clear_error();
+
+		LOGGER_OPENSSL(X509_STORE_set_flags);
+		X509_STORE_set_flags(st, X509_V_FLAG_PARTIAL_CHAIN);
+
+		LOGGER_OPENSSL(OCSP_basic_verify);
+		if (OCSP_basic_verify(bs, certs, st, OCSP_TRUSTOTHER) <= 0) {
+			THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "OCSP response signature is not valid");
+		}
+
+		int status, reason;
+		ASN1_GENERALIZEDTIME *revocationTime, *thisUpdate, *nextUpdate;
+
+		LOGGER_OPENSSL(OCSP_resp_find_status);
+		if (!OCSP_resp_find_status(bs, id, &status, &reason, &revocationTime, &thisUpdate, &nextUpdate)) {
+			THROW_EXCEPTION(0, Ocsp, NULL, "No status for the certificate in OCSP response");
+		}
+
+		LOGGER_OPENSSL(OCSP_check_validity);
+		if (!OCSP_check_validity(thisUpdate, nextUpdate, OCSP_VALIDITY_SKEW, -1)) {
+			THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "OCSP response is out of its validity period");
+		}
+
+		OcspResult res;
+		switch (status) {
+		case V_OCSP_CERTSTATUS_GOOD:
+			res.status = OcspCertStatus::Good;
+			break;
+		case V_OCSP_CERTSTATUS_REVOKED:
+			res.status = OcspCertStatus::Revoked;
+			res.reason = reason == OCSP_REVOKED_STATUS_NOSTATUS ? REVOCATION_REASON_NONE : reason;
+			res.revocationTime = asn1TimeToTime(revocationTime);
+			break;
+		default:
+			res.status = OcspCertStatus::Unknown;
+		}
+		res.thisUpdate = asn1TimeToTime(thisUpdate);
+		res.nextUpdate = asn1TimeToTime(nextUpdate);
+
+		sk_X509_free(certs);
+		X509_STORE_free(st);
+		OCSP_BASICRESP_free(bs);
+		OCSP_RESPONSE_free(resp);
+
+		return res;
+	}
+	catch (Handle<Exception> e) {
+		sk_X509_free(certs);
+		X509_STORE_free(st);
+		OCSP_BASICRESP_free(bs);
+		OCSP_RESPONSE_free(resp);
+
+		throw;
+	}
+}
+
+OcspResult Ocsp::check(Handle<Certificate> cert, Handle<Certificate> issuer, Handle<CertificateCollection> trusted, const std::string &url) {
+	LOGGER_FN();
+
+	OCSP_CERTID *id = NULL;
+	OCSP_REQUEST *req = NULL;
+
+	try {
+		id = createCertId(cert, issuer);
+		std::string certId = encodeCertId(id);
+		OcspResult res;
+
+		if (!this->cache_.isEmpty()) {
+			if (this->cache_->get(certId, res)) {
+				OCSP_CERTID_free(id);
+				return res;
+			}
+
+			std::string saved = this->cache_->load(certId);
+			if (!saved.empty() && !this->nonce_) {
+				try {
+					res = Ocsp::verifyResponse(saved, id, NULL, issuer, trusted);
+
+					if (OcspCache::isFresh(res, time(NULL))) {
+						this->cache_->put(certId, res);
+						OCSP_CERTID_free(id);
+
+						res.cached = true;
+						return res;
+					}
+				}
+				catch (Handle<Exception> e) {
+					/* Outdated or broken file, ask the responder */
+				}
+				ERR_clear_error();
+			}
+		}
+
+		std::string location = url;
+		if (location.empty()) {
+			std::vector<std::string> urls = Ocsp::getResponderUrls(cert);
+			if (urls.empty()) {
+				THROW_EXCEPTION(0, Ocsp, NULL, "Certificate has no OCSP responder URL");
+			}
+			location = urls[0];
+		}
+
+		LOGGER_OPENSSL(OCSP_CERTID_dup);
+		OCSP_CERTID *reqId = OCSP_CERTID_dup(id);
+		if (!reqId) {
+			THROW_OPENSSL_EXCEPTION(0, Ocsp, NULL, "Error copy CertID");
+		}
+		req = createOcspRequest(reqId, this->nonce_);
+
+		std::string response = this->transport_->send(location, encodeOcspRequest(req));
+		res = Ocsp::verifyResponse(response, id, this->nonce_ ? req : NULL, issuer, trusted);
+
+		if (!this->cache_.isEmpty()) {
+			this->cache_->put(certId, res);
+			this->cache_->save(certId, response);
+		}
+
+		OCSP_REQUEST_free(req);
+		OCSP_CERTID_free(id);
+
+		return res;
+	}
+	catch (Handle<Exception> e) {
+		OCSP_REQUEST_free(req);
+		OCSP_CERTID_free(id);
+
+		THROW_EXCEPTION(0, Ocsp, e, "Error check certificate status with OCSP");
+	}
+}
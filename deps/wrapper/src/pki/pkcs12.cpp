@@ -1,5 +1,7 @@
 #include "../stdafx.h"
 
+#include <openssl/sha.h>
+
 #include "wrapper/pki/pkcs12.h"
 
 void Pkcs12::read(Handle<Bio> in){
@@ -20,6 +22,9 @@ void Pkcs12::read(Handle<Bio> in){
 	}
 
 	this->setData(p12);
+
+	this->content_ = NULL;
+	this->contentPassword_.clear();
 }
 
 void Pkcs12::write(Handle<Bio> out){
@@ -54,75 +59,145 @@ Handle<Pkcs12> Pkcs12::create(Handle<Certificate> cert, Handle<Key> key, Handle<
 	}
 }
 
-Handle<Certificate> Pkcs12::getCertificate(const char *pass) {
+std::string Pkcs12::hashPassword(const char *pass) {
+	unsigned char md[SHA256_DIGEST_LENGTH];
+	SHA256((const unsigned char *)(pass ? pass : ""), pass ? strlen(pass) : 0, md);
+
+	return std::string((const char *)md, sizeof(md));
+}
+
+Handle<Pkcs12Content> Pkcs12::parse(const char *pass) {
 	LOGGER_FN();
 
 	try{
-		EVP_PKEY *pkey;
-		X509 *hcert;
+		std::string password = Pkcs12::hashPassword(pass);
+
+		if (!this->content_.isEmpty() && this->contentPassword_ == password) {
+			return this->content_;
+		}
+
+		EVP_PKEY *pkey = NULL;
+		X509 *hcert = NULL;
 		STACK_OF(X509) *ca = NULL;
 
+		LOGGER_OPENSSL(PKCS12_parse);
 		if (!PKCS12_parse(this->internal(), pass, &pkey, &hcert, &ca)) {
 			THROW_OPENSSL_EXCEPTION(0, Pkcs12, NULL, "Error parsing PKCS12", NULL);
 		}
 
-		if (hcert){
-			return new Certificate(hcert);
+		Handle<Pkcs12Content> content = new Pkcs12Content();
+		if (hcert) {
+			content->certificate = new Certificate(hcert);
 		}
-		else {
-			THROW_EXCEPTION(0, Pkcs12, NULL, "Cannot get certificate", 1);
+		if (pkey) {
+			content->key = new Key(pkey);
 		}
-		
+		content->ca = ca ? new CertificateCollection(ca) : new CertificateCollection();
+
+		this->content_ = content;
+		this->contentPassword_ = password;
+
+		return content;
 	}
 	catch (Handle<Exception> e){
-		THROW_EXCEPTION(0, Pkcs12, e, "Error get certificate from pkcs12");
+		THROW_EXCEPTION(0, Pkcs12, e, "Error open pkcs12");
 	}
 }
 
-Handle<Key> Pkcs12::getKey(const char *pass) {
+Handle<CertificateCollection> Pkcs12::copyCollection(Handle<CertificateCollection> certs) {
+	Handle<CertificateCollection> res = new CertificateCollection();
+
+	for (int i = 0, c = certs->length(); i < c; i++) {
+		res->push(certs->items(i));
+	}
+
+	return res;
+}
+
+Handle<Key> Pkcs12::copyKey(Handle<Key> key) {
 	LOGGER_FN();
 
-	try{
-		EVP_PKEY *pkey;
-		X509 *hcert;
-		STACK_OF(X509) *ca = NULL;
+	/* Key::duplicate shares the EVP_PKEY, a DER round trip gives a separate one */
+	unsigned char *der = NULL;
+	LOGGER_OPENSSL(i2d_PrivateKey);
+	int len = i2d_PrivateKey(key->internal(), &der);
+	if (len <= 0) {
+		THROW_OPENSSL_EXCEPTION(0, Pkcs12, NULL, "i2d_PrivateKey");
+	}
 
-		if (!PKCS12_parse(this->internal(), pass, &pkey, &hcert, &ca)) {
-			THROW_OPENSSL_EXCEPTION(0, Pkcs12, NULL, "Error parsing PKCS12", NULL);
-		}
+	const unsigned char *p = der;
+	LOGGER_OPENSSL(d2i_PrivateKey);
+	EVP_PKEY *pkey = d2i_PrivateKey(EVP_PKEY_id(key->internal()), NULL, &p, len);
+	OPENSSL_cleanse(der, len);
+	OPENSSL_free(der);
+	if (!pkey) {
+		THROW_OPENSSL_EXCEPTION(0, Pkcs12, NULL, "d2i_PrivateKey");
+	}
 
-		if (pkey) {
-			return new Key(pkey);
+	return new Key(pkey);
+}
+
+Handle<Pkcs12Content> Pkcs12::open(const char *pass) {
+	LOGGER_FN();
+
+	try{
+		Handle<Pkcs12Content> content = this->parse(pass);
+		Handle<Pkcs12Content> res = new Pkcs12Content();
+
+		if (!content->certificate.isEmpty()) {
+			res->certificate = content->certificate->duplicate();
 		}
-		else {
-			THROW_EXCEPTION(0, Pkcs12, NULL, "Cannot get key", 1);
+		if (!content->key.isEmpty()) {
+			res->key = Pkcs12::copyKey(content->key);
 		}
-		
+		res->ca = Pkcs12::copyCollection(content->ca);
+
+		return res;
 	}
 	catch (Handle<Exception> e){
-		THROW_EXCEPTION(0, Pkcs12, e, "Error get key from pkcs12");
+		THROW_EXCEPTION(0, Pkcs12, e, "Error open pkcs12");
 	}
 }
 
-Handle<CertificateCollection> Pkcs12::getCACertificates(const char *pass) {
+Handle<Certificate> Pkcs12::getCertificate(const char *pass) {
 	LOGGER_FN();
 
 	try{
-		EVP_PKEY *pkey;
-		X509 *hcert;
-		STACK_OF(X509) *ca = NULL;
+		Handle<Pkcs12Content> content = this->parse(pass);
 
-		if (!PKCS12_parse(this->internal(), pass, &pkey, &hcert, &ca)) {
-			THROW_OPENSSL_EXCEPTION(0, Pkcs12, NULL, "Error parsing PKCS12", NULL);
+		if (content->certificate.isEmpty()) {
+			THROW_EXCEPTION(0, Pkcs12, NULL, "Cannot get certificate", 1);
 		}
 
-		if (ca){
-			return new CertificateCollection(ca);
-		}
-		else {
-			return new CertificateCollection();
+		return content->certificate->duplicate();
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Pkcs12, e, "Error get certificate from pkcs12");
+	}
+}
+
+Handle<Key> Pkcs12::getKey(const char *pass) {
+	LOGGER_FN();
+
+	try{
+		Handle<Pkcs12Content> content = this->parse(pass);
+
+		if (content->key.isEmpty()) {
+			THROW_EXCEPTION(0, Pkcs12, NULL, "Cannot get key", 1);
 		}
 
+		return Pkcs12::copyKey(content->key);
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Pkcs12, e, "Error get key from pkcs12");
+	}
+}
+
+Handle<CertificateCollection> Pkcs12::getCACertificates(const char *pass) {
+	LOGGER_FN();
+
+	try{
+		return Pkcs12::copyCollection(this->parse(pass)->ca);
 	}
 	catch (Handle<Exception> e){
 		THROW_EXCEPTION(0, Pkcs12, e, "Error get ca from pkcs12");
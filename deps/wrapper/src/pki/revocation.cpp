@@ -1,6 +1,7 @@
 #include "../stdafx.h"
 
 #include "wrapper/pki/revocation.h"
+#include "wrapper/pki/crl_reader.h"
 
 Handle<CRL> Revocation::getCrlLocal(Handle<Certificate> cert, Handle<PkiStore> pkiStore){
 	LOGGER_FN();
@@ -43,8 +44,13 @@ Handle<CRL> Revocation::getCrlLocal(Handle<Certificate> cert, Handle<PkiStore> p
 				THROW_OPENSSL_EXCEPTION(0, Revocation, NULL, "sk_X509_CRL_value 'Unable get element of STACK_OF(X509_CRL)'");
 			}
 
+			/* deltaCRLIndicator */
+			if (xtempCRL->base_crl_number) {
+				continue;
+			}
+
 			LOGGER_OPENSSL(X509_get_issuer_name);
-			certIss = X509_get_issuer_name(cert->internal());
+			certIss = X509_get_issuer_name(cert->raw());
 			if (!certIss){
 				THROW_OPENSSL_EXCEPTION(0, Revocation, NULL, "X509_get_issuer_name 'Unable get cert issuer name'");
 			}
@@ -58,7 +64,7 @@ Handle<CRL> Revocation::getCrlLocal(Handle<Certificate> cert, Handle<PkiStore> p
 			LOGGER_OPENSSL(X509_NAME_cmp);
 			if (X509_NAME_cmp(certIss, crlIss) == 0){
 				LOGGER_OPENSSL(X509_check_akid);
-				ret = X509_check_akid(cert->internal(), xtempCRL->akid);
+				ret = X509_check_akid(cert->raw(), xtempCRL->akid);
 				if (ret == X509_V_OK){
 					return new CRL(xtempCRL);
 				}
@@ -72,11 +78,61 @@ Handle<CRL> Revocation::getCrlLocal(Handle<Certificate> cert, Handle<PkiStore> p
 	}
 }
 
+Handle<CRL> Revocation::getDeltaCrlLocal(Handle<CRL> hcrl, Handle<PkiStore> pkiStore){
+	LOGGER_FN();
+
+	try{
+		X509_CRL *crl = hcrl->raw();
+		X509_CRL *best = NULL;
+		Handle<CRL> res = new CRL();
+
+		if (!crl->crl_number){
+			return res;
+		}
+
+		Handle<Filter> filter = new Filter();
+		filter->types.push_back(new std::string("CRL"));
+
+		Handle<PkiItemCollection> filteredItems = pkiStore->find(filter);
+
+		for (int i = 0; i < filteredItems->length(); i++) {
+			Handle<CRL> item = pkiStore->getItemCrl(filteredItems->items(i));
+			X509_CRL *delta = item->raw();
+
+			if (!delta->base_crl_number || !delta->crl_number){
+				continue;
+			}
+
+			LOGGER_OPENSSL(X509_NAME_cmp);
+			if (X509_NAME_cmp(X509_CRL_get_issuer(delta), X509_CRL_get_issuer(crl)) != 0){
+				continue;
+			}
+
+			/* Base must be not older than BaseCRLNumber, delta must be newer than base */
+			LOGGER_OPENSSL(ASN1_INTEGER_cmp);
+			if (ASN1_INTEGER_cmp(delta->base_crl_number, crl->crl_number) > 0 ||
+				ASN1_INTEGER_cmp(delta->crl_number, crl->crl_number) <= 0){
+				continue;
+			}
+
+			if (!best || ASN1_INTEGER_cmp(delta->crl_number, best->crl_number) > 0){
+				best = delta;
+				res = item;
+			}
+		}
+
+		return res;
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Revocation, e, "Error get delta CRL local");
+	}
+}
+
 bool Revocation::checkCrlTime(Handle<CRL> hcrl) {
 	LOGGER_FN();
 
 	try{
-		X509_CRL *crl = hcrl->internal();
+		X509_CRL *crl = hcrl->raw();
 		if (!crl) {
 			THROW_EXCEPTION(0, Revocation, NULL, "Unable get current machine time");
 		}
@@ -129,7 +185,7 @@ std::vector<std::string> Revocation::getCrlDistPoints(Handle<Certificate> cert){
 	try{
 		STACK_OF(DIST_POINT)* pStack = NULL;
 		LOGGER_OPENSSL(X509_get_ext_d2i);
-		pStack = (STACK_OF(DIST_POINT)*) X509_get_ext_d2i(cert->internal(), NID_crl_distribution_points, NULL, NULL);
+		pStack = (STACK_OF(DIST_POINT)*) X509_get_ext_d2i(cert->raw(), NID_crl_distribution_points, NULL, NULL);
 		if (pStack){
 			LOGGER_OPENSSL(sk_DIST_POINT_num);
 			for (int j = 0; j < sk_DIST_POINT_num(pStack); j++){
@@ -164,3 +220,68 @@ std::vector<std::string> Revocation::getCrlDistPoints(Handle<Certificate> cert){
 
 	return res;
 }
+
+std::vector<std::string> Revocation::getDeltaCrlDistPoints(Handle<CRL> crl){
+	LOGGER_FN();
+
+	std::vector<std::string> res;
+
+	try{
+		LOGGER_OPENSSL(X509_CRL_get_ext_d2i);
+		STACK_OF(DIST_POINT) *points = (STACK_OF(DIST_POINT) *)X509_CRL_get_ext_d2i(crl->raw(), NID_freshest_crl, NULL, NULL);
+		if (!points){
+			return res;
+		}
+
+		for (int i = 0; i < sk_DIST_POINT_num(points); i++){
+			DIST_POINT *point = sk_DIST_POINT_value(points, i);
+			if (!point->distpoint || point->distpoint->type != 0){
+				continue;
+			}
+
+			STACK_OF(GENERAL_NAME) *names = point->distpoint->name.fullname;
+			for (int j = 0; j < sk_GENERAL_NAME_num(names); j++){
+				GENERAL_NAME *name = sk_GENERAL_NAME_value(names, j);
+				if (name->type == GEN_URI){
+					LOGGER_OPENSSL(ASN1_STRING_data);
+					res.push_back((const char *)ASN1_STRING_data(name->d.uniformResourceIdentifier));
+				}
+			}
+		}
+
+		LOGGER_OPENSSL(sk_DIST_POINT_pop_free);
+		sk_DIST_POINT_pop_free(points, DIST_POINT_free);
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Revocation, e, "Error get freshest CRL DP");
+	}
+
+	return res;
+}
+
+Handle<RevocationIndex> Revocation::getRevocationIndex(Handle<CRL> crl, Handle<CRL> delta, Handle<Certificate> issuer){
+	LOGGER_FN();
+
+	try{
+		/* Unverified delta could remove serials from the base CRL */
+		if (issuer.isEmpty()){
+			THROW_EXCEPTION(0, Revocation, NULL, ERROR_PARAMETER_NULL, 3);
+		}
+
+		Handle<std::string> encoded = crl->getEncoded();
+		Handle<RevocationIndex> res = CrlReader::read(new Bio(BIO_new_mem_buf((void *)encoded->data(), (int)encoded->length())), DataFormat::DER, issuer);
+
+		/* getDeltaCrlLocal returns an empty CRL if there is no delta */
+		if (delta.isEmpty() || !delta->raw()->base_crl_number){
+			return res;
+		}
+
+		encoded = delta->getEncoded();
+		Handle<RevocationIndex> deltaIndex = CrlReader::read(new Bio(BIO_new_mem_buf((void *)encoded->data(), (int)encoded->length())), DataFormat::DER, issuer);
+
+		return RevocationIndex::applyDelta(res, deltaIndex);
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, Revocation, e, "Error get revocation index");
+	}
+}
@@ -0,0 +1,662 @@
+#include "../stdafx.h"
+
+#include <algorithm>
+
+#include "wrapper/pki/revocation_index.h"
+
+#define REVOCATION_INDEX_MAGIC "CRIX"
+#define REVOCATION_INDEX_VERSION 3
+
+static void stripZeros(const unsigned char *&serial, size_t &length) {
+	while (length > 0 && serial[0] == 0) {
+		serial++;
+		length--;
+	}
+}
+
+/* FNV-1a, serials are mostly random so it is good enough for the filter */
+static uint64_t serialHash(const unsigned char *serial, size_t length) {
+	uint64_t h = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < length; i++) {
+		h ^= serial[i];
+		h *= 1099511628211ULL;
+	}
+
+	return h;
+}
+
+/* First 8 bytes of a padded serial as a number, ordered as memcmp of the serials */
+static uint64_t serialPrefix(const unsigned char *serial, size_t width) {
+	uint64_t res = 0;
+
+	for (size_t i = 0; i < 8; i++) {
+		res = (res << 8) | (i < width ? serial[i] : 0);
+	}
+
+	return res;
+}
+
+static void putUInt64(std::string &out, uint64_t value) {
+	for (int i = 0; i < 8; i++) {
+		out += (char)(value >> (i * 8));
+	}
+}
+
+static uint64_t getUInt64(const unsigned char *p) {
+	uint64_t res = 0;
+
+	for (int i = 7; i >= 0; i--) {
+		res = (res << 8) | p[i];
+	}
+
+	return res;
+}
+
+static void putBytes(std::string &out, const std::string &value) {
+	putUInt64(out, value.length());
+	out += value;
+}
+
+/* Bounds checked reader over the saved index */
+class IndexCursor {
+public:
+	IndexCursor(const unsigned char *p, const unsigned char *end) : p_(p), end_(end) {}
+
+	const unsigned char *take(uint64_t count) {
+		if ((uint64_t)(this->end_ - this->p_) < count) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, "Revocation index is corrupted");
+		}
+
+		const unsigned char *res = this->p_;
+		this->p_ += count;
+
+		return res;
+	}
+
+	uint64_t number() {
+		return getUInt64(this->take(8));
+	}
+
+	std::string bytes() {
+		uint64_t length = this->number();
+
+		return std::string((const char *)this->take(length), (size_t)length);
+	}
+
+	bool atEnd() {
+		return this->p_ == this->end_;
+	}
+
+protected:
+	const unsigned char *p_;
+	const unsigned char *end_;
+};
+
+/* Compares serials padded to different widths */
+static int compareSerials(const unsigned char *a, size_t aWidth, const unsigned char *b, size_t bWidth) {
+	for (; aWidth > bWidth; a++, aWidth--) {
+		if (*a) {
+			return 1;
+		}
+	}
+	for (; bWidth > aWidth; b++, bWidth--) {
+		if (*b) {
+			return -1;
+		}
+	}
+
+	return memcmp(a, b, aWidth);
+}
+
+/* CRL numbers are big-endian without leading zeros */
+static int compareNumbers(const std::string &a, const std::string &b) {
+	if (a.length() != b.length()) {
+		return a.length() < b.length() ? -1 : 1;
+	}
+
+	return memcmp(a.data(), b.data(), a.length());
+}
+
+class SerialLess {
+public:
+	SerialLess(const unsigned char *serials, size_t width) : serials_(serials), width_(width) {}
+
+	bool operator()(uint32_t a, uint32_t b) const {
+		return memcmp(this->serials_ + a * this->width_, this->serials_ + b * this->width_, this->width_) < 0;
+	}
+
+protected:
+	const unsigned char *serials_;
+	size_t width_;
+};
+
+RevocationIndex::RevocationIndex()
+	: thisUpdate(0), nextUpdate(0), width_(0), sorted_(true), bloomBitsPerEntry_(0), bloomHashes_(0)
+{
+}
+
+void RevocationIndex::add(const unsigned char *serial, size_t length, time_t date, int reason) {
+	stripZeros(serial, length);
+
+	if (length > 0xFF) {
+		THROW_EXCEPTION(0, RevocationIndex, NULL, "Serial number is too long (%d bytes)", (int)length);
+	}
+
+	if (length > this->width_) {
+		this->widen(length);
+	}
+
+	size_t count = this->dates_.size();
+	size_t offset = count * this->width_;
+
+	this->serials_.resize(offset + this->width_);
+	unsigned char *p = &this->serials_[offset];
+	memset(p, 0, this->width_ - length);
+	memcpy(p + this->width_ - length, serial, length);
+
+	if (this->sorted_ && count && memcmp(p - this->width_, p, this->width_) > 0) {
+		this->sorted_ = false;
+	}
+
+	this->dates_.push_back((int64_t)date);
+	this->reasons_.push_back((int8_t)reason);
+	this->prefixes_.clear();
+	this->bloom_.clear();
+}
+
+/* Appends serial padded to width <= width_. Caller keeps the order */
+void RevocationIndex::append(const unsigned char *serial, size_t width, int64_t date, int8_t reason) {
+	size_t offset = this->serials_.size();
+
+	this->serials_.resize(offset + this->width_, 0);
+	memcpy(&this->serials_[offset + this->width_ - width], serial, width);
+	this->dates_.push_back(date);
+	this->reasons_.push_back(reason);
+}
+
+/* Appends entries [from, to) of src, whose width is <= width_ */
+void RevocationIndex::appendRange(const RevocationIndex &src, size_t from, size_t to) {
+	if (src.width_ == this->width_) {
+		this->serials_.insert(this->serials_.end(), src.serials_.begin() + from * src.width_, src.serials_.begin() + to * src.width_);
+	}
+	else {
+		size_t offset = this->serials_.size() + this->width_ - src.width_;
+
+		this->serials_.resize(this->serials_.size() + (to - from) * this->width_, 0);
+		for (size_t i = from; i < to; i++, offset += this->width_) {
+			memcpy(&this->serials_[offset], &src.serials_[i * src.width_], src.width_);
+		}
+	}
+
+	this->dates_.insert(this->dates_.end(), src.dates_.begin() + from, src.dates_.begin() + to);
+	this->reasons_.insert(this->reasons_.end(), src.reasons_.begin() + from, src.reasons_.begin() + to);
+}
+
+/* First entry from the given one which is not less than serial */
+size_t RevocationIndex::lowerBound(const unsigned char *serial, size_t width, size_t from) {
+	size_t lo = from;
+	size_t hi = this->dates_.size();
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (compareSerials(&this->serials_[mid * this->width_], this->width_, serial, width) < 0) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+/* Re-pads all serials to a bigger width. Order does not change */
+void RevocationIndex::widen(size_t width) {
+	size_t count = this->dates_.size();
+
+	if (count) {
+		std::vector<unsigned char> serials(count * width, 0);
+
+		for (size_t i = 0; i < count; i++) {
+			memcpy(&serials[i * width + width - this->width_], &this->serials_[i * this->width_], this->width_);
+		}
+		this->serials_.swap(serials);
+	}
+
+	this->width_ = width;
+}
+
+void RevocationIndex::buildPrefixes() {
+	size_t count = this->dates_.size();
+
+	this->prefixes_.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		this->prefixes_[i] = serialPrefix(&this->serials_[i * this->width_], this->width_);
+	}
+}
+
+void RevocationIndex::setBloomFilter(int bitsPerEntry) {
+	this->bloomBitsPerEntry_ = bitsPerEntry > 0 ? bitsPerEntry : 0;
+	this->bloom_.clear();
+}
+
+void RevocationIndex::sort() {
+	LOGGER_FN();
+
+	size_t count = this->dates_.size();
+
+	if (!this->sorted_) {
+		std::vector<uint32_t> order(count);
+		for (size_t i = 0; i < count; i++) {
+			order[i] = (uint32_t)i;
+		}
+		std::sort(order.begin(), order.end(), SerialLess(&this->serials_[0], this->width_));
+
+		std::vector<unsigned char> serials(this->serials_.size());
+		std::vector<int64_t> dates(count);
+		std::vector<int8_t> reasons(count);
+		for (size_t i = 0; i < count; i++) {
+			memcpy(&serials[i * this->width_], &this->serials_[order[i] * this->width_], this->width_);
+			dates[i] = this->dates_[order[i]];
+			reasons[i] = this->reasons_[order[i]];
+		}
+
+		this->serials_.swap(serials);
+		this->dates_.swap(dates);
+		this->reasons_.swap(reasons);
+		this->sorted_ = true;
+	}
+
+	this->buildPrefixes();
+
+	this->bloom_.clear();
+	if (!this->bloomBitsPerEntry_ || !count) {
+		return;
+	}
+
+	/* k = ln 2 * m / n is optimal */
+	this->bloomHashes_ = (this->bloomBitsPerEntry_ * 7 + 5) / 10;
+	if (this->bloomHashes_ < 1) {
+		this->bloomHashes_ = 1;
+	}
+	if (this->bloomHashes_ > 16) {
+		this->bloomHashes_ = 16;
+	}
+
+	/* Power of two, so a bit is selected with a mask */
+	uint64_t bits = 64;
+	while (bits < (uint64_t)count * this->bloomBitsPerEntry_) {
+		bits <<= 1;
+	}
+	this->bloom_.assign((size_t)(bits / 64), 0);
+
+	for (size_t i = 0; i < count; i++) {
+		const unsigned char *serial = &this->serials_[i * this->width_];
+		size_t length = this->width_;
+		stripZeros(serial, length);
+
+		uint64_t h = serialHash(serial, length);
+		uint64_t h1 = h & 0xFFFFFFFF;
+		uint64_t h2 = (h >> 32) | 1;
+		for (int k = 0; k < this->bloomHashes_; k++) {
+			uint64_t bit = (h1 + k * h2) & (bits - 1);
+			this->bloom_[(size_t)(bit >> 6)] |= (uint64_t)1 << (bit & 63);
+		}
+	}
+}
+
+bool RevocationIndex::mayContain(const unsigned char *serial, size_t length) {
+	if (this->bloom_.empty()) {
+		return true;
+	}
+
+	uint64_t mask = (uint64_t)this->bloom_.size() * 64 - 1;
+	uint64_t h = serialHash(serial, length);
+	uint64_t h1 = h & 0xFFFFFFFF;
+	uint64_t h2 = (h >> 32) | 1;
+
+	for (int k = 0; k < this->bloomHashes_; k++) {
+		uint64_t bit = (h1 + k * h2) & mask;
+		if (!(this->bloom_[(size_t)(bit >> 6)] & ((uint64_t)1 << (bit & 63)))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t RevocationIndex::length() {
+	return this->dates_.size();
+}
+
+Handle<std::string> RevocationIndex::getSerialNumber(size_t index) {
+	LOGGER_FN();
+
+	if (index >= this->dates_.size()) {
+		THROW_EXCEPTION(0, RevocationIndex, NULL, "Has no item by index %d", (int)index);
+	}
+
+	static const char hex[] = "0123456789ABCDEF";
+	const unsigned char *serial = &this->serials_[index * this->width_];
+	size_t length = this->width_;
+	stripZeros(serial, length);
+
+	if (!length) {
+		return new std::string("00");
+	}
+
+	Handle<std::string> res = new std::string(length * 2, '0');
+	for (size_t i = 0; i < length; i++) {
+		(*res)[i * 2] = hex[serial[i] >> 4];
+		(*res)[i * 2 + 1] = hex[serial[i] & 0x0F];
+	}
+
+	return res;
+}
+
+time_t RevocationIndex::getRevocationDate(size_t index) {
+	if (index >= this->dates_.size()) {
+		THROW_EXCEPTION(0, RevocationIndex, NULL, "Has no item by index %d", (int)index);
+	}
+
+	return (time_t)this->dates_[index];
+}
+
+int RevocationIndex::getReason(size_t index) {
+	if (index >= this->dates_.size()) {
+		THROW_EXCEPTION(0, RevocationIndex, NULL, "Has no item by index %d", (int)index);
+	}
+
+	return this->reasons_[index];
+}
+
+long RevocationIndex::find(const unsigned char *serial, size_t length) {
+	stripZeros(serial, length);
+
+	if (length > this->width_ || this->dates_.empty()) {
+		return -1;
+	}
+
+	if (!this->sorted_ || this->prefixes_.size() != this->dates_.size()) {
+		this->sort();
+	}
+
+	if (!this->mayContain(serial, length)) {
+		return -1;
+	}
+
+	unsigned char key[0x100];
+	memset(key, 0, this->width_ - length);
+	memcpy(key + this->width_ - length, serial, length);
+
+	/* Lower bound over the prefixes */
+	uint64_t prefix = serialPrefix(key, this->width_);
+	const uint64_t *prefixes = &this->prefixes_[0];
+	size_t count = this->prefixes_.size();
+	size_t lo = 0;
+	size_t hi = count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (prefixes[mid] < prefix) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+
+	for (size_t i = lo; i < count && prefixes[i] == prefix; i++) {
+		if (this->width_ <= 8 || !memcmp(&this->serials_[i * this->width_], key, this->width_)) {
+			return (long)i;
+		}
+	}
+
+	return -1;
+}
+
+bool RevocationIndex::isRevoked(const unsigned char *serial, size_t length) {
+	return this->find(serial, length) >= 0;
+}
+
+bool RevocationIndex::isRevoked(Handle<Certificate> cert) {
+	LOGGER_FN();
+
+	ASN1_INTEGER *serial = X509_get_serialNumber(cert->raw());
+
+	return this->isRevoked(serial->data, serial->length);
+}
+
+bool RevocationIndex::isDelta() {
+	return !this->baseCrlNumber.empty();
+}
+
+Handle<RevocationIndex> RevocationIndex::applyDelta(Handle<RevocationIndex> base, Handle<RevocationIndex> delta) {
+	LOGGER_FN();
+
+	try {
+		if (base.isEmpty()) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, ERROR_PARAMETER_NULL, 1);
+		}
+		if (delta.isEmpty()) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, ERROR_PARAMETER_NULL, 2);
+		}
+		if (!delta->isDelta()) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, "CRL is not a delta CRL");
+		}
+		if (base->isDelta()) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, "Base CRL is a delta CRL");
+		}
+		if (!base->issuer.empty() && !delta->issuer.empty() && base->issuer != delta->issuer) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, "Delta CRL has another issuer");
+		}
+		if (base->crlNumber.empty()) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, "Base CRL has no CRL number");
+		}
+		if (compareNumbers(base->crlNumber, delta->baseCrlNumber) < 0) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, "Delta CRL requires a newer base CRL");
+		}
+
+		if (compareNumbers(delta->crlNumber, base->crlNumber) <= 0) {
+			return base;
+		}
+
+		base->sort();
+		delta->sort();
+
+		/* Both are sorted. Runs of base entries between delta entries are copied as blocks */
+		Handle<RevocationIndex> res = new RevocationIndex();
+		size_t count = base->dates_.size();
+		size_t deltaCount = delta->dates_.size();
+		size_t i = 0;
+
+		res->width_ = base->width_ > delta->width_ ? base->width_ : delta->width_;
+		res->serials_.reserve((count + deltaCount) * res->width_);
+		res->dates_.reserve(count + deltaCount);
+		res->reasons_.reserve(count + deltaCount);
+
+		for (size_t j = 0; j < deltaCount; j++) {
+			const unsigned char *serial = &delta->serials_[j * delta->width_];
+			size_t k = base->lowerBound(serial, delta->width_, i);
+
+			res->appendRange(*base, i, k);
+			i = k;
+
+			/* Delta entry replaces the base one */
+			if (i < count && !compareSerials(&base->serials_[i * base->width_], base->width_, serial, delta->width_)) {
+				i++;
+			}
+			if (delta->reasons_[j] != REVOCATION_REASON_REMOVE_FROM_CRL) {
+				res->append(serial, delta->width_, delta->dates_[j], delta->reasons_[j]);
+			}
+		}
+		res->appendRange(*base, i, count);
+
+		res->thisUpdate = delta->thisUpdate;
+		res->nextUpdate = delta->nextUpdate;
+		res->issuer = base->issuer;
+		res->crlNumber = delta->crlNumber;
+		res->freshestCrl = base->freshestCrl;
+		res->setBloomFilter(base->bloomBitsPerEntry_);
+		res->sort();
+
+		return res;
+	}
+	catch (Handle<Exception> e) {
+		THROW_EXCEPTION(0, RevocationIndex, e, "Error apply delta CRL");
+	}
+}
+
+/*
+ * Little-endian layout:
+ * magic, version, width, count, thisUpdate, nextUpdate, bloom hashes,
+ * bloom words (8 bytes each except magic), length prefixed fingerprint,
+ * issuer key, issuer, crlNumber, baseCrlNumber, count and freshestCrl URLs, then
+ * serials, dates, reasons and bloom words
+ */
+void RevocationIndex::write(Handle<Bio> out) {
+	LOGGER_FN();
+
+	try {
+		if (out.isEmpty()) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, ERROR_PARAMETER_NULL, 1);
+		}
+
+		this->sort();
+
+		size_t count = this->dates_.size();
+		std::string data(REVOCATION_INDEX_MAGIC);
+
+		putUInt64(data, REVOCATION_INDEX_VERSION);
+		putUInt64(data, this->width_);
+		putUInt64(data, count);
+		putUInt64(data, (uint64_t)(int64_t)this->thisUpdate);
+		putUInt64(data, (uint64_t)(int64_t)this->nextUpdate);
+		putUInt64(data, this->bloom_.empty() ? 0 : this->bloomHashes_);
+		putUInt64(data, this->bloom_.size());
+		putBytes(data, this->fingerprint);
+		putBytes(data, this->issuerKey);
+		putBytes(data, this->issuer);
+		putBytes(data, this->crlNumber);
+		putBytes(data, this->baseCrlNumber);
+		putUInt64(data, this->freshestCrl.size());
+		for (size_t i = 0; i < this->freshestCrl.size(); i++) {
+			putBytes(data, this->freshestCrl[i]);
+		}
+
+		data.reserve(data.length() + this->serials_.size() + count * 9 + this->bloom_.size() * 8);
+		if (count) {
+			data.append((const char *)&this->serials_[0], this->serials_.size());
+		}
+		for (size_t i = 0; i < count; i++) {
+			putUInt64(data, (uint64_t)this->dates_[i]);
+		}
+		if (count) {
+			data.append((const char *)&this->reasons_[0], count);
+		}
+		for (size_t i = 0; i < this->bloom_.size(); i++) {
+			putUInt64(data, this->bloom_[i]);
+		}
+
+		LOGGER_OPENSSL(BIO_write);
+		if (BIO_write(out->internal(), data.data(), (int)data.length()) != (int)data.length()) {
+			THROW_OPENSSL_EXCEPTION(0, RevocationIndex, NULL, "BIO_write");
+		}
+	}
+	catch (Handle<Exception> e) {
+		THROW_EXCEPTION(0, RevocationIndex, e, "Error write revocation index");
+	}
+}
+
+void RevocationIndex::read(Handle<Bio> in) {
+	LOGGER_FN();
+
+	try {
+		if (in.isEmpty()) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, ERROR_PARAMETER_NULL, 1);
+		}
+
+		std::string data;
+		char buf[64 * 1024];
+		int n;
+
+		LOGGER_OPENSSL(BIO_read);
+		while ((n = BIO_read(in->internal(), buf, sizeof(buf))) > 0) {
+			data.append(buf, n);
+		}
+
+		IndexCursor cursor((const unsigned char *)data.data(), (const unsigned char *)data.data() + data.length());
+
+		if (data.length() < 4 || memcmp(cursor.take(4), REVOCATION_INDEX_MAGIC, 4)) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, "Data is not a revocation index");
+		}
+		if (cursor.number() != REVOCATION_INDEX_VERSION) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, "Unsupported revocation index version");
+		}
+
+		uint64_t width = cursor.number();
+		uint64_t count = cursor.number();
+		time_t thisUpdate = (time_t)(int64_t)cursor.number();
+		time_t nextUpdate = (time_t)(int64_t)cursor.number();
+		uint64_t hashes = cursor.number();
+		uint64_t words = cursor.number();
+
+		if (width > 0xFF || hashes > 16 || (words & (words - 1)) || count > data.length() || words > data.length()) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, "Revocation index is corrupted");
+		}
+
+		this->fingerprint = cursor.bytes();
+		this->issuerKey = cursor.bytes();
+		this->issuer = cursor.bytes();
+		this->crlNumber = cursor.bytes();
+		this->baseCrlNumber = cursor.bytes();
+
+		uint64_t urls = cursor.number();
+		this->freshestCrl.clear();
+		for (uint64_t i = 0; i < urls; i++) {
+			this->freshestCrl.push_back(cursor.bytes());
+		}
+
+		const unsigned char *p = cursor.take(count * width);
+		/* Lookup is a binary search, an unsorted file would hide revoked serials */
+		for (uint64_t i = 1; i < count; i++) {
+			if (memcmp(p + (i - 1) * width, p + i * width, (size_t)width) > 0) {
+				THROW_EXCEPTION(0, RevocationIndex, NULL, "Revocation index is not sorted");
+			}
+		}
+		this->width_ = (size_t)width;
+		this->serials_.assign(p, p + count * width);
+
+		p = cursor.take(count * 8);
+		this->dates_.resize((size_t)count);
+		for (size_t i = 0; i < count; i++, p += 8) {
+			this->dates_[i] = (int64_t)getUInt64(p);
+		}
+
+		p = cursor.take(count);
+		this->reasons_.assign((const int8_t *)p, (const int8_t *)p + count);
+
+		p = cursor.take(words * 8);
+		this->bloom_.resize((size_t)words);
+		for (size_t i = 0; i < words; i++, p += 8) {
+			this->bloom_[i] = getUInt64(p);
+		}
+
+		if (!cursor.atEnd()) {
+			THROW_EXCEPTION(0, RevocationIndex, NULL, "Revocation index is corrupted");
+		}
+
+		this->thisUpdate = thisUpdate;
+		this->nextUpdate = nextUpdate;
+		this->buildPrefixes();
+		this->bloomHashes_ = (int)hashes;
+		this->bloomBitsPerEntry_ = count ? (int)(words * 64 / count) : 0;
+		this->sorted_ = true;
+	}
+	catch (Handle<Exception> e) {
+		THROW_EXCEPTION(0, RevocationIndex, e, "Error read revocation index");
+	}
+}
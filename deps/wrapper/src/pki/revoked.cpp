@@ -6,7 +6,7 @@ Handle<std::string> Revoked::getRevocationDate()
 {
 	LOGGER_FN();
 
-	ASN1_TIME *time = this->internal()->revocationDate;
+	ASN1_TIME *time = this->raw()->revocationDate;
 	LOGGER_OPENSSL(ASN1_TIME_to_generalizedtime);
 	ASN1_GENERALIZEDTIME *gtime = ASN1_TIME_to_generalizedtime(time, NULL);
 	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
@@ -23,7 +23,7 @@ Handle<std::string> Revoked::getSerialNumber() {
 	LOGGER_OPENSSL(BIO_new);
 	BIO * bioSerial = BIO_new(BIO_s_mem());
 	LOGGER_OPENSSL(i2a_ASN1_INTEGER);
-	if (i2a_ASN1_INTEGER(bioSerial, this->internal()->serialNumber) < 0){
+	if (i2a_ASN1_INTEGER(bioSerial, this->raw()->serialNumber) < 0){
 		THROW_OPENSSL_EXCEPTION(0, Revoked, NULL, "i2a_ASN1_INTEGER", NULL);
 	}
 
@@ -44,7 +44,7 @@ Handle<std::string> Revoked::getReason()
 	LOGGER_FN();
 
 	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
-	STACK_OF(X509_EXTENSION) *exts = this->internal()->extensions;
+	STACK_OF(X509_EXTENSION) *exts = this->raw()->extensions;
 	LOGGER_OPENSSL(sk_X509_EXTENSION_num);
 	for (int i = 0; i < sk_X509_EXTENSION_num(exts); i++) {
 		X509_EXTENSION *ex;
@@ -62,7 +62,7 @@ Handle<Revoked> Revoked::duplicate(){
 
 	X509_REVOKED *r = NULL;
 	LOGGER_OPENSSL(X509_REVOKED_dup);
-	r = X509_REVOKED_dup(this->internal());
+	r = X509_REVOKED_dup(this->raw());
 	if (!r)
 		THROW_EXCEPTION(1, Revoked, NULL, "X509_REVOKED_dup");
 	return new Revoked(r);
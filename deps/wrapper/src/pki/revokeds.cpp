@@ -12,7 +12,7 @@ void RevokedCollection::push(Handle<Revoked> rv) {
 	Handle<Revoked> rvcpy = rv->duplicate();
 
 	LOGGER_OPENSSL("sk_X509_REVOKED_push");
-	sk_X509_REVOKED_push(this->internal(), rvcpy->internal());
+	sk_X509_REVOKED_push(this->raw(), rvcpy->raw());
 
 	rvcpy->setParent(this->handle());
 }
@@ -24,32 +24,34 @@ int RevokedCollection::length() {
 		return 0;
 
 	LOGGER_OPENSSL("sk_X509_REVOKED_num");
-	return sk_X509_REVOKED_num(this->internal());
+	return sk_X509_REVOKED_num(this->raw());
 }
 
 Handle<Revoked> RevokedCollection::items(int index) {
 	LOGGER_FN();
 
 	LOGGER_OPENSSL("sk_X509_REVOKED_value");
-	X509_REVOKED *rv = sk_X509_REVOKED_value(this->internal(), index);
+	X509_REVOKED *rv = sk_X509_REVOKED_value(this->raw(), index);
 
 	if (!rv){
 		THROW_OPENSSL_EXCEPTION(0, RevokedCollection, NULL, "Has no item by index %d", index);
 	}
 
-	return (new Revoked(rv, this->handle()))->duplicate();
+	Handle<Revoked> item = new Revoked(rv, this->handle());
+
+	return item->duplicate();
 }
 
 void RevokedCollection::pop(){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL("sk_X509_REVOKED_value");
-	sk_X509_REVOKED_pop(this->internal());	
+	sk_X509_REVOKED_pop(this->raw());	
 }
 
 void RevokedCollection::removeAt(int index){
 	LOGGER_FN();
 
 	LOGGER_OPENSSL("sk_X509_REVOKED_delete");
-	sk_X509_REVOKED_delete(this->internal(), index);
+	sk_X509_REVOKED_delete(this->raw(), index);
 }
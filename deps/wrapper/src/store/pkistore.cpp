@@ -10,6 +10,28 @@
 	#include "wrapper/store/provider_cryptopro.h"
 #endif
 
+/*Canonical issuer name hash and DER of serial number, as X509_NAME_cmp and ASN1_INTEGER_cmp see them*/
+static std::string recipientIssuerSerialId(X509_NAME *issuer, ASN1_INTEGER *serial){
+	LOGGER_OPENSSL(X509_NAME_hash);
+	unsigned long hash = X509_NAME_hash(issuer);
+	int len;
+
+	LOGGER_OPENSSL(i2d_ASN1_INTEGER);
+	if ((len = i2d_ASN1_INTEGER(serial, NULL)) <= 0){
+		THROW_OPENSSL_EXCEPTION(0, PkiStore, NULL, "i2d_ASN1_INTEGER");
+	}
+
+	std::string res = "i" + std::string((const char *)&hash, sizeof hash) + std::string(len, 0);
+	unsigned char *p = (unsigned char *)&res[1 + sizeof hash];
+	i2d_ASN1_INTEGER(serial, &p);
+
+	return res;
+}
+
+static std::string recipientKeyId(ASN1_OCTET_STRING *keyid){
+	return "k" + std::string((const char *)ASN1_STRING_data(keyid), ASN1_STRING_length(keyid));
+}
+
 PkiStore::PkiStore(Handle<std::string> json){
 	LOGGER_FN();
 	
@@ -20,6 +42,7 @@ PkiStore::PkiStore(Handle<std::string> json){
 		
 		providers = new ProviderCollection();
 		storeItemCollection = new PkiItemCollection();
+		recipientsIndexed = false;
 	}
 	catch (Handle<Exception> e){
 		THROW_EXCEPTION(0, PkiStore, e, "Cannot be constructed PkiStore(Handle<std::string> json)");
@@ -99,6 +122,126 @@ Handle<PkiItem> PkiStore::findKey(Handle<Filter> filter){
 }
 
 
+Handle<PkiItem> PkiStore::findRecipient(Handle<CmsRecipientInfo> ri){
+	LOGGER_FN();
+
+	try{
+		ASN1_OCTET_STRING *keyid = NULL;
+		X509_NAME *issuer = NULL;
+		ASN1_INTEGER *serial = NULL;
+
+		if (ri.isEmpty() || !ri->ri){
+			THROW_PARAMETER_NULL(PkiStore, NULL, 1);
+		}
+
+		/*Key agreement and others need more than a certificate lookup*/
+		LOGGER_OPENSSL(CMS_RecipientInfo_type);
+		if (CMS_RecipientInfo_type(ri->ri) != CMS_RECIPINFO_TRANS){
+			return NULL;
+		}
+
+		LOGGER_OPENSSL(CMS_RecipientInfo_ktri_get0_signer_id);
+		if (!CMS_RecipientInfo_ktri_get0_signer_id(ri->ri, &keyid, &issuer, &serial)) {
+			THROW_OPENSSL_EXCEPTION(0, PkiStore, NULL, "CMS_RecipientInfo_ktri_get0_signer_id");
+		}
+
+		std::string id = keyid ? recipientKeyId(keyid) : recipientIssuerSerialId(issuer, serial);
+
+		if (!recipientsIndexed){
+			indexRecipients();
+		}
+
+		auto range = recipientIds.equal_range(id);
+		for (auto it = range.first; it != range.second; it++){
+			Recipient &recipient = recipients[it->second];
+
+			/*Hash of the name may collide*/
+			LOGGER_OPENSSL(CMS_RecipientInfo_ktri_cert_cmp);
+			if (CMS_RecipientInfo_ktri_cert_cmp(ri->ri, recipient.cert->internal()) != 0){
+				continue;
+			}
+
+			if (recipient.key.isEmpty()){
+				recipient.key = getItemKey(recipient.keyItem);
+			}
+
+			Handle<PkiItem> res = new PkiItem(*recipient.item);
+			res->certificate = recipient.cert;
+			res->key = recipient.key;
+
+			return res;
+		}
+
+		return NULL;
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, PkiStore, e, "Error search recipient");
+	}
+}
+
+void PkiStore::indexRecipients(){
+	LOGGER_FN();
+
+	try{
+		std::unordered_map<std::string, Handle<PkiItem> > keys;
+
+		recipients.clear();
+		recipientIds.clear();
+
+		for (int i = 0, c = storeItemCollection->length(); i < c; i++){
+			Handle<PkiItem> item = storeItemCollection->items(i);
+
+			if (strcmp(item->type->c_str(), "KEY") == 0){
+				keys[*item->hash] = item;
+			}
+		}
+
+		for (int i = 0, c = storeItemCollection->length(); i < c; i++){
+			Handle<PkiItem> item = storeItemCollection->items(i);
+
+			if (strcmp(item->type->c_str(), "CERTIFICATE") != 0 || item->certKey.isEmpty()){
+				continue;
+			}
+
+			auto key = keys.find(*item->certKey);
+			if (key == keys.end()){
+				continue;
+			}
+
+			Recipient recipient;
+			recipient.item = item;
+			recipient.keyItem = key->second;
+
+			/*Unreadable certificate must not break decryption for the others*/
+			try{
+				recipient.cert = getItemCert(item);
+			}
+			catch (Handle<Exception> e){
+				LOGGER_WARN("Skip certificate %s: %s", item->hash->c_str(), e->what());
+				continue;
+			}
+
+			X509 *cert = recipient.cert->internal();
+			size_t index = recipients.size();
+			recipients.push_back(recipient);
+
+			recipientIds.insert(std::make_pair(recipientIssuerSerialId(X509_get_issuer_name(cert), X509_get_serialNumber(cert)), index));
+
+			LOGGER_OPENSSL(X509_get_ext_d2i);
+			ASN1_OCTET_STRING *skid = (ASN1_OCTET_STRING *)X509_get_ext_d2i(cert, NID_subject_key_identifier, NULL, NULL);
+			if (skid){
+				recipientIds.insert(std::make_pair(recipientKeyId(skid), index));
+				ASN1_OCTET_STRING_free(skid);
+			}
+		}
+
+		recipientsIndexed = true;
+	}
+	catch (Handle<Exception> e){
+		THROW_EXCEPTION(0, PkiStore, e, "Error index recipients");
+	}
+}
+
 Handle<Certificate> PkiStore::getItemCert(Handle<PkiItem> item){
 	LOGGER_FN();
 
@@ -268,7 +411,7 @@ Handle<CertificateCollection> PkiStore::getCerts(){
 			for (int j = 0; j < tempColl->length(); j++){
 				if (strcmp(tempColl->items(j)->type->c_str(), "CERTIFICATE") == 0){
 					Handle<Certificate> cert = getItemCert(tempColl->items(j));
-					result->push(cert);
+					result->pushRef(cert);
 				}
 			}
 		}
@@ -284,6 +427,7 @@ void PkiStore::addProvider(Handle<Provider> provider) {
 	LOGGER_FN();
 	
 	providers->push(provider);
+	recipientsIndexed = false;
 
 	Handle<PkiItemCollection> tempColl = provider->getProviderItemCollection();
 	for (int i = 0; i < tempColl->length(); i++) {
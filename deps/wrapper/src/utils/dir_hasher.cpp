@@ -0,0 +1,538 @@
+#include "../stdafx.h"
+
+#include <inttypes.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+#include <openssl/err.h>
+#include <openssl/sha.h>
+
+#include "wrapper/utils/dir_hasher.h"
+#include "wrapper/common/mapped_file.h"
+#include "wrapper/store/storehelper.h"
+
+class DirectoryHasher::Job {
+public:
+	std::string dir;
+	const EVP_MD *md;
+	bool legacy;
+	std::vector<File> *files;
+	/* Indexes of files missing in the cache */
+	std::vector<size_t> pending;
+
+	std::atomic<size_t> next;
+	std::mutex errorMutex;
+	/* First error of the workers, read after join */
+	Handle<Exception> error;
+};
+
+static std::string toHex(const unsigned char *data, unsigned int length) {
+	static const char hex[] = "0123456789abcdef";
+
+	std::string res(length * 2, 0);
+	for (unsigned int i = 0; i < length; i++) {
+		res[i * 2] = hex[data[i] >> 4];
+		res[i * 2 + 1] = hex[data[i] & 0x0F];
+	}
+
+	return res;
+}
+
+DirectoryHasher::DirectoryHasher()
+	: digest_("sha1"), legacy_(false), threads_(0), hashed_(0)
+{
+}
+
+void DirectoryHasher::setDigest(const std::string &name) {
+	this->digest_ = name;
+}
+
+void DirectoryHasher::setLegacyEncoding(bool enable) {
+	this->legacy_ = enable;
+}
+
+void DirectoryHasher::setIgnore(const std::vector<std::string> &names) {
+	this->ignore_ = names;
+}
+
+void DirectoryHasher::setThreads(int count) {
+	this->threads_ = count;
+}
+
+void DirectoryHasher::setCache(const std::string &filename) {
+	this->cache_ = filename;
+}
+
+std::string DirectoryHasher::getStamp() {
+	return this->stamp_;
+}
+
+size_t DirectoryHasher::getHashedCount() {
+	return this->hashed_;
+}
+
+std::vector<std::string> DirectoryHasher::getDirectoryHashes() {
+	return this->directories_;
+}
+
+bool DirectoryHasher::isIgnored(const std::string &name) {
+	return std::find(this->ignore_.begin(), this->ignore_.end(), name) != this->ignore_.end();
+}
+
+void DirectoryHasher::walk(const std::string &dir, const std::string &relative, std::vector<File> &files, std::vector<Directory> &directories) {
+	LOGGER_FN();
+
+	std::vector<std::string> names;
+	size_t current = directories.size();
+
+	directories.push_back(Directory());
+	directories[current].relative = relative.empty() ? DIRECTORY_HASHER_ROOT : relative;
+
+#ifdef _WIN32
+	WIN32_FIND_DATA fileData;
+	std::string mask = dir + "\\*";
+
+	LOGGER_TRACE("FindFirstFile");
+	HANDLE handle = FindFirstFile(mask.c_str(), &fileData);
+	if (handle == INVALID_HANDLE_VALUE) {
+		THROW_EXCEPTION(0, DirectoryHasher, NULL, "Can not open directory '%s'", dir.c_str());
+	}
+
+	do {
+		std::string name = fileData.cFileName;
+		if (name != "." && name != "..") {
+			names.push_back(name);
+		}
+	} while (FindNextFile(handle, &fileData));
+
+	FindClose(handle);
+#else
+	DIR *handle = opendir(dir.c_str());
+	if (!handle) {
+		THROW_EXCEPTION(0, DirectoryHasher, NULL, "Can not open directory '%s'", dir.c_str());
+	}
+
+	struct dirent *ent;
+	while ((ent = readdir(handle)) != NULL) {
+		std::string name = ent->d_name;
+		if (name != "." && name != "..") {
+			names.push_back(name);
+		}
+	}
+
+	closedir(handle);
+#endif
+
+	/* Byte order, as libuv sorts fs.readdir results */
+	std::sort(names.begin(), names.end());
+
+	for (size_t i = 0; i < names.size(); i++) {
+		const std::string &name = names[i];
+		if (this->isIgnored(name)) {
+			continue;
+		}
+
+		std::string path = dir + CROSSPLATFORM_SLASH + name;
+		std::string rel = relative.empty() ? name : relative + "/" + name;
+
+		/* Follows symbolic links as fs.statSync */
+#ifdef _WIN32
+		struct _stat64 st;
+		if (_stat64(path.c_str(), &st) != 0) {
+			THROW_EXCEPTION(0, DirectoryHasher, NULL, "Can not get status of '%s'", path.c_str());
+		}
+		bool isDirectory = (st.st_mode & _S_IFDIR) != 0;
+		bool isFile = (st.st_mode & _S_IFREG) != 0;
+		int64_t mtime = (int64_t)st.st_mtime * 1000000000;
+		int64_t ctime = (int64_t)st.st_ctime * 1000000000;
+#else
+		struct stat st;
+		if (stat(path.c_str(), &st) != 0) {
+			THROW_EXCEPTION(0, DirectoryHasher, NULL, "Can not get status of '%s'", path.c_str());
+		}
+		bool isDirectory = S_ISDIR(st.st_mode);
+		bool isFile = S_ISREG(st.st_mode);
+#if defined(__APPLE__)
+		int64_t mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+		int64_t ctime = (int64_t)st.st_ctimespec.tv_sec * 1000000000 + st.st_ctimespec.tv_nsec;
+#else
+		int64_t mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+		int64_t ctime = (int64_t)st.st_ctim.tv_sec * 1000000000 + st.st_ctim.tv_nsec;
+#endif
+#endif
+
+		Directory::Entry entry;
+		entry.name = name;
+
+		if (isDirectory) {
+			entry.directory = true;
+			entry.index = directories.size();
+			directories[current].entries.push_back(entry);
+
+			this->walk(path, rel, files, directories);
+		}
+		else if (isFile) {
+			entry.directory = false;
+			entry.index = files.size();
+			directories[current].entries.push_back(entry);
+
+			File file;
+			file.relative = rel;
+			file.size = (uint64_t)st.st_size;
+			file.mtime = mtime;
+			file.ctime = ctime;
+			file.inode = (uint64_t)st.st_ino;
+			file.device = (uint64_t)st.st_dev;
+			files.push_back(file);
+		}
+	}
+}
+
+int DirectoryHasher::digestUpdate(EVP_MD_CTX *ctx, const unsigned char *data, size_t length, bool legacy) {
+	if (!legacy) {
+		return EVP_DigestUpdate(ctx, data, length);
+	}
+
+	unsigned char out[DIRECTORY_HASHER_LEGACY_CHUNK * 2];
+
+	while (length) {
+		size_t chunk = length < DIRECTORY_HASHER_LEGACY_CHUNK ? length : DIRECTORY_HASHER_LEGACY_CHUNK;
+		size_t count = 0;
+
+		for (size_t i = 0; i < chunk; i++) {
+			unsigned char c = data[i];
+			if (c < 0x80) {
+				out[count++] = c;
+			}
+			else {
+				out[count++] = 0xC0 | (c >> 6);
+				out[count++] = 0x80 | (c & 0x3F);
+			}
+		}
+
+		if (!EVP_DigestUpdate(ctx, out, count)) {
+			return 0;
+		}
+
+		data += chunk;
+		length -= chunk;
+	}
+
+	return 1;
+}
+
+std::string DirectoryHasher::hashFile(const std::string &filename, const EVP_MD *md, bool legacy) {
+	LOGGER_FN();
+
+	MappedFile file(filename);
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int length = 0;
+
+	if (!legacy) {
+		LOGGER_OPENSSL(EVP_Digest);
+		if (!EVP_Digest(file.data(), file.size(), digest, &length, md, NULL)) {
+			THROW_OPENSSL_EXCEPTION(0, DirectoryHasher, NULL, "Error hash file '%s'", filename.c_str());
+		}
+
+		return toHex(digest, length);
+	}
+
+	EVP_MD_CTX ctx;
+	EVP_MD_CTX_init(&ctx);
+
+	bool ok = EVP_DigestInit_ex(&ctx, md, NULL) &&
+		DirectoryHasher::digestUpdate(&ctx, file.data(), file.size(), true) &&
+		EVP_DigestFinal_ex(&ctx, digest, &length);
+
+	EVP_MD_CTX_cleanup(&ctx);
+
+	if (!ok) {
+		THROW_OPENSSL_EXCEPTION(0, DirectoryHasher, NULL, "Error hash file '%s'", filename.c_str());
+	}
+
+	return toHex(digest, length);
+}
+
+std::string DirectoryHasher::hashFile(const std::string &filename, uint64_t size, const EVP_MD *md, bool legacy, unsigned char *buffer) {
+	if (size >= DIRECTORY_HASHER_MAP_THRESHOLD) {
+		return DirectoryHasher::hashFile(filename, md, legacy);
+	}
+
+	FILE *file = fopen(filename.c_str(), "rb");
+	if (!file) {
+		THROW_EXCEPTION(0, DirectoryHasher, NULL, "Can not open file '%s'", filename.c_str());
+	}
+
+	EVP_MD_CTX ctx;
+	EVP_MD_CTX_init(&ctx);
+
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int length = 0;
+	bool ok = EVP_DigestInit_ex(&ctx, md, NULL) != 0;
+	size_t read;
+
+	while (ok && (read = fread(buffer, 1, DIRECTORY_HASHER_BUFFER_SIZE, file)) > 0) {
+		ok = DirectoryHasher::digestUpdate(&ctx, buffer, read, legacy) != 0;
+	}
+	ok = ok && !ferror(file) && EVP_DigestFinal_ex(&ctx, digest, &length);
+
+	EVP_MD_CTX_cleanup(&ctx);
+	fclose(file);
+
+	if (!ok) {
+		THROW_OPENSSL_EXCEPTION(0, DirectoryHasher, NULL, "Error hash file '%s'", filename.c_str());
+	}
+
+	return toHex(digest, length);
+}
+
+void DirectoryHasher::worker(Job *job) {
+	std::vector<unsigned char> buffer(DIRECTORY_HASHER_BUFFER_SIZE);
+	size_t count = job->pending.size();
+
+	for (;;) {
+		size_t i = job->next++;
+		if (i >= count) {
+			break;
+		}
+
+		Handle<Exception> error;
+		try {
+			File &file = (*job->files)[job->pending[i]];
+			file.hash = DirectoryHasher::hashFile(job->dir + CROSSPLATFORM_SLASH + file.relative, file.size, job->md, job->legacy, &buffer[0]);
+			continue;
+		}
+		catch (Handle<Exception> e) {
+			error = e;
+		}
+		catch (std::exception &e) {
+			error = new Exception(false, __FILE__, __LINE__, 0, "DirectoryHasher", __FUNCTION__, NULL, "%s", e.what());
+		}
+
+		std::lock_guard<std::mutex> lock(job->errorMutex);
+		if (job->error.isEmpty()) {
+			job->error = error;
+		}
+		job->next = count;
+	}
+}
+
+/* Hashes of another digest or encoding are not reused */
+std::string DirectoryHasher::getCacheHeader() {
+	return std::string(DIRECTORY_HASHER_CACHE_HEADER) + " " + this->digest_ + (this->legacy_ ? " legacy" : "");
+}
+
+void DirectoryHasher::loadCache(Cache &cache) {
+	LOGGER_FN();
+
+	std::string data;
+	try {
+		MappedFile file(this->cache_);
+		data.assign((const char *)file.data(), file.size());
+	}
+	catch (Handle<Exception> e) {
+		/* No cache yet */
+		return;
+	}
+
+	size_t pos = data.find('\n');
+	if (pos == std::string::npos || data.compare(0, pos, this->getCacheHeader())) {
+		/* Other format or digest, everything is hashed again */
+		return;
+	}
+
+	while (++pos < data.length()) {
+		size_t end = data.find('\n', pos);
+		if (end == std::string::npos) {
+			break;
+		}
+
+		std::string line = data.substr(pos, end - pos);
+		pos = end;
+
+		File file;
+		char hash[EVP_MAX_MD_SIZE * 2 + 1];
+		int offset = 0;
+		if (sscanf(line.c_str(), "%" SCNu64 " %" SCNd64 " %" SCNd64 " %" SCNu64 " %" SCNu64 " %128s %n",
+			&file.size, &file.mtime, &file.ctime, &file.inode, &file.device, hash, &offset) < 6 || !offset) {
+			continue;
+		}
+
+		file.relative = line.substr(offset);
+		file.hash = hash;
+		cache[file.relative] = file;
+	}
+}
+
+void DirectoryHasher::saveCache(const std::vector<File> &files) {
+	LOGGER_FN();
+
+	std::string tmp = this->cache_ + ".tmp";
+	FILE *f = fopen(tmp.c_str(), "wb");
+	if (!f) {
+		/* Cache only speeds up the next run, so a read-only location is not an error */
+		return;
+	}
+
+	int64_t racy = ((int64_t)time(NULL) - DIRECTORY_HASHER_RACY_INTERVAL) * 1000000000;
+	bool ok = fprintf(f, "%s\n", this->getCacheHeader().c_str()) > 0;
+
+	for (size_t i = 0; ok && i < files.size(); i++) {
+		const File &file = files[i];
+		if (file.mtime >= racy) {
+			continue;
+		}
+
+		ok = fprintf(f, "%" PRIu64 " %" PRId64 " %" PRId64 " %" PRIu64 " %" PRIu64 " %s %s\n",
+			file.size, file.mtime, file.ctime, file.inode, file.device, file.hash.c_str(), file.relative.c_str()) > 0;
+	}
+
+	ok = fclose(f) == 0 && ok;
+
+	remove(this->cache_.c_str());
+	if (!ok || rename(tmp.c_str(), this->cache_.c_str()) != 0) {
+		remove(tmp.c_str());
+	}
+}
+
+void DirectoryHasher::hashDirectories(const EVP_MD *md, const std::vector<File> &files, std::vector<Directory> &directories) {
+	LOGGER_FN();
+
+	EVP_MD_CTX ctx;
+	EVP_MD_CTX_init(&ctx);
+
+	/* Subdirectories follow their parent, so going backwards hashes them first */
+	for (size_t i = directories.size(); i-- > 0;) {
+		Directory &directory = directories[i];
+		unsigned char digest[EVP_MAX_MD_SIZE];
+		unsigned int length = 0;
+		bool ok = EVP_DigestInit_ex(&ctx, md, NULL) != 0;
+
+		for (size_t j = 0; ok && j < directory.entries.size(); j++) {
+			const Directory::Entry &entry = directory.entries[j];
+			const std::string &hash = entry.directory ? directories[entry.index].hash : files[entry.index].hash;
+
+			ok = EVP_DigestUpdate(&ctx, entry.directory ? "d" : "f", 1) &&
+				EVP_DigestUpdate(&ctx, entry.name.c_str(), entry.name.length() + 1) &&
+				EVP_DigestUpdate(&ctx, hash.data(), hash.length()) &&
+				EVP_DigestUpdate(&ctx, "\n", 1);
+		}
+
+		if (!ok || !EVP_DigestFinal_ex(&ctx, digest, &length)) {
+			EVP_MD_CTX_cleanup(&ctx);
+			THROW_OPENSSL_EXCEPTION(0, DirectoryHasher, NULL, "Error hash directory '%s'", directory.relative.c_str());
+		}
+
+		directory.hash = toHex(digest, length);
+	}
+
+	EVP_MD_CTX_cleanup(&ctx);
+}
+
+std::vector<std::string> DirectoryHasher::hash(const std::string &dir) {
+	LOGGER_FN();
+
+	try {
+		LOGGER_OPENSSL(EVP_get_digestbyname);
+		const EVP_MD *md = EVP_get_digestbyname(this->digest_.c_str());
+		if (!md) {
+			THROW_OPENSSL_EXCEPTION(0, DirectoryHasher, NULL, "Unknown digest '%s'", this->digest_.c_str());
+		}
+
+		std::vector<File> files;
+		std::vector<Directory> directories;
+		this->walk(dir, "", files, directories);
+
+		Cache cache;
+		if (!this->cache_.empty()) {
+			this->loadCache(cache);
+		}
+
+		Job job;
+		job.dir = dir;
+		job.md = md;
+		job.legacy = this->legacy_;
+		job.files = &files;
+		job.next = 0;
+
+		SHA_CTX stamp;
+		SHA1_Init(&stamp);
+
+		for (size_t i = 0; i < files.size(); i++) {
+			File &file = files[i];
+
+			char meta[128];
+			int length = sprintf(meta, " %" PRIu64 " %" PRId64 " %" PRId64 " %" PRIu64 " %" PRIu64 "\n",
+				file.size, file.mtime, file.ctime, file.inode, file.device);
+			SHA1_Update(&stamp, file.relative.data(), file.relative.length());
+			SHA1_Update(&stamp, meta, length);
+
+			Cache::iterator it = cache.find(file.relative);
+			if (it != cache.end() && it->second.size == file.size && it->second.mtime == file.mtime && it->second.ctime == file.ctime &&
+				it->second.inode == file.inode && it->second.device == file.device) {
+				file.hash = it->second.hash;
+			}
+			else {
+				job.pending.push_back(i);
+			}
+		}
+
+		unsigned char stampDigest[SHA_DIGEST_LENGTH];
+		SHA1_Final(stampDigest, &stamp);
+
+		size_t threads = this->threads_ > 0 ? (size_t)this->threads_ : (size_t)std::thread::hardware_concurrency();
+		if (threads > job.pending.size()) {
+			threads = job.pending.size();
+		}
+
+		/* Calling thread is one of the workers */
+		std::vector<std::thread> pool;
+		for (size_t i = 1; i < threads; i++) {
+			pool.push_back(std::thread([&job]() {
+				DirectoryHasher::worker(&job);
+				ERR_remove_thread_state(NULL);
+			}));
+		}
+		DirectoryHasher::worker(&job);
+		for (size_t i = 0; i < pool.size(); i++) {
+			pool[i].join();
+		}
+
+		if (!job.error.isEmpty()) {
+			THROW_EXCEPTION(0, DirectoryHasher, job.error, "Error hash files");
+		}
+
+		DirectoryHasher::hashDirectories(md, files, directories);
+
+		this->stamp_ = toHex(stampDigest, sizeof(stampDigest));
+		this->hashed_ = job.pending.size();
+		this->directories_.resize(directories.size());
+		for (size_t i = 0; i < directories.size(); i++) {
+			this->directories_[i] = directories[i].relative + "#" + directories[i].hash;
+		}
+
+		if (!this->cache_.empty() && job.pending.size()) {
+			this->saveCache(files);
+		}
+
+		std::vector<std::string> res(files.size());
+		for (size_t i = 0; i < files.size(); i++) {
+			res[i] = files[i].relative + "#" + files[i].hash;
+		}
+
+		return res;
+	}
+	catch (Handle<Exception> e) {
+		THROW_EXCEPTION(0, DirectoryHasher, e, "Error hash directory '%s'", dir.c_str());
+	}
+}
@@ -0,0 +1,117 @@
+#include <wrapper/stdafx.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <process.h>
+#include <sys/utime.h>
+#define test_getpid() _getpid()
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#define test_getpid() getpid()
+#endif
+
+#include <wrapper/store/storehelper.h>
+
+#include "fixtures.h"
+
+TestPki &TestPki::get() {
+	static TestPki *pki = NULL;
+
+	if (!pki) {
+		pki = new TestPki();
+
+		pki->caKey = fixtureGenerateKey(2048);
+		pki->ca = fixtureIssue("Test CA", pki->caKey, NULL, NULL, true);
+
+		pki->leafKey = fixtureGenerateKey(2048);
+		pki->leaf = fixtureIssue("Test Leaf", pki->leafKey, pki->ca, pki->caKey, false);
+
+		pki->ocspKey = fixtureGenerateKey(2048);
+		pki->ocsp = fixtureIssue("Test OCSP", pki->ocspKey, pki->ca, pki->caKey, false, "OCSPSigning");
+
+		pki->otherKey = fixtureGenerateKey(2048);
+		pki->other = fixtureIssue("Other CA", pki->otherKey, NULL, NULL, true);
+	}
+
+	return *pki;
+}
+
+Handle<CRL> testCrl(int count) {
+	TestPki &pki = TestPki::get();
+
+	return fixtureCrl(pki.ca, pki.caKey, count, true);
+}
+
+std::string testDer(Handle<CRL> crl) {
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+
+	crl->write(out, DataFormat::DER);
+
+	return *out->read();
+}
+
+Handle<Bio> testMemBio(const std::string &data) {
+	return new Bio(BIO_new_mem_buf((void *)data.c_str(), (int)data.length()));
+}
+
+std::string testTempFile(const char *name) {
+	static int counter = 0;
+	char buf[64];
+	const char *tmp = getenv("TMPDIR");
+
+	sprintf(buf, "%cwrapper_test_%d_%d_", CROSSPLATFORM_SLASH, (int)test_getpid(), counter++);
+
+	return std::string(tmp ? tmp : "/tmp") + buf + name;
+}
+
+void testWriteFile(const std::string &filename, const std::string &data) {
+	FILE *f = fopen(filename.c_str(), "wb");
+	if (!f) {
+		THROW_EXCEPTION(0, TestFixtures, NULL, "Can not create file '%s'", filename.c_str());
+	}
+
+	fwrite(data.data(), 1, data.length(), f);
+	fclose(f);
+}
+
+int64_t testGetMtime(const std::string &filename) {
+#if defined(_WIN32)
+	struct _stat64 st;
+	if (_stat64(filename.c_str(), &st) != 0) {
+		THROW_EXCEPTION(0, TestFixtures, NULL, "Can not get status of '%s'", filename.c_str());
+	}
+
+	return (int64_t)st.st_mtime * 1000000000;
+#else
+	struct stat st;
+	if (stat(filename.c_str(), &st) != 0) {
+		THROW_EXCEPTION(0, TestFixtures, NULL, "Can not get status of '%s'", filename.c_str());
+	}
+
+#if defined(__APPLE__)
+	return (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+	return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+#endif
+}
+
+void testSetMtime(const std::string &filename, int64_t mtime) {
+#if defined(_WIN32)
+	struct _utimbuf times;
+	times.actime = times.modtime = (time_t)(mtime / 1000000000);
+	int res = _utime(filename.c_str(), &times);
+#else
+	struct timespec times[2];
+	times[0].tv_sec = times[1].tv_sec = (time_t)(mtime / 1000000000);
+	times[0].tv_nsec = times[1].tv_nsec = (long)(mtime % 1000000000);
+	int res = utimensat(AT_FDCWD, filename.c_str(), times, 0);
+#endif
+
+	if (res != 0) {
+		THROW_EXCEPTION(0, TestFixtures, NULL, "Can not set time of '%s'", filename.c_str());
+	}
+}
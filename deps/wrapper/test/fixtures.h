@@ -0,0 +1,66 @@
+#ifndef TEST_FIXTURES_H_INCLUDED
+#define TEST_FIXTURES_H_INCLUDED
+
+#include <string>
+
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#define test_mkdir(path) _mkdir(path)
+#define test_rmdir(path) _rmdir(path)
+#else
+#include <unistd.h>
+#define test_mkdir(path) mkdir(path, 0700)
+#define test_rmdir(path) rmdir(path)
+#endif
+
+#include <gtest/gtest.h>
+
+#include <wrapper/common/common.h>
+#include <wrapper/pki/cert.h>
+#include <wrapper/pki/crl.h>
+#include <wrapper/pki/key.h>
+
+#include "pki_fixtures.h"
+
+/*
+ * Synthetic PKI generated once per test run: CA -> leaf, CA -> OCSP signer
+ * with id-kp-OCSPSigning, and an unrelated CA
+ */
+class TestPki {
+public:
+	Handle<Key> caKey;
+	Handle<Certificate> ca;
+	Handle<Key> leafKey;
+	Handle<Certificate> leaf;
+	Handle<Key> ocspKey;
+	Handle<Certificate> ocsp;
+	Handle<Key> otherKey;
+	Handle<Certificate> other;
+
+	static TestPki &get();
+};
+
+/*
+ * CRL of the test CA with count revoked serials 0x10000 + i.
+ * Entry i has reasonCode i % 11 unless i % 11 is 7 (unused value), which has no reasonCode
+ */
+Handle<CRL> testCrl(int count);
+
+std::string testDer(Handle<CRL> crl);
+Handle<Bio> testMemBio(const std::string &data);
+
+/* Unique file name in the temporary folder */
+std::string testTempFile(const char *name);
+void testWriteFile(const std::string &filename, const std::string &data);
+/* Modification time in nanoseconds since the epoch */
+int64_t testGetMtime(const std::string &filename);
+void testSetMtime(const std::string &filename, int64_t mtime);
+
+/* Fails the test with the exception text */
+#define TEST_TRY(...) \
+	try { __VA_ARGS__; } \
+	catch (Handle<Exception> e) { FAIL() << e->what(); }
+
+#endif //!TEST_FIXTURES_H_INCLUDED
@@ -0,0 +1,21 @@
+#include <wrapper/stdafx.h>
+
+#include <gtest/gtest.h>
+
+#include <wrapper/common/openssl.h>
+
+/*
+ * Usage:
+ *   cmake -DWRAPPER_BUILD_TESTS=ON ... && ctest
+ * or wrapper_test --gtest_filter=CrlReader.*
+ */
+int main(int argc, char **argv) {
+	OpenSSL::run();
+
+	testing::InitGoogleTest(&argc, argv);
+	int res = RUN_ALL_TESTS();
+
+	OpenSSL::stop();
+
+	return res;
+}
@@ -0,0 +1,57 @@
+#include <wrapper/stdafx.h>
+
+#include <wrapper/pki/bundle.h>
+
+#include "fixtures.h"
+
+static std::string pem(Handle<Certificate> cert) {
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+
+	cert->write(out, DataFormat::BASE64);
+
+	return *out->read();
+}
+
+TEST(Bundle, LoadCertificates) {
+	std::string filename = testTempFile("bundle.pem");
+	std::string data;
+
+	for (int i = 0; i < 3 * BUNDLE_ITEMS_PER_THREAD; i++) {
+		data += pem(i % 2 ? TestPki::get().ca : TestPki::get().leaf);
+	}
+
+	TEST_TRY({
+		testWriteFile(filename, data);
+		EXPECT_EQ(3 * BUNDLE_ITEMS_PER_THREAD, Bundle::loadCertificates(new std::string(filename))->length());
+	});
+
+	remove(filename.c_str());
+}
+
+TEST(Bundle, BadItemKeepsCause) {
+	std::string filename = testTempFile("bundle.pem");
+	std::string item = pem(TestPki::get().leaf);
+	std::string data;
+
+	for (int i = 0; i < 3 * BUNDLE_ITEMS_PER_THREAD; i++) {
+		data += item;
+	}
+
+	/*Base64 body of item 100 becomes garbage*/
+	size_t body = 100 * item.length() + item.find('\n') + 1;
+	data.replace(body, 64, std::string(64, '!'));
+
+	try {
+		testWriteFile(filename, data);
+		Bundle::loadCertificates(new std::string(filename));
+		ADD_FAILURE() << "Bad bundle loaded";
+	}
+	catch (Handle<Exception> e) {
+		std::string what = e->what();
+		EXPECT_NE(std::string::npos, what.find("Can not decode certificate 100")) << what;
+		/*Worker exception with the OpenSSL error queue is the cause*/
+		EXPECT_NE(std::string::npos, what.find("decodeCertificate")) << what;
+	}
+
+	remove(filename.c_str());
+}
@@ -0,0 +1,295 @@
+#include <wrapper/stdafx.h>
+
+#include <wrapper/pki/cipher.h>
+#include <wrapper/pki/kdf_cache.h>
+
+#include "fixtures.h"
+
+static std::string encrypt(Cipher &cipher, const std::string &data) {
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+
+	cipher.encrypt(testMemBio(data), out, DataFormat::DER);
+
+	return *out->read();
+}
+
+static std::string decrypt(Cipher &cipher, const std::string &data) {
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+
+	cipher.decrypt(testMemBio(data), out, DataFormat::DER);
+
+	return *out->read();
+}
+
+static Cipher *symmetric(const char *algorithm) {
+	Cipher *res = new Cipher();
+
+	res->setCryptoMethod(CryptoMethod::SYMMETRIC);
+	res->setAlgorithm(new std::string(algorithm));
+
+	return res;
+}
+
+class CipherTest : public ::testing::TestWithParam<const char *> {
+protected:
+	std::string plain = std::string(10000, 'a') + "end";
+};
+
+TEST_P(CipherTest, PasswordTakesNewSalt) {
+	TEST_TRY({
+		std::unique_ptr<Cipher> cipher(symmetric(GetParam()));
+		cipher->setPass(new std::string("4321"));
+
+		std::string first = encrypt(*cipher, this->plain);
+		std::string second = encrypt(*cipher, this->plain);
+		EXPECT_NE(first.substr(0, 16), second.substr(0, 16));
+		EXPECT_NE(first.substr(16), second.substr(16));
+
+		EXPECT_EQ(this->plain, decrypt(*cipher, first));
+		EXPECT_EQ(this->plain, decrypt(*cipher, second));
+	});
+}
+
+TEST_P(CipherTest, KeyTakesNewIv) {
+	TEST_TRY({
+		std::unique_ptr<Cipher> cipher(symmetric(GetParam()));
+		cipher->setKey(new std::string("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"));
+		cipher->setIV(new std::string("000102030405060708090a0b0c0d0e0f"));
+
+		std::string first = encrypt(*cipher, this->plain);
+		std::string second = encrypt(*cipher, this->plain);
+		EXPECT_NE(first, second);
+
+		std::unique_ptr<Cipher> other(symmetric(GetParam()));
+		other->setKey(new std::string("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"));
+		EXPECT_EQ(this->plain, decrypt(*other, first));
+		EXPECT_EQ(this->plain, decrypt(*other, second));
+	});
+}
+
+INSTANTIATE_TEST_CASE_P(Modes, CipherTest, ::testing::Values("aes-256-gcm", "aes-256-ctr", "aes-256-ofb"));
+
+TEST(Cipher, CbcKeepsIv) {
+	TEST_TRY({
+		std::unique_ptr<Cipher> cipher(symmetric("aes-256-cbc"));
+		cipher->setKey(new std::string("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"));
+		cipher->setIV(new std::string("000102030405060708090a0b0c0d0e0f"));
+
+		EXPECT_EQ(32U, encrypt(*cipher, std::string(20, 'a')).length());
+	});
+}
+
+static std::string encryptChunked(Cipher &cipher, const std::string &data) {
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+
+	cipher.encryptChunked(testMemBio(data), out);
+
+	return *out->read();
+}
+
+static std::string decryptChunked(Cipher &cipher, const std::string &data) {
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+
+	cipher.decryptChunked(testMemBio(data), out);
+
+	return *out->read();
+}
+
+class CipherChunkedTest : public ::testing::TestWithParam<bool> {
+protected:
+	void SetUp() {
+		for (int i = 0; i < 5000; i++) {
+			this->plain += (char)(i * 7 + (i >> 8));
+		}
+
+		TEST_TRY({
+			this->cipher.reset(symmetric("aes-256-gcm"));
+			this->cipher->setChunkSize(CIPHER_CHUNK_MIN_SIZE);
+			if (GetParam()) {
+				this->cipher->setPass(new std::string("4321"));
+			}
+			else {
+				this->cipher->setKey(new std::string("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"));
+			}
+		});
+	}
+
+	std::string plain;
+	std::unique_ptr<Cipher> cipher;
+};
+
+TEST_P(CipherChunkedTest, FilesDiffer) {
+	TEST_TRY({
+		std::string first = encryptChunked(*this->cipher, this->plain);
+		std::string second = encryptChunked(*this->cipher, this->plain);
+		ASSERT_EQ(first.length(), second.length());
+
+		/*Fixed header fields, nonce, then salt and key derivation parameters*/
+		size_t nonce = sizeof CIPHER_CHUNK_MAGIC - 1 + 2 + 1 + 4;
+		size_t header = nonce + CIPHER_CHUNK_NONCE_LENGTH + (GetParam() ? PKCS5_SALT_LEN + 13 : 0);
+		EXPECT_NE(first.substr(nonce, CIPHER_CHUNK_NONCE_LENGTH), second.substr(nonce, CIPHER_CHUNK_NONCE_LENGTH));
+
+		/*No ciphertext block may repeat, even at the same position*/
+		for (size_t i = header; i + 16 <= first.length(); i += 16) {
+			EXPECT_EQ(std::string::npos, second.find(first.substr(i, 16))) << "offset " << i;
+		}
+
+		EXPECT_EQ(this->plain, decryptChunked(*this->cipher, first));
+		EXPECT_EQ(this->plain, decryptChunked(*this->cipher, second));
+
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		this->cipher->decryptChunkedRange(testMemBio(second), out, 1000, 2000);
+		EXPECT_EQ(this->plain.substr(1000, 2000), *out->read());
+	});
+}
+
+TEST_P(CipherChunkedTest, NonceIsAuthenticated) {
+	std::string enc;
+	TEST_TRY(enc = encryptChunked(*this->cipher, this->plain));
+
+	/*Last byte of the header nonce*/
+	enc[sizeof CIPHER_CHUNK_MAGIC - 1 + 2 + 1 + 4 + CIPHER_CHUNK_NONCE_LENGTH - 1] ^= 1;
+	EXPECT_THROW(decryptChunked(*this->cipher, enc), Handle<Exception>);
+}
+
+INSTANTIATE_TEST_CASE_P(Password, CipherChunkedTest, ::testing::Bool());
+
+TEST(Cipher, KdfLimits) {
+	std::unique_ptr<Cipher> cipher(symmetric("aes-256-gcm"));
+
+	EXPECT_THROW(cipher->setKdf(KdfMethod::PBKDF2, CIPHER_KDF_MAX_ITERATIONS + 1), Handle<Exception>);
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+	EXPECT_THROW(cipher->setKdf(KdfMethod::SCRYPT, CIPHER_KDF_MAX_SCRYPT_N * 2), Handle<Exception>);
+	EXPECT_THROW(cipher->setKdf(KdfMethod::SCRYPT, 1 << 14, CIPHER_KDF_MAX_SCRYPT_R + 1), Handle<Exception>);
+	EXPECT_THROW(cipher->setKdf(KdfMethod::SCRYPT, 1 << 14, 8, CIPHER_KDF_MAX_SCRYPT_P + 1), Handle<Exception>);
+	/*1 GB*/
+	EXPECT_THROW(cipher->setKdf(KdfMethod::SCRYPT, 1 << 20, 8, 1), Handle<Exception>);
+	TEST_TRY(cipher->setKdf(KdfMethod::SCRYPT, 1 << 14, 8, 1));
+
+	TEST_TRY({
+		cipher->setKdfLimits(CIPHER_KDF_MAX_ITERATIONS, 1 << 20, 8, 1, 2048 * 1024 * 1024ULL);
+		cipher->setKdf(KdfMethod::SCRYPT, 1 << 20, 8, 1);
+	});
+#endif
+
+	TEST_TRY(cipher->setKdfLimits(1000, CIPHER_KDF_MAX_SCRYPT_N, CIPHER_KDF_MAX_SCRYPT_R, CIPHER_KDF_MAX_SCRYPT_P, CIPHER_KDF_MAX_MEMORY));
+	EXPECT_THROW(cipher->setKdf(KdfMethod::PBKDF2, 1001), Handle<Exception>);
+}
+
+TEST(Cipher, ChunkedHeaderKdfLimits) {
+	std::string enc;
+
+	TEST_TRY({
+		std::unique_ptr<Cipher> cipher(symmetric("aes-256-gcm"));
+		cipher->setKdf(KdfMethod::PBKDF2, 1000);
+		cipher->setPass(new std::string("4321"));
+		enc = encryptChunked(*cipher, "text");
+	});
+
+	/*PBKDF2 iterations after the header, salt and method: 100000000 would take minutes*/
+	size_t cost = sizeof CIPHER_CHUNK_MAGIC - 1 + 2 + 1 + 4 + CIPHER_CHUNK_NONCE_LENGTH + PKCS5_SALT_LEN + 1;
+	enc[cost] = 0x05;
+	enc[cost + 1] = (char)0xF5;
+	enc[cost + 2] = (char)0xE1;
+	enc[cost + 3] = 0x00;
+
+	std::unique_ptr<Cipher> cipher(symmetric("aes-256-gcm"));
+	TEST_TRY(cipher->setPass(new std::string("4321")));
+	EXPECT_THROW(decryptChunked(*cipher, enc), Handle<Exception>);
+
+	/*Data itself is fine with the default limits*/
+	enc[cost] = 0;
+	enc[cost + 1] = 0;
+	enc[cost + 2] = 0x03;
+	enc[cost + 3] = (char)0xE8;
+	TEST_TRY(EXPECT_EQ("text", decryptChunked(*cipher, enc)));
+}
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+TEST(Cipher, ScryptNeedsOpenSSL110) {
+	std::unique_ptr<Cipher> cipher(symmetric("aes-256-gcm"));
+	EXPECT_THROW(cipher->setKdf(KdfMethod::SCRYPT, 1 << 14, 8, 1), Handle<Exception>);
+
+	std::string enc;
+	TEST_TRY({
+		cipher->setKdf(KdfMethod::PBKDF2, 1000);
+		cipher->setPass(new std::string("4321"));
+		enc = encryptChunked(*cipher, "text");
+	});
+
+	/*Header with scrypt N = 2^14 instead of the PBKDF2 iterations*/
+	size_t method = sizeof CIPHER_CHUNK_MAGIC - 1 + 2 + 1 + 4 + CIPHER_CHUNK_NONCE_LENGTH + PKCS5_SALT_LEN;
+	enc[method] = KdfMethod::SCRYPT;
+	enc[method + 3] = 0x40;
+	enc[method + 4] = 0x00;
+
+	std::unique_ptr<Cipher> decipher(symmetric("aes-256-gcm"));
+	TEST_TRY(decipher->setPass(new std::string("4321")));
+	EXPECT_THROW(decryptChunked(*decipher, enc), Handle<Exception>);
+}
+#endif
+
+TEST(KdfCache, IdIsKeyed) {
+	std::vector<std::string> parts;
+	parts.push_back("salt");
+	parts.push_back("password");
+
+	std::string id;
+	TEST_TRY(id = KdfCache::makeId(parts));
+	TEST_TRY(EXPECT_EQ(id, KdfCache::makeId(parts)));
+
+	/*Plain SHA-256 of the same encoding would let anyone test password guesses*/
+	std::string encoded("\0\0\0\x04salt\0\0\0\x08password", 20);
+	unsigned char md[SHA256_DIGEST_LENGTH];
+	SHA256((const unsigned char *)encoded.data(), encoded.length(), md);
+	EXPECT_NE(std::string((char *)md, sizeof md), id);
+}
+
+TEST(Cipher, LongAlgorithmName) {
+	std::unique_ptr<Cipher> cipher(new Cipher());
+	std::string name(4000, 'x');
+
+	try {
+		cipher->setAlgorithm(new std::string(name));
+		FAIL() << "Unknown cipher accepted";
+	}
+	catch (Handle<Exception> e) {
+		EXPECT_NE(std::string::npos, std::string(e->what()).find(name));
+	}
+}
+
+/* Fixed salt gives the same key and iv to every message */
+TEST_P(CipherTest, PasswordRefusesFixedSalt) {
+	std::unique_ptr<Cipher> cipher(symmetric(GetParam()));
+
+	TEST_TRY({
+		cipher->setPass(new std::string("4321"));
+		cipher->setSalt(new std::string("0102030405060708"));
+	});
+	EXPECT_THROW(encrypt(*cipher, this->plain), Handle<Exception>);
+
+	/*Chunked files take a random nonce of their own*/
+	TEST_TRY({
+		cipher->setAlgorithm(new std::string("aes-256-gcm"));
+		cipher->setChunkSize(CIPHER_CHUNK_MIN_SIZE);
+
+		std::string first, second;
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		cipher->encryptChunked(testMemBio(this->plain), out);
+		first = *out->read();
+		out = new Bio(BIO_TYPE_MEM, "");
+		cipher->encryptChunked(testMemBio(this->plain), out);
+		second = *out->read();
+		EXPECT_NE(first, second);
+	});
+}
+
+TEST(Cipher, CbcKeepsFixedSalt) {
+	TEST_TRY({
+		std::unique_ptr<Cipher> cipher(symmetric("aes-256-cbc"));
+		cipher->setPass(new std::string("4321"));
+		cipher->setSalt(new std::string("0102030405060708"));
+
+		EXPECT_EQ(encrypt(*cipher, "text"), encrypt(*cipher, "text"));
+	});
+}
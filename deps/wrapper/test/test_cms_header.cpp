@@ -0,0 +1,96 @@
+#include <wrapper/stdafx.h>
+
+#include <wrapper/cms/header.h>
+#include <wrapper/cms/recipient_set.h>
+#include <wrapper/cms/signed_data.h>
+
+#include "fixtures.h"
+
+/* SignedData of the test leaf, BER with indefinite lengths when streamed */
+static std::string signedDer(const std::string &payload, bool streamed) {
+	TestPki &pki = TestPki::get();
+	unsigned int flags = CMS_BINARY | (streamed ? CMS_STREAM : 0);
+	Handle<Bio> in = testMemBio(payload);
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+
+	CMS_ContentInfo *cms = CMS_sign(pki.leaf->internal(), pki.leafKey->internal(), NULL, in->internal(), flags);
+	if (!cms) {
+		THROW_OPENSSL_EXCEPTION(0, TestCmsHeader, NULL, "CMS_sign");
+	}
+
+	int res = streamed ? i2d_CMS_bio_stream(out->internal(), cms, testMemBio(payload)->internal(), flags)
+		: i2d_CMS_bio(out->internal(), cms);
+	CMS_ContentInfo_free(cms);
+	if (!res) {
+		THROW_OPENSSL_EXCEPTION(0, TestCmsHeader, NULL, "i2d_CMS_bio");
+	}
+
+	return *out->read();
+}
+
+static std::string envelopedDer(const std::string &payload) {
+	Handle<CertificateCollection> certs = new CertificateCollection();
+	certs->push(TestPki::get().leaf);
+
+	CmsRecipientSet set;
+	set.push(certs);
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+	set.encrypt(testMemBio(payload), out, DataFormat::DER);
+
+	return *out->read();
+}
+
+class CmsHeaderTest : public ::testing::TestWithParam<bool> {
+};
+
+TEST_P(CmsHeaderTest, SignedDataFromBio) {
+	TEST_TRY({
+		std::string der = signedDer(std::string(1 << 20, 'a'), GetParam());
+
+		/* Memory and BIO walks agree */
+		CmsHeader expected;
+		expected.read((const unsigned char *)der.data(), der.length());
+
+		CmsHeader header;
+		header.read(testMemBio(der), DataFormat::DER);
+
+		EXPECT_EQ(NID_pkcs7_signed, header.getContentType()->toNid());
+		EXPECT_EQ(NID_pkcs7_data, header.getEncapsulatedType()->toNid());
+		EXPECT_FALSE(header.isDetached());
+		ASSERT_EQ(1, header.getSignersLength());
+		ASSERT_EQ(1, expected.getSignersLength());
+		EXPECT_EQ(*expected.getSigner(0)->getSerialNumber(), *header.getSigner(0)->getSerialNumber());
+		EXPECT_EQ(*expected.getSigner(0)->getIssuerName(), *header.getSigner(0)->getIssuerName());
+		EXPECT_EQ(*TestPki::get().leaf->getSerialNumber(), *header.getSigner(0)->getSerialNumber());
+	});
+}
+
+TEST_P(CmsHeaderTest, TruncatedBio) {
+	std::string der;
+	TEST_TRY(der = signedDer(std::string(1 << 16, 'a'), GetParam()));
+
+	/* Ends in the middle of the skipped content */
+	CmsHeader header;
+	EXPECT_THROW(header.read(testMemBio(der.substr(0, der.length() / 2)), DataFormat::DER), Handle<Exception>);
+}
+
+INSTANTIATE_TEST_CASE_P(Streamed, CmsHeaderTest, ::testing::Bool());
+
+TEST(CmsHeader, EnvelopedDataStopsAtRecipients) {
+	TEST_TRY({
+		std::string der = envelopedDer(std::string(1 << 20, 'a'));
+		Handle<Bio> in = testMemBio(der);
+
+		CmsHeader header;
+		header.read(in, DataFormat::DER);
+
+		EXPECT_EQ(NID_pkcs7_enveloped, header.getContentType()->toNid());
+		EXPECT_EQ(NID_pkcs7_data, header.getEncapsulatedType()->toNid());
+		ASSERT_EQ(1, header.getRecipientsLength());
+		EXPECT_EQ(*TestPki::get().leaf->getSerialNumber(), *header.getRecipient(0)->getSerialNumber());
+		EXPECT_EQ(*TestPki::get().leaf->getIssuerName(), *header.getRecipient(0)->getIssuerName());
+
+		/* Encrypted content is left in the BIO */
+		EXPECT_GT(BIO_ctrl_pending(in->internal()), (size_t)(1 << 20) - 4096);
+	});
+}
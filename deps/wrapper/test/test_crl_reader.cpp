@@ -0,0 +1,208 @@
+#include <wrapper/stdafx.h>
+
+#include <stdio.h>
+
+#include <wrapper/pki/crl_reader.h>
+
+#include "fixtures.h"
+
+static std::string serialBytes(ASN1_INTEGER *serial) {
+	return std::string((const char *)serial->data, serial->length);
+}
+
+static time_t asn1ToUnix(ASN1_TIME *tm) {
+	int days, seconds;
+	ASN1_TIME *epoch = ASN1_TIME_set(NULL, 0);
+
+	ASN1_TIME_diff(&days, &seconds, epoch, tm);
+	ASN1_TIME_free(epoch);
+
+	return (time_t)days * 86400 + seconds;
+}
+
+/* Every X509_REVOKED of the CRL is in the index with the same date and reason */
+static void expectSameEntries(Handle<CRL> crl, Handle<RevocationIndex> index) {
+	STACK_OF(X509_REVOKED) *revoked = X509_CRL_get_REVOKED(crl->internal());
+
+	ASSERT_EQ((size_t)sk_X509_REVOKED_num(revoked), index->length());
+
+	for (int i = 0; i < sk_X509_REVOKED_num(revoked); i++) {
+		X509_REVOKED *rv = sk_X509_REVOKED_value(revoked, i);
+		std::string serial = serialBytes(rv->serialNumber);
+
+		long found = index->find((const unsigned char *)serial.data(), serial.length());
+		ASSERT_GE(found, 0) << "serial of entry " << i;
+
+		int reason = REVOCATION_REASON_NONE;
+		ASN1_ENUMERATED *ext = (ASN1_ENUMERATED *)X509_REVOKED_get_ext_d2i(rv, NID_crl_reason, NULL, NULL);
+		if (ext) {
+			reason = (int)ASN1_ENUMERATED_get(ext);
+			ASN1_ENUMERATED_free(ext);
+		}
+
+		EXPECT_EQ(reason, index->getReason((size_t)found)) << "reason of entry " << i;
+		EXPECT_EQ(asn1ToUnix(rv->revocationDate), index->getRevocationDate((size_t)found)) << "date of entry " << i;
+	}
+}
+
+TEST(CrlReader, EntriesMatchOpenSSL) {
+	TEST_TRY({
+		Handle<CRL> crl = testCrl(500);
+		std::string der = testDer(crl);
+
+		Handle<RevocationIndex> index = CrlReader::read(testMemBio(der), DataFormat::DER, TestPki::get().ca);
+		expectSameEntries(crl, index);
+
+		EXPECT_EQ(asn1ToUnix(X509_CRL_get_lastUpdate(crl->internal())), index->thisUpdate);
+		EXPECT_EQ(asn1ToUnix(X509_CRL_get_nextUpdate(crl->internal())), index->nextUpdate);
+		EXPECT_EQ(std::string("\x01", 1), index->crlNumber);
+		EXPECT_FALSE(index->isDelta());
+	});
+}
+
+TEST(CrlReader, EntriesMatchOpenSSLPem) {
+	TEST_TRY({
+		Handle<CRL> crl = testCrl(100);
+		Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+		crl->write(out, DataFormat::BASE64);
+		std::string pem = *out->read();
+
+		Handle<RevocationIndex> index = CrlReader::read(testMemBio(pem), DataFormat::BASE64, TestPki::get().ca);
+		expectSameEntries(crl, index);
+	});
+}
+
+TEST(CrlReader, EmptyCrl) {
+	TEST_TRY({
+		Handle<CRL> crl = testCrl(0);
+
+		Handle<RevocationIndex> index = CrlReader::read(testMemBio(testDer(crl)), DataFormat::DER, TestPki::get().ca);
+		EXPECT_EQ((size_t)0, index->length());
+	});
+}
+
+TEST(CrlReader, TamperedSignatureRejected) {
+	std::string der;
+	TEST_TRY(der = testDer(testCrl(10)));
+
+	/* Last byte of signatureValue */
+	std::string signature = der;
+	signature[signature.length() - 1] ^= 0x01;
+	EXPECT_THROW(CrlReader::read(testMemBio(signature), DataFormat::DER, TestPki::get().ca), Handle<Exception>);
+
+	/* Serial of the first entry: 02 03 01 00 00 */
+	std::string serial = der;
+	size_t pos = serial.find(std::string("\x02\x03\x01\x00\x00", 5));
+	ASSERT_NE(std::string::npos, pos);
+	serial[pos + 4] = 0x01;
+	EXPECT_THROW(CrlReader::read(testMemBio(serial), DataFormat::DER, TestPki::get().ca), Handle<Exception>);
+
+	/* Without an issuer the signature is not checked */
+	TEST_TRY(CrlReader::read(testMemBio(serial), DataFormat::DER, NULL));
+}
+
+TEST(CrlReader, WrongIssuerRejected) {
+	std::string der;
+	TEST_TRY(der = testDer(testCrl(10)));
+
+	EXPECT_THROW(CrlReader::read(testMemBio(der), DataFormat::DER, TestPki::get().other), Handle<Exception>);
+}
+
+TEST(CrlReader, TruncatedRejected) {
+	std::string der;
+	TEST_TRY(der = testDer(testCrl(10)));
+
+	for (size_t length = 0; length < der.length(); length += 37) {
+		EXPECT_THROW(CrlReader::read(testMemBio(der.substr(0, length)), DataFormat::DER, NULL), Handle<Exception>) << length;
+	}
+}
+
+/* Lengths close to 4 GB must fail as Handle<Exception>, not std::bad_alloc */
+TEST(CrlReader, CraftedLengthRejected) {
+	/* CertificateList longer than the input */
+	std::string outer("\x30\x84\x7F\xFF\xFF\xFF\x30\x03\x02\x01\x01", 11);
+	EXPECT_THROW(CrlReader::read(testMemBio(outer), DataFormat::DER, NULL), Handle<Exception>);
+
+	/* Element longer than its tbsCertList */
+	std::string inner("\x30\x0A\x30\x08\x02\x84\x7F\xFF\xFF\xFF\x00\x00", 12);
+	EXPECT_THROW(CrlReader::read(testMemBio(inner), DataFormat::DER, NULL), Handle<Exception>);
+
+	/* Input size is not known for a file: the element size limit applies */
+	std::string nested("\x30\x84\x7F\xFF\xFF\xF0\x30\x84\x7F\xFF\xFF\xE0\x02\x84\x7F\xFF\xFF\x00\x00", 19);
+	std::string filename = testTempFile("crafted.crl");
+	TEST_TRY(testWriteFile(filename, nested));
+
+	EXPECT_THROW(CrlReader::read(new Bio(BIO_TYPE_FILE, filename, "rb"), DataFormat::DER, NULL), Handle<Exception>);
+	remove(filename.c_str());
+}
+
+class CrlReaderOpen : public ::testing::Test {
+protected:
+	void SetUp() {
+		this->filename = testTempFile("open.crl");
+		TEST_TRY(this->der = testDer(testCrl(50)));
+	}
+
+	void TearDown() {
+		remove(this->filename.c_str());
+		remove((this->filename + REVOCATION_INDEX_FILE_SUFFIX).c_str());
+	}
+
+	std::string filename;
+	std::string der;
+};
+
+TEST_F(CrlReaderOpen, SavesAndReloadsIndex) {
+	TEST_TRY({
+		testWriteFile(this->filename, this->der);
+
+		Handle<RevocationIndex> built = CrlReader::open(this->filename, DataFormat::DER, TestPki::get().ca, 10);
+		Handle<RevocationIndex> loaded = CrlReader::open(this->filename, DataFormat::DER, TestPki::get().ca, 10);
+
+		EXPECT_EQ((size_t)50, loaded->length());
+		EXPECT_EQ(built->fingerprint, loaded->fingerprint);
+		EXPECT_FALSE(loaded->issuerKey.empty());
+	});
+}
+
+/* Size and tail of the file are the same, only the whole file hash differs */
+TEST_F(CrlReaderOpen, ChangedFileIsParsedAgain) {
+	TEST_TRY({
+		testWriteFile(this->filename, this->der);
+		CrlReader::open(this->filename, DataFormat::DER, TestPki::get().ca, 0);
+	});
+
+	std::string forged = this->der;
+	size_t pos = forged.find(std::string("\x02\x03\x01\x00\x00", 5));
+	ASSERT_NE(std::string::npos, pos);
+	forged[pos + 4] = 0x01;
+	TEST_TRY(testWriteFile(this->filename, forged));
+
+	EXPECT_THROW(CrlReader::open(this->filename, DataFormat::DER, TestPki::get().ca, 0), Handle<Exception>);
+}
+
+/* An index saved without the signature check is not used when the issuer is known */
+TEST_F(CrlReaderOpen, UnverifiedIndexIsNotTrusted) {
+	std::string forged = this->der;
+	size_t pos = forged.find(std::string("\x02\x03\x01\x00\x00", 5));
+	ASSERT_NE(std::string::npos, pos);
+	forged[pos + 4] = 0x01;
+
+	TEST_TRY({
+		testWriteFile(this->filename, forged);
+		Handle<RevocationIndex> index = CrlReader::open(this->filename, DataFormat::DER, NULL, 0);
+		EXPECT_TRUE(index->issuerKey.empty());
+	});
+
+	EXPECT_THROW(CrlReader::open(this->filename, DataFormat::DER, TestPki::get().ca, 0), Handle<Exception>);
+}
+
+/* An index verified with another key is checked again */
+TEST_F(CrlReaderOpen, IndexOfAnotherIssuerKeyIsNotTrusted) {
+	TEST_TRY({
+		testWriteFile(this->filename, this->der);
+		CrlReader::open(this->filename, DataFormat::DER, TestPki::get().ca, 0);
+	});
+
+	EXPECT_THROW(CrlReader::open(this->filename, DataFormat::DER, TestPki::get().other, 0), Handle<Exception>);
+}
@@ -0,0 +1,216 @@
+#include <wrapper/stdafx.h>
+
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <wrapper/pki/crl_scheduler.h>
+#include <wrapper/store/provider_system.h>
+
+#include "fixtures.h"
+
+/* Serves location as is, or a missing file while failing is set */
+class TestCrlFetcher : public CrlFetcher {
+public:
+	TestCrlFetcher() : failing(false), calls(0) {}
+
+	std::string fetch(const std::string &location) {
+		calls++;
+		return failing ? location + ".missing" : location;
+	}
+
+	std::atomic<bool> failing;
+	std::atomic<int> calls;
+};
+
+/* Leaf of the test CA with serial 0x10000, the first serial of testCrl */
+static Handle<Certificate> revokedLeaf() {
+	TestPki &pki = TestPki::get();
+	X509 *x = X509_dup(pki.leaf->internal());
+
+	ASN1_INTEGER_set(X509_get_serialNumber(x), 0x10000);
+	X509_sign(x, pki.caKey->internal(), EVP_sha256());
+
+	return new Certificate(x);
+}
+
+static void writeCrl(const std::string &filename, int count, long crlNumber, long validity = 60 * 60 * 24 * 7) {
+	TestPki &pki = TestPki::get();
+
+	testWriteFile(filename, testDer(fixtureCrl(pki.ca, pki.caKey, count, false, crlNumber, validity)));
+}
+
+/* Polls cond for up to 10 seconds */
+template <class Cond>
+static bool waitFor(Cond cond) {
+	for (int i = 0; i < 1000 && !cond(); i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	return cond();
+}
+
+TEST(CrlScheduler, SnapshotSwap) {
+	std::string filename = testTempFile("scheduler.crl");
+
+	TEST_TRY({
+		Handle<Certificate> cert = revokedLeaf();
+		writeCrl(filename, 0, 1);
+
+		CrlScheduler scheduler(new CrlFileFetcher());
+		scheduler.add(filename, "", DataFormat::DER, TestPki::get().ca);
+		scheduler.refresh();
+
+		SharedRevocationIndex before = scheduler.getIndex(cert);
+		ASSERT_TRUE(before != NULL);
+		EXPECT_FALSE(scheduler.isRevoked(cert));
+
+		writeCrl(filename, 1, 2);
+		scheduler.refresh();
+
+		SharedRevocationIndex after = scheduler.getIndex(cert);
+		ASSERT_TRUE(after != NULL);
+		EXPECT_NE(before.get(), after.get());
+		EXPECT_TRUE(scheduler.isRevoked(cert));
+
+		/* Readers holding the old index are not affected by the swap */
+		EXPECT_EQ((size_t)0, before->length());
+		EXPECT_FALSE(before->isRevoked(cert));
+	});
+
+	remove(filename.c_str());
+	remove((filename + REVOCATION_INDEX_FILE_SUFFIX).c_str());
+}
+
+TEST(CrlScheduler, FailedRefreshKeepsIndex) {
+	std::string filename = testTempFile("scheduler.crl");
+
+	TEST_TRY({
+		Handle<Certificate> cert = revokedLeaf();
+		writeCrl(filename, 1, 1);
+
+		TestCrlFetcher *fetcher = new TestCrlFetcher();
+		CrlScheduler scheduler(fetcher);
+		scheduler.add(filename, "", DataFormat::DER, TestPki::get().ca);
+		scheduler.refresh();
+
+		EXPECT_TRUE(scheduler.isRevoked(cert));
+		EXPECT_EQ("", scheduler.getLastError(filename));
+
+		fetcher->failing = true;
+		scheduler.refresh();
+
+		EXPECT_NE("", scheduler.getLastError(filename));
+		EXPECT_TRUE(scheduler.isRevoked(cert));
+	});
+
+	remove(filename.c_str());
+	remove((filename + REVOCATION_INDEX_FILE_SUFFIX).c_str());
+}
+
+TEST(CrlScheduler, RetryAfterFailure) {
+	std::string filename = testTempFile("scheduler.crl");
+
+	TEST_TRY({
+		Handle<Certificate> cert = revokedLeaf();
+		writeCrl(filename, 1, 1);
+
+		TestCrlFetcher *fetcher = new TestCrlFetcher();
+		fetcher->failing = true;
+
+		CrlScheduler scheduler(fetcher);
+		scheduler.setRetryInterval(1);
+		scheduler.add(filename, "", DataFormat::DER, TestPki::get().ca);
+		scheduler.start();
+
+		ASSERT_TRUE(waitFor([&]() { return !scheduler.getLastError(filename).empty(); }));
+		EXPECT_TRUE(scheduler.getIndex(cert) == NULL);
+		EXPECT_THROW(scheduler.isRevoked(cert), Handle<Exception>);
+
+		/* The thread retries after the retry interval without a wake up */
+		int calls = fetcher->calls;
+		fetcher->failing = false;
+
+		ASSERT_TRUE(waitFor([&]() { return scheduler.getIndex(cert) != NULL; }));
+		EXPECT_GT(fetcher->calls, calls);
+		EXPECT_EQ("", scheduler.getLastError(filename));
+		EXPECT_TRUE(scheduler.isRevoked(cert));
+
+		scheduler.stop();
+	});
+
+	remove(filename.c_str());
+	remove((filename + REVOCATION_INDEX_FILE_SUFFIX).c_str());
+}
+
+TEST(CrlScheduler, ExpiredIndexIsNotAnswer) {
+	std::string filename = testTempFile("scheduler.crl");
+
+	TEST_TRY({
+		Handle<Certificate> cert = revokedLeaf();
+		writeCrl(filename, 0, 1, -60 * 60);
+
+		TestCrlFetcher *fetcher = new TestCrlFetcher();
+		CrlScheduler scheduler(fetcher);
+		scheduler.add(filename, "", DataFormat::DER, TestPki::get().ca);
+		scheduler.refresh();
+
+		ASSERT_TRUE(scheduler.getIndex(cert) != NULL);
+		EXPECT_THROW(scheduler.isRevoked(cert), Handle<Exception>);
+
+		fetcher->failing = true;
+		scheduler.refresh();
+		EXPECT_THROW(scheduler.isRevoked(cert), Handle<Exception>);
+
+		/* Refreshed source answers again */
+		fetcher->failing = false;
+		writeCrl(filename, 1, 2);
+		scheduler.refresh();
+		EXPECT_TRUE(scheduler.isRevoked(cert));
+	});
+
+	remove(filename.c_str());
+	remove((filename + REVOCATION_INDEX_FILE_SUFFIX).c_str());
+}
+
+TEST(CrlScheduler, AddStoreNeedsIssuer) {
+	std::string folder = testTempFile("store");
+	Handle<std::string> crlUri, caUri;
+
+	TEST_TRY({
+		TestPki &pki = TestPki::get();
+		Handle<Certificate> cert = revokedLeaf();
+
+		Handle<PkiStore> store = new PkiStore(new std::string("test"));
+		Handle<Provider> provider = new Provider_System(new std::string(folder));
+		crlUri = store->addPkiObject(provider, new std::string("CRL"), testCrl(1), 0);
+		store->addProvider(new Provider_System(new std::string(folder)));
+
+		CrlScheduler scheduler(new CrlFileFetcher());
+		EXPECT_THROW(scheduler.addStore(store), Handle<Exception>);
+
+		caUri = store->addPkiObject(provider, new std::string("TRUST"), pki.ca, 0);
+		store = new PkiStore(new std::string("test"));
+		store->addProvider(new Provider_System(new std::string(folder)));
+
+		scheduler.addStore(store);
+		scheduler.refresh();
+		EXPECT_EQ("", scheduler.getLastError(*crlUri));
+		EXPECT_TRUE(scheduler.isRevoked(cert));
+	});
+
+	if (!crlUri.isEmpty()) {
+		remove(crlUri->c_str());
+		remove((*crlUri + REVOCATION_INDEX_FILE_SUFFIX).c_str());
+	}
+	if (!caUri.isEmpty()) {
+		remove(caUri->c_str());
+	}
+	const char *categories[] = { "MY", "OTHERS", "TRUST", "CRL" };
+	for (size_t i = 0; i < sizeof(categories) / sizeof(*categories); i++) {
+		test_rmdir((folder + CROSSPLATFORM_SLASH + categories[i]).c_str());
+	}
+	test_rmdir(folder.c_str());
+}
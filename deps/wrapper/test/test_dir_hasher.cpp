@@ -0,0 +1,181 @@
+#include <wrapper/stdafx.h>
+
+#include <stdio.h>
+
+#include <openssl/sha.h>
+
+#include <wrapper/utils/dir_hasher.h>
+#include <wrapper/store/storehelper.h>
+
+#include "fixtures.h"
+
+static std::string sha1Hex(const std::string &data) {
+	unsigned char md[SHA_DIGEST_LENGTH];
+	char hex[SHA_DIGEST_LENGTH * 2 + 1];
+
+	SHA1((const unsigned char *)data.data(), data.length(), md);
+	for (int i = 0; i < SHA_DIGEST_LENGTH; i++) {
+		sprintf(hex + i * 2, "%02x", md[i]);
+	}
+
+	return hex;
+}
+
+/* Node Buffer.from(data.toString("binary"), "utf8") */
+static std::string latin1ToUtf8(const std::string &data) {
+	std::string res;
+
+	for (size_t i = 0; i < data.length(); i++) {
+		unsigned char c = (unsigned char)data[i];
+		if (c < 0x80) {
+			res += (char)c;
+		}
+		else {
+			res += (char)(0xC0 | (c >> 6));
+			res += (char)(0x80 | (c & 0x3F));
+		}
+	}
+
+	return res;
+}
+
+class DirectoryHasherTest : public ::testing::Test {
+protected:
+	void SetUp() {
+		this->dir = testTempFile("hasher");
+		ASSERT_EQ(0, test_mkdir(this->dir.c_str()));
+
+		/* Every byte value, once in a file which is read and once in a mapped one */
+		for (int i = 0; i < 256; i++) {
+			this->small += (char)i;
+		}
+		while (this->large.length() < DIRECTORY_HASHER_MAP_THRESHOLD + 1000) {
+			this->large += this->small;
+		}
+
+		/* Older than the racy interval, so the stat cache keeps them */
+		TEST_TRY({
+			int64_t old = ((int64_t)time(NULL) - 60 * 60) * 1000000000;
+			testWriteFile(this->path("large.bin"), this->large);
+			testWriteFile(this->path("small.bin"), this->small);
+			testSetMtime(this->path("large.bin"), old);
+			testSetMtime(this->path("small.bin"), old);
+		});
+	}
+
+	void TearDown() {
+		remove(this->path("large.bin").c_str());
+		remove(this->path("small.bin").c_str());
+		test_rmdir(this->dir.c_str());
+	}
+
+	std::string path(const char *name) {
+		return this->dir + CROSSPLATFORM_SLASH + name;
+	}
+
+	std::string dir;
+	std::string small;
+	std::string large;
+};
+
+TEST_F(DirectoryHasherTest, RawBytes) {
+	TEST_TRY({
+		DirectoryHasher hasher;
+		std::vector<std::string> files = hasher.hash(this->dir);
+
+		ASSERT_EQ((size_t)2, files.size());
+		EXPECT_EQ("large.bin#" + sha1Hex(this->large), files[0]);
+		EXPECT_EQ("small.bin#" + sha1Hex(this->small), files[1]);
+	});
+}
+
+TEST_F(DirectoryHasherTest, LegacyEncoding) {
+	TEST_TRY({
+		DirectoryHasher hasher;
+		hasher.setLegacyEncoding(true);
+		std::vector<std::string> files = hasher.hash(this->dir);
+
+		ASSERT_EQ((size_t)2, files.size());
+		EXPECT_EQ("large.bin#" + sha1Hex(latin1ToUtf8(this->large)), files[0]);
+		EXPECT_EQ("small.bin#" + sha1Hex(latin1ToUtf8(this->small)), files[1]);
+	});
+}
+
+/* Hashes of one encoding are not taken from the cache for the other */
+TEST_F(DirectoryHasherTest, CacheKeepsEncoding) {
+	std::string cache = testTempFile("hasher.cache");
+
+	TEST_TRY({
+		DirectoryHasher raw;
+		raw.setCache(cache);
+		std::vector<std::string> rawFiles = raw.hash(this->dir);
+
+		DirectoryHasher again;
+		again.setCache(cache);
+		EXPECT_EQ(rawFiles, again.hash(this->dir));
+		EXPECT_EQ((size_t)0, again.getHashedCount());
+
+		DirectoryHasher legacy;
+		legacy.setCache(cache);
+		legacy.setLegacyEncoding(true);
+		std::vector<std::string> legacyFiles = legacy.hash(this->dir);
+
+		EXPECT_EQ((size_t)2, legacy.getHashedCount());
+		EXPECT_NE(rawFiles, legacyFiles);
+	});
+
+	remove(cache.c_str());
+}
+
+/* Same size and mtime, only ctime tells that the content changed */
+TEST_F(DirectoryHasherTest, CacheNoticesRestoredMtime) {
+	std::string cache = testTempFile("hasher.cache");
+
+	TEST_TRY({
+		DirectoryHasher first;
+		first.setCache(cache);
+		std::vector<std::string> before = first.hash(this->dir);
+
+		std::string filename = this->path("small.bin");
+		int64_t mtime = testGetMtime(filename);
+		std::string changed = this->small;
+		changed[0] = 'x';
+		testWriteFile(filename, changed);
+		testSetMtime(filename, mtime);
+		ASSERT_EQ(mtime, testGetMtime(filename));
+
+		DirectoryHasher second;
+		second.setCache(cache);
+		std::vector<std::string> after = second.hash(this->dir);
+
+		EXPECT_EQ((size_t)1, second.getHashedCount());
+		EXPECT_EQ(before[0], after[0]);
+		EXPECT_EQ("small.bin#" + sha1Hex(changed), after[1]);
+		EXPECT_NE(first.getStamp(), second.getStamp());
+	});
+
+	remove(cache.c_str());
+}
+
+#ifndef _WIN32
+/* Error about a path longer than the old 256 bytes message buffer keeps the whole path */
+TEST_F(DirectoryHasherTest, LongPathError) {
+	std::string nested = this->path(std::string(200, 'd').c_str());
+	std::string link = nested + CROSSPLATFORM_SLASH + std::string(200, 'l');
+
+	ASSERT_EQ(0, test_mkdir(nested.c_str()));
+	ASSERT_EQ(0, symlink("missing", link.c_str()));
+
+	try {
+		DirectoryHasher hasher;
+		hasher.hash(this->dir);
+		ADD_FAILURE() << "Dangling link hashed";
+	}
+	catch (Handle<Exception> e) {
+		EXPECT_NE(std::string::npos, std::string(e->what()).find(link));
+	}
+
+	remove(link.c_str());
+	test_rmdir(nested.c_str());
+}
+#endif
@@ -0,0 +1,208 @@
+#include <wrapper/stdafx.h>
+
+#include <stdio.h>
+
+#include <openssl/sha.h>
+
+#include <wrapper/pki/ocsp.h>
+#include <wrapper/store/storehelper.h>
+
+#include "fixtures.h"
+
+#define TEST_OCSP_URL "http://ocsp.test"
+
+/* Revocation index with the leaf certificate revoked as keyCompromise */
+static Handle<RevocationIndex> revokedLeaf(time_t date) {
+	Handle<RevocationIndex> index = new RevocationIndex();
+	ASN1_INTEGER *serial = X509_get_serialNumber(TestPki::get().leaf->internal());
+
+	index->add(serial->data, serial->length, date, 1);
+	index->sort();
+
+	return index;
+}
+
+/* Owned by the Handle<OcspTransport> it is put into */
+static OcspLocalResponder *caResponder(Handle<RevocationIndex> index) {
+	TestPki &pki = TestPki::get();
+
+	return new OcspLocalResponder(pki.ca, pki.ca, pki.caKey, index);
+}
+
+static OcspResult check(Handle<OcspTransport> transport, Handle<OcspCache> cache, bool nonce) {
+	Handle<Ocsp> ocsp = new Ocsp(transport, cache);
+	ocsp->setNonce(nonce);
+
+	return ocsp->check(TestPki::get().leaf, TestPki::get().ca, NULL, TEST_OCSP_URL);
+}
+
+/* Name used by OcspCache for the saved response */
+static std::string cacheFilename(const std::string &folder, const std::string &certId) {
+	unsigned char md[SHA_DIGEST_LENGTH];
+	char name[SHA_DIGEST_LENGTH * 2 + 1];
+
+	SHA1((const unsigned char *)certId.data(), certId.length(), md);
+	for (int i = 0; i < SHA_DIGEST_LENGTH; i++) {
+		sprintf(name + i * 2, "%02x", md[i]);
+	}
+
+	return folder + CROSSPLATFORM_SLASH + name + OCSP_CACHE_FILE_SUFFIX;
+}
+
+/* Answers with the response to another request, so the nonce is not the one sent */
+class ReplayTransport : public OcspTransport {
+public:
+	ReplayTransport(Handle<OcspTransport> responder) : responder_(responder) {}
+
+	std::string send(const std::string &url, const std::string & /* request */) {
+		Handle<std::string> other = Ocsp::createRequest(TestPki::get().leaf, TestPki::get().ca, true);
+
+		return this->responder_->send(url, *other);
+	}
+
+protected:
+	Handle<OcspTransport> responder_;
+};
+
+TEST(Ocsp, GoodStatus) {
+	TEST_TRY({
+		OcspLocalResponder *responder = caResponder(new RevocationIndex());
+		Handle<OcspTransport> transport = responder;
+
+		OcspResult res = check(transport, NULL, false);
+		EXPECT_EQ(OcspCertStatus::Good, res.status);
+		EXPECT_FALSE(res.cached);
+		EXPECT_EQ(1, responder->getRequestCount());
+	});
+}
+
+TEST(Ocsp, RevokedStatus) {
+	TEST_TRY({
+		time_t date = time(NULL) - 60 * 60;
+
+		OcspResult res = check(caResponder(revokedLeaf(date)), NULL, false);
+		EXPECT_EQ(OcspCertStatus::Revoked, res.status);
+		EXPECT_EQ(1, res.reason);
+		EXPECT_EQ(date, res.revocationTime);
+	});
+}
+
+TEST(Ocsp, ExpiredResponseRejected) {
+	Handle<OcspTransport> transport;
+	TEST_TRY({
+		OcspLocalResponder *responder = caResponder(new RevocationIndex());
+		transport = responder;
+		responder->setClockOffset(-3 * 60 * 60);
+		responder->setValidity(60 * 60);
+	});
+
+	EXPECT_THROW(check(transport, NULL, false), Handle<Exception>);
+}
+
+TEST(Ocsp, FutureResponseRejected) {
+	Handle<OcspTransport> transport;
+	TEST_TRY({
+		OcspLocalResponder *responder = caResponder(new RevocationIndex());
+		transport = responder;
+		responder->setClockOffset(OCSP_VALIDITY_SKEW + 60 * 60);
+	});
+
+	EXPECT_THROW(check(transport, NULL, false), Handle<Exception>);
+}
+
+TEST(Ocsp, DelegatedResponder) {
+	TEST_TRY({
+		TestPki &pki = TestPki::get();
+		Handle<OcspTransport> transport = new OcspLocalResponder(pki.ca, pki.ocsp, pki.ocspKey, revokedLeaf(time(NULL)));
+
+		EXPECT_EQ(OcspCertStatus::Revoked, check(transport, NULL, false).status);
+	});
+}
+
+/* The leaf is issued by the CA but has no id-kp-OCSPSigning */
+TEST(Ocsp, DelegatedResponderWithoutOcspSigningRejected) {
+	Handle<OcspTransport> transport;
+	TEST_TRY({
+		TestPki &pki = TestPki::get();
+		transport = new OcspLocalResponder(pki.ca, pki.leaf, pki.leafKey, new RevocationIndex());
+	});
+
+	EXPECT_THROW(check(transport, NULL, false), Handle<Exception>);
+}
+
+TEST(Ocsp, ResponderOfAnotherCaRejected) {
+	Handle<OcspTransport> transport;
+	TEST_TRY({
+		TestPki &pki = TestPki::get();
+		transport = new OcspLocalResponder(pki.ca, pki.other, pki.otherKey, new RevocationIndex());
+	});
+
+	EXPECT_THROW(check(transport, NULL, false), Handle<Exception>);
+}
+
+TEST(Ocsp, Nonce) {
+	TEST_TRY(EXPECT_EQ(OcspCertStatus::Good, check(caResponder(new RevocationIndex()), NULL, true).status));
+}
+
+TEST(Ocsp, NonceMismatchRejected) {
+	Handle<OcspTransport> transport;
+	TEST_TRY(transport = new ReplayTransport(caResponder(new RevocationIndex())));
+
+	EXPECT_THROW(check(transport, NULL, true), Handle<Exception>);
+}
+
+TEST(Ocsp, MemoryCache) {
+	TEST_TRY({
+		OcspLocalResponder *responder = caResponder(new RevocationIndex());
+		Handle<OcspTransport> transport = responder;
+		Handle<OcspCache> cache = new OcspCache("");
+
+		EXPECT_FALSE(check(transport, cache, false).cached);
+		EXPECT_TRUE(check(transport, cache, false).cached);
+		EXPECT_EQ(1, responder->getRequestCount());
+	});
+}
+
+TEST(Ocsp, DiskCacheReload) {
+	std::string folder = testTempFile("ocsp");
+	ASSERT_EQ(0, test_mkdir(folder.c_str()));
+
+	std::string certId;
+	TEST_TRY({
+		certId = Ocsp::getCertId(TestPki::get().leaf, TestPki::get().ca);
+
+		EXPECT_FALSE(check(caResponder(revokedLeaf(time(NULL))), new OcspCache(folder), false).cached);
+
+		/* New cache object has an empty memory part and loads the saved response */
+		OcspLocalResponder *unused = caResponder(new RevocationIndex());
+		Handle<OcspTransport> transport = unused;
+		OcspResult res = check(transport, new OcspCache(folder), false);
+		EXPECT_TRUE(res.cached);
+		EXPECT_EQ(OcspCertStatus::Revoked, res.status);
+		EXPECT_EQ(0, unused->getRequestCount());
+	});
+
+	/* Saved response which is out of date is replaced */
+	TEST_TRY({
+		OcspLocalResponder *stale = caResponder(new RevocationIndex());
+		Handle<OcspTransport> staleTransport = stale;
+		stale->setClockOffset(-3 * 60 * 60);
+		stale->setValidity(60 * 60);
+		Handle<std::string> request = Ocsp::createRequest(TestPki::get().leaf, TestPki::get().ca, false);
+		Handle<OcspCache> cache = new OcspCache(folder);
+		cache->save(certId, staleTransport->send(TEST_OCSP_URL, *request));
+
+		OcspLocalResponder *responder = caResponder(new RevocationIndex());
+		Handle<OcspTransport> transport = responder;
+		OcspResult res = check(transport, new OcspCache(folder), false);
+		EXPECT_FALSE(res.cached);
+		EXPECT_EQ(OcspCertStatus::Good, res.status);
+		EXPECT_EQ(1, responder->getRequestCount());
+
+		std::string saved = cache->load(certId);
+		EXPECT_EQ(OcspCertStatus::Good, Ocsp::verifyResponse(saved, TestPki::get().leaf, TestPki::get().ca, NULL).status);
+	});
+
+	remove(cacheFilename(folder, certId).c_str());
+	test_rmdir(folder.c_str());
+}
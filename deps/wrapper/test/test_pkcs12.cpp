@@ -0,0 +1,39 @@
+#include <wrapper/stdafx.h>
+
+#include <wrapper/pki/pkcs12.h>
+
+#include "fixtures.h"
+
+static Handle<Pkcs12> testPkcs12(const char *pass) {
+	TestPki &pki = TestPki::get();
+	Handle<Pkcs12> p12 = new Pkcs12();
+
+	return p12->create(pki.leaf, pki.leafKey, new CertificateCollection(), (char *)pass, (char *)"leaf");
+}
+
+TEST(Pkcs12, GettersReturnCopies) {
+	TEST_TRY({
+		Handle<Pkcs12> p12 = testPkcs12("1234");
+
+		Handle<Key> first = p12->getKey("1234");
+		Handle<Key> second = p12->getKey("1234");
+		Handle<Key> opened = p12->open("1234")->key;
+
+		/* Separate EVP_PKEY objects of the same key */
+		EXPECT_NE(first->internal(), second->internal());
+		EXPECT_NE(first->internal(), opened->internal());
+		EXPECT_EQ(1, EVP_PKEY_cmp(first->internal(), TestPki::get().leafKey->internal()));
+		EXPECT_EQ(1, EVP_PKEY_cmp(second->internal(), opened->internal()));
+
+		Handle<Certificate> cert = p12->getCertificate("1234");
+		EXPECT_NE(cert->internal(), p12->getCertificate("1234")->internal());
+		EXPECT_EQ(0, X509_cmp(cert->internal(), TestPki::get().leaf->internal()));
+	});
+}
+
+TEST(Pkcs12, WrongPassword) {
+	Handle<Pkcs12> p12;
+	TEST_TRY(p12 = testPkcs12("1234"));
+
+	EXPECT_THROW(p12->getKey("4321"), Handle<Exception>);
+}
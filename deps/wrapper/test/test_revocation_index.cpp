@@ -0,0 +1,181 @@
+#include <wrapper/stdafx.h>
+
+#include <wrapper/pki/revocation.h>
+#include <wrapper/pki/revocation_index.h>
+
+#include "fixtures.h"
+
+static std::string saveIndex(Handle<RevocationIndex> index) {
+	Handle<Bio> out = new Bio(BIO_TYPE_MEM, "");
+
+	index->write(out);
+
+	return *out->read();
+}
+
+TEST(RevocationIndex, WriteReadRoundTrip) {
+	TEST_TRY({
+		Handle<RevocationIndex> index = new RevocationIndex();
+		const unsigned char a[] = { 0x02, 0x02 }, b[] = { 0x01, 0x01 }, c[] = { 0x7F };
+		index->add(a, sizeof(a), 100, 1);
+		index->add(b, sizeof(b), 200, REVOCATION_REASON_NONE);
+		index->add(c, sizeof(c), 300, 5);
+		index->fingerprint = "fingerprint";
+		index->issuerKey = "issuer key";
+
+		Handle<RevocationIndex> loaded = new RevocationIndex();
+		loaded->read(testMemBio(saveIndex(index)));
+
+		EXPECT_EQ((size_t)3, loaded->length());
+		EXPECT_EQ("fingerprint", loaded->fingerprint);
+		EXPECT_EQ("issuer key", loaded->issuerKey);
+		EXPECT_EQ(REVOCATION_REASON_NONE, loaded->getReason((size_t)loaded->find(b, sizeof(b))));
+		EXPECT_EQ((time_t)100, loaded->getRevocationDate((size_t)loaded->find(a, sizeof(a))));
+		EXPECT_TRUE(loaded->isRevoked(c, sizeof(c)));
+	});
+}
+
+TEST(RevocationIndex, UnsortedFileRejected) {
+	std::string data;
+	TEST_TRY({
+		Handle<RevocationIndex> index = new RevocationIndex();
+		const unsigned char a[] = { 0x01, 0x01 }, b[] = { 0x02, 0x02 };
+		index->add(a, sizeof(a), 100, 1);
+		index->add(b, sizeof(b), 200, 1);
+		data = saveIndex(index);
+	});
+
+	size_t pos = data.find(std::string("\x01\x01\x02\x02", 4));
+	ASSERT_NE(std::string::npos, pos);
+	data.replace(pos, 4, std::string("\x02\x02\x01\x01", 4));
+
+	Handle<RevocationIndex> loaded = new RevocationIndex();
+	EXPECT_THROW(loaded->read(testMemBio(data)), Handle<Exception>);
+}
+
+static Handle<RevocationIndex> newIndex(const char *crlNumber, const char *baseCrlNumber) {
+	Handle<RevocationIndex> res = new RevocationIndex();
+
+	res->crlNumber = crlNumber;
+	res->baseCrlNumber = baseCrlNumber;
+
+	return res;
+}
+
+TEST(RevocationIndex, DeltaReplacesAndAdds) {
+	TEST_TRY({
+		const unsigned char a[] = { 0x01 }, b[] = { 0x02 }, c[] = { 0x03 };
+		Handle<RevocationIndex> base = newIndex("\x01", "");
+		base->add(a, sizeof(a), 100, 1);
+		base->add(c, sizeof(c), 300, 1);
+
+		Handle<RevocationIndex> delta = newIndex("\x02", "\x01");
+		delta->add(a, sizeof(a), 200, 5);
+		delta->add(b, sizeof(b), 250, REVOCATION_REASON_NONE);
+
+		Handle<RevocationIndex> res = RevocationIndex::applyDelta(base, delta);
+		ASSERT_EQ((size_t)3, res->length());
+		EXPECT_EQ(5, res->getReason((size_t)res->find(a, sizeof(a))));
+		EXPECT_EQ((time_t)200, res->getRevocationDate((size_t)res->find(a, sizeof(a))));
+		EXPECT_TRUE(res->isRevoked(b, sizeof(b)));
+		EXPECT_TRUE(res->isRevoked(c, sizeof(c)));
+		EXPECT_EQ("\x02", res->crlNumber);
+
+		/*Base is not changed*/
+		EXPECT_EQ((size_t)2, base->length());
+		EXPECT_EQ(1, base->getReason((size_t)base->find(a, sizeof(a))));
+	});
+}
+
+TEST(RevocationIndex, DeltaRemovesFromCrl) {
+	TEST_TRY({
+		const unsigned char a[] = { 0x01 }, c[] = { 0x03 };
+		Handle<RevocationIndex> base = newIndex("\x01", "");
+		base->add(a, sizeof(a), 100, 1);
+		base->add(c, sizeof(c), 300, 1);
+
+		Handle<RevocationIndex> delta = newIndex("\x02", "\x01");
+		delta->add(c, sizeof(c), 400, REVOCATION_REASON_REMOVE_FROM_CRL);
+
+		Handle<RevocationIndex> res = RevocationIndex::applyDelta(base, delta);
+		EXPECT_EQ((size_t)1, res->length());
+		EXPECT_TRUE(res->isRevoked(a, sizeof(a)));
+		EXPECT_FALSE(res->isRevoked(c, sizeof(c)));
+	});
+}
+
+/* Serials are compared as numbers when the base and the delta have different widths */
+TEST(RevocationIndex, DeltaSerialWidthMismatch) {
+	TEST_TRY({
+		const unsigned char small[] = { 0x05 }, medium[] = { 0x01, 0x00 }, large[] = { 0x01, 0x00, 0x00 };
+		const unsigned char wideMedium[] = { 0x00, 0x01, 0x00 };
+		Handle<RevocationIndex> base = newIndex("\x01", "");
+		base->add(small, sizeof(small), 100, 1);
+		base->add(medium, sizeof(medium), 100, 1);
+
+		Handle<RevocationIndex> delta = newIndex("\x02", "\x01");
+		delta->add(small, sizeof(small), 200, REVOCATION_REASON_REMOVE_FROM_CRL);
+		delta->add(wideMedium, sizeof(wideMedium), 200, 4);
+		delta->add(large, sizeof(large), 200, 1);
+
+		Handle<RevocationIndex> res = RevocationIndex::applyDelta(base, delta);
+		EXPECT_EQ((size_t)2, res->length());
+		EXPECT_FALSE(res->isRevoked(small, sizeof(small)));
+		EXPECT_EQ(4, res->getReason((size_t)res->find(medium, sizeof(medium))));
+		EXPECT_TRUE(res->isRevoked(large, sizeof(large)));
+	});
+}
+
+TEST(RevocationIndex, DeltaNeedsNewerBase) {
+	const unsigned char a[] = { 0x01 };
+	Handle<RevocationIndex> base = newIndex("\x02", "");
+	base->add(a, sizeof(a), 100, 1);
+
+	Handle<RevocationIndex> delta = newIndex("\x04", "\x03");
+	delta->add(a, sizeof(a), 200, REVOCATION_REASON_REMOVE_FROM_CRL);
+
+	EXPECT_THROW(RevocationIndex::applyDelta(base, delta), Handle<Exception>);
+}
+
+TEST(RevocationIndex, DeltaNotNewerKeepsBase) {
+	TEST_TRY({
+		const unsigned char a[] = { 0x01 };
+		Handle<RevocationIndex> base = newIndex("\x02", "");
+		base->add(a, sizeof(a), 100, 1);
+
+		Handle<RevocationIndex> delta = newIndex("\x02", "\x01");
+		delta->add(a, sizeof(a), 200, REVOCATION_REASON_REMOVE_FROM_CRL);
+
+		EXPECT_TRUE(RevocationIndex::applyDelta(base, delta)->isRevoked(a, sizeof(a)));
+	});
+}
+
+TEST(Revocation, RevocationIndexWithDelta) {
+	TEST_TRY({
+		TestPki &pki = TestPki::get();
+		Revocation revocation;
+		Handle<RevocationIndex> res = revocation.getRevocationIndex(fixtureCrl(pki.ca, pki.caKey, 10, false),
+			fixtureDeltaCrl(pki.ca, pki.caKey, 4), pki.ca);
+
+		/*0x10000 and 0x10002 are removed, 0x1000001 and 0x1000003 are added*/
+		EXPECT_EQ((size_t)10, res->length());
+		const unsigned char removed[] = { 0x01, 0x00, 0x02 }, added[] = { 0x01, 0x00, 0x00, 0x03 };
+		EXPECT_FALSE(res->isRevoked(removed, sizeof(removed)));
+		EXPECT_TRUE(res->isRevoked(added, sizeof(added)));
+	});
+}
+
+/* Delta signed by another key must not remove serials */
+TEST(Revocation, RevocationIndexRejectsForgedDelta) {
+	TestPki &pki = TestPki::get();
+	Revocation revocation;
+	Handle<CRL> crl, forged;
+
+	TEST_TRY({
+		crl = fixtureCrl(pki.ca, pki.caKey, 10, false);
+		forged = fixtureDeltaCrl(pki.ca, pki.otherKey, 4);
+	});
+
+	EXPECT_THROW(revocation.getRevocationIndex(crl, forged, pki.ca), Handle<Exception>);
+	EXPECT_THROW(revocation.getRevocationIndex(crl, forged, Handle<Certificate>()), Handle<Exception>);
+}
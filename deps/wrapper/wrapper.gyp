@@ -7,12 +7,15 @@
             "sources": [
                 "src/stdafx.cpp",
                 "src/utils/jwt.cpp",
+                "src/utils/dir_hasher.cpp",
                 "src/common/bio.cpp",
                 "src/common/common.cpp",
                 "src/common/excep.cpp",
                 "src/common/log.cpp",
                 "src/common/openssl.cpp",
                 "src/common/prov.cpp",
+                "src/common/mapped_file.cpp",
+                "src/common/pool.cpp",
                 "src/pki/crl.cpp",
                 "src/pki/crls.cpp",
                 "src/pki/revoked.cpp",
@@ -24,9 +27,15 @@
                 "src/pki/cert_request.cpp",
                 "src/pki/csr.cpp",
                 "src/pki/cipher.cpp",
+                "src/pki/kdf_cache.cpp",
                 "src/pki/chain.cpp",
                 "src/pki/pkcs12.cpp",
                 "src/pki/revocation.cpp",
+                "src/pki/bundle.cpp",
+                "src/pki/revocation_index.cpp",
+                "src/pki/crl_reader.cpp",
+                "src/pki/crl_scheduler.cpp",
+                "src/pki/ocsp.cpp",
                 "src/store/cashjson.cpp",
                 "src/store/pkistore.cpp",
                 "src/store/provider_system.cpp",
@@ -44,6 +53,8 @@
                 "src/cms/signed_data.cpp",
                 "src/cms/cmsRecipientInfo.cpp",
                 "src/cms/cmsRecipientInfos.cpp",
+                "src/cms/recipient_set.cpp",
+                "src/cms/header.cpp",
                 "jsoncpp/jsoncpp.cpp"
             ],
             "xcode_settings": {
@@ -21,6 +21,19 @@ declare namespace trusted {
         ASSYMETRIC = 1,
     }
 }
+declare namespace trusted {
+    /**
+     * Key derivation from password for symmetric encryption.
+     * The native library also has scrypt (2) with OpenSSL 1.1.0, the module is built with 1.0.x
+     *
+     * @export
+     * @enum {number}
+     */
+    enum KdfMethod {
+        BYTES_TO_KEY = 0,
+        PBKDF2 = 1,
+    }
+}
 declare namespace trusted {
     /**
      * Public exponent values
@@ -50,6 +63,40 @@ declare namespace trusted {
         ALL = 63,
     }
 }
+declare namespace trusted {
+    /**
+     * Status of verification result
+     *
+     * @export
+     * @enum {number}
+     */
+    enum VerifyStatus {
+        VALID = 0,
+        INVALID = 1,
+        ERROR = 2,
+    }
+    /**
+     * Verification result. Rejected data is reported here instead of exception
+     *
+     * @export
+     * @interface IVerifyResult
+     */
+    interface IVerifyResult {
+        /**
+         * INVALID if data was checked and rejected, ERROR if it could not be checked
+         */
+        status: VerifyStatus;
+        /**
+         * X509_V_ERR_* code for chain, OpenSSL error code for signature
+         */
+        code: number;
+        /**
+         * Depth of the failed certificate in chain or index of the failed signer, -1 if unknown
+         */
+        index: number;
+        message: string;
+    }
+}
 declare namespace native {
     namespace PKI {
         class Key {
@@ -115,6 +162,7 @@ declare namespace native {
             equals(cert: Certificate): boolean;
             duplicate(): Certificate;
             hash(digestName: string): Buffer;
+            hashes(digestNames: string[]): Buffer[];
         }
         class Revoked {
             getSerialNumber(): string;
@@ -135,6 +183,7 @@ declare namespace native {
             push(cer: Certificate): void;
             pop(): void;
             removeAt(index: number): void;
+            load(filename: string): void;
         }
         class CRL {
             getEncoded(): Buffer;
@@ -157,6 +206,7 @@ declare namespace native {
             compare(crl: CRL): number;
             equals(crl: CRL): boolean;
             hash(digestName: string): Buffer;
+            hashes(digestNames: string[]): Buffer[];
             duplicate(): CRL;
         }
         class CrlCollection {
@@ -165,6 +215,7 @@ declare namespace native {
             push(crl: CRL): void;
             pop(): void;
             removeAt(index: number): void;
+            load(filename: string): void;
         }
         class CertificationRequestInfo {
             setSubject(x509name: string): void;
@@ -191,22 +242,33 @@ declare namespace native {
             addRecipientsCerts(certs: CertificateCollection): void;
             setPrivKey(rkey: Key): void;
             setRecipientCert(rcert: Certificate): void;
+            setRecipientStore(store: PKISTORE.PkiStore): void;
             setPass(password: string): void;
             setDigest(digest: string): void;
             setIV(iv: string): void;
             setKey(key: string): void;
+            setKdf(method: trusted.KdfMethod, cost: number, r: number, p: number): void;
+            setKdfLimits(maxIterations: number, maxN: number, maxR: number, maxP: number, maxMemory: number): void;
+            setKdfCacheSize(size: number): void;
             setSalt(salt: string): void;
             getSalt(): Buffer;
             getIV(): Buffer;
             getKey(): Buffer;
+            setAlgorithm(name: string): void;
             getAlgorithm(): string;
             getMode(): string;
             getDigestAlgorithm(): string;
+            setThreads(count: number): void;
+            setChunkSize(size: number): void;
+            encryptChunked(filenameSource: string, filenameEnc: string): void;
+            decryptChunked(filenameEnc: string, filenameDec: string): void;
+            decryptChunkedRange(filenameEnc: string, filenameDec: string, offset: number, length: number): void;
             getRecipientInfos(filenameEnc: string, format: trusted.DataFormat): CMS.CmsRecipientInfoCollection;
         }
         class Chain {
             buildChain(cert: Certificate, certs: CertificateCollection): CertificateCollection;
             verifyChain(chain: CertificateCollection, crls: CrlCollection): boolean;
+            verifyChainResult(chain: CertificateCollection, crls: CrlCollection): trusted.IVerifyResult;
         }
         class Revocation {
             getCrlLocal(cert: Certificate, store: PKISTORE.PkiStore): any;
@@ -214,10 +276,16 @@ declare namespace native {
             checkCrlTime(crl: CRL): boolean;
             downloadCRL(distPoints: string[], path: string, done: (err: Error, crl: PKI.CRL) => void): void;
         }
+        interface IPkcs12Content {
+            certificate?: Certificate;
+            key?: Key;
+            ca: CertificateCollection;
+        }
         class Pkcs12 {
             getCertificate(password: string): Certificate;
             getKey(password: string): Key;
             getCACertificates(password: string): CertificateCollection;
+            open(password: string): IPkcs12Content;
             load(filename: string): void;
             save(filename: string): void;
             create(cert: Certificate, key: Key, ca: CertificateCollection, password: string, name: string): Pkcs12;
@@ -240,6 +308,7 @@ declare namespace native {
             createSigner(cert: PKI.Certificate, key: PKI.Key): Signer;
             addCertificate(cert: PKI.Certificate): void;
             verify(certs?: PKI.CertificateCollection): boolean;
+            verifyResult(certs?: PKI.CertificateCollection): trusted.IVerifyResult;
             sign(): void;
         }
         class SignerCollection {
@@ -281,6 +350,22 @@ declare namespace native {
             pop(): void;
             items(index: number): CmsRecipientInfo;
         }
+        class CmsRecipientSet {
+            push(cert: PKI.Certificate): void;
+            pushCerts(certs: PKI.CertificateCollection): void;
+            length(): number;
+            setAlgorithm(name: string): void;
+            encrypt(filenameSource: string, filenameEnc: string, format: trusted.DataFormat): void;
+        }
+        class CmsHeader {
+            load(filename: string, format: trusted.DataFormat): void;
+            import(data: Buffer, format: trusted.DataFormat): void;
+            getContentType(): PKI.OID;
+            getEncapsulatedType(): PKI.OID;
+            isDetached(): boolean;
+            getSigners(): SignerId[];
+            getRecipients(): SignerId[];
+        }
     }
     namespace PKISTORE {
         interface IPkiItem extends IPkiCrl, IPkiCertificate, IPkiRequest, IPkiKey {
@@ -442,6 +527,17 @@ declare namespace native {
             sign(modulePath: string, cert: PKI.Certificate, key: PKI.Key): void;
             verify(modulePath: string, cacerts?: PKI.CertificateCollection): object;
         }
+        class DirectoryHasher {
+            setDigest(name: string): void;
+            setLegacyEncoding(enable: boolean): void;
+            setIgnore(names: string[]): void;
+            setThreads(count: number): void;
+            setCache(filename: string): void;
+            hash(dir: string): string[];
+            getStamp(): string;
+            getHashedCount(): number;
+            getDirectoryHashes(): string[];
+        }
         class Logger {
             start(filename: string, level: trusted.LoggerLevel): void;
             stop(): void;
@@ -648,16 +744,62 @@ declare namespace trusted.utils {
     }
 }
 declare const path: any;
-declare const crypto2: any;
 declare const fs2: any;
-declare const os: any;
-declare const OS_TYPE: any;
 declare const DEFAULT_IGNORE: string[];
 declare const DEFAULT_OUT_FILENAME = "cerber.lock";
+/**
+ * Verify result is kept in <cache>.result
+ */
+declare const VERIFY_CACHE_RESULT_SUFFIX = ".result";
+/**
+ * Cached verify result is trusted at most this long (ms)
+ */
+declare const VERIFY_CACHE_MAX_AGE: number;
+/**
+ * Lock files changed this recently (ms) are not cached,
+ * a change within the same mtime tick would not be noticed
+ */
+declare const VERIFY_CACHE_RACY_INTERVAL = 2000;
+/**
+ * cerber.lock with directory hashes. Version 1 is a plain array of module_name#sha1_hash
+ */
+declare const MERKLE_MANIFEST_VERSION = 2;
+/**
+ * Package directory in manifest tree
+ */
+declare const MERKLE_ROOT = ".";
 interface IVerifyStatus {
     difModules: string[];
+    /**
+     * Directories whose subtree hash changed, only for manifests signed with digest
+     */
+    difDirectories?: string[];
     signature: boolean;
 }
+/**
+ * cerber.lock version 2
+ */
+interface ICerberManifest {
+    version: number;
+    /**
+     * OpenSSL digest name
+     */
+    digest: string;
+    /**
+     * Hash of package directory
+     */
+    root: string;
+    /**
+     * Directory path => subtree hash
+     */
+    tree: {
+        [dir: string]: string;
+    };
+    /**
+     * module_name#hash
+     */
+    files: string[];
+}
 declare namespace trusted.utils {
     /**
      * App for sign and verify node packages
@@ -674,10 +816,11 @@ declare namespace trusted.utils {
          * @param {string} modulePath Directory path
          * @param {pki.Certificate} cert Signer certificate
          * @param {pki.Key} key Signer private key
+         * @param {string} [digest] Digest for manifest with directory hashes, see sign()
          *
          * @memberOf Cerber
          */
-        static sign(modulePath: string, cert: pki.Certificate, key: pki.Key): void;
+        static sign(modulePath: string, cert: pki.Certificate, key: pki.Key, digest?: string): void;
         /**
          * Verify package
          *
@@ -685,11 +828,25 @@ declare namespace trusted.utils {
          * @param {string} modulePath Directory path
          * @param {pki.CertificateCollection} [cacerts] CA certificates
          * @param {string[]} [policies]
+         * @param {string} [cachePath] Verification cache file, see verify()
          * @returns {IVerifyStatus}
          *
          * @memberOf Cerber
          */
-        static verify(modulePath: string, cacerts?: pki.CertificateCollection, policies?: string[]): IVerifyStatus;
+        static verify(modulePath: string, cacerts?: pki.CertificateCollection, policies?: string[], cachePath?: string): IVerifyStatus;
+        /**
+         * Verify one directory of package
+         *
+         * @static
+         * @param {string} modulePath Package directory path
+         * @param {string} subdir Directory relative to modulePath, see verifyModule()
+         * @param {pki.CertificateCollection} [cacerts] CA certificates
+         * @param {string[]} [policies]
+         * @returns {IVerifyStatus}
+         *
+         * @memberOf Cerber
+         */
+        static verifyModule(modulePath: string, subdir: string, cacerts?: pki.CertificateCollection, policies?: string[]): IVerifyStatus;
         /**
          * Return signer certificate info:
          * issuername, organization, subjectname, thumbprint
@@ -714,21 +871,44 @@ declare namespace trusted.utils {
          * @param {string} modulePath Directory path
          * @param {pki.Certificate} cert Signer certificate
          * @param {pki.Key} key Signer private key
+         * @param {string} [digest] OpenSSL digest name (sha256, sha512...). With it cerber.lock also
+         * keeps a hash of each directory, so changed subtrees are found and single directories
+         * can be verified. Without it cerber.lock is the sha1 list of files
          *
          * @memberOf Cerber
          */
-        sign(modulePath: string, cert: pki.Certificate, key: pki.Key): void;
+        sign(modulePath: string, cert: pki.Certificate, key: pki.Key, digest?: string): void;
         /**
          * Verify package
          *
+         * For manifest with directory hashes only files of changed directories are compared
+         * and difDirectories lists them.
+         * With cachePath only files whose path, size, mtime or inode changed are hashed again.
+         * If neither the files nor cerber.lock and its signature changed, the previous result
+         * is returned without checking the signature
+         *
          * @param {string} modulePath Directory path
          * @param {pki.CertificateCollection} [cacerts] CA certificates
          * @param {string[]} [policies]
+         * @param {string} [cachePath] Verification cache file, must be outside of modulePath
          * @returns {IVerifyStatus}
          *
          * @memberOf Cerber
          */
-        verify(modulePath: string, cacerts?: pki.CertificateCollection, policies?: string[]): IVerifyStatus;
+        verify(modulePath: string, cacerts?: pki.CertificateCollection, policies?: string[], cachePath?: string): IVerifyStatus;
+        /**
+         * Verify one directory of package against signed cerber.lock.
+         * Only this directory is read, so package must be signed with digest
+         *
+         * @param {string} modulePath Package directory path
+         * @param {string} subdir Directory relative to modulePath, e.g. "lib/utils"
+         * @param {pki.CertificateCollection} [cacerts] CA certificates
+         * @param {string[]} [policies]
+         * @returns {IVerifyStatus} difModules and difDirectories are relative to modulePath
+         *
+         * @memberOf Cerber
+         */
+        verifyModule(modulePath: string, subdir: string, cacerts?: pki.CertificateCollection, policies?: string[]): IVerifyStatus;
         /**
          * Return signer certificate info:
          * issuername, organization, subjectname, thumbprint
@@ -740,16 +920,111 @@ declare namespace trusted.utils {
          */
         getSignersInfo(modulePath: string): string[];
         /**
-         * Get filenames and sha1 hashes
+         * Check signature of cerber.lock, set res.signature
+         *
+         * @private
+         * @param {string} cerberLockPath
+         * @param {IVerifyStatus} res
+         * @param {pki.CertificateCollection} [cacerts]
+         * @param {string[]} [policies]
+         * @returns {cms.SignedData} Loaded signature
+         *
+         * @memberOf Cerber
+         */
+        private verifySignature(cerberLockPath, res, cacerts?, policies?);
+        /**
+         * Throw if cerber.lock is not a known manifest version
          *
          * @private
-         * @param {string} dir Directory path
-         * @param {string} [relative] Subdirectory
-         * @returns {string[]} module_name#sha1_hash
+         * @param {*} manifest Parsed cerber.lock
+         * @returns {ICerberManifest}
          *
          * @memberOf Cerber
          */
-        private rehash(dir, relative?);
+        private checkManifest(manifest);
+        /**
+         * Directory hashes as manifest tree
+         *
+         * @private
+         * @param {string[]} hashes DirectoryHasher.getDirectoryHashes()
+         * @param {string} prefix Path of hashed directory in package
+         * @returns {{[dir: string]: string}}
+         *
+         * @memberOf Cerber
+         */
+        private treeHashes(hashes, prefix);
+        /**
+         * Directories whose hash differs from manifest.
+         * Nothing else is compared when top directory matches
+         *
+         * @private
+         * @param {ICerberManifest} manifest
+         * @param {{[dir: string]: string}} tree Current hashes
+         * @param {string} top Hashed directory
+         * @returns {string[]}
+         *
+         * @memberOf Cerber
+         */
+        private diffTree(manifest, tree, top);
+        /**
+         * Files of changed directories which are not in manifest
+         *
+         * @private
+         * @param {ICerberManifest} manifest
+         * @param {string[]} modules Current module_name#hash
+         * @param {string[]} dirs Changed directories
+         * @returns {string[]}
+         *
+         * @memberOf Cerber
+         */
+        private diffFiles(manifest, modules, dirs);
+        /**
+         * Native hasher with Cerber ignore list
+         *
+         * @private
+         * @param {string} [cachePath] Stat cache file
+         * @returns {native.UTILS.DirectoryHasher}
+         *
+         * @memberOf Cerber
+         */
+        private createHasher(cachePath?);
+        /**
+         * Everything the verify result depends on: tree state, lock files and options
+         *
+         * @private
+         * @param {string} cerberLockPath
+         * @param {string} stamp Tree stamp from DirectoryHasher
+         * @param {pki.CertificateCollection} [cacerts]
+         * @param {string[]} [policies]
+         * @returns {string}
+         *
+         * @memberOf Cerber
+         */
+        private verifyCacheKey(cerberLockPath, stamp, cacerts?, policies?);
+        /**
+         * Cached verify result for key or undefined
+         *
+         * @private
+         * @param {string} cachePath
+         * @param {string} key
+         * @returns {IVerifyStatus}
+         *
+         * @memberOf Cerber
+         */
+        private readVerifyCache(cachePath, key);
+        /**
+         * Save verify result. It expires with the earliest certificate of signature
+         *
+         * @private
+         * @param {string} cachePath
+         * @param {string} key
+         * @param {string} cerberLockPath
+         * @param {pki.CertificateCollection} certs Certificates of signature
+         * @param {IVerifyStatus} result
+         *
+         * @memberOf Cerber
+         */
+        private writeVerifyCache(cachePath, key, cerberLockPath, certs, result);
     }
 }
 declare namespace trusted.pki {
@@ -1291,6 +1566,15 @@ declare namespace trusted.pki {
          * @memberOf Certificate
          */
         hash(algorithm?: string): string;
+        /**
+         * Return certificate hashes for several algorithms at once
+         *
+         * @param {string[]} [algorithms=["sha1"]]
+         * @returns {string[]} Hex encoded hashes in order of algorithms
+         *
+         * @memberOf Certificate
+         */
+        hashes(algorithms?: string[]): string[];
         /**
          * Return certificate duplicat
          *
@@ -1347,6 +1631,16 @@ declare namespace trusted.pki {
      * @implements {core.ICollectionWrite}
      */
     class CertificateCollection extends BaseObject<native.PKI.CertificateCollection> implements core.ICollectionWrite {
+        /**
+         * Load certificates from PEM or DER bundle file
+         *
+         * @static
+         * @param {string} filename File location
+         * @returns {CertificateCollection}
+         *
+         * @memberOf CertificateCollection
+         */
+        static load(filename: string): CertificateCollection;
         /**
          * Creates an instance of CertificateCollection.
          * @param {native.PKI.CertificateCollection} [param]
@@ -1753,6 +2047,15 @@ declare namespace trusted.pki {
          * @memberOf Crl
          */
         hash(algorithm?: string): string;
+        /**
+         * Return CRL hashes for several algorithms at once
+         *
+         * @param {string[]} [algorithms=["sha1"]]
+         * @returns {string[]} Hex encoded hashes in order of algorithms
+         *
+         * @memberOf Crl
+         */
+        hashes(algorithms?: string[]): string[];
         /**
          * Return CRL duplicat
          *
@@ -1882,6 +2185,16 @@ declare namespace trusted.pki {
      * @implements {core.ICollectionWrite}
      */
     class CrlCollection extends BaseObject<native.PKI.CrlCollection> implements core.ICollectionWrite {
+        /**
+         * Load CRLs from PEM or DER bundle file
+         *
+         * @static
+         * @param {string} filename File location
+         * @returns {CrlCollection}
+         *
+         * @memberOf CrlCollection
+         */
+        static load(filename: string): CrlCollection;
         /**
          * Creates an instance of CrlCollection.
          * @param {native.PKI.CrlCollection} [param]
@@ -2005,6 +2318,16 @@ declare namespace trusted.pki {
          * @memberOf Chain
          */
         verifyChain(chain: CertificateCollection, crls: CrlCollection): boolean;
+        /**
+         * Verify chain without exception on rejected chain
+         *
+         * @param {CertificateCollection} chain Certificates collection
+         * @param {CrlCollection} crls Crl collection
+         * @returns {IVerifyResult} status, X509_V_ERR_* code and depth of the failed certificate
+         *
+         * @memberOf Chain
+         */
+        verifyChainResult(chain: CertificateCollection, crls: CrlCollection): IVerifyResult;
     }
 }
 declare namespace trusted.pki {
@@ -2016,6 +2339,16 @@ declare namespace trusted.pki {
      * @extends {BaseObject<native.PKI.Cipher>}
      */
     class Cipher extends BaseObject<native.PKI.Cipher> {
+        /**
+         * Number of PBKDF2 and scrypt keys kept for reuse by all Cipher objects of the process.
+         * Default 16, 0 - no cache
+         *
+         * @static
+         * @param {number} size
+         *
+         * @memberOf Cipher
+         */
+        static setKdfCacheSize(size: number): void;
         /**
          * Creates an instance of Cipher.
          *
@@ -2075,6 +2408,16 @@ declare namespace trusted.pki {
          * @memberOf Cipher
          */
         recipientCert: Certificate;
+        /**
+         * Store with recipient certificates and private keys for decrypt.
+         * Used when recipient certificate and key are not set:
+         * the message is parsed once and decrypted with the first matching certificate having a key
+         *
+         * @param {pkistore.PkiStore} store
+         *
+         * @memberOf Cipher
+         */
+        recipientStore: pkistore.PkiStore;
         password: string;
         digest: string;
         readonly riv: Buffer;
@@ -2083,9 +2426,75 @@ declare namespace trusted.pki {
         key: string;
         readonly rsalt: Buffer;
         salt: string;
-        readonly algorithm: string;
+        /**
+         * Set key derivation from password, call it before password.
+         * Data encrypted with password in "Salted__" format does not keep it, decrypt needs the same.
+         * Chunked format keeps it in the header
+         *
+         * @param {KdfMethod} method BYTES_TO_KEY (default) or PBKDF2
+         * @param {number} [cost] PBKDF2 iterations
+         *
+         * @memberOf Cipher
+         */
+        setKdf(method: KdfMethod, cost?: number): void;
+        /**
+         * Upper limits of key derivation parameters. setKdf and chunked data with larger ones are rejected.
+         * Default 10000000 PBKDF2 iterations, scrypt N = 2^20, r = 32, p = 16 and 256 MB
+         *
+         * @param {number} maxIterations PBKDF2 iterations
+         * @param {number} maxN scrypt N
+         * @param {number} maxR scrypt r
+         * @param {number} maxP scrypt p
+         * @param {number} maxMemory scrypt memory in bytes, 128 * r * (N + p + 2)
+         *
+         * @memberOf Cipher
+         */
+        setKdfLimits(maxIterations: number, maxN: number, maxR: number, maxP: number, maxMemory: number): void;
+        /**
+         * Cipher name: aes-256-gcm, aes-256-ctr, aes-256-cbc...
+         * Default des-ede3-cbc. Set it before password, key and iv.
+         * In GCM mode the authentication tag follows the encrypted data.
+         * AEAD ciphers are not available for asymmetric (CMS) method with OpenSSL 1.0.2
+         *
+         * @memberOf Cipher
+         */
+        algorithm: string;
         readonly mode: string;
         readonly dgst: string;
+        /**
+         * Threads for chunked encryption, 0 - number of CPU cores
+         *
+         * @memberOf Cipher
+         */
+        threads: number;
+        /**
+         * Plain bytes in one chunk of chunked encryption. Default 1 MB
+         *
+         * @memberOf Cipher
+         */
+        chunkSize: number;
+        /**
+         * Encrypt data to chunked format: chunks are encrypted independently on several threads
+         * and can be decrypted separately. Needs AEAD algorithm (aes-256-gcm) and password or key
+         *
+         * @param {string} filenameSource This file will encrypted
+         * @param {string} filenameEnc File path for save encrypted data
+         *
+         * @memberOf Cipher
+         */
+        encryptChunked(filenameSource: string, filenameEnc: string): void;
+        /**
+         * Decrypt data in chunked format. With offset only chunks of the range are read.
+         * On error filenameDec must be discarded
+         *
+         * @param {string} filenameEnc This file will decrypt
+         * @param {string} filenameDec File path for save decrypted data
+         * @param {number} [offset] First byte of plain data to decrypt
+         * @param {number} [length] Number of bytes, default up to the end
+         *
+         * @memberOf Cipher
+         */
+        decryptChunked(filenameEnc: string, filenameDec: string, offset?: number, length?: number): void;
         /**
          * Return recipient infos
          *
@@ -2099,6 +2508,26 @@ declare namespace trusted.pki {
     }
 }
 declare namespace trusted.pki {
+    /**
+     * Content of PKCS#12 decrypted with one password
+     *
+     * @export
+     * @interface IPkcs12Content
+     */
+    interface IPkcs12Content {
+        /**
+         * Undefined if PKCS#12 has no certificate for the key
+         */
+        certificate?: Certificate;
+        /**
+         * Undefined if PKCS#12 has no private key
+         */
+        key?: Key;
+        /**
+         * CA certificates (not client certificates)
+         */
+        ca: CertificateCollection;
+    }
     /**
      * PKCS#12 (PFX)
      *
@@ -2124,6 +2553,16 @@ declare namespace trusted.pki {
          * @memberOf Pkcs12
          */
         constructor(param?: native.PKI.Pkcs12);
+        /**
+         * Return certificate, private key and CA certificates.
+         * PKCS#12 is decrypted once, result is reused by certificate(), key() and ca()
+         *
+         * @param {string} password
+         * @returns {IPkcs12Content}
+         *
+         * @memberOf Pkcs12
+         */
+        open(password: string): IPkcs12Content;
         /**
          * Return certificate
          *
@@ -2284,6 +2723,141 @@ declare namespace trusted.cms {
         removeAt(index: number): void;
     }
 }
+declare namespace trusted.cms {
+    /**
+     * Fixed list of recipients for many encrypted messages.
+     * Public keys and recipient identifiers are taken from the certificates once,
+     * each message only encrypts its content key for every recipient.
+     * Output is the same as of Cipher.encrypt in asymmetric mode
+     *
+     * @export
+     * @class CmsRecipientSet
+     * @extends {BaseObject<native.CMS.CmsRecipientSet>}
+     */
+    class CmsRecipientSet extends BaseObject<native.CMS.CmsRecipientSet> {
+        /**
+         * Creates an instance of CmsRecipientSet.
+         * @param {pki.CertificateCollection} [certs] Recipients certificates
+         *
+         * @memberOf CmsRecipientSet
+         */
+        constructor(certs?: pki.CertificateCollection);
+        /**
+         * Return number of recipients
+         *
+         * @readonly
+         * @type {number}
+         * @memberOf CmsRecipientSet
+         */
+        readonly length: number;
+        /**
+         * Content cipher name: aes-256-cbc, aes-128-cbc...
+         * Default des-ede3-cbc. AEAD ciphers are not supported
+         *
+         * @memberOf CmsRecipientSet
+         */
+        algorithm: string;
+        /**
+         * Add recipient certificate or certificates
+         *
+         * @param {(pki.Certificate | pki.CertificateCollection)} certs
+         *
+         * @memberOf CmsRecipientSet
+         */
+        push(certs: pki.Certificate | pki.CertificateCollection): void;
+        /**
+         * Encrypt data for all recipients
+         *
+         * @param {string} filenameSource This file will encrypted
+         * @param {string} filenameEnc File path for save encrypted data
+         * @param {DataFormat} [format=DEFAULT_DATA_FORMAT]
+         *
+         * @memberOf CmsRecipientSet
+         */
+        encrypt(filenameSource: string, filenameEnc: string, format?: DataFormat): void;
+    }
+}
+declare namespace trusted.cms {
+    /**
+     * Content type, signers and recipients of CMS message.
+     * Only tags and lengths are walked: content, certificates and signatures are not decoded,
+     * so it is cheap to route a message before it is loaded as SignedData or decrypted
+     *
+     * @export
+     * @class CmsHeader
+     * @extends {BaseObject<native.CMS.CmsHeader>}
+     */
+    class CmsHeader extends BaseObject<native.CMS.CmsHeader> {
+        /**
+         * Read CMS header from file location
+         *
+         * @static
+         * @param {string} filename File location
+         * @param {DataFormat} [format=DEFAULT_DATA_FORMAT] PEM | DER (default)
+         * @returns {CmsHeader}
+         *
+         * @memberOf CmsHeader
+         */
+        static load(filename: string, format?: DataFormat): CmsHeader;
+        /**
+         * Read CMS header from memory
+         *
+         * @static
+         * @param {Buffer} buffer
+         * @param {DataFormat} [format=DEFAULT_DATA_FORMAT] PEM | DER (default)
+         * @returns {CmsHeader}
+         *
+         * @memberOf CmsHeader
+         */
+        static import(buffer: Buffer, format?: DataFormat): CmsHeader;
+        /**
+         * Creates an instance of CmsHeader.
+         *
+         * @memberOf CmsHeader
+         */
+        constructor();
+        /**
+         * Return content type: signedData, envelopedData...
+         *
+         * @readonly
+         * @type {pki.Oid}
+         * @memberOf CmsHeader
+         */
+        readonly contentType: pki.Oid;
+        /**
+         * Return type of signed or encrypted content
+         *
+         * @readonly
+         * @type {pki.Oid}
+         * @memberOf CmsHeader
+         */
+        readonly encapsulatedType: pki.Oid;
+        /**
+         * Return signers identifiers of signed data
+         *
+         * @readonly
+         * @type {SignerId[]}
+         * @memberOf CmsHeader
+         */
+        readonly signers: SignerId[];
+        /**
+         * Return recipients identifiers of enveloped data
+         *
+         * @readonly
+         * @type {SignerId[]}
+         * @memberOf CmsHeader
+         */
+        readonly recipients: SignerId[];
+        /**
+         * Return true if message has no content
+         *
+         * @returns {boolean}
+         *
+         * @memberOf CmsHeader
+         */
+        isDetached(): boolean;
+    }
+}
 declare namespace trusted.cms {
     /**
      * Wrap signer identifier information (keyidentifier, issuer name and serial number)
@@ -2694,6 +3268,15 @@ declare namespace trusted.cms {
          * @memberOf SignedData
          */
         verify(certs?: pki.CertificateCollection): boolean;
+        /**
+         * Verify signature without exception on rejected signature
+         *
+         * @param {CertificateCollection} [certs] Certificate collection
+         * @returns {IVerifyResult} status, error code and index of the failed signer
+         *
+         * @memberOf SignedData
+         */
+        verifyResult(certs?: pki.CertificateCollection): IVerifyResult;
         /**
          * Create sign
          *
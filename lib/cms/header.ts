@@ -0,0 +1,114 @@
+/// <reference path="../native.ts" />
+/// <reference path="../object.ts" />
+
+namespace trusted.cms {
+    const DEFAULT_DATA_FORMAT: DataFormat = DataFormat.DER;
+
+    /**
+     * Content type, signers and recipients of CMS message.
+     * Only tags and lengths are walked: content, certificates and signatures are not decoded,
+     * so it is cheap to route a message before it is loaded as SignedData or decrypted
+     *
+     * @export
+     * @class CmsHeader
+     * @extends {BaseObject<native.CMS.CmsHeader>}
+     */
+    export class CmsHeader extends BaseObject<native.CMS.CmsHeader> {
+        /**
+         * Read CMS header from file location
+         *
+         * @static
+         * @param {string} filename File location
+         * @param {DataFormat} [format=DEFAULT_DATA_FORMAT] PEM | DER (default)
+         * @returns {CmsHeader}
+         *
+         * @memberOf CmsHeader
+         */
+        public static load(filename: string, format: DataFormat = DEFAULT_DATA_FORMAT): CmsHeader {
+            const header: CmsHeader = new CmsHeader();
+            header.handle.load(filename, format);
+            return header;
+        }
+
+        /**
+         * Read CMS header from memory
+         *
+         * @static
+         * @param {Buffer} buffer
+         * @param {DataFormat} [format=DEFAULT_DATA_FORMAT] PEM | DER (default)
+         * @returns {CmsHeader}
+         *
+         * @memberOf CmsHeader
+         */
+        public static import(buffer: Buffer, format: DataFormat = DEFAULT_DATA_FORMAT): CmsHeader {
+            const header: CmsHeader = new CmsHeader();
+            header.handle.import(buffer, format);
+            return header;
+        }
+
+        /**
+         * Creates an instance of CmsHeader.
+         *
+         * @memberOf CmsHeader
+         */
+        constructor() {
+            super();
+            this.handle = new native.CMS.CmsHeader();
+        }
+
+        /**
+         * Return content type: signedData, envelopedData...
+         *
+         * @readonly
+         * @type {pki.Oid}
+         * @memberOf CmsHeader
+         */
+        get contentType(): pki.Oid {
+            return new pki.Oid(this.handle.getContentType());
+        }
+
+        /**
+         * Return type of signed or encrypted content
+         *
+         * @readonly
+         * @type {pki.Oid}
+         * @memberOf CmsHeader
+         */
+        get encapsulatedType(): pki.Oid {
+            return new pki.Oid(this.handle.getEncapsulatedType());
+        }
+
+        /**
+         * Return signers identifiers of signed data
+         *
+         * @readonly
+         * @type {SignerId[]}
+         * @memberOf CmsHeader
+         */
+        get signers(): SignerId[] {
+            return this.handle.getSigners().map((id) => new SignerId(id));
+        }
+
+        /**
+         * Return recipients identifiers of enveloped data
+         *
+         * @readonly
+         * @type {SignerId[]}
+         * @memberOf CmsHeader
+         */
+        get recipients(): SignerId[] {
+            return this.handle.getRecipients().map((id) => new SignerId(id));
+        }
+
+        /**
+         * Return true if message has no content
+         *
+         * @returns {boolean}
+         *
+         * @memberOf CmsHeader
+         */
+        public isDetached(): boolean {
+            return this.handle.isDetached();
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/// <reference path="../native.ts" />
+/// <reference path="../object.ts" />
+
+namespace trusted.cms {
+    const DEFAULT_DATA_FORMAT: DataFormat = DataFormat.DER;
+
+    /**
+     * Fixed list of recipients for many encrypted messages.
+     * Public keys and recipient identifiers are taken from the certificates once,
+     * each message only encrypts its content key for every recipient.
+     * Output is the same as of Cipher.encrypt in asymmetric mode
+     *
+     * @export
+     * @class CmsRecipientSet
+     * @extends {BaseObject<native.CMS.CmsRecipientSet>}
+     */
+    export class CmsRecipientSet extends BaseObject<native.CMS.CmsRecipientSet> {
+        /**
+         * Creates an instance of CmsRecipientSet.
+         * @param {pki.CertificateCollection} [certs] Recipients certificates
+         *
+         * @memberOf CmsRecipientSet
+         */
+        constructor(certs?: pki.CertificateCollection) {
+            super();
+            this.handle = new native.CMS.CmsRecipientSet();
+            if (certs) {
+                this.push(certs);
+            }
+        }
+
+        /**
+         * Return number of recipients
+         *
+         * @readonly
+         * @type {number}
+         * @memberOf CmsRecipientSet
+         */
+        get length(): number {
+            return this.handle.length();
+        }
+
+        /**
+         * Content cipher name: aes-256-cbc, aes-128-cbc...
+         * Default des-ede3-cbc. AEAD ciphers are not supported
+         *
+         * @memberOf CmsRecipientSet
+         */
+        set algorithm(name: string) {
+            this.handle.setAlgorithm(name);
+        }
+
+        /**
+         * Add recipient certificate or certificates
+         *
+         * @param {(pki.Certificate | pki.CertificateCollection)} certs
+         *
+         * @memberOf CmsRecipientSet
+         */
+        public push(certs: pki.Certificate | pki.CertificateCollection): void {
+            if (certs instanceof pki.CertificateCollection) {
+                this.handle.pushCerts(certs.handle);
+            } else {
+                this.handle.push(certs.handle);
+            }
+        }
+
+        /**
+         * Encrypt data for all recipients
+         *
+         * @param {string} filenameSource This file will encrypted
+         * @param {string} filenameEnc File path for save encrypted data
+         * @param {DataFormat} [format=DEFAULT_DATA_FORMAT]
+         *
+         * @memberOf CmsRecipientSet
+         */
+        public encrypt(filenameSource: string, filenameEnc: string, format: DataFormat = DEFAULT_DATA_FORMAT): void {
+            this.handle.encrypt(filenameSource, filenameEnc, format);
+        }
+    }
+}
@@ -348,6 +348,22 @@ namespace trusted.cms {
             return this.handle.verify(certsD.handle);
         }
 
+        /**
+         * Verify signature without exception on rejected signature
+         *
+         * @param {CertificateCollection} [certs] Certificate collection
+         * @returns {IVerifyResult} status, error code and index of the failed signer
+         *
+         * @memberOf SignedData
+         */
+        public verifyResult(certs?: pki.CertificateCollection): IVerifyResult {
+            let certsD: pki.CertificateCollection = certs;
+            if (!certs) {
+                certsD = new pki.CertificateCollection();
+            }
+            return this.handle.verifyResult(certsD.handle);
+        }
+
         /**
          * Create sign
          *
@@ -0,0 +1,13 @@
+namespace trusted {
+    /**
+     * Key derivation from password for symmetric encryption.
+     * The native library also has scrypt (2) with OpenSSL 1.1.0, the module is built with 1.0.x
+     *
+     * @export
+     * @enum {number}
+     */
+    export enum KdfMethod {
+        BYTES_TO_KEY = 0,
+        PBKDF2 = 1,
+    }
+}
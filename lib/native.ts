@@ -75,6 +75,7 @@ declare namespace native {
             public equals(cert: Certificate): boolean;
             public duplicate(): Certificate;
             public hash(digestName: string): Buffer;
+            public hashes(digestNames: string[]): Buffer[];
         }
 
         class Revoked {
@@ -99,6 +100,7 @@ declare namespace native {
             public push(cer: Certificate): void;
             public pop(): void;
             public removeAt(index: number): void;
+            public load(filename: string): void;
         }
 
         class CRL {
@@ -123,6 +125,7 @@ declare namespace native {
             public compare(crl: CRL): number;
             public equals(crl: CRL): boolean;
             public hash(digestName: string): Buffer;
+            public hashes(digestNames: string[]): Buffer[];
             public duplicate(): CRL;
         }
 
@@ -132,6 +135,7 @@ declare namespace native {
             public push(crl: CRL): void;
             public pop(): void;
             public removeAt(index: number): void;
+            public load(filename: string): void;
         }
 
         class CertificationRequestInfo {
@@ -162,23 +166,34 @@ declare namespace native {
             public addRecipientsCerts(certs: CertificateCollection): void;
             public setPrivKey(rkey: Key): void;
             public setRecipientCert(rcert: Certificate): void;
+            public setRecipientStore(store: PKISTORE.PkiStore): void;
             public setPass(password: string): void;
             public setDigest(digest: string): void;
             public setIV(iv: string): void;
             public setKey(key: string): void;
+            public setKdf(method: trusted.KdfMethod, cost: number, r: number, p: number): void;
+            public setKdfLimits(maxIterations: number, maxN: number, maxR: number, maxP: number, maxMemory: number): void;
+            public setKdfCacheSize(size: number): void;
             public setSalt(salt: string): void;
             public getSalt(): Buffer;
             public getIV(): Buffer;
             public getKey(): Buffer;
+            public setAlgorithm(name: string): void;
             public getAlgorithm(): string;
             public getMode(): string;
             public getDigestAlgorithm(): string;
+            public setThreads(count: number): void;
+            public setChunkSize(size: number): void;
+            public encryptChunked(filenameSource: string, filenameEnc: string): void;
+            public decryptChunked(filenameEnc: string, filenameDec: string): void;
+            public decryptChunkedRange(filenameEnc: string, filenameDec: string, offset: number, length: number): void;
             public getRecipientInfos(filenameEnc: string, format: trusted.DataFormat): CMS.CmsRecipientInfoCollection;
         }
 
         class Chain {
             public buildChain(cert: Certificate, certs: CertificateCollection): CertificateCollection;
             public verifyChain(chain: CertificateCollection, crls: CrlCollection): boolean;
+            public verifyChainResult(chain: CertificateCollection, crls: CrlCollection): trusted.IVerifyResult;
         }
 
         class Revocation {
@@ -188,10 +203,17 @@ declare namespace native {
             public downloadCRL(distPoints: string[], path: string, done: (err: Error, crl: PKI.CRL) => void): void;
         }
 
+        interface IPkcs12Content {
+            certificate?: Certificate;
+            key?: Key;
+            ca: CertificateCollection;
+        }
+
         class Pkcs12 {
             public getCertificate(password: string): Certificate;
             public getKey(password: string): Key;
             public getCACertificates(password: string): CertificateCollection;
+            public open(password: string): IPkcs12Content;
 
             public load(filename: string): void;
             public save(filename: string): void;
@@ -217,6 +239,7 @@ declare namespace native {
             public createSigner(cert: PKI.Certificate, key: PKI.Key): Signer;
             public addCertificate(cert: PKI.Certificate): void;
             public verify(certs?: PKI.CertificateCollection): boolean;
+            public verifyResult(certs?: PKI.CertificateCollection): trusted.IVerifyResult;
             public sign(): void;
         }
 
@@ -265,6 +288,24 @@ declare namespace native {
             public items(index: number): CmsRecipientInfo;
         }
 
+        class CmsRecipientSet {
+            public push(cert: PKI.Certificate): void;
+            public pushCerts(certs: PKI.CertificateCollection): void;
+            public length(): number;
+            public setAlgorithm(name: string): void;
+            public encrypt(filenameSource: string, filenameEnc: string, format: trusted.DataFormat): void;
+        }
+
+        class CmsHeader {
+            public load(filename: string, format: trusted.DataFormat): void;
+            public import(data: Buffer, format: trusted.DataFormat): void;
+            public getContentType(): PKI.OID;
+            public getEncapsulatedType(): PKI.OID;
+            public isDetached(): boolean;
+            public getSigners(): SignerId[];
+            public getRecipients(): SignerId[];
+        }
+
     }
 
     export namespace PKISTORE {
@@ -452,6 +493,18 @@ declare namespace native {
             public verify(modulePath: string, cacerts?: PKI.CertificateCollection): object;
         }
 
+        class DirectoryHasher {
+            public setDigest(name: string): void;
+            public setLegacyEncoding(enable: boolean): void;
+            public setIgnore(names: string[]): void;
+            public setThreads(count: number): void;
+            public setCache(filename: string): void;
+            public hash(dir: string): string[];
+            public getStamp(): string;
+            public getHashedCount(): number;
+            public getDirectoryHashes(): string[];
+        }
+
         class Logger {
             public start(filename: string, level: trusted.LoggerLevel): void;
             public stop(): void;
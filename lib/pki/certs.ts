@@ -13,6 +13,21 @@ namespace trusted.pki {
     export class CertificateCollection extends BaseObject<native.PKI.CertificateCollection>
         implements core.ICollectionWrite {
 
+        /**
+         * Load certificates from PEM or DER bundle file
+         *
+         * @static
+         * @param {string} filename File location
+         * @returns {CertificateCollection}
+         *
+         * @memberOf CertificateCollection
+         */
+        public static load(filename: string): CertificateCollection {
+            const collection: CertificateCollection = new CertificateCollection();
+            collection.handle.load(filename);
+            return collection;
+        }
+
         /**
          * Creates an instance of CertificateCollection.
          * @param {native.PKI.CertificateCollection} [param]
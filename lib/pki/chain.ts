@@ -54,5 +54,22 @@ namespace trusted.pki {
             }
             return this.handle.verifyChain(chain.handle, crlsD.handle);
         }
+
+        /**
+         * Verify chain without exception on rejected chain
+         *
+         * @param {CertificateCollection} chain Certificates collection
+         * @param {CrlCollection} crls Crl collection
+         * @returns {IVerifyResult} status, X509_V_ERR_* code and depth of the failed certificate
+         *
+         * @memberOf Chain
+         */
+        public verifyChainResult(chain: CertificateCollection, crls: CrlCollection): IVerifyResult {
+            let crlsD: CrlCollection = crls;
+            if (!crls) {
+                crlsD = new CrlCollection();
+            }
+            return this.handle.verifyChainResult(chain.handle, crlsD.handle);
+        }
     }
 }
@@ -10,6 +10,18 @@ namespace trusted.pki {
      * @extends {BaseObject<native.PKI.Cipher>}
      */
     export class Cipher extends BaseObject<native.PKI.Cipher> {
+        /**
+         * Number of PBKDF2 and scrypt keys kept for reuse by all Cipher objects of the process.
+         * Default 16, 0 - no cache
+         *
+         * @static
+         * @param {number} size
+         *
+         * @memberOf Cipher
+         */
+        public static setKdfCacheSize(size: number): void {
+            new native.PKI.Cipher().setKdfCacheSize(size);
+        }
 
         /**
          * Creates an instance of Cipher.
@@ -92,6 +104,19 @@ namespace trusted.pki {
             this.handle.setRecipientCert(rcert.handle);
         }
 
+        /**
+         * Store with recipient certificates and private keys for decrypt.
+         * Used when recipient certificate and key are not set:
+         * the message is parsed once and decrypted with the first matching certificate having a key
+         *
+         * @param {pkistore.PkiStore} store
+         *
+         * @memberOf Cipher
+         */
+        set recipientStore(store: pkistore.PkiStore) {
+            this.handle.setRecipientStore(store.handle);
+        }
+
         set password(pass: string) {
             this.handle.setPass(pass);
         }
@@ -104,6 +129,12 @@ namespace trusted.pki {
             return this.handle.getIV();
         }
 
+        /**
+         * Hex iv for CBC mode. CTR, OFB, CFB and GCM encrypt with a random iv
+         * written before the data, decrypt reads it from there
+         *
+         * @memberOf Cipher
+         */
         set iv(iv: string) {
             this.handle.setIV(iv);
         }
@@ -120,14 +151,62 @@ namespace trusted.pki {
             return this.handle.getSalt();
         }
 
+        /**
+         * Hex salt for password encrypt. Without it every encrypt takes a random salt
+         * Only CBC mode accepts it, in other modes a fixed salt would repeat the iv
+         *
+         * @memberOf Cipher
+         */
         set salt(salt: string) {
             this.handle.setSalt(salt);
         }
 
+        /**
+         * Set key derivation from password, call it before password.
+         * Data encrypted with password in "Salted__" format does not keep it, decrypt needs the same.
+         * Chunked format keeps it in the header
+         *
+         * @param {KdfMethod} method BYTES_TO_KEY (default) or PBKDF2
+         * @param {number} [cost] PBKDF2 iterations
+         *
+         * @memberOf Cipher
+         */
+        public setKdf(method: KdfMethod, cost?: number): void {
+            this.handle.setKdf(method, cost === undefined ? 0 : cost, 8, 1);
+        }
+
+        /**
+         * Upper limits of key derivation parameters. setKdf and chunked data with larger ones are rejected.
+         * Default 10000000 PBKDF2 iterations, scrypt N = 2^20, r = 32, p = 16 and 256 MB
+         *
+         * @param {number} maxIterations PBKDF2 iterations
+         * @param {number} maxN scrypt N
+         * @param {number} maxR scrypt r
+         * @param {number} maxP scrypt p
+         * @param {number} maxMemory scrypt memory in bytes, 128 * r * (N + p + 2)
+         *
+         * @memberOf Cipher
+         */
+        public setKdfLimits(maxIterations: number, maxN: number, maxR: number, maxP: number, maxMemory: number): void {
+            this.handle.setKdfLimits(maxIterations, maxN, maxR, maxP, maxMemory);
+        }
+
         get algorithm(): string {
             return this.handle.getAlgorithm();
         }
 
+        /**
+         * Cipher name: aes-256-gcm, aes-256-ctr, aes-256-cbc...
+         * Default des-ede3-cbc. Set it before password, key and iv.
+         * In GCM mode the authentication tag follows the encrypted data.
+         * AEAD ciphers are not available for asymmetric (CMS) method with OpenSSL 1.0.2
+         *
+         * @memberOf Cipher
+         */
+        set algorithm(name: string) {
+            this.handle.setAlgorithm(name);
+        }
+
         get mode(): string {
             return this.handle.getMode();
         }
@@ -136,6 +215,57 @@ namespace trusted.pki {
             return this.handle.getDigestAlgorithm();
         }
 
+        /**
+         * Threads for chunked encryption, 0 - number of CPU cores
+         *
+         * @memberOf Cipher
+         */
+        set threads(count: number) {
+            this.handle.setThreads(count);
+        }
+
+        /**
+         * Plain bytes in one chunk of chunked encryption. Default 1 MB
+         *
+         * @memberOf Cipher
+         */
+        set chunkSize(size: number) {
+            this.handle.setChunkSize(size);
+        }
+
+        /**
+         * Encrypt data to chunked format: chunks are encrypted independently on several threads
+         * and can be decrypted separately. Needs AEAD algorithm (aes-256-gcm) and password or key
+         *
+         * @param {string} filenameSource This file will encrypted
+         * @param {string} filenameEnc File path for save encrypted data
+         *
+         * @memberOf Cipher
+         */
+        public encryptChunked(filenameSource: string, filenameEnc: string): void {
+            this.handle.encryptChunked(filenameSource, filenameEnc);
+        }
+
+        /**
+         * Decrypt data in chunked format. With offset only chunks of the range are read.
+         * On error filenameDec must be discarded
+         *
+         * @param {string} filenameEnc This file will decrypt
+         * @param {string} filenameDec File path for save decrypted data
+         * @param {number} [offset] First byte of plain data to decrypt
+         * @param {number} [length] Number of bytes, default up to the end
+         *
+         * @memberOf Cipher
+         */
+        public decryptChunked(filenameEnc: string, filenameDec: string, offset?: number, length?: number): void {
+            if (offset === undefined) {
+                this.handle.decryptChunked(filenameEnc, filenameDec);
+            } else {
+                this.handle.decryptChunkedRange(filenameEnc, filenameDec, offset,
+                    length === undefined ? Infinity : length);
+            }
+        }
+
         /**
          * Return recipient infos
          *
@@ -284,6 +284,18 @@ namespace trusted.pki {
             return this.handle.hash(algorithm).toString("hex");
         }
 
+        /**
+         * Return CRL hashes for several algorithms at once
+         *
+         * @param {string[]} [algorithms=["sha1"]]
+         * @returns {string[]} Hex encoded hashes in order of algorithms
+         *
+         * @memberOf Crl
+         */
+        public hashes(algorithms: string[] = ["sha1"]): string[] {
+            return this.handle.hashes(algorithms).map((hash: Buffer) => hash.toString("hex"));
+        }
+
         /**
          * Return CRL duplicat
          *
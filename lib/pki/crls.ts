@@ -13,6 +13,21 @@ namespace trusted.pki {
      */
     export class CrlCollection extends BaseObject<native.PKI.CrlCollection> implements core.ICollectionWrite {
 
+        /**
+         * Load CRLs from PEM or DER bundle file
+         *
+         * @static
+         * @param {string} filename File location
+         * @returns {CrlCollection}
+         *
+         * @memberOf CrlCollection
+         */
+        public static load(filename: string): CrlCollection {
+            const collection: CrlCollection = new CrlCollection();
+            collection.handle.load(filename);
+            return collection;
+        }
+
         /**
          * Creates an instance of CrlCollection.
          * @param {native.PKI.CrlCollection} [param]
@@ -3,6 +3,29 @@
 
 namespace trusted.pki {
 
+    /**
+     * Content of PKCS#12 decrypted with one password
+     *
+     * @export
+     * @interface IPkcs12Content
+     */
+    export interface IPkcs12Content {
+        /**
+         * Undefined if PKCS#12 has no certificate for the key
+         */
+        certificate?: Certificate;
+
+        /**
+         * Undefined if PKCS#12 has no private key
+         */
+        key?: Key;
+
+        /**
+         * CA certificates (not client certificates)
+         */
+        ca: CertificateCollection;
+    }
+
     /**
      * PKCS#12 (PFX)
      *
@@ -41,6 +64,25 @@ namespace trusted.pki {
             }
         }
 
+        /**
+         * Return certificate, private key and CA certificates.
+         * PKCS#12 is decrypted once, result is reused by certificate(), key() and ca()
+         *
+         * @param {string} password
+         * @returns {IPkcs12Content}
+         *
+         * @memberOf Pkcs12
+         */
+        public open(password: string): IPkcs12Content {
+            const content: native.PKI.IPkcs12Content = this.handle.open(password);
+            return {
+                ca: new CertificateCollection(content.ca),
+                certificate: content.certificate ?
+                    Certificate.wrap<native.PKI.Certificate, Certificate>(content.certificate) : undefined,
+                key: content.key ? Key.wrap<native.PKI.Key, Key>(content.key) : undefined,
+            };
+        }
+
         /**
          * Return certificate
          *
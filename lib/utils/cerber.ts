@@ -4,11 +4,7 @@
 /* tslint:disable:no-var-requires */
 
 const path = require("path");
-const crypto2 = require("crypto");
 const fs2 = require("fs");
-const os = require("os");
-
-const OS_TYPE = os.type();
 
 const DEFAULT_IGNORE = ([
   ".DS_Store",
@@ -31,12 +27,60 @@ const DEFAULT_IGNORE = ([
 ]);
 
 const DEFAULT_OUT_FILENAME = "cerber.lock";
+/**
+ * Verify result is kept in <cache>.result
+ */
+const VERIFY_CACHE_RESULT_SUFFIX = ".result";
+/**
+ * Cached verify result is trusted at most this long (ms)
+ */
+const VERIFY_CACHE_MAX_AGE = 24 * 60 * 60 * 1000;
+/**
+ * Lock files changed this recently (ms) are not cached,
+ * a change within the same mtime tick would not be noticed
+ */
+const VERIFY_CACHE_RACY_INTERVAL = 2000;
+/**
+ * cerber.lock with directory hashes. Version 1 is a plain array of module_name#sha1_hash
+ */
+const MERKLE_MANIFEST_VERSION = 2;
+/**
+ * Package directory in manifest tree
+ */
+const MERKLE_ROOT = ".";
 
 interface IVerifyStatus {
     difModules: string[];
+    /**
+     * Directories whose subtree hash changed, only for manifests signed with digest
+     */
+    difDirectories?: string[];
     signature: boolean;
 }
 
+/**
+ * cerber.lock version 2
+ */
+interface ICerberManifest {
+    version: number;
+    /**
+     * OpenSSL digest name
+     */
+    digest: string;
+    /**
+     * Hash of package directory
+     */
+    root: string;
+    /**
+     * Directory path => subtree hash
+     */
+    tree: {[dir: string]: string};
+    /**
+     * module_name#hash
+     */
+    files: string[];
+}
+
 namespace trusted.utils {
     /**
      * App for sign and verify node packages
@@ -53,12 +97,13 @@ namespace trusted.utils {
          * @param {string} modulePath Directory path
          * @param {pki.Certificate} cert Signer certificate
          * @param {pki.Key} key Signer private key
+         * @param {string} [digest] Digest for manifest with directory hashes, see sign()
          *
          * @memberOf Cerber
          */
-        public static sign(modulePath: string, cert: pki.Certificate, key: pki.Key): void {
+        public static sign(modulePath: string, cert: pki.Certificate, key: pki.Key, digest?: string): void {
             const cerber = new Cerber();
-            cerber.sign(modulePath, cert, key);
+            cerber.sign(modulePath, cert, key, digest);
         }
 
         /**
@@ -68,14 +113,33 @@ namespace trusted.utils {
          * @param {string} modulePath Directory path
          * @param {pki.CertificateCollection} [cacerts] CA certificates
          * @param {string[]} [policies]
+         * @param {string} [cachePath] Verification cache file, see verify()
          * @returns {IVerifyStatus}
          *
          * @memberOf Cerber
          */
         public static verify(modulePath: string, cacerts?: pki.CertificateCollection,
-                             policies?: string[]): IVerifyStatus {
+                             policies?: string[], cachePath?: string): IVerifyStatus {
             const cerber = new Cerber();
-            return cerber.verify(modulePath, cacerts, policies);
+            return cerber.verify(modulePath, cacerts, policies, cachePath);
+        }
+
+        /**
+         * Verify one directory of package
+         *
+         * @static
+         * @param {string} modulePath Package directory path
+         * @param {string} subdir Directory relative to modulePath, see verifyModule()
+         * @param {pki.CertificateCollection} [cacerts] CA certificates
+         * @param {string[]} [policies]
+         * @returns {IVerifyStatus}
+         *
+         * @memberOf Cerber
+         */
+        public static verifyModule(modulePath: string, subdir: string, cacerts?: pki.CertificateCollection,
+                                   policies?: string[]): IVerifyStatus {
+            const cerber = new Cerber();
+            return cerber.verifyModule(modulePath, subdir, cacerts, policies);
         }
 
         /**
@@ -109,11 +173,19 @@ namespace trusted.utils {
          * @param {string} modulePath Directory path
          * @param {pki.Certificate} cert Signer certificate
          * @param {pki.Key} key Signer private key
+         * @param {string} [digest] OpenSSL digest name (sha256, sha512...). With it cerber.lock also
+         * keeps a hash of each directory, so changed subtrees are found and single directories
+         * can be verified. Without it cerber.lock is the sha1 list of files, hashed the way
+         * version 1 manifests always were (see createHasher)
          *
          * @memberOf Cerber
          */
-        public sign(modulePath: string, cert: pki.Certificate, key: pki.Key): void {
-            const modules = this.rehash(modulePath);
+        public sign(modulePath: string, cert: pki.Certificate, key: pki.Key, digest?: string): void {
+            const hasher = this.createHasher(!digest);
+            if (digest) {
+                hasher.setDigest(digest);
+            }
+            const modules = hasher.hash(modulePath);
             if (!modules.length) {
                 throw new Error("Empty directory");
             }
@@ -122,7 +194,19 @@ namespace trusted.utils {
             let sd: cms.SignedData;
             let signer: cms.Signer;
 
-            const str = JSON.stringify(modules, null, 2);
+            let manifest: string[] | ICerberManifest = modules;
+            if (digest) {
+                const tree = this.treeHashes(hasher.getDirectoryHashes(), MERKLE_ROOT);
+                manifest = {
+                    digest,
+                    files: modules,
+                    root: tree[MERKLE_ROOT],
+                    tree,
+                    version: MERKLE_MANIFEST_VERSION,
+                };
+            }
+
+            const str = JSON.stringify(manifest, null, 2);
             fs2.writeFileSync(cerberLockPath, str);
 
             sd = new trusted.cms.SignedData();
@@ -141,50 +225,106 @@ namespace trusted.utils {
         /**
          * Verify package
          *
+         * For manifest with directory hashes only files of changed directories are compared
+         * and difDirectories lists them.
+         * With cachePath only files whose path, size, mtime, ctime, inode or device changed are hashed again.
+         * If neither the files nor cerber.lock and its signature changed, the previous result
+         * is returned without checking the signature
+         *
          * @param {string} modulePath Directory path
          * @param {pki.CertificateCollection} [cacerts] CA certificates
          * @param {string[]} [policies]
+         * @param {string} [cachePath] Verification cache file, must be outside of modulePath
          * @returns {IVerifyStatus}
          *
          * @memberOf Cerber
          */
-        public verify(modulePath: string, cacerts?: pki.CertificateCollection, policies?: string[]): IVerifyStatus {
+        public verify(modulePath: string, cacerts?: pki.CertificateCollection, policies?: string[],
+                      cachePath?: string): IVerifyStatus {
             const cerberLockPath = path.join(modulePath, DEFAULT_OUT_FILENAME);
-            const modules = this.rehash(modulePath);
-            const buffer = fs2.readFileSync(cerberLockPath, "utf8");
-            const ccerber = JSON.parse(buffer);
-
-            const res: IVerifyStatus = {signature: false, difModules: []};
-
-            let cms: cms.SignedData;
+            const ccerber = JSON.parse(fs2.readFileSync(cerberLockPath, "utf8"));
+            const merkle = !Array.isArray(ccerber);
 
-            let certsD: pki.CertificateCollection = cacerts;
-            if (!certsD) {
-                certsD = new pki.CertificateCollection();
+            const hasher = this.createHasher(!merkle, cachePath);
+            if (merkle) {
+                hasher.setDigest(this.checkManifest(ccerber).digest);
+            }
+            const modules = hasher.hash(modulePath);
+
+            let cacheKey: string;
+            if (cachePath) {
+                cacheKey = this.verifyCacheKey(cerberLockPath, hasher.getStamp(), cacerts, policies);
+                const cached = this.readVerifyCache(cachePath, cacheKey);
+                if (cached) {
+                    return cached;
+                }
             }
 
-            if (!(JSON.stringify(ccerber) === JSON.stringify(modules))) {
+            const res: IVerifyStatus = {signature: false, difModules: []};
+
+            if (merkle) {
+                const tree = this.treeHashes(hasher.getDirectoryHashes(), MERKLE_ROOT);
+                res.difDirectories = this.diffTree(ccerber, tree, MERKLE_ROOT);
+                res.difModules = this.diffFiles(ccerber, modules, res.difDirectories);
+            } else if (!(JSON.stringify(ccerber) === JSON.stringify(modules))) {
                 res.difModules = modules.filter(function(x) {
                     return ccerber.indexOf(x) === -1;
                 });
             }
 
-            cms = new trusted.cms.SignedData();
-            if (policies) {
-                cms.policies = policies;
+            const cms = this.verifySignature(cerberLockPath, res, cacerts, policies);
+
+            if (cachePath) {
+                this.writeVerifyCache(cachePath, cacheKey, cerberLockPath, cms.certificates(), res);
             }
 
-            cms.load(cerberLockPath + ".sig", trusted.DataFormat.PEM);
+            return res;
+        }
 
-            if (cms.isDetached()) {
-                cms.content = {
-                    data: cerberLockPath,
-                    type: trusted.cms.SignedDataContentType.url,
+        /**
+         * Verify one directory of package against signed cerber.lock.
+         * Only this directory is read, so package must be signed with digest
+         *
+         * @param {string} modulePath Package directory path
+         * @param {string} subdir Directory relative to modulePath, e.g. "lib/utils"
+         * @param {pki.CertificateCollection} [cacerts] CA certificates
+         * @param {string[]} [policies]
+         * @returns {IVerifyStatus} difModules and difDirectories are relative to modulePath
+         *
+         * @memberOf Cerber
+         */
+        public verifyModule(modulePath: string, subdir: string, cacerts?: pki.CertificateCollection,
+                            policies?: string[]): IVerifyStatus {
+            const cerberLockPath = path.join(modulePath, DEFAULT_OUT_FILENAME);
+            const ccerber = JSON.parse(fs2.readFileSync(cerberLockPath, "utf8"));
+            if (Array.isArray(ccerber)) {
+                throw new Error("Package is signed without directory hashes");
+            }
+            const manifest = this.checkManifest(ccerber);
 
-                };
+            const prefix = subdir.split(/[\\/]+/).filter(function(x) {
+                return x && x !== ".";
+            }).join("/") || MERKLE_ROOT;
+            if (!Object.prototype.hasOwnProperty.call(manifest.tree, prefix)) {
+                throw new Error("Directory is not signed: " + subdir);
             }
 
-            res.signature = cms.verify(certsD);
+            const hasher = this.createHasher(false);
+            hasher.setDigest(manifest.digest);
+            let modules = hasher.hash(path.join(modulePath, prefix));
+            if (prefix !== MERKLE_ROOT) {
+                modules = modules.map(function(x) {
+                    return prefix + "/" + x;
+                });
+            }
+
+            const res: IVerifyStatus = {signature: false, difModules: []};
+
+            const tree = this.treeHashes(hasher.getDirectoryHashes(), prefix);
+            res.difDirectories = this.diffTree(manifest, tree, prefix);
+            res.difModules = this.diffFiles(manifest, modules, res.difDirectories);
+
+            this.verifySignature(cerberLockPath, res, cacerts, policies);
 
             return res;
         }
@@ -241,49 +381,257 @@ namespace trusted.utils {
         }
 
         /**
-         * Get filenames and sha1 hashes
+         * Check signature of cerber.lock, set res.signature
+         *
+         * @private
+         * @param {string} cerberLockPath
+         * @param {IVerifyStatus} res
+         * @param {pki.CertificateCollection} [cacerts]
+         * @param {string[]} [policies]
+         * @returns {cms.SignedData} Loaded signature
+         *
+         * @memberOf Cerber
+         */
+        private verifySignature(cerberLockPath: string, res: IVerifyStatus, cacerts?: pki.CertificateCollection,
+                                policies?: string[]): cms.SignedData {
+            let certsD: pki.CertificateCollection = cacerts;
+            if (!certsD) {
+                certsD = new pki.CertificateCollection();
+            }
+
+            const cms = new trusted.cms.SignedData();
+            if (policies) {
+                cms.policies = policies;
+            }
+
+            cms.load(cerberLockPath + ".sig", trusted.DataFormat.PEM);
+
+            if (cms.isDetached()) {
+                cms.content = {
+                    data: cerberLockPath,
+                    type: trusted.cms.SignedDataContentType.url,
+
+                };
+            }
+
+            res.signature = cms.verify(certsD);
+
+            return cms;
+        }
+
+        /**
+         * Throw if cerber.lock is not a known manifest version
          *
          * @private
-         * @param {string} dir Directory path
-         * @param {string} [relative] Subdirectory
-         * @returns {string[]} module_name#sha1_hash
+         * @param {*} manifest Parsed cerber.lock
+         * @returns {ICerberManifest}
          *
          * @memberOf Cerber
          */
-        private rehash(dir: string, relative?: string): string[] {
-            let modules = [];
-            const filenames = fs2.readdirSync(dir);
+        private checkManifest(manifest: any): ICerberManifest {
+            if (manifest.version !== MERKLE_MANIFEST_VERSION || typeof manifest.digest !== "string" ||
+                typeof manifest.tree !== "object" || !Array.isArray(manifest.files)) {
+                throw new Error("Unsupported cerber.lock format");
+            }
+
+            return manifest;
+        }
 
-            const filteredFiles = filenames.filter(function(e) {
-                if (DEFAULT_IGNORE.indexOf(e) < 0) {
-                    return true;
+        /**
+         * Directory hashes as manifest tree
+         *
+         * @private
+         * @param {string[]} hashes DirectoryHasher.getDirectoryHashes()
+         * @param {string} prefix Path of hashed directory in package
+         * @returns {{[dir: string]: string}}
+         *
+         * @memberOf Cerber
+         */
+        private treeHashes(hashes: string[], prefix: string): {[dir: string]: string} {
+            const tree: {[dir: string]: string} = {};
+
+            for (const item of hashes) {
+                const pos = item.lastIndexOf("#");
+                let dir = item.substring(0, pos);
+                if (prefix !== MERKLE_ROOT) {
+                    dir = dir === MERKLE_ROOT ? prefix : prefix + "/" + dir;
                 }
+                tree[dir] = item.substring(pos + 1);
+            }
+
+            return tree;
+        }
 
-                return false;
+        /**
+         * Directories whose hash differs from manifest.
+         * Nothing else is compared when top directory matches
+         *
+         * @private
+         * @param {ICerberManifest} manifest
+         * @param {{[dir: string]: string}} tree Current hashes
+         * @param {string} top Hashed directory
+         * @returns {string[]}
+         *
+         * @memberOf Cerber
+         */
+        private diffTree(manifest: ICerberManifest, tree: {[dir: string]: string}, top: string): string[] {
+            if (manifest.tree[top] === tree[top]) {
+                return [];
+            }
+
+            return Object.keys(tree).filter(function(dir) {
+                return manifest.tree[dir] !== tree[dir];
             });
+        }
+
+        /**
+         * Files of changed directories which are not in manifest
+         *
+         * @private
+         * @param {ICerberManifest} manifest
+         * @param {string[]} modules Current module_name#hash
+         * @param {string[]} dirs Changed directories
+         * @returns {string[]}
+         *
+         * @memberOf Cerber
+         */
+        private diffFiles(manifest: ICerberManifest, modules: string[], dirs: string[]): string[] {
+            if (!dirs.length) {
+                return [];
+            }
 
-            for (const name of filteredFiles) {
-                const loc = path.join(dir, name);
-                const stat = fs2.statSync(loc);
-                let rel = relative ? path.join(relative, name) : name;
+            const changed: {[dir: string]: boolean} = {};
+            for (const dir of dirs) {
+                changed[dir] = true;
+            }
 
-                if (stat.isDirectory()) {
-                    modules = modules.concat(this.rehash(loc, rel));
-                } else {
-                    if (stat.isFile()) {
-                        const buffer = fs2.readFileSync(loc, "binary");
-                        const hash = crypto2.createHash("sha1").update(buffer).digest("hex");
+            const signed: {[file: string]: boolean} = {};
+            for (const file of manifest.files) {
+                signed[file] = true;
+            }
 
-                        if (OS_TYPE === "Windows_NT") {
-                            rel = rel.replace(/\\/g, "/");
-                        }
+            return modules.filter(function(x) {
+                const name = x.substring(0, x.lastIndexOf("#"));
+                const pos = name.lastIndexOf("/");
+                const dir = pos === -1 ? MERKLE_ROOT : name.substring(0, pos);
+                return changed[dir] && !signed[x];
+            });
+        }
 
-                        modules.push(rel + "#" + hash);
-                    }
+        /**
+         * Native hasher with Cerber ignore list
+         *
+         * @private
+         * @param {boolean} legacy Manifest version 1. Its hashes were taken over file content read
+         * as a "binary" string, which crypto encodes as UTF-8, so bytes from 0x80 count twice.
+         * Versioned manifests hash raw bytes
+         * @param {string} [cachePath] Stat cache file
+         * @returns {native.UTILS.DirectoryHasher}
+         *
+         * @memberOf Cerber
+         */
+        private createHasher(legacy: boolean, cachePath?: string): native.UTILS.DirectoryHasher {
+            const hasher = new native.UTILS.DirectoryHasher();
+            hasher.setLegacyEncoding(legacy);
+            hasher.setIgnore(DEFAULT_IGNORE);
+            if (cachePath) {
+                hasher.setCache(cachePath);
+            }
+            return hasher;
+        }
+
+        /**
+         * Everything the verify result depends on: tree state, lock files and options
+         *
+         * @private
+         * @param {string} cerberLockPath
+         * @param {string} stamp Tree stamp from DirectoryHasher
+         * @param {pki.CertificateCollection} [cacerts]
+         * @param {string[]} [policies]
+         * @returns {string}
+         *
+         * @memberOf Cerber
+         */
+        private verifyCacheKey(cerberLockPath: string, stamp: string, cacerts?: pki.CertificateCollection,
+                               policies?: string[]): string {
+            const files = [cerberLockPath, cerberLockPath + ".sig"].map(function(filename) {
+                try {
+                    // Nanosecond times where Node has bigint stats, older versions ignore the option
+                    const stat = fs2.statSync(filename, {bigint: true});
+                    const mtime = stat.mtimeNs !== undefined ? stat.mtimeNs : stat.mtime.getTime();
+                    const ctime = stat.ctimeNs !== undefined ? stat.ctimeNs : stat.ctime.getTime();
+                    return [stat.size, mtime, ctime, stat.ino, stat.dev].map(String);
+                } catch (e) {
+                    return null;
+                }
+            });
+
+            const thumbprints: string[] = [];
+            if (cacerts) {
+                for (let i = 0; i < cacerts.length; i++) {
+                    thumbprints.push(cacerts.items(i).thumbprint);
                 }
             }
 
-            return modules;
+            return JSON.stringify([stamp, files, policies || [], thumbprints]);
+        }
+
+        /**
+         * Cached verify result for key or undefined
+         *
+         * @private
+         * @param {string} cachePath
+         * @param {string} key
+         * @returns {IVerifyStatus}
+         *
+         * @memberOf Cerber
+         */
+        private readVerifyCache(cachePath: string, key: string): IVerifyStatus {
+            try {
+                const cached = JSON.parse(fs2.readFileSync(cachePath + VERIFY_CACHE_RESULT_SUFFIX, "utf8"));
+                if (cached.key === key && Date.now() < cached.expires) {
+                    return cached.result;
+                }
+            } catch (e) {
+                // No cache or broken file, verify again
+            }
+
+            return undefined;
+        }
+
+        /**
+         * Save verify result. It expires with the earliest certificate of signature
+         *
+         * @private
+         * @param {string} cachePath
+         * @param {string} key
+         * @param {string} cerberLockPath
+         * @param {pki.CertificateCollection} certs Certificates of signature
+         * @param {IVerifyStatus} result
+         *
+         * @memberOf Cerber
+         */
+        private writeVerifyCache(cachePath: string, key: string, cerberLockPath: string,
+                                 certs: pki.CertificateCollection, result: IVerifyStatus): void {
+            const now = Date.now();
+
+            for (const filename of [cerberLockPath, cerberLockPath + ".sig"]) {
+                const changed = fs2.existsSync(filename) ? fs2.statSync(filename).mtime.getTime() : 0;
+                if (changed > now - VERIFY_CACHE_RACY_INTERVAL) {
+                    return;
+                }
+            }
+
+            let expires = now + VERIFY_CACHE_MAX_AGE;
+            for (let i = 0; i < certs.length; i++) {
+                expires = Math.min(expires, certs.items(i).notAfter.getTime());
+            }
+
+            try {
+                fs2.writeFileSync(cachePath + VERIFY_CACHE_RESULT_SUFFIX, JSON.stringify({expires, key, result}));
+            } catch (e) {
+                // Cache only speeds up the next run
+            }
         }
     }
 }
@@ -0,0 +1,38 @@
+namespace trusted {
+    /**
+     * Status of verification result
+     *
+     * @export
+     * @enum {number}
+     */
+    export enum VerifyStatus {
+        VALID = 0,
+        INVALID = 1,
+        ERROR = 2,
+    }
+
+    /**
+     * Verification result. Rejected data is reported here instead of exception
+     *
+     * @export
+     * @interface IVerifyResult
+     */
+    export interface IVerifyResult {
+        /**
+         * INVALID if data was checked and rejected, ERROR if it could not be checked
+         */
+        status: VerifyStatus;
+
+        /**
+         * X509_V_ERR_* code for chain, OpenSSL error code for signature
+         */
+        code: number;
+
+        /**
+         * Depth of the failed certificate in chain or index of the failed signer, -1 if unknown
+         */
+        index: number;
+
+        message: string;
+    }
+}
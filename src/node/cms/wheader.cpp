@@ -0,0 +1,184 @@
+#include "../stdafx.h"
+
+#include "wheader.h"
+#include "wsigner_id.h"
+#include "../pki/woid.h"
+
+void WCmsHeader::Init(v8::Handle<v8::Object> exports){
+	v8::Local<v8::String> className = Nan::New("CmsHeader").ToLocalChecked();
+
+	// Basic instance setup
+	v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+
+	tpl->SetClassName(className);
+	tpl->InstanceTemplate()->SetInternalFieldCount(1); // req'd by ObjectWrap
+
+	Nan::SetPrototypeMethod(tpl, "load", Load);
+	Nan::SetPrototypeMethod(tpl, "import", Import);
+	Nan::SetPrototypeMethod(tpl, "getContentType", GetContentType);
+	Nan::SetPrototypeMethod(tpl, "getEncapsulatedType", GetEncapsulatedType);
+	Nan::SetPrototypeMethod(tpl, "isDetached", IsDetached);
+	Nan::SetPrototypeMethod(tpl, "getSigners", GetSigners);
+	Nan::SetPrototypeMethod(tpl, "getRecipients", GetRecipients);
+
+	// Store the constructor in the target bindings.
+	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+
+	exports->Set(className, tpl->GetFunction());
+}
+
+NAN_METHOD(WCmsHeader::New){
+	METHOD_BEGIN();
+
+	try{
+		WCmsHeader *obj = new WCmsHeader();
+		obj->data_ = new CmsHeader();
+
+		obj->Wrap(info.This());
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * filename: String
+ * format: DataFormat
+ */
+NAN_METHOD(WCmsHeader::Load){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("filename");
+		v8::String::Utf8Value v8Filename(info[0]->ToString());
+		char *filename = *v8Filename;
+
+		LOGGER_ARG("format");
+		int format = info[1]->ToNumber()->Int32Value();
+
+		UNWRAP_DATA(CmsHeader);
+
+		Handle<Bio> in = new Bio(BIO_TYPE_FILE, filename, "rb");
+
+		_this->read(in, DataFormat::get(format));
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * data: Buffer
+ * format: DataFormat
+ */
+NAN_METHOD(WCmsHeader::Import){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("data");
+		char* buf = node::Buffer::Data(info[0]->ToObject());
+		size_t buflen = node::Buffer::Length(info[0]);
+		std::string buffer(buf, buflen);
+
+		LOGGER_ARG("format");
+		int format = info[1]->ToNumber()->Int32Value();
+
+		UNWRAP_DATA(CmsHeader);
+
+		Handle<Bio> in = new Bio(BIO_TYPE_MEM, buffer);
+
+		_this->read(in, DataFormat::get(format));
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCmsHeader::GetContentType){
+	METHOD_BEGIN();
+
+	try{
+		UNWRAP_DATA(CmsHeader);
+
+		Handle<OID> oid = _this->getContentType();
+		v8::Local<v8::Object> v8Oid = WOID::NewInstance(oid);
+
+		info.GetReturnValue().Set(v8Oid);
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCmsHeader::GetEncapsulatedType){
+	METHOD_BEGIN();
+
+	try{
+		UNWRAP_DATA(CmsHeader);
+
+		Handle<OID> oid = _this->getEncapsulatedType();
+		v8::Local<v8::Object> v8Oid = WOID::NewInstance(oid);
+
+		info.GetReturnValue().Set(v8Oid);
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCmsHeader::IsDetached){
+	METHOD_BEGIN();
+
+	try{
+		UNWRAP_DATA(CmsHeader);
+
+		bool detached = _this->isDetached();
+
+		info.GetReturnValue().Set(Nan::New<v8::Boolean>(detached));
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCmsHeader::GetSigners){
+	METHOD_BEGIN();
+
+	try{
+		UNWRAP_DATA(CmsHeader);
+
+		v8::Isolate* isolate = v8::Isolate::GetCurrent();
+
+		int len = _this->getSignersLength();
+		v8::Local<v8::Array> array8 = v8::Array::New(isolate, len);
+
+		for (int i = 0; i < len; i++) {
+			array8->Set(i, WSignerId::NewInstance(_this->getSigner(i)));
+		}
+
+		info.GetReturnValue().Set(array8);
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCmsHeader::GetRecipients){
+	METHOD_BEGIN();
+
+	try{
+		UNWRAP_DATA(CmsHeader);
+
+		v8::Isolate* isolate = v8::Isolate::GetCurrent();
+
+		int len = _this->getRecipientsLength();
+		v8::Local<v8::Array> array8 = v8::Array::New(isolate, len);
+
+		for (int i = 0; i < len; i++) {
+			array8->Set(i, WSignerId::NewInstance(_this->getRecipient(i)));
+		}
+
+		info.GetReturnValue().Set(array8);
+		return;
+	}
+	TRY_END();
+}
@@ -0,0 +1,28 @@
+#ifndef CMS_WHEADER_H_INCLUDED
+#define CMS_WHEADER_H_INCLUDED
+
+#include <wrapper/cms/header.h>
+
+#include <nan.h>
+#include "../utils/wrap.h"
+#include "../helper.h"
+
+WRAP_CLASS(CmsHeader) {
+public:
+	WCmsHeader(){};
+	~WCmsHeader(){};
+
+	static void Init(v8::Handle<v8::Object>);
+	static NAN_METHOD(New);
+
+	static NAN_METHOD(Load);
+	static NAN_METHOD(Import);
+
+	static NAN_METHOD(GetContentType);
+	static NAN_METHOD(GetEncapsulatedType);
+	static NAN_METHOD(IsDetached);
+	static NAN_METHOD(GetSigners);
+	static NAN_METHOD(GetRecipients);
+};
+
+#endif //CMS_WHEADER_H_INCLUDED
@@ -0,0 +1,149 @@
+#include "../stdafx.h"
+
+#include "wrecipient_set.h"
+#include "../pki/wcert.h"
+#include "../pki/wcerts.h"
+
+void WCmsRecipientSet::Init(v8::Handle<v8::Object> exports){
+	v8::Local<v8::String> className = Nan::New("CmsRecipientSet").ToLocalChecked();
+
+	// Basic instance setup
+	v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+
+	tpl->SetClassName(className);
+	tpl->InstanceTemplate()->SetInternalFieldCount(1); // req'd by ObjectWrap
+
+	Nan::SetPrototypeMethod(tpl, "push", Push);
+	Nan::SetPrototypeMethod(tpl, "pushCerts", PushCerts);
+	Nan::SetPrototypeMethod(tpl, "length", Length);
+	Nan::SetPrototypeMethod(tpl, "setAlgorithm", SetAlgorithm);
+	Nan::SetPrototypeMethod(tpl, "encrypt", Encrypt);
+
+	// Store the constructor in the target bindings.
+	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+
+	exports->Set(className, tpl->GetFunction());
+}
+
+NAN_METHOD(WCmsRecipientSet::New){
+	METHOD_BEGIN();
+
+	try{
+		WCmsRecipientSet *obj = new WCmsRecipientSet();
+		obj->data_ = new CmsRecipientSet();
+
+		obj->Wrap(info.This());
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * cert: Certificate
+ */
+NAN_METHOD(WCmsRecipientSet::Push){
+	METHOD_BEGIN();
+
+	try{
+		UNWRAP_DATA(CmsRecipientSet);
+
+		LOGGER_ARG("cert");
+		WCertificate *wCert = WCertificate::Unwrap<WCertificate>(info[0]->ToObject());
+
+		_this->push(wCert->data_);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * certs: CertificateCollection
+ */
+NAN_METHOD(WCmsRecipientSet::PushCerts){
+	METHOD_BEGIN();
+
+	try{
+		UNWRAP_DATA(CmsRecipientSet);
+
+		LOGGER_ARG("certs");
+		WCertificateCollection *wCerts = WCertificateCollection::Unwrap<WCertificateCollection>(info[0]->ToObject());
+
+		_this->push(wCerts->data_);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCmsRecipientSet::Length){
+	METHOD_BEGIN();
+
+	try{
+		UNWRAP_DATA(CmsRecipientSet);
+
+		int len = _this->length();
+
+		info.GetReturnValue().Set(Nan::New<v8::Number>(len));
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * name: string
+ */
+NAN_METHOD(WCmsRecipientSet::SetAlgorithm){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("name");
+		v8::String::Utf8Value v8Name(info[0]->ToString());
+		char *name = *v8Name;
+
+		UNWRAP_DATA(CmsRecipientSet);
+
+		_this->setAlgorithm(new std::string(name));
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * filenameSource: string
+ * filenameEnc: string
+ * format: DataFormat
+ */
+NAN_METHOD(WCmsRecipientSet::Encrypt){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("filenameSource");
+		v8::String::Utf8Value v8FilenameSource(info[0]->ToString());
+		char *filenameSource = *v8FilenameSource;
+
+		LOGGER_ARG("filenameEnc");
+		v8::String::Utf8Value v8FilenameEnc(info[1]->ToString());
+		char *filenameEnc = *v8FilenameEnc;
+
+		LOGGER_ARG("format");
+		int format = info[2]->ToNumber()->Int32Value();
+
+		Handle<Bio> inSource = new Bio(BIO_TYPE_FILE, filenameSource, "rb");
+		Handle<Bio> outEnc = new Bio(BIO_TYPE_FILE, filenameEnc, "wb");
+
+		UNWRAP_DATA(CmsRecipientSet);
+
+		_this->encrypt(inSource, outEnc, DataFormat::get(format));
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
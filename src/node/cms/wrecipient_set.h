@@ -0,0 +1,25 @@
+#ifndef CMS_WRECIPIENT_SET_H_INCLUDED
+#define CMS_WRECIPIENT_SET_H_INCLUDED
+
+#include <wrapper/cms/recipient_set.h>
+
+#include <nan.h>
+#include "../utils/wrap.h"
+#include "../helper.h"
+
+WRAP_CLASS(CmsRecipientSet) {
+public:
+	WCmsRecipientSet(){};
+	~WCmsRecipientSet(){};
+
+	static void Init(v8::Handle<v8::Object>);
+	static NAN_METHOD(New);
+
+	static NAN_METHOD(Push);
+	static NAN_METHOD(PushCerts);
+	static NAN_METHOD(Length);
+	static NAN_METHOD(SetAlgorithm);
+	static NAN_METHOD(Encrypt);
+};
+
+#endif //CMS_WRECIPIENT_SET_H_INCLUDED
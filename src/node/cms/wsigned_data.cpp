@@ -35,6 +35,7 @@ void WSignedData::Init(v8::Handle<v8::Object> exports){
 	Nan::SetPrototypeMethod(tpl, "createSigner", CreateSigner);
 	Nan::SetPrototypeMethod(tpl, "addCertificate", AddCertificate);
 	Nan::SetPrototypeMethod(tpl, "verify", Verify);
+	Nan::SetPrototypeMethod(tpl, "verifyResult", VerifyResult);
 	Nan::SetPrototypeMethod(tpl, "sign", Sign);
 
 	// Store the constructor in the target bindings.
@@ -333,6 +334,29 @@ NAN_METHOD(WSignedData::Verify) {
 	TRY_END();
 }
 
+/*
+ * certs: CertificateCollection
+ * Returns { status, code, index, message }, doesn't throw on rejected signature
+ */
+NAN_METHOD(WSignedData::VerifyResult) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(SignedData);
+
+		WCertificateCollection *wcerts = WCertificateCollection::Unwrap<WCertificateCollection>(info[0]->ToObject());
+
+		::VerifyResult res = _this->verifyResult(wcerts->data_);
+		if (!_this->getContent().isEmpty()) {
+			_this->getContent()->reset();
+		}
+
+		info.GetReturnValue().Set(verifyResultToObject(res));
+		return;
+	}
+	TRY_END();
+}
+
 NAN_METHOD(WSignedData::Sign) {
 	METHOD_BEGIN();
 
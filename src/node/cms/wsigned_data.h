@@ -37,6 +37,7 @@ public:
 	static NAN_METHOD(AddCertificate);
 	static NAN_METHOD(IsDetached);
 	static NAN_METHOD(Verify);
+	static NAN_METHOD(VerifyResult);
 	static NAN_METHOD(Sign);
 };
 
@@ -95,3 +95,17 @@ Handle<std::string> getErrorText(Handle<Exception> e)
 
 	return t;
 }
+
+v8::Local<v8::Object> verifyResultToObject(const VerifyResult &res)
+{
+	LOGGER_FN();
+
+	v8::Local<v8::Object> v8Result = Nan::New<v8::Object>();
+
+	v8Result->Set(Nan::New("status").ToLocalChecked(), Nan::New<v8::Integer>((int)res.status));
+	v8Result->Set(Nan::New("code").ToLocalChecked(), Nan::New<v8::Number>((double)res.code));
+	v8Result->Set(Nan::New("index").ToLocalChecked(), Nan::New<v8::Integer>(res.index));
+	v8Result->Set(Nan::New("message").ToLocalChecked(), Nan::New(res.message).ToLocalChecked());
+
+	return v8Result;
+}
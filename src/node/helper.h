@@ -4,6 +4,7 @@
 #include <nan.h>
 
 #include <wrapper/common/common.h>	
+#include <wrapper/pki/pki.h>
 
 #define LOGGER_ARG(name) LOGGER_INFO("Param: %s", name)
 
@@ -28,6 +29,11 @@ Handle<std::string> getBuffer(v8::Local<v8::Value> v8Value);
 
 Handle<std::string> getErrorText(Handle<Exception> e);
 
+/**
+* Convert VerifyResult to { status, code, index, message }
+*/
+v8::Local<v8::Object> verifyResultToObject(const VerifyResult &res);
+
 #define METHOD_BEGIN() \
 	LOGGER_FN();
 
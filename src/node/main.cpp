@@ -10,6 +10,7 @@
 
 #include "utils/wlog.h"
 #include "utils/wjwt.h"
+#include "utils/wdir_hasher.h"
 
 #include "pki/wkey.h"
 #include "pki/wcert.h"
@@ -45,6 +46,8 @@
 #include "cms/wsigner_attrs.h"
 #include "cms/wcmsRecipientInfo.h"
 #include "cms/wcmsRecipientInfos.h"
+#include "cms/wrecipient_set.h"
+#include "cms/wheader.h"
 
 #include <node_object_wrap.h>
 
@@ -72,6 +75,7 @@ void init(v8::Handle<v8::Object> target) {
 
 	target->Set(Nan::New("UTILS").ToLocalChecked(), Utils);
 	WJwt::Init(Utils);
+	WDirectoryHasher::Init(Utils);
 	WLogger::Init(Utils);
 
 	v8::Local<v8::Object> Pki = Nan::New<v8::Object>();
@@ -105,6 +109,8 @@ void init(v8::Handle<v8::Object> target) {
 	WSignerAttributeCollection::Init(Cms);
 	WCmsRecipientInfo::Init(Cms);
 	WCmsRecipientInfoCollection::Init(Cms);
+	WCmsRecipientSet::Init(Cms);
+	WCmsHeader::Init(Cms);
 
 	v8::Local<v8::Object> PkiStore = Nan::New<v8::Object>();
 	target->Set(Nan::New("PKISTORE").ToLocalChecked(), PkiStore);
@@ -46,6 +46,7 @@ public:
 	static NAN_METHOD(Equals);
 	static NAN_METHOD(Duplicate);
 	static NAN_METHOD(Hash);
+	static NAN_METHOD(Hashes);
 };
 
 #endif //PKI_WCERT_H_INCLUDED
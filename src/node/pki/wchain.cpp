@@ -22,6 +22,7 @@ void WChain::Init(v8::Handle<v8::Object> exports){
 
 	Nan::SetPrototypeMethod(tpl, "buildChain", BuildChain);
 	Nan::SetPrototypeMethod(tpl, "verifyChain", VerifyChain);
+	Nan::SetPrototypeMethod(tpl, "verifyChainResult", VerifyChainResult);
 
 	// Store the constructor in the target bindings.
 	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
@@ -84,3 +85,26 @@ NAN_METHOD(WChain::VerifyChain) {
 	}
 	TRY_END();
 }
+
+/*
+ * Returns { status, code, index, message }, index is depth of the failed certificate
+ */
+NAN_METHOD(WChain::VerifyChainResult) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("chain");
+		WCertificateCollection * wChain = WCertificateCollection::Unwrap<WCertificateCollection>(info[0]->ToObject());
+
+		LOGGER_ARG("crls");
+		WCrlCollection * wCrls = WCrlCollection::Unwrap<WCrlCollection>(info[1]->ToObject());
+
+		UNWRAP_DATA(Chain);
+
+		VerifyResult res = _this->verifyChainResult(wChain->data_, wCrls->data_);
+
+		info.GetReturnValue().Set(verifyResultToObject(res));
+		return;
+	}
+	TRY_END();
+}
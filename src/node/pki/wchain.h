@@ -17,6 +17,7 @@ public:
 
 	static NAN_METHOD(BuildChain);
 	static NAN_METHOD(VerifyChain);
+	static NAN_METHOD(VerifyChainResult);
 };
 
 #endif //PKI_WCHAIN_H_INCLUDED
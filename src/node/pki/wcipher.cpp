@@ -7,6 +7,7 @@
 #include "wcert.h"
 #include "wkey.h"
 #include "../cms/wcmsRecipientInfos.h"
+#include "../store/wpkistore.h"
 
 void WCipher::Init(v8::Handle<v8::Object> exports){
 	METHOD_BEGIN();
@@ -28,21 +29,32 @@ void WCipher::Init(v8::Handle<v8::Object> exports){
 	Nan::SetPrototypeMethod(tpl, "setPrivKey", SetPrivKey);
 	Nan::SetPrototypeMethod(tpl, "setRecipientCert", SetRecipientCert);
 	Nan::SetPrototypeMethod(tpl, "getRecipientInfos", GetRecipientInfos);
+	Nan::SetPrototypeMethod(tpl, "setRecipientStore", SetRecipientStore);
 
 	Nan::SetPrototypeMethod(tpl, "setDigest", SetDigest);
 	Nan::SetPrototypeMethod(tpl, "setSalt", SetSalt);
 	Nan::SetPrototypeMethod(tpl, "setPass", SetPass);
 	Nan::SetPrototypeMethod(tpl, "setIV", SetIV);
 	Nan::SetPrototypeMethod(tpl, "setKey", SetKey);
+	Nan::SetPrototypeMethod(tpl, "setKdf", SetKdf);
+	Nan::SetPrototypeMethod(tpl, "setKdfLimits", SetKdfLimits);
+	Nan::SetPrototypeMethod(tpl, "setKdfCacheSize", SetKdfCacheSize);
 
 	Nan::SetPrototypeMethod(tpl, "getSalt", GetSalt);
 	Nan::SetPrototypeMethod(tpl, "getIV", GetIV);
 	Nan::SetPrototypeMethod(tpl, "getKey", GetKey);
 
+	Nan::SetPrototypeMethod(tpl, "setAlgorithm", SetAlgorithm);
 	Nan::SetPrototypeMethod(tpl, "getAlgorithm", GetAlgorithm);
 	Nan::SetPrototypeMethod(tpl, "getMode", GetMode);
 	Nan::SetPrototypeMethod(tpl, "getDigestAlgorithm", GetDigestAlgorithm);
 
+	Nan::SetPrototypeMethod(tpl, "setThreads", SetThreads);
+	Nan::SetPrototypeMethod(tpl, "setChunkSize", SetChunkSize);
+	Nan::SetPrototypeMethod(tpl, "encryptChunked", EncryptChunked);
+	Nan::SetPrototypeMethod(tpl, "decryptChunked", DecryptChunked);
+	Nan::SetPrototypeMethod(tpl, "decryptChunkedRange", DecryptChunkedRange);
+
 	// Store the constructor in the target bindings.
 	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
 
@@ -177,6 +189,23 @@ NAN_METHOD(WCipher::SetRecipientCert) {
 	TRY_END();
 }
 
+NAN_METHOD(WCipher::SetRecipientStore) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("store");
+		WPkiStore * wStore = WPkiStore::Unwrap<WPkiStore>(info[0]->ToObject());
+
+		UNWRAP_DATA(Cipher);
+
+		_this->setRecipientStore(wStore->data_);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
 NAN_METHOD(WCipher::GetRecipientInfos) {
 	METHOD_BEGIN();
 
@@ -291,6 +320,104 @@ NAN_METHOD(WCipher::SetKey) {
 	TRY_END();
 }
 
+/*
+ * method: KdfMethod
+ * cost: Number
+ * r: Number
+ * p: Number
+ */
+NAN_METHOD(WCipher::SetKdf) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("method");
+		int method = info[0]->ToNumber()->Int32Value();
+
+		LOGGER_ARG("cost");
+		double cost = info[1]->ToNumber()->Value();
+
+		LOGGER_ARG("r");
+		double r = info[2]->ToNumber()->Value();
+
+		LOGGER_ARG("p");
+		double p = info[3]->ToNumber()->Value();
+
+		if (!(cost >= 0 && cost <= 4294967295.0 && r >= 0 && r <= 4294967295.0 && p >= 0 && p <= 4294967295.0)) {
+			Nan::ThrowError("Invalid key derivation parameters");
+			return;
+		}
+
+		UNWRAP_DATA(Cipher);
+
+		_this->setKdf(KdfMethod::get(method), (unsigned long)cost, (unsigned long)r, (unsigned long)p);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * maxIterations: Number
+ * maxN: Number
+ * maxR: Number
+ * maxP: Number
+ * maxMemory: Number
+ */
+NAN_METHOD(WCipher::SetKdfLimits) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("maxIterations");
+		double maxIterations = info[0]->ToNumber()->Value();
+
+		LOGGER_ARG("maxN");
+		double maxN = info[1]->ToNumber()->Value();
+
+		LOGGER_ARG("maxR");
+		double maxR = info[2]->ToNumber()->Value();
+
+		LOGGER_ARG("maxP");
+		double maxP = info[3]->ToNumber()->Value();
+
+		LOGGER_ARG("maxMemory");
+		double maxMemory = info[4]->ToNumber()->Value();
+
+		if (!(maxIterations >= 0 && maxIterations <= 4294967295.0 && maxN >= 0 && maxN <= 4294967295.0
+			&& maxR >= 0 && maxR <= 4294967295.0 && maxP >= 0 && maxP <= 4294967295.0 && maxMemory >= 0)) {
+			Nan::ThrowError("Invalid key derivation limits");
+			return;
+		}
+
+		UNWRAP_DATA(Cipher);
+
+		_this->setKdfLimits((unsigned long)maxIterations, (unsigned long)maxN, (unsigned long)maxR, (unsigned long)maxP, (uint64_t)maxMemory);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * size: Number
+ * Process-wide, not only for this object
+ */
+NAN_METHOD(WCipher::SetKdfCacheSize) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("size");
+		int size = info[0]->ToNumber()->Int32Value();
+
+		Cipher::setKdfCacheSize(size > 0 ? (size_t)size : 0);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
 NAN_METHOD(WCipher::SetSalt) {
 	METHOD_BEGIN();
 
@@ -351,6 +478,24 @@ NAN_METHOD(WCipher::GetKey) {
 	TRY_END();
 }
 
+NAN_METHOD(WCipher::SetAlgorithm) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("name");
+		v8::String::Utf8Value v8Name(info[0]->ToString());
+		char *name = *v8Name;
+
+		UNWRAP_DATA(Cipher);
+
+		_this->setAlgorithm(new std::string(name));
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
 NAN_METHOD(WCipher::GetAlgorithm) {
 	METHOD_BEGIN();
 
@@ -394,4 +539,135 @@ NAN_METHOD(WCipher::GetDigestAlgorithm) {
 		return;
 	}
 	TRY_END();
-}
\ No newline at end of file
+}
+
+NAN_METHOD(WCipher::SetThreads) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("count");
+		int count = info[0]->ToNumber()->Int32Value();
+
+		UNWRAP_DATA(Cipher);
+
+		_this->setThreads(count);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCipher::SetChunkSize) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("size");
+		double size = info[0]->ToNumber()->Value();
+
+		UNWRAP_DATA(Cipher);
+
+		_this->setChunkSize((size_t)size);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCipher::EncryptChunked) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("filenameSource");
+		v8::String::Utf8Value v8FilenameSource(info[0]->ToString());
+		char *filenameSource = *v8FilenameSource;
+
+		LOGGER_ARG("filenameEnc");
+		v8::String::Utf8Value v8FilenameEnc(info[1]->ToString());
+		char *filenameEnc = *v8FilenameEnc;
+
+		Handle<Bio> inSource = new Bio(BIO_TYPE_FILE, filenameSource, "rb");
+		Handle<Bio> outEnc = new Bio(BIO_TYPE_FILE, filenameEnc, "wb");
+
+		UNWRAP_DATA(Cipher);
+
+		_this->encryptChunked(inSource, outEnc);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WCipher::DecryptChunked) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("filenameEnc");
+		v8::String::Utf8Value v8FilenameEnc(info[0]->ToString());
+		char *filenameEnc = *v8FilenameEnc;
+
+		LOGGER_ARG("filenameDec");
+		v8::String::Utf8Value v8FilenameDec(info[1]->ToString());
+		char *filenameDec = *v8FilenameDec;
+
+		Handle<Bio> inEnc = new Bio(BIO_TYPE_FILE, filenameEnc, "rb");
+		Handle<Bio> outDec = new Bio(BIO_TYPE_FILE, filenameDec, "wb");
+
+		UNWRAP_DATA(Cipher);
+
+		_this->decryptChunked(inEnc, outDec);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * filenameEnc: String
+ * filenameDec: String
+ * offset: Number
+ * length: Number
+ */
+NAN_METHOD(WCipher::DecryptChunkedRange) {
+	METHOD_BEGIN();
+
+	try {
+		LOGGER_ARG("filenameEnc");
+		v8::String::Utf8Value v8FilenameEnc(info[0]->ToString());
+		char *filenameEnc = *v8FilenameEnc;
+
+		LOGGER_ARG("filenameDec");
+		v8::String::Utf8Value v8FilenameDec(info[1]->ToString());
+		char *filenameDec = *v8FilenameDec;
+
+		LOGGER_ARG("offset");
+		double offset = info[2]->ToNumber()->Value();
+
+		LOGGER_ARG("length");
+		double length = info[3]->ToNumber()->Value();
+
+		if (!(offset >= 0 && length >= 0)) {
+			Nan::ThrowError("Offset and length must not be negative");
+			return;
+		}
+
+		/*Infinity - up to the end*/
+		if (length > 9007199254740992.0) {
+			length = 9007199254740992.0;
+		}
+
+		Handle<Bio> inEnc = new Bio(BIO_TYPE_FILE, filenameEnc, "rb");
+		Handle<Bio> outDec = new Bio(BIO_TYPE_FILE, filenameDec, "wb");
+
+		UNWRAP_DATA(Cipher);
+
+		_this->decryptChunkedRange(inEnc, outDec, (uint64_t)offset, (uint64_t)length);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
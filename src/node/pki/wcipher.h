@@ -23,21 +23,32 @@ public:
 	static NAN_METHOD(SetPrivKey);
 	static NAN_METHOD(SetRecipientCert);
 	static NAN_METHOD(GetRecipientInfos);
+	static NAN_METHOD(SetRecipientStore);
 
 	static NAN_METHOD(SetDigest);
 	static NAN_METHOD(SetSalt);
 	static NAN_METHOD(SetPass);
 	static NAN_METHOD(SetIV);
 	static NAN_METHOD(SetKey);
+	static NAN_METHOD(SetKdf);
+	static NAN_METHOD(SetKdfLimits);
+	static NAN_METHOD(SetKdfCacheSize);
 
 	static NAN_METHOD(GetSalt);
 	static NAN_METHOD(GetIV);
 	static NAN_METHOD(GetKey);
 
+	static NAN_METHOD(SetAlgorithm);
 	static NAN_METHOD(GetAlgorithm);
 	static NAN_METHOD(GetMode);
 	static NAN_METHOD(GetDigestAlgorithm);
 
+	static NAN_METHOD(SetThreads);
+	static NAN_METHOD(SetChunkSize);
+	static NAN_METHOD(EncryptChunked);
+	static NAN_METHOD(DecryptChunked);
+	static NAN_METHOD(DecryptChunkedRange);
+
 	Handle<Cipher> data_;
 
 	static inline Nan::Persistent<v8::Function> & constructor() {
@@ -20,6 +20,7 @@ void WCRL::Init(v8::Handle<v8::Object> exports){
 	Nan::SetPrototypeMethod(tpl, "compare", Compare);
 	Nan::SetPrototypeMethod(tpl, "duplicate", Duplicate);
 	Nan::SetPrototypeMethod(tpl, "hash", Hash);
+	Nan::SetPrototypeMethod(tpl, "hashes", Hashes);
 
 	Nan::SetPrototypeMethod(tpl, "getEncoded", GetEncoded);
 	Nan::SetPrototypeMethod(tpl, "getSignature", GetSignature);
@@ -379,6 +380,41 @@ NAN_METHOD(WCRL::Hash)
 	TRY_END();
 }
 
+/*
+ * algorithms: String[]
+ */
+NAN_METHOD(WCRL::Hashes)
+{
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(CRL);
+
+		LOGGER_ARG("algorithms")
+		v8::Local<v8::Array> v8Algs = v8::Local<v8::Array>::Cast(info[0]);
+
+		std::vector<Handle<std::string> > algs;
+		for (uint32_t i = 0; i < v8Algs->Length(); i++) {
+			v8::String::Utf8Value v8Alg(v8Algs->Get(i)->ToString());
+			algs.push_back(new std::string(*v8Alg));
+		}
+
+		std::vector<Handle<std::string> > res = _this->hashes(algs);
+
+		v8::Isolate* isolate = v8::Isolate::GetCurrent();
+
+		v8::Local<v8::Array> array8 = v8::Array::New(isolate, res.size());
+
+		for (size_t i = 0; i < res.size(); i++) {
+			array8->Set(i, stringToBuffer(res[i]));
+		}
+
+		info.GetReturnValue().Set(array8);
+		return;
+	}
+	TRY_END();
+}
+
 NAN_METHOD(WCRL::GetEncoded) {
 	METHOD_BEGIN();
 
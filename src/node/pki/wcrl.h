@@ -23,6 +23,7 @@ public:
 	static NAN_METHOD(Compare);
 	static NAN_METHOD(Duplicate);
 	static NAN_METHOD(Hash);
+	static NAN_METHOD(Hashes);
 
 	static NAN_METHOD(GetEncoded);
 	static NAN_METHOD(GetSignature);
@@ -19,6 +19,7 @@ void WCrlCollection::Init(v8::Handle<v8::Object> exports){
 	Nan::SetPrototypeMethod(tpl, "pop", Pop);
 	Nan::SetPrototypeMethod(tpl, "removeAt", RemoveAt);
 	Nan::SetPrototypeMethod(tpl, "length", Length);
+	Nan::SetPrototypeMethod(tpl, "load", Load);
 
 	// Store the constructor in the target bindings.
 	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
@@ -115,3 +116,25 @@ NAN_METHOD(WCrlCollection::Push){
 	}
 	TRY_END();
 }
+
+/*
+ * filename: String
+ * Replaces collection by CRLs from PEM or DER bundle
+ */
+NAN_METHOD(WCrlCollection::Load){
+	METHOD_BEGIN();
+
+	try{
+		LOGGER_ARG("filename");
+		v8::String::Utf8Value v8Filename(info[0]->ToString());
+		char *filename = *v8Filename;
+
+		UNWRAP_DATA(CrlCollection);
+
+		__obj->data_ = Bundle::loadCrls(new std::string(filename));
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
\ No newline at end of file
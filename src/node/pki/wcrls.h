@@ -2,6 +2,7 @@
 #define  PKI_WCRLS_H_INCLUDED
 
 #include <wrapper/pki/crls.h>
+#include <wrapper/pki/bundle.h>
 
 #include <nan.h>
 #include "../utils/wrap.h"
@@ -25,6 +26,7 @@ public:
 	static NAN_METHOD(Pop);
 	static NAN_METHOD(RemoveAt);
 	static NAN_METHOD(Length);
+	static NAN_METHOD(Load);
 };
 
 #endif //PKI_WCRLS_H_INCLUDED
\ No newline at end of file
@@ -20,6 +20,7 @@ void WPkcs12::Init(v8::Handle<v8::Object> exports) {
 	Nan::SetPrototypeMethod(tpl, "getKey", GetKey);
 	Nan::SetPrototypeMethod(tpl, "getCACertificates", GetCACertificates);
 
+	Nan::SetPrototypeMethod(tpl, "open", Open);
 	Nan::SetPrototypeMethod(tpl, "load", Load);
 	Nan::SetPrototypeMethod(tpl, "save", Save);
 	Nan::SetPrototypeMethod(tpl, "create", Create);
@@ -45,6 +46,37 @@ NAN_METHOD(WPkcs12::New) {
 	TRY_END();
 }
 
+/*
+ * password: String
+ * Returns { certificate, key, ca }, certificate and key are undefined if absent
+ */
+NAN_METHOD(WPkcs12::Open) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(Pkcs12);
+
+		LOGGER_ARG("password");
+		v8::String::Utf8Value v8Pass(info[0]->ToString());
+		char *password = *v8Pass;
+
+		Handle<Pkcs12Content> content = _this->open(password);
+
+		v8::Local<v8::Object> v8Content = Nan::New<v8::Object>();
+		if (!content->certificate.isEmpty()) {
+			v8Content->Set(Nan::New("certificate").ToLocalChecked(), WCertificate::NewInstance(content->certificate));
+		}
+		if (!content->key.isEmpty()) {
+			v8Content->Set(Nan::New("key").ToLocalChecked(), WKey::NewInstance(content->key));
+		}
+		v8Content->Set(Nan::New("ca").ToLocalChecked(), WCertificateCollection::NewInstance(content->ca));
+
+		info.GetReturnValue().Set(v8Content);
+		return;
+	}
+	TRY_END();
+}
+
 /*
  * filename: String
  */
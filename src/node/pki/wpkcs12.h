@@ -21,6 +21,7 @@ public:
 	static NAN_METHOD(GetCACertificates);
 
 	//Methods
+	static NAN_METHOD(Open);
 	static NAN_METHOD(Load);
 	static NAN_METHOD(Save);
 	static NAN_METHOD(Create);
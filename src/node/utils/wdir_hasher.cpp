@@ -0,0 +1,229 @@
+#include "../stdafx.h"
+
+#include "wdir_hasher.h"
+
+void WDirectoryHasher::Init(v8::Handle<v8::Object> exports) {
+	METHOD_BEGIN();
+
+	v8::Local<v8::String> className = Nan::New("DirectoryHasher").ToLocalChecked();
+
+	// Basic instance setup
+	v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+
+	tpl->SetClassName(className);
+	tpl->InstanceTemplate()->SetInternalFieldCount(1); // req'd by ObjectWrap
+
+	Nan::SetPrototypeMethod(tpl, "setDigest", SetDigest);
+	Nan::SetPrototypeMethod(tpl, "setLegacyEncoding", SetLegacyEncoding);
+	Nan::SetPrototypeMethod(tpl, "setIgnore", SetIgnore);
+	Nan::SetPrototypeMethod(tpl, "setThreads", SetThreads);
+	Nan::SetPrototypeMethod(tpl, "setCache", SetCache);
+	Nan::SetPrototypeMethod(tpl, "hash", Hash);
+	Nan::SetPrototypeMethod(tpl, "getStamp", GetStamp);
+	Nan::SetPrototypeMethod(tpl, "getHashedCount", GetHashedCount);
+	Nan::SetPrototypeMethod(tpl, "getDirectoryHashes", GetDirectoryHashes);
+
+	// Store the constructor in the target bindings.
+	constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+
+	exports->Set(className, tpl->GetFunction());
+}
+
+NAN_METHOD(WDirectoryHasher::New) {
+	METHOD_BEGIN();
+
+	try {
+		WDirectoryHasher *obj = new WDirectoryHasher();
+		obj->data_ = new DirectoryHasher();
+
+		obj->Wrap(info.This());
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * name: String
+ */
+NAN_METHOD(WDirectoryHasher::SetDigest) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(DirectoryHasher);
+
+		LOGGER_ARG("name");
+		v8::String::Utf8Value v8Name(info[0]->ToString());
+
+		_this->setDigest(*v8Name);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * enable: Boolean
+ */
+NAN_METHOD(WDirectoryHasher::SetLegacyEncoding) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(DirectoryHasher);
+
+		LOGGER_ARG("enable");
+		v8::Local<v8::Boolean> v8Enable = info[0]->ToBoolean();
+
+		_this->setLegacyEncoding(v8Enable->BooleanValue());
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * names: String[]
+ */
+NAN_METHOD(WDirectoryHasher::SetIgnore) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(DirectoryHasher);
+
+		LOGGER_ARG("names");
+		v8::Local<v8::Array> v8Names = v8::Local<v8::Array>::Cast(info[0]);
+
+		std::vector<std::string> names;
+		for (uint32_t i = 0; i < v8Names->Length(); i++) {
+			v8::String::Utf8Value v8Name(v8Names->Get(i)->ToString());
+			names.push_back(*v8Name);
+		}
+
+		_this->setIgnore(names);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * count: Number
+ */
+NAN_METHOD(WDirectoryHasher::SetThreads) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(DirectoryHasher);
+
+		LOGGER_ARG("count");
+		int count = info[0]->ToNumber()->Int32Value();
+
+		_this->setThreads(count);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * filename: String
+ */
+NAN_METHOD(WDirectoryHasher::SetCache) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(DirectoryHasher);
+
+		LOGGER_ARG("filename");
+		v8::String::Utf8Value v8Filename(info[0]->ToString());
+
+		_this->setCache(*v8Filename);
+
+		info.GetReturnValue().Set(info.This());
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * dir: String
+ * Returns String[] of "relative/path#hash"
+ */
+NAN_METHOD(WDirectoryHasher::Hash) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(DirectoryHasher);
+
+		LOGGER_ARG("dir");
+		v8::String::Utf8Value v8Dir(info[0]->ToString());
+
+		std::vector<std::string> res = _this->hash(*v8Dir);
+
+		v8::Isolate* isolate = v8::Isolate::GetCurrent();
+
+		v8::Local<v8::Array> array8 = v8::Array::New(isolate, res.size());
+
+		for (size_t i = 0; i < res.size(); i++) {
+			array8->Set(i, Nan::New(res[i]).ToLocalChecked());
+		}
+
+		info.GetReturnValue().Set(array8);
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WDirectoryHasher::GetStamp) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(DirectoryHasher);
+
+		info.GetReturnValue().Set(Nan::New(_this->getStamp()).ToLocalChecked());
+		return;
+	}
+	TRY_END();
+}
+
+NAN_METHOD(WDirectoryHasher::GetHashedCount) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(DirectoryHasher);
+
+		info.GetReturnValue().Set(Nan::New<v8::Number>((double)_this->getHashedCount()));
+		return;
+	}
+	TRY_END();
+}
+
+/*
+ * Returns String[] of "relative/dir#hash", "." is the hashed directory
+ */
+NAN_METHOD(WDirectoryHasher::GetDirectoryHashes) {
+	METHOD_BEGIN();
+
+	try {
+		UNWRAP_DATA(DirectoryHasher);
+
+		std::vector<std::string> res = _this->getDirectoryHashes();
+
+		v8::Isolate* isolate = v8::Isolate::GetCurrent();
+
+		v8::Local<v8::Array> array8 = v8::Array::New(isolate, res.size());
+
+		for (size_t i = 0; i < res.size(); i++) {
+			array8->Set(i, Nan::New(res[i]).ToLocalChecked());
+		}
+
+		info.GetReturnValue().Set(array8);
+		return;
+	}
+	TRY_END();
+}
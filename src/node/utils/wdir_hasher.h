@@ -0,0 +1,29 @@
+#ifndef UTIL_WDIR_HASHER_INCLUDED
+#define UTIL_WDIR_HASHER_INCLUDED
+
+#include <nan.h>
+#include "wrap.h"
+#include "../helper.h"
+
+#include <wrapper/utils/dir_hasher.h>
+
+WRAP_CLASS(DirectoryHasher){
+public:
+	WDirectoryHasher(){};
+	~WDirectoryHasher(){};
+
+	static void Init(v8::Handle<v8::Object>);
+	static NAN_METHOD(New);
+
+	static NAN_METHOD(SetDigest);
+	static NAN_METHOD(SetLegacyEncoding);
+	static NAN_METHOD(SetIgnore);
+	static NAN_METHOD(SetThreads);
+	static NAN_METHOD(SetCache);
+	static NAN_METHOD(Hash);
+	static NAN_METHOD(GetStamp);
+	static NAN_METHOD(GetHashedCount);
+	static NAN_METHOD(GetDirectoryHashes);
+};
+
+#endif //!UTIL_WDIR_HASHER_INCLUDED
@@ -3,6 +3,8 @@
 var assert = require("assert");
 var trusted = require("../index.js");
 var fs = require("fs");
+var os = require("os");
+var path = require("path");
 
 var DEFAULT_RESOURCES_PATH = "test/resources";
 var CERBER_PACKAGE_PATH = DEFAULT_RESOURCES_PATH + "/cerber";
@@ -63,6 +65,144 @@ describe("Cerber", function() {
         assert.equal(typeof (res.difModules), "object", "Bad difmodules value");
     });
 
+    it("verify with cache", function() {
+        var res, cached;
+        var cachePath = path.join(os.tmpdir(), "trusted_cerber_test.cache");
+
+        [cachePath, cachePath + ".result"].forEach(function(filename) {
+            if (fs.existsSync(filename)) {
+                fs.unlinkSync(filename);
+            }
+        });
+
+        res = cerber.verify(CERBER_PACKAGE_PATH, null, ["noSignerCertificateVerify"], cachePath);
+        assert.equal(res.signature, true, "verify package with cache");
+        assert.equal(res.difModules.length, 0, "Bad difmodules value");
+
+        cached = trusted.utils.Cerber.verify(CERBER_PACKAGE_PATH, null, ["noSignerCertificateVerify"], cachePath);
+        assert.equal(JSON.stringify(cached), JSON.stringify(res), "cached verify result");
+
+        res = cerber.verify(CERBER_PACKAGE_PATH, null, null, cachePath);
+        assert.equal(res.signature, false, "cache depends on policies");
+    });
+
+    it("verify with cache notices restored mtime", function() {
+        var cert, key, res, stat;
+        var pkg = path.join(os.tmpdir(), "trusted_cerber_ctime");
+        var cachePath = path.join(os.tmpdir(), "trusted_cerber_ctime.cache");
+        var file = path.join(pkg, "index.js");
+        var old = new Date(Date.now() - 60 * 60 * 1000);
+
+        [cachePath, cachePath + ".result"].forEach(function(filename) {
+            if (fs.existsSync(filename)) {
+                fs.unlinkSync(filename);
+            }
+        });
+        if (!fs.existsSync(pkg)) {
+            fs.mkdirSync(pkg);
+        }
+        fs.writeFileSync(file, "module.exports = 1;\n");
+        fs.utimesSync(file, old, old);
+
+        cert = trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/cert1.crt", trusted.DataFormat.PEM);
+        key = trusted.pki.Key.readPrivateKey(DEFAULT_RESOURCES_PATH + "/cert1.key", trusted.DataFormat.PEM, "");
+        cerber.sign(pkg, cert, key);
+
+        res = cerber.verify(pkg, null, ["noSignerCertificateVerify"], cachePath);
+        assert.equal(res.difModules.length, 0, "signed package is not changed");
+
+        // Same size, mtime set back: only ctime changes
+        stat = fs.statSync(file);
+        fs.writeFileSync(file, "module.exports = 2;\n");
+        fs.utimesSync(file, stat.atime, stat.mtime);
+        assert.equal(fs.statSync(file).mtime.getTime(), stat.mtime.getTime(), "mtime restored");
+
+        res = cerber.verify(pkg, null, ["noSignerCertificateVerify"], cachePath);
+        assert.equal(res.difModules.length, 1, "changed file with restored mtime");
+        assert.equal(res.difModules[0].indexOf("index.js#"), 0, "changed file name");
+    });
+
+    it("sign and verify with directory hashes", function() {
+        var cert, key, lock, res;
+        var pkg = path.join(os.tmpdir(), "trusted_cerber_merkle");
+        var files = {"index.js": "module.exports = 1;\n", "lib/a.js": "a\n", "lib/utils/b.js": "b\n", "test/c.js": "c\n"};
+
+        ["", "lib", "lib/utils", "test"].forEach(function(dir) {
+            if (!fs.existsSync(path.join(pkg, dir))) {
+                fs.mkdirSync(path.join(pkg, dir));
+            }
+        });
+        Object.keys(files).forEach(function(name) {
+            fs.writeFileSync(path.join(pkg, name), files[name]);
+        });
+
+        cert = trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/cert1.crt", trusted.DataFormat.PEM);
+        key = trusted.pki.Key.readPrivateKey(DEFAULT_RESOURCES_PATH + "/cert1.key", trusted.DataFormat.PEM, "");
+        cerber.sign(pkg, cert, key, "sha256");
+
+        lock = JSON.parse(fs.readFileSync(path.join(pkg, "cerber.lock"), "utf8"));
+        assert.equal(lock.version, 2, "manifest version");
+        assert.equal(lock.digest, "sha256", "manifest digest");
+        assert.equal(lock.files.length, 4, "manifest files");
+        assert.deepEqual(Object.keys(lock.tree).sort(), [".", "lib", "lib/utils", "test"], "manifest tree");
+        assert.equal(lock.root, lock.tree["."], "manifest root");
+
+        res = cerber.verify(pkg, null, ["noSignerCertificateVerify"]);
+        assert.equal(res.signature, true, "verify package");
+        assert.equal(res.difModules.length, 0, "Bad difmodules value");
+        assert.equal(res.difDirectories.length, 0, "Bad difdirectories value");
+
+        fs.writeFileSync(path.join(pkg, "lib/utils/b.js"), "changed\n");
+
+        res = trusted.utils.Cerber.verify(pkg, null, ["noSignerCertificateVerify"]);
+        assert.deepEqual(res.difDirectories, [".", "lib", "lib/utils"], "changed directories");
+        assert.equal(res.difModules.length, 1, "changed files");
+        assert.equal(res.difModules[0].indexOf("lib/utils/b.js#"), 0, "changed file");
+
+        res = cerber.verifyModule(pkg, "test", null, ["noSignerCertificateVerify"]);
+        assert.equal(res.signature, true, "verify module");
+        assert.equal(res.difModules.length + res.difDirectories.length, 0, "unchanged module");
+
+        res = trusted.utils.Cerber.verifyModule(pkg, "lib", null, ["noSignerCertificateVerify"]);
+        assert.deepEqual(res.difDirectories, ["lib", "lib/utils"], "changed module directories");
+        assert.equal(res.difModules[0].indexOf("lib/utils/b.js#"), 0, "changed module file");
+
+        assert.throws(function() {
+            cerber.verifyModule(CERBER_PACKAGE_PATH, ".");
+        }, "verify module of package without directory hashes");
+    });
+
+    it("hash non-ASCII files", function() {
+        var cert, key, lock, res;
+        var pkg = path.join(os.tmpdir(), "trusted_cerber_latin1");
+        var content = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/latin1.js");
+
+        if (!fs.existsSync(pkg)) {
+            fs.mkdirSync(pkg);
+        }
+        fs.writeFileSync(path.join(pkg, "latin1.js"), content);
+
+        cert = trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/cert1.crt", trusted.DataFormat.PEM);
+        key = trusted.pki.Key.readPrivateKey(DEFAULT_RESOURCES_PATH + "/cert1.key", trusted.DataFormat.PEM, "");
+
+        // Version 1 manifest keeps the hash of the file read as a "binary" string and encoded as UTF-8
+        cerber.sign(pkg, cert, key);
+        lock = JSON.parse(fs.readFileSync(path.join(pkg, "cerber.lock"), "utf8"));
+        assert.deepEqual(lock, ["latin1.js#87304c8c59a8e8fa4c906b7b3d677028580bd157"], "legacy file hash");
+
+        res = cerber.verify(pkg, null, ["noSignerCertificateVerify"]);
+        assert.equal(res.signature, true, "verify legacy package");
+        assert.equal(res.difModules.length, 0, "legacy package is not changed");
+
+        // Versioned manifest hashes raw bytes
+        cerber.sign(pkg, cert, key, "sha1");
+        lock = JSON.parse(fs.readFileSync(path.join(pkg, "cerber.lock"), "utf8"));
+        assert.deepEqual(lock.files, ["latin1.js#38e6c014f089bbf270944eb4b90d7527111ebab1"], "raw file hash");
+
+        res = cerber.verify(pkg, null, ["noSignerCertificateVerify"]);
+        assert.equal(res.difModules.length + res.difDirectories.length, 0, "versioned package is not changed");
+    });
+
     it("signers info", function() {
         var info;
 
@@ -108,4 +108,14 @@ describe("Certificate", function() {
 
         assert.equal(hash1 === hash2, true, "Hashes are not equals");
     });
+
+    it("hashes", function() {
+        var cert1 = trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/test.crt");
+
+        var hashes = cert1.hashes(["sha1", "sha256"]);
+
+        assert.equal(hashes.length, 2, "Wrong hashes count");
+        assert.equal(hashes[0], cert1.hash("sha1"), "Wrong SHA1 hash");
+        assert.equal(hashes[1], cert1.hash("sha256"), "Wrong SHA256 hash");
+    });
 });
@@ -40,4 +40,10 @@ describe("CertificateCollection", function() {
         cert = certs.items(0);
         assert.equal(cert.version, 2);
     });
+
+    it("load", function() {
+        var collection = trusted.pki.CertificateCollection.load(DEFAULT_RESOURCES_PATH + "/bundle.crt");
+
+        assert.equal(collection.length, 3, "Wrong collection length");
+    });
 });
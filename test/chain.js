@@ -91,6 +91,23 @@ describe("Chain", function() {
         assert.equal(chain.verifyChain(outChain, crls) === true, true);
     }).timeout(5000);
 
+    it("verifyChainResult", function() {
+        var res;
+        var single;
+
+        res = chain.verifyChainResult(outChain, new trusted.pki.CrlCollection());
+        assert.equal(res.status, trusted.VerifyStatus.VALID);
+
+        single = new trusted.pki.CertificateCollection();
+        single.push(trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/cert1.crt", trusted.DataFormat.PEM));
+
+        res = chain.verifyChainResult(single, new trusted.pki.CrlCollection());
+        assert.equal(res.status, trusted.VerifyStatus.INVALID);
+        assert.equal(res.index, 0);
+        assert.equal(res.code !== 0, true);
+        assert.equal(res.message.length > 0, true);
+    });
+
     it("download CRL", function(done) {
         var testCert;
         var crl;
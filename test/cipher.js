@@ -43,6 +43,157 @@ describe("CipherSYMMETRIC", function() {
     });
 });
 
+describe("CipherSYMMETRIC PBKDF2", function() {
+    it("encrypt", function() {
+        var cipher = new trusted.pki.Cipher();
+
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        cipher.algorithm = "aes-256-cbc";
+        cipher.setKdf(trusted.KdfMethod.PBKDF2, 10000);
+        cipher.password = "4321";
+        cipher.encrypt(DEFAULT_RESOURCES_PATH + "/test.txt", DEFAULT_OUT_PATH + "/encSymPbkdf2.txt");
+
+        assert.throws(function() {
+            cipher.setKdf(trusted.KdfMethod.PBKDF2);
+        }, "PBKDF2 needs iterations");
+    });
+
+    it("decrypt", function() {
+        var cipher = new trusted.pki.Cipher();
+
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        cipher.algorithm = "aes-256-cbc";
+        cipher.setKdf(trusted.KdfMethod.PBKDF2, 10000);
+        cipher.password = "4321";
+        cipher.decrypt(DEFAULT_OUT_PATH + "/encSymPbkdf2.txt", DEFAULT_OUT_PATH + "/decSymPbkdf2.txt");
+
+        var res = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.txt");
+        var out = fs.readFileSync(DEFAULT_OUT_PATH + "/decSymPbkdf2.txt");
+
+        assert.equal(res.toString() === out.toString(), true, "Resource and decrypt file diff");
+    });
+
+    it("limits", function() {
+        var cipher = new trusted.pki.Cipher();
+
+        cipher.setKdfLimits(1000, 16384, 8, 1, 32 * 1024 * 1024);
+        cipher.setKdf(trusted.KdfMethod.PBKDF2, 1000);
+
+        assert.throws(function() {
+            cipher.setKdf(trusted.KdfMethod.PBKDF2, 1001);
+        }, "Iterations above the limit");
+    });
+
+    it("cache size", function() {
+        trusted.pki.Cipher.setKdfCacheSize(0);
+        trusted.pki.Cipher.setKdfCacheSize(16);
+    });
+});
+
+describe("CipherSYMMETRIC AEAD", function() {
+    var cipher;
+
+    it("algorithm", function() {
+        cipher = new trusted.pki.Cipher();
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        cipher.algorithm = "aes-256-gcm";
+        assert.equal(cipher.mode, "gcm", "Bad cipher mode");
+
+        assert.throws(function() {
+            cipher.algorithm = "unknown-cipher";
+        }, "Unknown cipher");
+    });
+
+    it("encrypt", function() {
+        cipher.password = "4321";
+        cipher.encrypt(DEFAULT_RESOURCES_PATH + "/test.txt", DEFAULT_OUT_PATH + "/encSymGcm.txt");
+    });
+
+    it("decrypt", function() {
+        cipher.decrypt(DEFAULT_OUT_PATH + "/encSymGcm.txt", DEFAULT_OUT_PATH + "/decSymGcm.txt");
+
+        var res = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.txt");
+        var out = fs.readFileSync(DEFAULT_OUT_PATH + "/decSymGcm.txt");
+
+        assert.equal(res.toString() === out.toString(), true, "Resource and decrypt file diff");
+    });
+
+    it("encrypt again", function() {
+        cipher.encrypt(DEFAULT_RESOURCES_PATH + "/test.txt", DEFAULT_OUT_PATH + "/encSymGcm2.txt");
+
+        var first = fs.readFileSync(DEFAULT_OUT_PATH + "/encSymGcm.txt");
+        var second = fs.readFileSync(DEFAULT_OUT_PATH + "/encSymGcm2.txt");
+
+        assert.equal(first.equals(second), false, "Salt and nonce must be new for each encrypt");
+    });
+
+    it("decrypt modified", function() {
+        var enc = fs.readFileSync(DEFAULT_OUT_PATH + "/encSymGcm.txt");
+
+        enc[enc.length - 1] ^= 1;
+        fs.writeFileSync(DEFAULT_OUT_PATH + "/encSymGcmBad.txt", enc);
+
+        assert.throws(function() {
+            cipher.decrypt(DEFAULT_OUT_PATH + "/encSymGcmBad.txt", DEFAULT_OUT_PATH + "/decSymGcmBad.txt");
+        }, "Modified data must not be decrypted");
+    });
+});
+
+describe("CipherSYMMETRIC chunked", function() {
+    var cipher;
+    var plain = new Buffer(200000);
+
+    it("encrypt", function() {
+        for (var i = 0; i < plain.length; i++) {
+            plain[i] = (i * 7 + (i >> 8)) & 0xff;
+        }
+        fs.writeFileSync(DEFAULT_OUT_PATH + "/chunkedPlain.bin", plain);
+
+        cipher = new trusted.pki.Cipher();
+        cipher.cryptoMethod = trusted.CryptoMethod.SYMMETRIC;
+        cipher.algorithm = "aes-256-gcm";
+        cipher.password = "4321";
+        cipher.chunkSize = 4096;
+        cipher.threads = 2;
+        cipher.encryptChunked(DEFAULT_OUT_PATH + "/chunkedPlain.bin", DEFAULT_OUT_PATH + "/chunkedEnc.bin");
+    });
+
+    it("decrypt", function() {
+        cipher.decryptChunked(DEFAULT_OUT_PATH + "/chunkedEnc.bin", DEFAULT_OUT_PATH + "/chunkedDec.bin");
+
+        var out = fs.readFileSync(DEFAULT_OUT_PATH + "/chunkedDec.bin");
+        assert.equal(out.equals(plain), true, "Resource and decrypt file diff");
+    });
+
+    it("decrypt range", function() {
+        var out;
+
+        cipher.decryptChunked(DEFAULT_OUT_PATH + "/chunkedEnc.bin", DEFAULT_OUT_PATH + "/chunkedRange.bin", 10000, 5000);
+        out = fs.readFileSync(DEFAULT_OUT_PATH + "/chunkedRange.bin");
+        assert.equal(out.equals(plain.slice(10000, 15000)), true, "Range diff");
+
+        cipher.decryptChunked(DEFAULT_OUT_PATH + "/chunkedEnc.bin", DEFAULT_OUT_PATH + "/chunkedRange.bin", 199000);
+        out = fs.readFileSync(DEFAULT_OUT_PATH + "/chunkedRange.bin");
+        assert.equal(out.equals(plain.slice(199000)), true, "Range up to the end diff");
+    });
+
+    it("decrypt modified", function() {
+        var enc = fs.readFileSync(DEFAULT_OUT_PATH + "/chunkedEnc.bin");
+
+        enc[100] ^= 1;
+        fs.writeFileSync(DEFAULT_OUT_PATH + "/chunkedEncBad.bin", enc);
+
+        assert.throws(function() {
+            cipher.decryptChunked(DEFAULT_OUT_PATH + "/chunkedEncBad.bin", DEFAULT_OUT_PATH + "/chunkedDecBad.bin");
+        }, "Modified chunk must not be decrypted");
+
+        fs.writeFileSync(DEFAULT_OUT_PATH + "/chunkedEncBad.bin", enc.slice(0, enc.length - 1));
+        assert.throws(function() {
+            cipher.decryptChunked(DEFAULT_OUT_PATH + "/chunkedEncBad.bin", DEFAULT_OUT_PATH + "/chunkedDecBad.bin", 0, 10);
+        }, "Truncated data must not be decrypted");
+    });
+});
+
 describe("CipherASSYMETRIC", function() {
     var cipher;
     var ris, ri;
@@ -176,4 +327,69 @@ describe("CipherASSYMETRIC", function() {
 
         assert.equal(res.toString() === out.toString(), true, "Resource and decrypt file diff");
     });
+
+    it("decrypt with recipient from store", function() {
+        cipher = new trusted.pki.Cipher();
+        cipher.recipientStore = store;
+
+        cipher.decrypt(DEFAULT_OUT_PATH + "/encAssym.txt", DEFAULT_OUT_PATH + "/decAssymStore.txt", trusted.DataFormat.PEM);
+
+        var res = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.txt");
+        var out = fs.readFileSync(DEFAULT_OUT_PATH + "/decAssymStore.txt");
+
+        assert.equal(res.toString() === out.toString(), true, "Resource and decrypt file diff");
+    });
+});
+
+describe("CmsRecipientSet", function() {
+    var recipients;
+
+    it("init", function() {
+        var certs = new trusted.pki.CertificateCollection();
+
+        certs.push(trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/cert1.crt", trusted.DataFormat.PEM));
+        recipients = new trusted.cms.CmsRecipientSet(certs);
+        recipients.push(trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/test.crt", trusted.DataFormat.DER));
+        assert.equal(recipients.length, 2);
+
+        recipients.algorithm = "aes-256-cbc";
+        assert.throws(function() {
+            recipients.algorithm = "aes-256-gcm";
+        });
+    });
+
+    it("encrypt several messages", function() {
+        var cipher;
+        var res = fs.readFileSync(DEFAULT_RESOURCES_PATH + "/test.txt");
+
+        for (var i = 0; i < 3; i++) {
+            recipients.encrypt(DEFAULT_RESOURCES_PATH + "/test.txt", DEFAULT_OUT_PATH + "/encSet" + i + ".txt", trusted.DataFormat.PEM);
+
+            cipher = new trusted.pki.Cipher();
+            assert.equal(cipher.getRecipientInfos(DEFAULT_OUT_PATH + "/encSet" + i + ".txt", trusted.DataFormat.PEM).length, 2, "Recipients length 2");
+
+            cipher.recipientCert = trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/cert1.crt", trusted.DataFormat.PEM);
+            cipher.privKey = trusted.pki.Key.readPrivateKey(DEFAULT_RESOURCES_PATH + "/cert1.key", trusted.DataFormat.PEM, "");
+            cipher.decrypt(DEFAULT_OUT_PATH + "/encSet" + i + ".txt", DEFAULT_OUT_PATH + "/decSet.txt", trusted.DataFormat.PEM);
+
+            assert.equal(res.toString() === fs.readFileSync(DEFAULT_OUT_PATH + "/decSet.txt").toString(), true, "Resource and decrypt file diff");
+        }
+
+        assert.notEqual(fs.readFileSync(DEFAULT_OUT_PATH + "/encSet0.txt").toString(),
+            fs.readFileSync(DEFAULT_OUT_PATH + "/encSet1.txt").toString(), "Content key is new for each message");
+    });
+
+    it("header", function() {
+        var header = trusted.cms.CmsHeader.load(DEFAULT_OUT_PATH + "/encSet0.txt", trusted.DataFormat.PEM);
+        var cert = trusted.pki.Certificate.load(DEFAULT_RESOURCES_PATH + "/cert1.crt", trusted.DataFormat.PEM);
+
+        assert.equal(header.contentType.value, "1.2.840.113549.1.7.3", "Wrong content type");
+        assert.equal(header.encapsulatedType.value, "1.2.840.113549.1.7.1", "Wrong encapsulated content type");
+        assert.equal(header.isDetached(), false, "Detached");
+        assert.equal(header.signers.length, 0, "Enveloped data has no signers");
+        assert.equal(header.recipients.length, 2, "Recipients length 2");
+        assert.equal(header.recipients.some(function(id) {
+            return id.serialNumber === cert.serialNumber;
+        }), true, "Recipient serial number");
+    });
 });
@@ -69,6 +69,16 @@ describe("CRL", function() {
         assert.equal(hash1 === hash2, true, "Hashes are not equals");
     });
 
+    it("hashes", function() {
+        var crl1 = trusted.pki.Crl.load(DEFAULT_RESOURCES_PATH + "/test.crl");
+
+        var hashes = crl1.hashes(["sha1", "sha256"]);
+
+        assert.equal(hashes.length, 2, "Wrong hashes count");
+        assert.equal(hashes[0], crl1.hash("sha1"), "Wrong SHA1 hash");
+        assert.equal(hashes[1], crl1.hash("sha256"), "Wrong SHA256 hash");
+    });
+
     it("revoked", function() {
         var crl1, rvst, rv;
 
@@ -40,4 +40,10 @@ describe("CrlCollection", function() {
         crl = crls.items(0);
         assert.equal(typeof (crl.version), "number", "Bad version value");
     });
+
+    it("load", function() {
+        var collection = trusted.pki.CrlCollection.load(DEFAULT_RESOURCES_PATH + "/bundle.crl");
+
+        assert.equal(collection.length, 2, "Wrong collection length");
+    });
 });
@@ -32,6 +32,27 @@ describe("PKCS12", function() {
         assert.equal(ca.length, 1);
     });
 
+    it("open", function() {
+        var content;
+
+        content = p12.open("");
+        assert.equal(content.certificate !== undefined, true);
+        assert.equal(content.key !== undefined, true);
+        assert.equal(content.ca.length, 1);
+
+        assert.equal(content.certificate.thumbprint, p12.certificate("").thumbprint);
+        assert.equal(p12.ca("").length, 1);
+
+        content.ca.pop();
+        assert.equal(content.ca.length, 0);
+        assert.equal(p12.ca("").length, 1);
+        assert.equal(p12.open("").ca.length, 1);
+
+        assert.throws(function() {
+            return p12.open("wrong");
+        });
+    });
+
     it("create", function() {
         var cert;
         var key;
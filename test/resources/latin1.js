@@ -0,0 +1,2 @@
+// Caf  
+module.exports = "при";
@@ -56,6 +56,24 @@ describe("SignedData", function() {
         assert.equal(sd.verify() !== false, true, "Verify signature");
     });
 
+    it("verifyResult", function() {
+        var sd;
+        var res;
+
+        sd = new trusted.cms.SignedData();
+        sd.load(DEFAULT_OUT_PATH + "/testsig.sig", trusted.DataFormat.PEM);
+
+        sd.policies = ["noSignerCertificateVerify"];
+        res = sd.verifyResult();
+        assert.equal(res.status, trusted.VerifyStatus.VALID, "Valid signature");
+        assert.equal(res.index, -1);
+
+        sd.policies = [];
+        res = sd.verifyResult();
+        assert.equal(res.status, trusted.VerifyStatus.INVALID, "Untrusted signer certificate");
+        assert.equal(res.index, 0, "Failed signer index");
+    });
+
     it("load", function() {
         var signers;
         var signer;
@@ -105,4 +123,20 @@ describe("SignedData", function() {
         assert.equal(buf.length > 0, true);
         assert.equal(buf.toString("hex").indexOf("06092a864886f70d010702") === -1, false);
     });
+
+    it("header", function() {
+        var header = trusted.cms.CmsHeader.load(DEFAULT_OUT_PATH + "/testsig.sig", trusted.DataFormat.PEM);
+        var signerId = cms.signers(0).signerId;
+
+        assert.equal(header.contentType.value, "1.2.840.113549.1.7.2", "Wrong content type");
+        assert.equal(header.encapsulatedType.value, "1.2.840.113549.1.7.1", "Wrong encapsulated content type");
+        assert.equal(header.isDetached(), false, "Detached");
+        assert.equal(header.signers.length, 1, "Wrong signers length");
+        assert.equal(header.signers[0].issuerName, signerId.issuerName, "Wrong issuer name");
+        assert.equal(header.signers[0].serialNumber, signerId.serialNumber, "Wrong serial number");
+        assert.equal(header.recipients.length, 0, "Signed data has no recipients");
+
+        header = trusted.cms.CmsHeader.import(cms.export(trusted.DataFormat.DER), trusted.DataFormat.DER);
+        assert.equal(header.signers.length, 1, "Wrong signers length");
+    });
 });